@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/** Times load_obj on a generated grid with positions, UVs and normals.
+ *
+ *  Usage: obj_benchmark [size] [path]
+ *
+ *  A size of 1000 gives 1M vertices and 2M faces (about 200 MB). The file is
+ *  written to path (obj_benchmark.obj by default) and removed afterwards.
+ *  Run it under `taskset -c 0` to measure a single core. The benchmark only
+ *  uses the public load_obj API, so it can also be built against earlier
+ *  versions of the library for comparison.
+ */
+
+#include "scenepic.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace sp = scenepic;
+
+namespace
+{
+  /** Writes a size x size grid of vertices, split into two triangles per
+   *  cell, with a UV and a normal per vertex.
+   */
+  void write_grid(const std::string& path, int size)
+  {
+    std::ofstream file(path);
+    file.precision(7);
+    for (int row = 0; row < size; ++row)
+    {
+      for (int col = 0; col < size; ++col)
+      {
+        float x = static_cast<float>(col) / size;
+        float y = static_cast<float>(row) / size;
+        file << "v " << x << " " << y << " " << x * y << "\n";
+      }
+    }
+
+    for (int row = 0; row < size; ++row)
+    {
+      for (int col = 0; col < size; ++col)
+      {
+        file << "vt " << static_cast<float>(col) / size << " "
+             << static_cast<float>(row) / size << "\n";
+      }
+    }
+
+    for (int row = 0; row < size; ++row)
+    {
+      for (int col = 0; col < size; ++col)
+      {
+        float x = static_cast<float>(col) / size;
+        float y = static_cast<float>(row) / size;
+        file << "vn " << -y << " " << -x << " 1\n";
+      }
+    }
+
+    auto corner = [&file](int index) {
+      file << " " << index << "/" << index << "/" << index;
+    };
+
+    for (int row = 0; row + 1 < size; ++row)
+    {
+      for (int col = 0; col + 1 < size; ++col)
+      {
+        int v00 = row * size + col + 1;
+        int v01 = v00 + 1;
+        int v10 = v00 + size;
+        int v11 = v10 + 1;
+        file << "f";
+        corner(v00);
+        corner(v01);
+        corner(v11);
+        file << "\nf";
+        corner(v00);
+        corner(v11);
+        corner(v10);
+        file << "\n";
+      }
+    }
+  }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  int size = argc > 1 ? std::atoi(argv[1]) : 1000;
+  std::string path = argc > 2 ? argv[2] : "obj_benchmark.obj";
+
+  write_grid(path, size);
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  std::cout << "grid with " << size * size << " vertices ("
+            << file.tellg() / (1024 * 1024) << " MB)" << std::endl;
+  file.close();
+
+  const int num_runs = 3;
+  for (int run = 0; run < num_runs; ++run)
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto mesh_info = sp::load_obj(path);
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    std::cout << "load_obj: " << elapsed.count() << "ms ("
+              << mesh_info->position_buffer().rows() << " vertices, "
+              << mesh_info->triangle_buffer().rows() << " triangles)"
+              << std::endl;
+  }
+
+  std::remove(path.c_str());
+  return 0;
+}
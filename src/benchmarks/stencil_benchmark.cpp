@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "scenepic.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace sp = scenepic;
+
+namespace
+{
+  /** Creates the triangles of a closed torus made from a grid of quads. */
+  sp::TriangleBuffer torus_triangles(std::uint32_t rows, std::uint32_t cols)
+  {
+    sp::TriangleBuffer triangles(2 * rows * cols, 3);
+    auto index = [cols](std::uint32_t row, std::uint32_t col) {
+      return row * cols + col;
+    };
+
+    for (std::uint32_t row = 0, i = 0; row < rows; ++row)
+    {
+      std::uint32_t next_row = (row + 1) % rows;
+      for (std::uint32_t col = 0; col < cols; ++col)
+      {
+        std::uint32_t next_col = (col + 1) % cols;
+        std::uint32_t v00 = index(row, col);
+        std::uint32_t v01 = index(row, next_col);
+        std::uint32_t v10 = index(next_row, col);
+        std::uint32_t v11 = index(next_row, next_col);
+        triangles.row(i++) = sp::Triangle(v00, v01, v11);
+        triangles.row(i++) = sp::Triangle(v00, v11, v10);
+      }
+    }
+
+    return triangles;
+  }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  std::uint32_t size = argc > 1 ? std::atoi(argv[1]) : 500;
+  sp::TriangleBuffer triangles = torus_triangles(size, size);
+  std::cout << "torus with " << triangles.rows() << " triangles" << std::endl;
+
+  for (int steps = 1; steps <= 3; ++steps)
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto stencil = sp::LoopSubdivisionStencil::create(triangles, steps);
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    std::cout << "steps=" << steps << ": " << elapsed.count() << "ms ("
+              << stencil.vertex_count() << " vertices, "
+              << stencil.triangle_count() << " triangles)" << std::endl;
+  }
+
+  const int num_frames = 32;
+  auto stencil = sp::LoopSubdivisionStencil::create(triangles, 2);
+  sp::VertexBuffer frames =
+    sp::VertexBuffer::Random(triangles.maxCoeff() + 1, 3 * num_frames);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < num_frames; ++frame)
+  {
+    stencil.apply(frames.middleCols(3 * frame, 3));
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = end - start;
+  std::cout << "apply x" << num_frames << ": " << elapsed.count() << "ms"
+            << std::endl;
+
+  start = std::chrono::steady_clock::now();
+  stencil.apply_batch(frames);
+  end = std::chrono::steady_clock::now();
+  elapsed = end - start;
+  std::cout << "apply_batch(" << num_frames << "): " << elapsed.count() << "ms"
+            << std::endl;
+
+  return 0;
+}
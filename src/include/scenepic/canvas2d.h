@@ -81,6 +81,31 @@ namespace scenepic
 
     Canvas2D& media_id(const std::string& media_id);
 
+    /** Whether the coordinates and styles of every frame are written as a
+     *  single pair of buffers at the canvas level. Each frame then refers to
+     *  its range of rows, which saves the overhead of compressing many small
+     *  buffers and lets similar frames compress against each other. The
+     *  default is false.
+     */
+    bool shared_buffers() const;
+
+    /** Whether the frame buffers are written once for the whole canvas. */
+    Canvas2D& shared_buffers(bool shared_buffers);
+
+    /** Whether the shared coordinates of a frame are stored relative to
+     *  those of the previous frame, when both have the same number of
+     *  coordinates. The bits of each coordinate are XOR-ed with those of the
+     *  previous frame, which is lossless and turns unchanged coordinates into
+     *  zeros. Has no effect unless shared_buffers is set. The default is
+     *  false.
+     */
+    bool delta_coordinates() const;
+
+    /** Whether shared coordinates are stored relative to the previous
+     *  frame.
+     */
+    Canvas2D& delta_coordinates(bool delta_coordinates);
+
   private:
     friend class Scene;
 
@@ -91,6 +116,11 @@ namespace scenepic
      */
     Canvas2D(const std::string& canvas_id, double width, double height);
 
+    /** Appends a command holding the buffers of every frame, followed by
+     *  frames which refer to them.
+     */
+    void append_shared_frames(JsonValue& canvas_commands) const;
+
     std::string m_canvas_id;
     std::string m_media_id;
     std::vector<std::string> m_layer_ids;
@@ -100,6 +130,8 @@ namespace scenepic
     Color m_background_color;
     double m_width;
     double m_height;
+    bool m_shared_buffers;
+    bool m_delta_coordinates;
 
     // This will get out of sync with the above after a call to clear_script()
     // DO NOT REMOVE - it is important
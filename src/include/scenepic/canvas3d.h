@@ -13,10 +13,12 @@
 #include "shading.h"
 #include "ui_parameters.h"
 
+#include <cstddef>
 #include <limits>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace scenepic
 {
@@ -72,6 +74,70 @@ namespace scenepic
       return this->create_frame(frame_id, focus_point, mesh_ids, camera);
     }
 
+    /** Adds a mesh to a run of consecutive frames with a different pose in
+     *  each frame, e.g. for rigid-body animation. This has the same effect
+     *  as calling add_mesh_by_id on each frame, but the whole track is
+     *  stored as a single quantized, delta-coded buffer, which is orders of
+     *  magnitude smaller than one transform per frame.
+     *
+     *  \param mesh_id the id of the mesh to animate
+     *  \param poses one row per frame, either [F, 7] poses stored as
+     *               [tx, ty, tz, qx, qy, qz, qw] (a translation followed by a
+     *               rotation quaternion) or [F, 16] affine transforms stored
+     *               as the 4x4 matrix in row-major order
+     *  \param start_frame the index of the frame which receives the first
+     *                     pose. The frames must already have been created.
+     *  \param precision the largest error allowed in translations. Rotations
+     *                   are quantized to 1/32768, relative to the largest
+     *                   scale of each axis for affine transforms.
+     *  \throws std::invalid_argument if there are no poses
+     */
+    void add_transform_track(
+      const std::string& mesh_id,
+      const ConstVertexBufferRef& poses,
+      std::size_t start_frame = 0,
+      float precision = 1e-4f);
+
+    /** Sets the cameras of a run of frames, e.g. for a fly-through created
+     *  with Camera::orbit. This replaces the cameras passed to create_frame,
+     *  but instead of two matrices per frame the center, look-at point, up
+     *  direction and field of view of every camera are stored as a single
+     *  quantized, delta-coded buffer. With a keyframe interval greater than
+     *  one, the client interpolates linearly between consecutive cameras
+     *  for the frames in between.
+     *
+     *  \param cameras one camera per keyframe. All of them must have a
+     *                 perspective projection with the same aspect ratio
+     *                 and clipping planes.
+     *  \param start_frame the index of the frame which receives the first
+     *                     camera. The frames must already have been created.
+     *  \param keyframe_interval the number of frames between cameras
+     *  \param precision the largest error allowed in positions
+     */
+    void add_camera_track(
+      const std::vector<Camera>& cameras,
+      std::size_t start_frame = 0,
+      std::size_t keyframe_interval = 1,
+      float precision = 1e-4f);
+
+    /** Sets the focus points of a run of frames. This works in the same way
+     *  as add_camera_track, with the positions (and orientations, if the
+     *  focus points have them) stored as a single delta-coded buffer.
+     *
+     *  \param focus_points one focus point per keyframe. Either all or none
+     *                      of them must have an orientation.
+     *  \param start_frame the index of the frame which receives the first
+     *                     focus point. The frames must already have been
+     *                     created.
+     *  \param keyframe_interval the number of frames between focus points
+     *  \param precision the largest error allowed in positions
+     */
+    void add_focus_point_track(
+      const std::vector<FocusPoint>& focus_points,
+      std::size_t start_frame = 0,
+      std::size_t keyframe_interval = 1,
+      float precision = 1e-4f);
+
     /** Specify the visibilities and opacities of certain mesh layers.
      *  Each Mesh object can optionally be part of a user-identified layer
      *  (see Mesh constructor). Calling set_layer_settings will result in an
@@ -137,6 +203,20 @@ namespace scenepic
 
     Canvas3D& media_id(const std::string& audio_id);
 
+    /** Whether frames are written relative to the previous frame. When
+     *  enabled, the meshes which every frame shares are written once as a
+     *  static layer, and each frame after the first lists only the meshes
+     *  which were removed from or added to the previous frame (a mesh which
+     *  moved counts as both). Meshes may be drawn in a different order
+     *  within a frame, but every frame is reconstructed in full by the
+     *  client. Once enabled, later scripts written without deltas clear the
+     *  static layer held by the client. The default is false.
+     */
+    bool delta_frames() const;
+
+    /** Whether frames are written relative to the previous frame. */
+    Canvas3D& delta_frames(bool delta_frames);
+
     /** The width of the canvas */
     double width() const;
 
@@ -163,6 +243,25 @@ namespace scenepic
       const FocusPoint& focus_point = FocusPoint::None(),
       const UIParameters& ui_parameters = UIParameters());
 
+    /** Appends the frames to the canvas commands as a static layer followed
+     *  by frames which are each expressed relative to the one before.
+     */
+    void append_delta_frames(JsonValue& canvas_commands) const;
+
+    /** Checks that a track of keyframes fits within the frames of the canvas
+     *  and starts the command which holds it.
+     *  \param command_type the type of the track command
+     *  \param num_keyframes the number of values in the track
+     *  \param start_frame the frame which receives the first value
+     *  \param keyframe_interval the number of frames between values
+     *  \return the command, to which the track values are added
+     */
+    JsonValue track_command(
+      const std::string& command_type,
+      std::size_t num_keyframes,
+      std::size_t start_frame,
+      std::size_t keyframe_interval) const;
+
     std::string m_canvas_id;
     Camera m_camera;
     Shading m_shading;
@@ -170,9 +269,15 @@ namespace scenepic
     UIParameters m_ui_parameters;
     std::map<std::string, LayerSettings> m_layer_settings;
     std::vector<std::shared_ptr<Frame3D>> m_frames;
+    std::vector<JsonValue> m_tracks;
     std::string m_media_id;
     double m_width;
     double m_height;
+    bool m_delta_frames;
+
+    // Whether a static layer may have been sent to the client, which must
+    // then be cleared when frames are no longer written as deltas
+    bool m_static_layer;
 
     // This will get out of sync with the above after a call to clear_script()
     // DO NOT REMOVE - it is important
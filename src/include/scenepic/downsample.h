@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#ifndef _SCENEPIC_DOWNSAMPLE_H_
+#define _SCENEPIC_DOWNSAMPLE_H_
+
+#include "matrix.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace scenepic
+{
+  /** Chooses a subset of a series of values which draws as nearly the same
+   *  line, so that long series can be displayed without sending every value.
+   *
+   *  "m4" splits the series into max_points / 4 equal ranges of indices and
+   *  keeps the first, last, smallest and largest value of each, so the
+   *  extremes of the series are always kept. "lttb" (Largest Triangle Three
+   *  Buckets) keeps the first and last values and, from each of
+   *  max_points - 2 ranges in between, the value which forms the largest
+   *  triangle with its neighbours, which follows the shape of the line more
+   *  closely for the same number of points.
+   *
+   *  \param values the series of values
+   *  \param max_points the largest number of values to keep
+   *  \param method the method to use, one of "m4" or "lttb"
+   *  \return the increasing indices of the values to keep. If there are no
+   *          more than max_points values, every index is returned.
+   */
+  std::vector<std::uint32_t> downsample(
+    const ConstValueBufferRef& values,
+    std::size_t max_points,
+    const std::string& method = "m4");
+} // namespace scenepic
+
+#endif
@@ -8,8 +8,10 @@
 #include "json_value.h"
 #include "matrix.h"
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace scenepic
 {
@@ -34,6 +36,28 @@ namespace scenepic
       bool close_path = false,
       const std::string& layer_id = "");
 
+    /** Add many lines with the same style to the frame at once. This is
+     *  much faster than calling add_line for each of them.
+     *  \param coordinates the coordinates of all of the lines, one after the
+     *                     other
+     *  \param offsets the index of the first coordinate of each line. Each
+     *                 line ends where the next one starts, and the last one
+     *                 at the end of the coordinates.
+     *  \param line_color the color of the lines
+     *  \param line_width the width of the lines
+     *  \param fill_color the fill color to use
+     *  \param close_path whether to close the paths
+     *  \param layer_id the unique ID of the layer for these primitives
+     */
+    void add_lines(
+      const CoordinateBuffer& coordinates,
+      const std::vector<std::uint32_t>& offsets,
+      const Color& line_color = Colors::Black,
+      float line_width = 1.0f,
+      const Color& fill_color = Color::None(),
+      bool close_path = false,
+      const std::string& layer_id = "");
+
     /** Add a rectangle to the frame.
      *  \param x the upper left corner x coordinate
      *  \param y the upper left corner y coordinate
@@ -72,6 +96,45 @@ namespace scenepic
       const Color& fill_color = Color::None(),
       const std::string& layer_id = "");
 
+    /** Add many rectangles to the frame at once. Each of the per-rectangle
+     *  arguments can either have one row per rectangle or a single row which
+     *  is shared by all of them.
+     *  \param rectangles the [N, 4] rectangles as (x, y, w, h) rows, where
+     *                    (x, y) is the upper left corner
+     *  \param line_colors the colors of the lines. Defaults to black.
+     *  \param line_widths the widths of the lines. Defaults to 1.
+     *  \param fill_colors the fill colors. Rows equal to Color::None() are
+     *                     not filled. Defaults to no fill.
+     *  \param layer_ids the unique IDs of the layers for these primitives.
+     *                   Defaults to no layer.
+     */
+    void add_rectangles(
+      const ConstVertexBufferRef& rectangles,
+      const ConstColorBufferRef& line_colors = ColorBufferNone(),
+      const ConstValueBufferRef& line_widths = ValueBufferNone(),
+      const ConstColorBufferRef& fill_colors = ColorBufferNone(),
+      const std::vector<std::string>& layer_ids = {});
+
+    /** Add many circles to the frame at once. Each of the per-circle
+     *  arguments can either have one row per circle or a single row which
+     *  is shared by all of them.
+     *  \param centers the [N, 2] centers of the circles
+     *  \param radii the radii of the circles
+     *  \param line_colors the colors of the lines. Defaults to black.
+     *  \param line_widths the widths of the lines. Defaults to 1.
+     *  \param fill_colors the fill colors. Rows equal to Color::None() are
+     *                     not filled. Defaults to no fill.
+     *  \param layer_ids the unique IDs of the layers for these primitives.
+     *                   Defaults to no layer.
+     */
+    void add_circles(
+      const ConstCoordinateBufferRef& centers,
+      const ConstValueBufferRef& radii,
+      const ConstColorBufferRef& line_colors = ColorBufferNone(),
+      const ConstValueBufferRef& line_widths = ValueBufferNone(),
+      const ConstColorBufferRef& fill_colors = ColorBufferNone(),
+      const std::vector<std::string>& layer_ids = {});
+
     /** Add an image to the frame.
      *  \param image_id the unique identifier of the image
      *  \param position_type one of "fit", "fill", "stretch", or "manual"
@@ -130,8 +193,30 @@ namespace scenepic
       const std::string& font_family = "sans-serif",
       const std::string& layer_id = "");
 
+    /** Add many pieces of text to the frame at once. The texts are sent as
+     *  a table of distinct strings, so repeated labels are only sent once.
+     *  Each of the per-text arguments can either have one row per text or a
+     *  single row which is shared by all of them.
+     *  \param texts the texts to display
+     *  \param positions the [N, 2] pixel positions of the left and bottom
+     *                   sides of the texts
+     *  \param colors the colors of the texts. Defaults to white.
+     *  \param sizes_in_pixels the vertical sizes of the texts in pixels.
+     *                         Defaults to 12.
+     *  \param font_family the font to use for all of the texts
+     *  \param layer_ids the unique IDs of the layers for these primitives.
+     *                   Defaults to no layer.
+     */
+    void add_texts(
+      const std::vector<std::string>& texts,
+      const ConstCoordinateBufferRef& positions,
+      const ConstColorBufferRef& colors = ColorBufferNone(),
+      const ConstValueBufferRef& sizes_in_pixels = ValueBufferNone(),
+      const std::string& font_family = "sans-serif",
+      const std::vector<std::string>& layer_ids = {});
+
     /** The number of coordinates in the buffer. */
-    std::uint16_t num_coordinates() const;
+    std::uint32_t num_coordinates() const;
 
     /** Return a JSON string representing the object */
     std::string to_string() const;
@@ -149,21 +234,46 @@ namespace scenepic
      */
     Frame2D(const std::string& frame_id);
 
+    /** Convert this object into ScenePic json.
+     *  \param coordinate_start the row of the first coordinate of this frame
+     *                          in the buffer shared by the canvas, or -1 to
+     *                          write the coordinates in the frame
+     *  \param style_start the row of the first line style of this frame in
+     *                     the buffer shared by the canvas (circle styles
+     *                     follow the line styles), or -1 to write the styles
+     *                     in the frame
+     *  \param delta_coordinates whether the shared coordinates are stored
+     *                           relative to the previous frame
+     *  \return a json value
+     */
+    JsonValue to_json(
+      std::int64_t coordinate_start,
+      std::int64_t style_start,
+      bool delta_coordinates) const;
+
     IndexVector
     lookup_layer_ids(const std::vector<std::string>& layer_ids) const;
+
+    /** Appends a coordinate to the buffer.
+     *  \return the index of the coordinate
+     */
+    std::uint32_t add_coordinate(float x, float y);
     std::map<std::string, std::uint8_t> m_layer_lookup;
 
     std::string m_frame_id;
-    CoordinateBuffer m_coord_buffer;
+    // the buffers are flat vectors so that appending is amortized
+    std::vector<float> m_coords;
 
-    PolyLineBuffer m_line_buffer;
-    StyleBuffer m_line_style_buffer;
+    // the start, end and close flag of each line
+    std::vector<std::uint32_t> m_lines;
+    std::vector<std::uint8_t> m_line_styles;
     std::vector<std::string> m_line_layer_ids;
     std::vector<float> m_line_width;
 
-    CircleBuffer m_circle_buffer;
+    // the center, radius and line width of each circle
+    std::vector<float> m_circles;
     std::vector<std::string> m_circle_layer_ids;
-    StyleBuffer m_circle_style_buffer;
+    std::vector<std::uint8_t> m_circle_styles;
 
     std::vector<JsonValue> m_frame_commands;
 
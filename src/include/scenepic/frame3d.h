@@ -12,8 +12,10 @@
 #include "matrix.h"
 #include "mesh.h"
 #include "mesh_update.h"
+#include "util.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -109,6 +111,20 @@ namespace scenepic
     /** Set the focus point of the frame. */
     Frame3D& focus_point(const FocusPoint& focus_point);
 
+    /** Whether the meshes of this frame are sent to the client as a single
+     *  compact table instead of one command per mesh.
+     */
+    bool compact_meshes() const;
+
+    /** Whether the meshes of this frame are sent to the client as a single
+     *  compact table instead of one command per mesh. The table holds the
+     *  distinct mesh ids of the frame, a compressed buffer of per-mesh
+     *  indices into them, and (if any mesh is transformed) one compressed
+     *  buffer of per-mesh transforms. This is much smaller and faster to
+     *  produce for frames which contain many meshes.
+     */
+    Frame3D& compact_meshes(bool compact_meshes);
+
     /** Return a JSON string representing the object */
     std::string to_string() const;
 
@@ -130,10 +146,34 @@ namespace scenepic
       const FocusPoint& focus_point = FocusPoint::None(),
       const Camera& camera = Camera::None());
 
+    /** Converts the frame into ScenePic json, using the provided commands
+     *  to add its meshes.
+     *  \param mesh_commands a JSON array of commands which add the meshes
+     *  \return a json value
+     */
+    JsonValue to_json(JsonValue mesh_commands) const;
+
+    /** Builds the commands which add a subset of the meshes of the frame.
+     *  \param draws the indices of the meshes to add, in the order they
+     *                should be added
+     *  \return a JSON array of commands
+     */
+    JsonValue mesh_commands_to_json(
+      const std::vector<std::uint32_t>& draws) const;
+
+    /** Builds a single command which adds a subset of the meshes at once.
+     *  \param draws the indices of the meshes to add
+     */
+    JsonValue mesh_table_to_json(const std::vector<std::uint32_t>& draws) const;
+
     std::string m_frame_id;
     FocusPoint m_focus_point;
     Camera m_camera;
-    std::vector<JsonValue> m_frame_commands;
+    IndexMap<std::string> m_mesh_ids;
+    std::vector<std::uint32_t> m_mesh_indices;
+    // 16 floats per mesh, in the storage order of Transform
+    std::vector<float> m_transforms;
+    bool m_compact_meshes;
     std::map<std::string, LayerSettings> m_layer_settings;
   };
 } // namespace scenepic
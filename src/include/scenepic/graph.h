@@ -162,6 +162,43 @@ namespace scenepic
     /** Set the size of the graph labels in pixels */
     Graph& value_size(float value_size);
 
+    /** The largest number of points sent for each sparkline, or 0 to send
+     *  every value (the default). Longer sparklines are downsampled (see
+     *  downsample) when the graph is converted to json, and the client
+     *  interpolates between the points which remain.
+     */
+    std::size_t max_points() const;
+
+    /** Set the largest number of points sent for each sparkline */
+    Graph& max_points(std::size_t max_points);
+
+    /** The method used to downsample sparklines, one of "m4" (the default)
+     *  or "lttb".
+     */
+    const std::string& downsampling() const;
+
+    /** Set the method used to downsample sparklines */
+    Graph& downsampling(const std::string& downsampling);
+
+    /** The number of resolutions sent for each downsampled sparkline. Each
+     *  level has four times as many points as the one before, up to every
+     *  value, and the client draws the coarsest level which has a point for
+     *  each pixel of the line. The default is 1.
+     */
+    std::size_t pyramid_levels() const;
+
+    /** Set the number of resolutions sent for each downsampled sparkline */
+    Graph& pyramid_levels(std::size_t pyramid_levels);
+
+    /** How sparkline values are stored, one of "float32" (the default),
+     *  "float16" or "quantized". Quantized values are delta coded in steps of
+     *  1/65535 of the range of the sparkline.
+     */
+    const std::string& value_encoding() const;
+
+    /** Set how sparkline values are stored */
+    Graph& value_encoding(const std::string& value_encoding);
+
     /** The unique ID of the media file associated with this canvas.
      *  This file will be used to drive playback, i.e. frames will be displayed
      *  in time with of the media file.
@@ -185,6 +222,20 @@ namespace scenepic
       std::string to_string() const;
       JsonValue to_json() const;
 
+      /** Convert this object into ScenePic json.
+       *  \param max_points the largest number of points to send, or 0 to
+       *                    send every value
+       *  \param downsampling the method used to downsample the values
+       *  \param pyramid_levels the number of resolutions to send
+       *  \param value_encoding how the values are stored
+       *  \return a json value
+       */
+      JsonValue to_json(
+        std::size_t max_points,
+        const std::string& downsampling,
+        std::size_t pyramid_levels,
+        const std::string& value_encoding) const;
+
     private:
       std::string m_name;
       ValueBuffer m_values;
@@ -210,6 +261,10 @@ namespace scenepic
     std::string m_value_align;
     float m_name_size;
     float m_value_size;
+    std::size_t m_max_points;
+    std::string m_downsampling;
+    std::size_t m_pyramid_levels;
+    std::string m_value_encoding;
   };
 } // namespace scenepic
 
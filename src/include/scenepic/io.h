@@ -6,12 +6,17 @@
 
 #include "mesh_info.h"
 
+#include <cstddef>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace scenepic
 {
+  class MeshUpdate;
+  class Scene;
+
   /** Load the geometry of a WaveFront OBJ file from a location on disk.
    *
    *  \param path location of the OBJ on disk
@@ -27,6 +32,53 @@ namespace scenepic
    *  \return the mesh information from the OBJ
    */
   std::shared_ptr<MeshInfo> load_obj(std::istream& stream);
-}
+
+  /** Load a sequence of WaveFront OBJ files (e.g. the frames of a capture) as
+   *  updates to a base mesh. Files are loaded in parallel on a pool of worker
+   *  threads, with only a bounded number of frames held in memory at once,
+   *  and the updates are added to the scene in frame order. Each file must
+   *  have the same faces (i.e. the same position, texture coordinate and
+   *  normal indices) as the base OBJ file, and each vertex of the base mesh
+   *  takes its position (and normal, if the files contain them) from the
+   *  same indices in every frame. Vertices which coincide in some frames
+   *  therefore do not change the topology.
+   *
+   *  \param scene the scene which contains the base mesh
+   *  \param base_mesh_id the id of the base mesh to update
+   *  \param base_path the location of the OBJ file the base mesh was created
+   *                   from with load_obj
+   *  \param paths the locations of the OBJ files on disk, in frame order
+   *  \param num_threads the number of worker threads to use. A value of 0
+   *                     uses one per hardware thread.
+   *
+   *  \return the mesh updates, one per file
+   */
+  std::vector<std::shared_ptr<MeshUpdate>> load_obj_sequence(
+    Scene& scene,
+    const std::string& base_mesh_id,
+    const std::string& base_path,
+    const std::vector<std::string>& paths,
+    std::size_t num_threads = 0);
+
+  /** Load the geometry of a binary (little endian) PLY file from a location
+   *  on disk. Vertex positions, normals, colors and texture coordinates are
+   *  read if present, and polygonal faces are triangulated. The file is
+   *  memory mapped and its vertices are read in chunks, so files larger than
+   *  the available memory can be loaded.
+   *
+   *  \param path location of the PLY on disk
+   *
+   *  \return the mesh information from the PLY
+   */
+  std::shared_ptr<MeshInfo> load_ply(const std::string& path);
+
+  /** Save the geometry of a mesh info as a binary (little endian) PLY file.
+   *
+   *  \param path location on disk to write the PLY
+   *  \param mesh_info the mesh information to save
+   */
+  void save_ply(
+    const std::string& path, const std::shared_ptr<MeshInfo>& mesh_info);
+} // namespace scenepic
 
 #endif
\ No newline at end of file
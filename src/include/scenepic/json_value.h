@@ -6,8 +6,8 @@
 
 #include <cstdint>
 #include <iostream>
-#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace scenepic
@@ -24,6 +24,86 @@ namespace scenepic
     Null
   };
 
+  class JsonValue;
+
+  /** The members of a JSON object, in the order they were added. Objects in
+   *  a scene have only a handful of members, so they are kept in one flat
+   *  array and found by a linear search, which takes a single allocation
+   *  instead of one per member. Larger objects (e.g. parsed from a file)
+   *  also keep the member positions sorted by key, so that building them
+   *  does not take quadratic time. The interface follows that of std::map,
+   *  except that adding a member may invalidate references to the others,
+   *  and the keys must not be changed through an iterator.
+   */
+  class JsonObject
+  {
+  public:
+    typedef std::pair<std::string, JsonValue> value_type;
+    typedef std::vector<value_type>::iterator iterator;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+
+    /** Iterator to the first member */
+    iterator begin();
+
+    /** Iterator to the first member */
+    const_iterator begin() const;
+
+    /** Iterator past the last member */
+    iterator end();
+
+    /** Iterator past the last member */
+    const_iterator end() const;
+
+    /** The number of members */
+    std::size_t size() const;
+
+    /** Whether the object has no members */
+    bool empty() const;
+
+    /** The number of members with the specified key (zero or one) */
+    std::size_t count(const std::string& key) const;
+
+    /** Return the member with the specified key, or end() if there is none.
+     *  \param key the locator key
+     */
+    iterator find(const std::string& key);
+
+    /** Return the member with the specified key, or end() if there is none.
+     *  \param key the locator key
+     */
+    const_iterator find(const std::string& key) const;
+
+    /** Return the value of the member with the specified key.
+     *  \param key the locator key
+     *  \return the stored value
+     *  \throws std::out_of_range if there is no such member
+     */
+    JsonValue& at(const std::string& key);
+
+    /** Return the value of the member with the specified key.
+     *  \param key the locator key
+     *  \return the stored value
+     *  \throws std::out_of_range if there is no such member
+     */
+    const JsonValue& at(const std::string& key) const;
+
+    /** Return the value of the member with the specified key, adding an
+     *  empty member at the end if there is none.
+     *  \param key the locator key
+     *  \return the stored value
+     */
+    JsonValue& operator[](const std::string& key);
+
+  private:
+    /** The first entry of the index whose key is not less than key. */
+    std::vector<std::size_t>::const_iterator
+    index_bound(const std::string& key) const;
+
+    std::vector<value_type> m_members;
+    // positions of the members sorted by key, once there are enough of them
+    std::vector<std::size_t> m_index;
+  };
+
   /** Representation of a JSON value according to the specification at
    * https://www.json.org/json-en.html. */
   class JsonValue
@@ -67,6 +147,22 @@ namespace scenepic
      */
     JsonValue(bool value);
 
+    /** Copy constructor. Copies every value this object contains. */
+    JsonValue(const JsonValue& other) = default;
+
+    /** Move constructor. Takes the values of the other object without
+     *  copying them.
+     */
+    JsonValue(JsonValue&& other) noexcept = default;
+
+    /** Copy assignment. Copies every value the other object contains. */
+    JsonValue& operator=(const JsonValue& other) = default;
+
+    /** Move assignment. Takes the values of the other object without
+     *  copying them.
+     */
+    JsonValue& operator=(JsonValue&& other) noexcept = default;
+
     /** Convert this objec to an array of the specified size.
      *
      *  \param size the number of elements in the array
@@ -151,8 +247,21 @@ namespace scenepic
     /** Return the values of this JSON array. */
     const std::vector<JsonValue>& values() const;
 
-    /** Return the key/value lookup for this JSON object. */
-    const std::map<std::string, JsonValue>& lookup() const;
+    /** Return the values of this JSON array. */
+    std::vector<JsonValue>& values();
+
+    /** Return the key/value lookup for this JSON object. This used to be a
+     *  std::map, so code which names that type must use JsonObject (or
+     *  auto) instead. Members are visited in the order they were added
+     *  rather than sorted by key, and adding a member through operator[]
+     *  may invalidate references to the others.
+     */
+    const JsonObject& lookup() const;
+
+    /** Return the key/value lookup for this JSON object. See the const
+     *  overload for how it differs from the std::map it replaces.
+     */
+    JsonObject& lookup();
 
     /** Parse a JsonValue object from the provided input stream.
      *  \param stream an input stream
@@ -164,12 +273,16 @@ namespace scenepic
     static JsonValue nullSingleton();
 
   private:
-    std::string m_string;
-    double m_double;
-    std::int64_t m_int;
-    bool m_bool;
     JsonType m_type;
-    std::map<std::string, JsonValue> m_lookup;
+    union
+    {
+      double m_double;
+      std::int64_t m_int;
+      bool m_bool;
+    };
+
+    std::string m_string;
+    JsonObject m_lookup;
     std::vector<JsonValue> m_values;
   };
 } // namespace scenepic
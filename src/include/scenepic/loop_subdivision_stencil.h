@@ -6,9 +6,16 @@
 
 #include "matrix.h"
 #include "mesh_info.h"
+#include "mesh_update.h"
+
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace scenepic
 {
+  class Scene;
+
   /** This class enables efficient Loop subdivision of triangle meshes.
    *
    *  The subdivision stencil specifies what linear combinations of existing
@@ -37,6 +44,30 @@ namespace scenepic
      */
     VertexBuffer apply(const ConstVertexBufferRef vertices) const;
 
+    /** Applies the stencil to several frames of vertices at once.
+     *
+     *  \param frames a (N, 3F) buffer holding F frames of vertices side by
+     *                side, such that frame f occupies columns 3f to 3f + 2.
+     *  \return a (S, 3F) buffer of subdivided frames in the same layout
+     */
+    VertexBuffer apply_batch(const ConstVertexBufferRef frames) const;
+
+    /** Applies the stencil to several frames of vertices and adds each
+     *  subdivided frame to the scene as an update of a base mesh. The
+     *  frames are subdivided a few at a time, so the full set of
+     *  subdivided positions is never held in memory.
+     *
+     *  \param frames a (N, 3F) buffer holding F frames of vertices side by
+     *                side, such that frame f occupies columns 3f to 3f + 2.
+     *  \param scene the scene which will hold the mesh updates
+     *  \param base_mesh_id the id of the subdivided base mesh
+     *  \return the mesh updates, one per frame
+     */
+    std::vector<std::shared_ptr<MeshUpdate>> apply_batch(
+      const ConstVertexBufferRef frames,
+      Scene& scene,
+      const std::string& base_mesh_id) const;
+
     /** The number of vertices in the subdivided mesh. */
     std::size_t vertex_count() const;
 
@@ -58,9 +89,49 @@ namespace scenepic
       int steps = 1,
       bool project_to_limit = false);
 
+    /** Returns a stencil for the provided triangles, reusing a previous
+     *  stencil if one was created in this process for the same triangles
+     *  and settings. Stencils are found by a hash of the triangles, so
+     *  meshes which share connectivity share a stencil.
+     *
+     *  \param triangles the initial triangle indices
+     *  \param steps specifies how many steps of subdivision to apply.
+     *               Defaults to 1.
+     *  \param project_to_limit specifies whether the vertices should be
+     *                          projected onto the limit surface in the final
+     *                          step of subdivision. Defaults to false.
+     *  \return a shared stencil object
+     */
+    static std::shared_ptr<LoopSubdivisionStencil> create_cached(
+      const ConstTriangleBufferRef triangles,
+      int steps = 1,
+      bool project_to_limit = false);
+
+    /** Removes all stencils from the cache used by create_cached. */
+    static void clear_cache();
+
+    /** Save the stencil to a binary file. The file holds the subdivided
+     *  triangles and the subdivision matrix as CSR arrays, each aligned so
+     *  that it can be used in place from a memory mapping.
+     *
+     *  \param path the location of the file on disk
+     */
+    void save(const std::string& path) const;
+
+    /** Load a stencil from a file written by save.
+     *
+     *  \param path the location of the file on disk
+     *  \return a stencil object
+     */
+    static LoopSubdivisionStencil load(const std::string& path);
+
   private:
+    LoopSubdivisionStencil(
+      TriangleBuffer triangles,
+      Eigen::SparseMatrix<float, Eigen::RowMajor> subdiv);
+
     TriangleBuffer m_triangles;
-    SparseMatrix m_subdiv;
+    Eigen::SparseMatrix<float, Eigen::RowMajor> m_subdiv;
   };
 } // namespace scenepic
 
@@ -54,6 +54,7 @@ namespace scenepic
   typedef Eigen::Matrix<std::uint16_t, Eigen::Dynamic, 3, Eigen::RowMajor>
     PolyLineBuffer;
   typedef Eigen::Matrix<std::uint8_t, Eigen::Dynamic, 1> IndexVector;
+  typedef Eigen::Matrix<std::uint16_t, Eigen::Dynamic, 1> HalfBuffer;
 
   typedef Eigen::Matrix<float, 1, Eigen::Dynamic> Vertex;
   typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
@@ -61,6 +62,15 @@ namespace scenepic
   typedef Eigen::
     Matrix<std::uint16_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
       FixedPointVertexBuffer;
+  typedef Eigen::Matrix<std::int16_t, Eigen::Dynamic, 2, Eigen::RowMajor>
+    PackedNormalShortBuffer;
+  typedef Eigen::Matrix<std::int8_t, Eigen::Dynamic, 2, Eigen::RowMajor>
+    PackedNormalByteBuffer;
+  typedef Eigen::Matrix<std::uint8_t, Eigen::Dynamic, 3, Eigen::RowMajor>
+    PackedColorBuffer;
+  typedef Eigen::
+    Matrix<std::int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      DeltaBuffer;
   typedef Eigen::Block<VertexBuffer, Eigen::Dynamic, Eigen::Dynamic, false>
     VertexBlock;
   typedef Eigen::
@@ -69,10 +79,13 @@ namespace scenepic
 
   typedef Eigen::Ref<const VectorBuffer> ConstVectorBufferRef;
   typedef Eigen::Ref<const TriangleBuffer> ConstTriangleBufferRef;
+  typedef Eigen::Ref<const LineBuffer> ConstLineBufferRef;
   typedef Eigen::Ref<const UVBuffer> ConstUVBufferRef;
   typedef Eigen::Ref<const ColorBuffer> ConstColorBufferRef;
   typedef Eigen::Ref<const QuaternionBuffer> ConstQuaternionBufferRef;
   typedef Eigen::Ref<const VertexBuffer> ConstVertexBufferRef;
+  typedef Eigen::Ref<const CoordinateBuffer> ConstCoordinateBufferRef;
+  typedef Eigen::Ref<const ValueBuffer> ConstValueBufferRef;
   typedef Eigen::Ref<TriangleBuffer> TriangleBufferRef;
   typedef Eigen::Ref<UVBuffer> UVBufferRef;
   typedef Eigen::Ref<ColorBuffer> ColorBufferRef;
@@ -84,6 +97,7 @@ namespace scenepic
   const ColorBuffer& ColorBufferNone();
   const UVBuffer& UVBufferNone();
   const QuaternionBuffer& QuaternionBufferNone();
+  const ValueBuffer& ValueBufferNone();
   const Vector& VectorNone();
 
   /** Appends a row to a matrix.
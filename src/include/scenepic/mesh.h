@@ -60,6 +60,14 @@ namespace scenepic
      */
     void reverse_triangle_order();
 
+    /** Reorders the vertices of the mesh along a space-filling curve and
+     *  remaps the triangles and lines to match. Nearby vertices end up close
+     *  together in the vertex buffer, which makes the buffers compress better
+     *  and gives the client coherent ranges to cull.
+     *  \param curve the curve to follow, either "morton" or "hilbert"
+     */
+    void spatial_sort(const std::string& curve = "morton");
+
     /** Apply a 3D homogeneous matrix transform (i.e. 4x4 matrix) to all
      *  vertices (and appropriately to the normals) in the Mesh.
      *  \param transform a 3D homogeneous transform
@@ -353,6 +361,67 @@ namespace scenepic
       bool fill_triangles = true,
       bool add_wireframe = false);
 
+    /** Add N unit diameter cubes to this Mesh in a single batch. Each cube is
+     *  scaled, then rotated, then translated to its position.
+     *  \param positions the N cube centers
+     *  \param colors optional N per-cube colors, required unless Mesh was
+     *                constructed with shared_color argument.
+     *  \param scales optional N per-cube (x, y, z) scale factors
+     *  \param rotations optional N per-cube quaternion rotations
+     *  \param fill_triangles whether to fill the primitives
+     *  \param add_wireframe whether to add wireframe outlines
+     */
+    void add_cubes(
+      const ConstVectorBufferRef& positions,
+      const ConstColorBufferRef& colors = ColorBufferNone(),
+      const ConstVectorBufferRef& scales = VectorBufferNone(),
+      const ConstQuaternionBufferRef& rotations = QuaternionBufferNone(),
+      bool fill_triangles = true,
+      bool add_wireframe = false);
+
+    /** Add N default (ico) unit diameter spheres to this Mesh in a single
+     *  batch. Each sphere is scaled, then rotated, then translated to its
+     *  position.
+     *  \param positions the N sphere centers
+     *  \param colors optional N per-sphere colors, required unless Mesh was
+     *                constructed with shared_color argument.
+     *  \param scales optional N per-sphere (x, y, z) scale factors
+     *  \param rotations optional N per-sphere quaternion rotations
+     *  \param fill_triangles whether to fill the primitives
+     *  \param add_wireframe whether to add wireframe outlines
+     */
+    void add_spheres(
+      const ConstVectorBufferRef& positions,
+      const ConstColorBufferRef& colors = ColorBufferNone(),
+      const ConstVectorBufferRef& scales = VectorBufferNone(),
+      const ConstQuaternionBufferRef& rotations = QuaternionBufferNone(),
+      bool fill_triangles = true,
+      bool add_wireframe = false);
+
+    /** Add N cones to this Mesh in a single batch (see add_cone). Each cone
+     *  is scaled, then rotated, then translated to its position.
+     *  \param positions the N cone centers
+     *  \param colors optional N per-cone colors, required unless Mesh was
+     *                constructed with shared_color argument.
+     *  \param scales optional N per-cone (x, y, z) scale factors
+     *  \param rotations optional N per-cone quaternion rotations
+     *  \param truncation_height draws truncated cones of this height
+     *  \param lat_count number of discrete samples in latitude
+     *  \param long_count number of discrete samples in longitude
+     *  \param fill_triangles whether to fill the primitives
+     *  \param add_wireframe whether to add wireframe outlines
+     */
+    void add_cones(
+      const ConstVectorBufferRef& positions,
+      const ConstColorBufferRef& colors = ColorBufferNone(),
+      const ConstVectorBufferRef& scales = VectorBufferNone(),
+      const ConstQuaternionBufferRef& rotations = QuaternionBufferNone(),
+      float truncation_height = 1,
+      std::uint32_t lat_count = 10,
+      std::uint32_t long_count = 10,
+      bool fill_triangles = true,
+      bool add_wireframe = false);
+
     /** Add a triangle mesh to this ScenePic Mesh, with normals computed
      *  automatically.
      *  \param vertices matrix of N vertex positions
@@ -364,6 +433,10 @@ namespace scenepic
      *                                order
      *  \param fill_triangles whether to fill the primitive
      *  \param add_wireframe whether to add a wireframe outline
+     *  \param wireframe_feature_angle if greater than zero, the wireframe only
+     *                                 includes boundary edges and edges whose
+     *                                 dihedral angle (in degrees) exceeds this
+     *                                 value.
      */
     void add_mesh_without_normals(
       const ConstVectorBufferRef& vertices,
@@ -373,7 +446,8 @@ namespace scenepic
       const Transform& transform = Transform::Identity(),
       bool reverse_triangle_order = false,
       bool fill_triangles = true,
-      bool add_wireframe = false);
+      bool add_wireframe = false,
+      float wireframe_feature_angle = 0);
 
     /** Compute the vertex normals given a set of triangles and vertices.
      *
@@ -388,6 +462,28 @@ namespace scenepic
       const ConstTriangleBufferRef& triangles,
       bool reverse_triangle_order = false);
 
+    /** Compute the unique edges of a set of triangles. Edges shared by
+     *  several triangles are only included once.
+     *
+     *  \param triangles the triangles defining the mesh
+     *  \return a buffer containing one line per unique edge
+     */
+    static LineBuffer compute_edges(const ConstTriangleBufferRef& triangles);
+
+    /** Compute the feature edges of a mesh, i.e. boundary edges, edges with
+     *  more than two triangles and edges where the angle between the normals
+     *  of the adjacent triangles exceeds a threshold.
+     *
+     *  \param vertices the vertex positions
+     *  \param triangles the triangles defining the mesh
+     *  \param angle the dihedral angle threshold in degrees
+     *  \return a buffer containing one line per feature edge
+     */
+    static LineBuffer compute_feature_edges(
+      const ConstVectorBufferRef& vertices,
+      const ConstTriangleBufferRef& triangles,
+      float angle);
+
     /** Add a triangle mesh to this ScenePic Mesh, with normals provided.
      * \param vertices matrix of N vertex positions
      * \param normals matrix of N vertex normals
@@ -399,6 +495,10 @@ namespace scenepic
      *                               order
      * \param fill_triangles whether to fill the primitive
      * \param add_wireframe whether to add a wireframe outline
+     * \param wireframe_feature_angle if greater than zero, the wireframe only
+     *                                includes boundary edges and edges whose
+     *                                dihedral angle (in degrees) exceeds this
+     *                                value.
      */
     void add_mesh_with_normals(
       const ConstVectorBufferRef& vertices,
@@ -409,7 +509,8 @@ namespace scenepic
       const Transform& transform = Transform::Identity(),
       bool reverse_triangle_order = false,
       bool fill_triangles = true,
-      bool add_wireframe = false);
+      bool add_wireframe = false,
+      float wireframe_feature_angle = 0);
 
     /** Add a triangle mesh to this ScenePic Mesh, with normals computed
      *  automatically.
@@ -419,13 +520,18 @@ namespace scenepic
      *                                winding order
      *  \param fill_triangles whether to fill the primitive
      *  \param add_wireframe whether to add a wireframe outline
+     *  \param wireframe_feature_angle if greater than zero, the wireframe only
+     *                                 includes boundary edges and edges whose
+     *                                 dihedral angle (in degrees) exceeds this
+     *                                 value.
      */
     void add_mesh(
       const std::shared_ptr<MeshInfo>& mesh_info,
       const Transform& transform = Transform::Identity(),
       bool reverse_triangle_order = false,
       bool fill_triangles = true,
-      bool add_wireframe = false);
+      bool add_wireframe = false,
+      float wireframe_feature_angle = 0);
 
     /** Add a line cloud to this Mesh.
      * \param start_points defines N line start positions (and, optionally,
@@ -450,11 +556,14 @@ namespace scenepic
      *               Mesh's shared_color or per-vertex color
      * \param rotations if provided, a per-instance quaternion rotation that
      *                  rotates each instance
+     * \param sort_curve if "morton" or "hilbert", the instances are reordered
+     *                   along that space-filling curve (see spatial_sort())
      */
     void enable_instancing(
       const ConstVectorBufferRef& positions,
       const ConstQuaternionBufferRef& rotations = QuaternionBufferNone(),
-      const ConstColorBufferRef& colors = ColorBufferNone());
+      const ConstColorBufferRef& colors = ColorBufferNone(),
+      const std::string& sort_curve = "none");
 
     /** Return a JSON string representing the object */
     std::string to_string() const;
@@ -563,9 +672,34 @@ namespace scenepic
      */
     Mesh& is_label(bool is_label);
 
+    /** The number of bits per component used to send the vertex normals
+     *  to the client using octahedral encoding (8 or 16). A value of 0
+     *  (the default) sends the normals as 32-bit floats.
+     */
+    std::uint32_t packed_normals() const;
+
+    /** The number of bits per component used to send the vertex normals
+     *  to the client using octahedral encoding (8 or 16). A value of 0
+     *  (the default) sends the normals as 32-bit floats.
+     */
+    Mesh& packed_normals(std::uint32_t packed_normals);
+
+    /** Whether to send per-vertex colors to the client as 8-bit RGB
+     *  instead of 32-bit floats.
+     */
+    bool packed_colors() const;
+
+    /** Whether to send per-vertex colors to the client as 8-bit RGB
+     *  instead of 32-bit floats.
+     */
+    Mesh& packed_colors(bool packed_colors);
+
     /** The triangles (i.e. face vertex indices) defining the mesh */
     const ConstTriangleBufferRef triangles() const;
 
+    /** The lines (i.e. edge vertex indices) of the mesh wireframe */
+    const ConstLineBufferRef lines() const;
+
     /** Reference to the vertex positions. */
     VertexBlock vertex_positions();
 
@@ -638,6 +772,22 @@ namespace scenepic
     void append_triangle(
       std::uint32_t index0, std::uint32_t index1, std::uint32_t index2);
     void append_line(std::uint32_t index0, std::uint32_t index1);
+    void append_primitive(
+      const VectorBuffer& positions,
+      const VectorBuffer& normals,
+      const TriangleBuffer& triangles,
+      const LineBuffer& lines,
+      const Color& color,
+      const Transform& transform,
+      bool fill_triangles,
+      bool add_wireframe);
+    void append_primitives(
+      const Mesh& primitive,
+      const ConstVectorBufferRef& positions,
+      const ConstColorBufferRef& colors,
+      const ConstVectorBufferRef& scales,
+      const ConstQuaternionBufferRef& rotations);
+    Color template_color() const;
     JsonValue definition_to_json() const;
 
     VertexBuffer m_vertices;
@@ -653,6 +803,8 @@ namespace scenepic
     bool m_use_texture_alpha;
     bool m_is_billboard;
     bool m_is_label;
+    std::uint32_t m_packed_normals;
+    bool m_packed_colors;
 
     InstanceBuffer m_instance_buffer;
     bool m_instance_buffer_has_rotations;
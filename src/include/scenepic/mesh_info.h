@@ -6,7 +6,9 @@
 
 #include "matrix.h"
 
+#include <limits>
 #include <memory>
+#include <string>
 
 namespace scenepic
 {
@@ -69,7 +71,8 @@ namespace scenepic
     /** Whether the mesh info contains vertex normals. */
     bool has_normals() const;
 
-    /** Subdivide this mesh using loop subdivision.
+    /** Subdivide this mesh using loop subdivision. The stencil is reused
+     *  across meshes which share the same triangles.
      *
      *  \param steps specifies how many steps of subdivision to apply.
      *               Defaults to 1.
@@ -81,6 +84,41 @@ namespace scenepic
     std::shared_ptr<MeshInfo>
     subdivide(int steps = 1, bool project_to_limit = false);
 
+    /** Simplify this mesh using quadric error edge collapses. Vertex
+     *  normals, colors and UVs are interpolated along each collapsed edge.
+     *
+     *  \param target_triangle_count the number of triangles to reduce the
+     *                               mesh to (if possible).
+     *  \param max_error the maximum distance of a collapsed vertex from the
+     *                   planes of the original faces it replaces, as a
+     *                   fraction of the diagonal of the mesh bounding box.
+     *                   Boundary and interior vertices are held to the same
+     *                   limit. Simplification stops early when no collapse
+     *                   stays within this error. Defaults to no limit.
+     *  \return a simplified version of this mesh
+     */
+    std::shared_ptr<MeshInfo> simplify(
+      std::size_t target_triangle_count,
+      float max_error = std::numeric_limits<float>::infinity()) const;
+
+    /** Save this mesh info to disk in a native binary format which can be
+     *  reloaded far faster than parsing an OBJ or PLY. Each buffer is stored
+     *  in its own aligned section, optionally deflated.
+     *
+     *  \param path the location on disk to write the file
+     *  \param compress whether to deflate the buffers. This makes the file
+     *                  smaller but slower to load. Defaults to false.
+     */
+    void save_binary(const std::string& path, bool compress = false) const;
+
+    /** Load a mesh info from a file written by save_binary. The file is
+     *  memory mapped and each buffer is copied directly from the mapping.
+     *
+     *  \param path the location of the file on disk
+     *  \return the mesh info stored in the file
+     */
+    static std::shared_ptr<MeshInfo> load_binary(const std::string& path);
+
   private:
     VectorBuffer m_position_buffer;
     VectorBuffer m_normal_buffer;
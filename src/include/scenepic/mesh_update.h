@@ -56,6 +56,16 @@ namespace scenepic
     /** The updated vertex buffer */
     VertexBufferRef vertex_buffer();
 
+    /** The number of bits per component used to send the normals using
+     *  octahedral encoding, or 0 for none. Inherited from the base mesh.
+     *  Quantized updates are never packed.
+     */
+    std::uint32_t packed_normals() const;
+
+    /** Whether colors are sent as 8-bit RGB. Inherited from the base mesh.
+     */
+    bool packed_colors() const;
+
     /** Return a JSON string representing the object */
     std::string to_string() const;
 
@@ -114,6 +124,9 @@ namespace scenepic
       const std::vector<VertexBufferType>& buffer_types,
       std::uint32_t frame_index);
 
+    /** Adds the vertex buffer to the json, splitting out packed streams. */
+    void add_vertex_buffers(JsonValue& obj) const;
+
     std::string m_base_mesh_id;
     std::string m_mesh_id;
     VertexBuffer m_vertex_buffer;
@@ -123,6 +136,8 @@ namespace scenepic
     std::uint32_t m_frame_index;
     std::uint32_t m_keyframe_index;
     VertexBufferType m_update_flags;
+    std::uint32_t m_packed_normals;
+    bool m_packed_colors;
   };
 } // namespace scenepic
 
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#ifndef _SCENEPIC_PACKING_H_
+#define _SCENEPIC_PACKING_H_
+
+#include "json_value.h"
+#include "matrix.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace scenepic
+{
+  /** Packs unit normals into a two-component octahedral encoding using 16
+   *  bits per component.
+   *  \param normals the (normalized) normals to pack
+   *  \return the packed normals
+   */
+  PackedNormalShortBuffer
+  pack_normals_oct16(const ConstVectorBufferRef& normals);
+
+  /** Packs unit normals into a two-component octahedral encoding using 8
+   *  bits per component.
+   *  \param normals the (normalized) normals to pack
+   *  \return the packed normals
+   */
+  PackedNormalByteBuffer pack_normals_oct8(const ConstVectorBufferRef& normals);
+
+  /** Unpacks octahedral normals created by pack_normals_oct16.
+   *  \param packed the packed normals
+   *  \return the unit normals
+   */
+  VectorBuffer unpack_normals(const PackedNormalShortBuffer& packed);
+
+  /** Unpacks octahedral normals created by pack_normals_oct8.
+   *  \param packed the packed normals
+   *  \return the unit normals
+   */
+  VectorBuffer unpack_normals(const PackedNormalByteBuffer& packed);
+
+  /** Packs [0, 1] float colors into 8-bit RGB.
+   *  \param colors the colors to pack
+   *  \return the packed colors
+   */
+  PackedColorBuffer pack_colors(const ConstColorBufferRef& colors);
+
+  /** Unpacks 8-bit RGB colors created by pack_colors.
+   *  \param packed the packed colors
+   *  \return the [0, 1] float colors
+   */
+  ColorBuffer unpack_colors(const PackedColorBuffer& packed);
+
+  /** Packs floats into IEEE 754 half precision (binary16), rounding to the
+   *  nearest representable value. Values beyond the half range become
+   *  infinities.
+   *  \param values the values to pack
+   *  \return the bits of the half precision values
+   */
+  HalfBuffer pack_half(const ConstValueBufferRef& values);
+
+  /** Unpacks half precision values created by pack_half.
+   *  \param packed the bits of the half precision values
+   *  \return the values
+   */
+  ValueBuffer unpack_half(const HalfBuffer& packed);
+
+  /** The name used in ScenePic json for a normal packing.
+   *  \param bits the number of bits per packed component (8 or 16)
+   *  \return the packing name
+   */
+  std::string normal_packing_name(std::uint32_t bits);
+
+  /** Convert a normal buffer to its packed JSON-friendly representation.
+   *  \param normals the normals to pack
+   *  \param bits the number of bits per packed component (8 or 16)
+   *  \return the Base64 of the packed normal binary
+   */
+  std::string packed_normals_to_json(
+    const ConstVectorBufferRef& normals, std::uint32_t bits);
+
+  /** Throws an exception if the number of bits is not a supported normal
+   *  packing (0, 8, or 16).
+   *  \param bits the number of bits per packed component
+   */
+  void check_normal_packing(std::uint32_t bits);
+
+  /** Quantizes each column of a buffer to a whole number of steps and delta
+   *  codes it, so that every row after the first is stored as its
+   *  difference from the previous one. Values which change smoothly become
+   *  runs of small integers, which compress far better than raw floats.
+   *  Decoding recovers each value to within half a step.
+   *  \param values the [N, C] values to encode, e.g. one row per frame
+   *  \param steps the quantization step of each of the C columns
+   *  \return the [C, N] deltas, with the deltas of each column stored
+   *          contiguously
+   */
+  DeltaBuffer delta_encode(
+    const ConstVertexBufferRef& values, const std::vector<float>& steps);
+
+  /** Decodes deltas created by delta_encode.
+   *  \param deltas the [C, N] deltas
+   *  \param steps the quantization step of each of the C columns
+   *  \return the [N, C] values
+   */
+  VertexBuffer
+  delta_decode(const DeltaBuffer& deltas, const std::vector<float>& steps);
+
+  /** Adds delta-coded values to a JSON object as "Steps", "Origin" (the
+   *  quantized first value of each column), "DeltaOrder", "DeltaType" and
+   *  "DeltaBuffer" (the remaining deltas, one column after another). If it
+   *  makes them smaller, the deltas are differenced a second time
+   *  (DeltaOrder 2), keeping the first delta of each column as is. The
+   *  buffer uses the narrowest of Int8, Int16 or Int32 which holds every
+   *  value.
+   *  \param deltas the deltas created by delta_encode
+   *  \param steps the quantization step of each column
+   *  \param obj the object to which the buffer is added
+   */
+  void deltas_to_json(
+    const DeltaBuffer& deltas,
+    const std::vector<float>& steps,
+    JsonValue& obj);
+} // namespace scenepic
+
+#endif
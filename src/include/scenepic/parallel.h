@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#ifndef _SCENEPIC_PARALLEL_H_
+#define _SCENEPIC_PARALLEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace scenepic
+{
+  /** The number of worker threads to use for parallel loops. */
+  inline std::ptrdiff_t thread_count()
+  {
+    std::ptrdiff_t count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+  }
+
+  /** The number of chunks parallel_for will split a range into.
+   *  \param count the number of items in the range
+   *  \param min_chunk the minimum number of items per chunk
+   *  \return the number of chunks
+   */
+  inline std::ptrdiff_t
+  parallel_chunk_count(std::ptrdiff_t count, std::ptrdiff_t min_chunk)
+  {
+    if (count <= 0)
+    {
+      return 0;
+    }
+
+    min_chunk = std::max<std::ptrdiff_t>(min_chunk, 1);
+    return std::min(thread_count(), (count + min_chunk - 1) / min_chunk);
+  }
+
+  /** Splits [begin, end) into contiguous chunks and calls
+   *  func(chunk_begin, chunk_end, chunk_index) once per chunk, each on its
+   *  own thread. Ranges smaller than min_chunk run on the calling thread.
+   *  The function must not throw.
+   *
+   *  \param begin the start of the range
+   *  \param end the end of the range
+   *  \param func the function to call for each chunk
+   *  \param min_chunk the minimum number of items per chunk
+   */
+  template<typename Func>
+  void parallel_for(
+    std::ptrdiff_t begin,
+    std::ptrdiff_t end,
+    Func func,
+    std::ptrdiff_t min_chunk = 1024)
+  {
+    std::ptrdiff_t count = end - begin;
+    std::ptrdiff_t num_chunks = parallel_chunk_count(count, min_chunk);
+    if (num_chunks == 0)
+    {
+      return;
+    }
+
+    if (num_chunks == 1)
+    {
+      func(begin, end, std::ptrdiff_t(0));
+      return;
+    }
+
+    std::ptrdiff_t chunk_size = (count + num_chunks - 1) / num_chunks;
+    std::vector<std::thread> threads;
+    threads.reserve(num_chunks - 1);
+    for (std::ptrdiff_t chunk = 1; chunk < num_chunks; ++chunk)
+    {
+      std::ptrdiff_t chunk_begin = std::min(end, begin + chunk * chunk_size);
+      std::ptrdiff_t chunk_end = std::min(end, chunk_begin + chunk_size);
+      threads.emplace_back(func, chunk_begin, chunk_end, chunk);
+    }
+
+    func(begin, std::min(end, begin + chunk_size), std::ptrdiff_t(0));
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+  }
+} // namespace scenepic
+
+#endif
@@ -427,6 +427,15 @@ namespace scenepic
 
     void status_bar_visibility(const std::string& visibility);
 
+    /** Whether mesh, layer and canvas ids are interned when the scene is
+     *  converted to JSON. Each distinct id is then written once, in a table
+     *  at the start of the script, and commands refer to it by its index in
+     *  the table. The default is false.
+     */
+    bool intern_ids() const;
+
+    void intern_ids(bool intern_ids);
+
     /** Save the scene as a JSON file.
      *  To view the JSON, you will need to separately code up the wrapper html
      *  and provide the scenepic.min.js library file. Alternatively, use
@@ -444,6 +453,16 @@ namespace scenepic
      */
     void save_as_script(const std::string& path, bool standalone = false) const;
 
+    /** Save the meshes of the scene as a binary glTF 2.0 (GLB) file.
+     *  Each mesh becomes a node, and instanced meshes are written using the
+     *  EXT_mesh_gpu_instancing extension. Mesh updates are animated at the
+     *  scene framerate, as morph targets for regular meshes and as per-frame
+     *  nodes for instanced meshes. Labels, canvases and frames are not
+     *  exported.
+     *  \param path the path to the file on disk
+     */
+    void save_as_glb(const std::string& path) const;
+
     /** Quantize the mesh updates.
      *  Each update will be reduced in size in such a way as to minimize
      *  the expected per-value error from quantization. The number of keyframes
@@ -551,6 +570,7 @@ namespace scenepic
     std::size_t m_num_text_panels;
     std::size_t m_num_drop_down_menus;
     bool m_script_cleared;
+    bool m_intern_ids;
   };
 } // namespace scenepic
 
@@ -4,9 +4,12 @@
 #ifndef _SCENEPIC_H_
 #define _SCENEPIC_H_
 
+#include "downsample.h"
 #include "io.h"
 #include "loop_subdivision_stencil.h"
+#include "packing.h"
 #include "scene.h"
+#include "spatial_sort.h"
 #include "transforms.h"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#ifndef _SCENEPIC_SPATIAL_SORT_H_
+#define _SCENEPIC_SPATIAL_SORT_H_
+
+#include "matrix.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace scenepic
+{
+  /** Computes an ordering of points along a space-filling curve, so that
+   *  points which are close in space end up close in the ordering.
+   *
+   *  Positions are quantized to 21 bits per axis over their bounding box and
+   *  the resulting 63-bit curve keys are ordered with a stable parallel radix
+   *  sort, so points which share a key keep their relative order.
+   *
+   *  \param positions the [N, 3] point positions
+   *  \param curve the curve to follow, one of "morton", "hilbert" or "none"
+   *  \return the original index of the point at each position in the new
+   *          order. "none" returns the identity ordering.
+   */
+  std::vector<std::uint32_t> spatial_order(
+    const ConstVectorBufferRef& positions, const std::string& curve = "morton");
+} // namespace scenepic
+
+#endif
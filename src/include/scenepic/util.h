@@ -4,9 +4,20 @@
 #ifndef _SCENEPIC_UTIL_H_
 #define _SCENEPIC_UTIL_H_
 
-#include <map>
+#include "parallel.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace scenepic
@@ -25,7 +36,241 @@ namespace scenepic
     }
   }
 
+  /** Mixes some bits into a running hash value. */
+  inline std::uint64_t hash_combine(std::uint64_t seed, std::uint64_t bits)
+  {
+    seed = (seed ^ bits) * 0xFF51AFD7ED558CCDull;
+    return seed ^ (seed >> 32);
+  }
+
+  template<typename T>
+  typename std::enable_if<
+    std::is_integral<T>::value || std::is_enum<T>::value,
+    std::uint64_t>::type
+  hash_value(std::uint64_t seed, T value);
+
+  template<typename T>
+  typename std::enable_if<std::is_floating_point<T>::value, std::uint64_t>::
+    type
+    hash_value(std::uint64_t seed, T value);
+
+  inline std::uint64_t hash_value(std::uint64_t seed, const std::string& value);
+
+  template<typename A, typename B>
+  std::uint64_t hash_value(std::uint64_t seed, const std::pair<A, B>& value);
+
+  template<typename... Types>
+  std::uint64_t
+  hash_value(std::uint64_t seed, const std::tuple<Types...>& value);
+
+  template<typename T, std::size_t N>
+  std::uint64_t hash_value(std::uint64_t seed, const std::array<T, N>& value);
+
+  template<typename Scalar, int Rows, int Cols, int Options, int MR, int MC>
+  std::uint64_t hash_value(
+    std::uint64_t seed,
+    const Eigen::Matrix<Scalar, Rows, Cols, Options, MR, MC>& value);
+
+  template<typename T>
+  typename std::enable_if<
+    std::is_integral<T>::value || std::is_enum<T>::value,
+    std::uint64_t>::type
+  hash_value(std::uint64_t seed, T value)
+  {
+    return hash_combine(seed, static_cast<std::uint64_t>(value));
+  }
+
   template<typename T>
+  typename std::enable_if<std::is_floating_point<T>::value, std::uint64_t>::
+    type
+    hash_value(std::uint64_t seed, T value)
+  {
+    // -0 and 0 compare equal, so they must hash the same
+    if (value == 0)
+    {
+      value = 0;
+    }
+
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, std::min(sizeof(T), sizeof(bits)));
+    return hash_combine(seed, bits);
+  }
+
+  inline std::uint64_t hash_value(std::uint64_t seed, const std::string& value)
+  {
+    return hash_combine(seed, std::hash<std::string>()(value));
+  }
+
+  template<typename A, typename B>
+  std::uint64_t hash_value(std::uint64_t seed, const std::pair<A, B>& value)
+  {
+    return hash_value(hash_value(seed, value.first), value.second);
+  }
+
+  template<typename Tuple, std::size_t... Indices>
+  std::uint64_t hash_tuple(
+    std::uint64_t seed, const Tuple& value, std::index_sequence<Indices...>)
+  {
+    using expand = int[];
+    (void)expand{0, (seed = hash_value(seed, std::get<Indices>(value)), 0)...};
+    return seed;
+  }
+
+  template<typename... Types>
+  std::uint64_t
+  hash_value(std::uint64_t seed, const std::tuple<Types...>& value)
+  {
+    return hash_tuple(seed, value, std::index_sequence_for<Types...>());
+  }
+
+  template<typename T, std::size_t N>
+  std::uint64_t hash_value(std::uint64_t seed, const std::array<T, N>& value)
+  {
+    for (const auto& element : value)
+    {
+      seed = hash_value(seed, element);
+    }
+
+    return seed;
+  }
+
+  template<typename Scalar, int Rows, int Cols, int Options, int MR, int MC>
+  std::uint64_t hash_value(
+    std::uint64_t seed,
+    const Eigen::Matrix<Scalar, Rows, Cols, Options, MR, MC>& value)
+  {
+    seed = hash_combine(seed, static_cast<std::uint64_t>(value.size()));
+    for (Eigen::Index i = 0; i < value.size(); ++i)
+    {
+      seed = hash_value(seed, value(i));
+    }
+
+    return seed;
+  }
+
+  /** Hash function object for the keys of an IndexMap. Supports integers,
+   *  floating point values (with 0 and -0 hashing the same), strings,
+   *  pairs, tuples, arrays and Eigen matrices (e.g. fixed-size rows).
+   */
+  template<typename T>
+  struct IndexHash
+  {
+    std::size_t operator()(const T& value) const
+    {
+      return static_cast<std::size_t>(hash_value(0x9E3779B97F4A7C15ull, value));
+    }
+  };
+
+  /** Open addressing hash table which assigns each distinct key the index
+   *  of its first insertion. The keys are stored contiguously in insertion
+   *  order.
+   */
+  template<typename T, typename Hash = IndexHash<T>>
+  class IndexMap
+  {
+  public:
+    /** Constructor.
+     *  \param expected_count the number of keys to reserve space for
+     */
+    explicit IndexMap(std::size_t expected_count = 0)
+    {
+      this->reserve(expected_count);
+    }
+
+    /** Sizes the table so that count keys can be inserted without growing.
+     *  \param count the number of keys to reserve space for
+     */
+    void reserve(std::size_t count)
+    {
+      std::size_t capacity = 16;
+      while (capacity < count * 2)
+      {
+        capacity *= 2;
+      }
+
+      m_keys.reserve(count);
+      if (capacity > m_slots.size())
+      {
+        this->rehash(capacity);
+      }
+    }
+
+    /** Returns the index of the key, adding it if it is new. */
+    std::uint32_t insert(const T& key)
+    {
+      std::size_t mask = m_slots.size() - 1;
+      for (std::size_t slot = m_hash(key) & mask;; slot = (slot + 1) & mask)
+      {
+        std::uint32_t index = m_slots[slot];
+        if (index == EMPTY_SLOT)
+        {
+          index = static_cast<std::uint32_t>(m_keys.size());
+          m_keys.push_back(key);
+          m_slots[slot] = index;
+          if (m_keys.size() * 2 > m_slots.size())
+          {
+            this->rehash(m_slots.size() * 2);
+          }
+
+          return index;
+        }
+
+        if (m_keys[index] == key)
+        {
+          return index;
+        }
+      }
+    }
+
+    /** The distinct keys in order of first insertion. */
+    const std::vector<T>& keys() const
+    {
+      return m_keys;
+    }
+
+    /** The number of distinct keys. */
+    std::size_t size() const
+    {
+      return m_keys.size();
+    }
+
+  private:
+    enum : std::uint32_t
+    {
+      EMPTY_SLOT = std::numeric_limits<std::uint32_t>::max()
+    };
+
+    void rehash(std::size_t capacity)
+    {
+      std::vector<std::uint32_t> slots(capacity, EMPTY_SLOT);
+      std::size_t mask = capacity - 1;
+      for (std::size_t index = 0; index < m_keys.size(); ++index)
+      {
+        std::size_t slot = m_hash(m_keys[index]) & mask;
+        while (slots[slot] != EMPTY_SLOT)
+        {
+          slot = (slot + 1) & mask;
+        }
+
+        slots[slot] = static_cast<std::uint32_t>(index);
+      }
+
+      m_slots.swap(slots);
+    }
+
+    Hash m_hash;
+    std::vector<std::uint32_t> m_slots;
+    std::vector<T> m_keys;
+  };
+
+  /** Finds the distinct items of a list.
+   *
+   *  \param items the items to index
+   *  \param unique_items receives the distinct items in order of first
+   *                      occurrence
+   *  \param reverse_index receives the index into unique_items of each item
+   */
+  template<typename T, typename Hash = IndexHash<T>>
   void unique_index(
     const std::vector<T>& items,
     std::vector<T>& unique_items,
@@ -36,22 +281,197 @@ namespace scenepic
       return;
     }
 
-    std::map<T, std::size_t> lookup;
-    for (auto& item : items)
+    std::size_t offset = unique_items.size();
+    IndexMap<T, Hash> lookup(items.size());
+    reverse_index.reserve(reverse_index.size() + items.size());
+    for (const auto& item : items)
     {
-      if (lookup.count(item))
-      {
-        reverse_index.push_back(lookup[item]);
-      }
-      else
+      reverse_index.push_back(offset + lookup.insert(item));
+    }
+
+    const std::vector<T>& keys = lookup.keys();
+    unique_items.insert(unique_items.end(), keys.begin(), keys.end());
+  }
+
+  /** Finds the distinct items of a list using several threads. The items
+   *  are first partitioned by hash, so that each partition can find the
+   *  first occurrence of its items independently, and then the distinct
+   *  items are numbered in order of first occurrence. The results are
+   *  identical to unique_index.
+   *
+   *  \param items the items to index
+   *  \param unique_items receives the distinct items in order of first
+   *                      occurrence
+   *  \param reverse_index receives the index into unique_items of each item
+   */
+  template<typename T, typename Hash = IndexHash<T>>
+  void parallel_unique_index(
+    const std::vector<T>& items,
+    std::vector<T>& unique_items,
+    std::vector<std::size_t>& reverse_index)
+  {
+    const std::ptrdiff_t MIN_CHUNK = 1 << 14;
+    const std::uint32_t EMPTY_SLOT = std::numeric_limits<std::uint32_t>::max();
+    auto count = static_cast<std::ptrdiff_t>(items.size());
+    std::ptrdiff_t num_chunks = parallel_chunk_count(count, MIN_CHUNK);
+    if (num_chunks <= 1)
+    {
+      unique_index<T, Hash>(items, unique_items, reverse_index);
+      return;
+    }
+
+    // phase one: partition the items by hash, keeping them in order
+    std::size_t num_partitions = 1;
+    while (num_partitions < static_cast<std::size_t>(4 * num_chunks))
+    {
+      num_partitions *= 2;
+    }
+
+    Hash hash;
+    std::vector<std::size_t> hashes(items.size());
+    std::vector<std::vector<std::uint32_t>> histograms(
+      num_chunks, std::vector<std::uint32_t>(num_partitions, 0));
+    auto partition_of = [num_partitions](std::size_t value) {
+      std::uint64_t bits = value * 0x9E3779B97F4A7C15ull;
+      return static_cast<std::size_t>(bits >> 40) & (num_partitions - 1);
+    };
+
+    parallel_for(
+      0,
+      count,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+        for (auto i = begin; i < end; ++i)
+        {
+          hashes[i] = hash(items[i]);
+          histograms[chunk][partition_of(hashes[i])] += 1;
+        }
+      },
+      MIN_CHUNK);
+
+    std::vector<std::uint32_t> partition_offsets(num_partitions + 1, 0);
+    std::uint32_t total = 0;
+    for (std::size_t partition = 0; partition < num_partitions; ++partition)
+    {
+      partition_offsets[partition] = total;
+      for (auto& histogram : histograms)
       {
-        std::size_t index = unique_items.size();
-        lookup[item] = index;
-        unique_items.push_back(item);
-        reverse_index.push_back(index);
+        std::uint32_t partition_count = histogram[partition];
+        histogram[partition] = total;
+        total += partition_count;
       }
     }
+
+    partition_offsets[num_partitions] = total;
+    std::vector<std::uint32_t> order(items.size());
+    parallel_for(
+      0,
+      count,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+        for (auto i = begin; i < end; ++i)
+        {
+          auto& offset = histograms[chunk][partition_of(hashes[i])];
+          order[offset++] = static_cast<std::uint32_t>(i);
+        }
+      },
+      MIN_CHUNK);
+
+    // each partition finds the first occurrence of each of its items
+    std::vector<std::uint32_t> first(items.size());
+    parallel_for(
+      0,
+      static_cast<std::ptrdiff_t>(num_partitions),
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+        std::vector<std::uint32_t> slots;
+        for (auto partition = begin; partition < end; ++partition)
+        {
+          std::uint32_t start = partition_offsets[partition];
+          std::uint32_t stop = partition_offsets[partition + 1];
+          std::size_t capacity = 16;
+          while (capacity < (stop - start) * 2)
+          {
+            capacity *= 2;
+          }
+
+          slots.assign(capacity, EMPTY_SLOT);
+          std::size_t mask = capacity - 1;
+          for (std::uint32_t position = start; position < stop; ++position)
+          {
+            std::uint32_t i = order[position];
+            for (std::size_t slot = hashes[i] & mask;;
+                 slot = (slot + 1) & mask)
+            {
+              std::uint32_t other = slots[slot];
+              if (other == EMPTY_SLOT)
+              {
+                slots[slot] = i;
+                first[i] = i;
+                break;
+              }
+
+              if (hashes[other] == hashes[i] && items[other] == items[i])
+              {
+                first[i] = other;
+                break;
+              }
+            }
+          }
+        }
+      },
+      1);
+
+    // phase two: number the first occurrences in order
+    std::vector<std::size_t> chunk_counts(num_chunks + 1, 0);
+    parallel_for(
+      0,
+      count,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+        std::size_t chunk_count = 0;
+        for (auto i = begin; i < end; ++i)
+        {
+          chunk_count += first[i] == static_cast<std::uint32_t>(i);
+        }
+
+        chunk_counts[chunk + 1] = chunk_count;
+      },
+      MIN_CHUNK);
+
+    for (std::ptrdiff_t chunk = 0; chunk < num_chunks; ++chunk)
+    {
+      chunk_counts[chunk + 1] += chunk_counts[chunk];
+    }
+
+    std::size_t unique_offset = unique_items.size();
+    std::size_t offset = reverse_index.size();
+    reverse_index.resize(offset + items.size());
+    unique_items.resize(unique_offset + chunk_counts[num_chunks]);
+    std::vector<std::size_t> rank(items.size());
+    parallel_for(
+      0,
+      count,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+        std::size_t next = unique_offset + chunk_counts[chunk];
+        for (auto i = begin; i < end; ++i)
+        {
+          if (first[i] == static_cast<std::uint32_t>(i))
+          {
+            unique_items[next] = items[i];
+            rank[i] = next++;
+          }
+        }
+      },
+      MIN_CHUNK);
+
+    parallel_for(
+      0,
+      count,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+        for (auto i = begin; i < end; ++i)
+        {
+          reverse_index[offset + i] = rank[first[i]];
+        }
+      },
+      MIN_CHUNK);
   }
 } // namespace scenepic
 
-#endif
\ No newline at end of file
+#endif
@@ -20,8 +20,10 @@ namespace scenepic
   /** Inflates a byte array created by @see deflate.
    *  \param data the deflated bytes
    *  \param source_length the number of deflated bytes
-   *  \param dest_length an estimate of the number of original bytes
+   *  \param dest_length the number of original bytes
    *  \return the original bytes
+   *  \throws std::invalid_argument if the data cannot be inflated to exactly
+   *          dest_length bytes
    */
   std::vector<std::uint8_t> inflate(
     const std::uint8_t* data,
@@ -42,7 +42,7 @@ from .drop_down_menu import DropDownMenu
 from .focus_point import FocusPoint
 from .frame2d import Frame2D
 from .frame3d import Frame3D
-from .globals import ColorFromBytes, js_lib_src, load_obj
+from .globals import ColorFromBytes, js_lib_src, load_obj, load_obj_sequence, load_ply, save_ply
 from .graph import Graph
 from .image import Image
 from .label import Label
@@ -77,9 +77,12 @@ __all__ = [
     "Label",
     "LayerSettings",
     "load_obj",
+    "load_obj_sequence",
+    "load_ply",
     "Shading",
     "UIParameters",
     "QuantizationOptions",
+    "save_ply",
     "Canvas3D",
     "Frame2D",
     "Image",
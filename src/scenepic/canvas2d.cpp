@@ -5,6 +5,10 @@
 
 #include "util.h"
 
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 namespace scenepic
 {
   Canvas2D::Canvas2D(const std::string& canvas_id, double width, double height)
@@ -13,7 +17,9 @@ namespace scenepic
     m_height(height),
     m_background_color(Colors::Black),
     m_num_frames(0),
-    m_media_id("")
+    m_media_id(""),
+    m_shared_buffers(false),
+    m_delta_coordinates(false)
   {}
 
   const std::string& Canvas2D::media_id() const
@@ -73,14 +79,14 @@ namespace scenepic
     JsonValue background;
     background["CommandType"] = "SetBackgroundStyle";
     background["Value"] = m_background_color.to_html_hex();
-    canvas_commands.append(background);
+    canvas_commands.append(std::move(background));
 
     if (!m_media_id.empty())
     {
       JsonValue media;
       media["CommandType"] = "SetMedia";
       media["MediaId"] = m_media_id;
-      canvas_commands.append(media);
+      canvas_commands.append(std::move(media));
     }
 
     if (m_layer_settings.size())
@@ -92,20 +98,104 @@ namespace scenepic
         layer_settings["Value"][layer.first] = layer.second.to_json();
       }
 
-      canvas_commands.append(layer_settings);
+      canvas_commands.append(std::move(layer_settings));
     }
 
-    for (const auto& frame : m_frames)
+    if (m_shared_buffers)
     {
-      canvas_commands.append(frame->to_json());
+      this->append_shared_frames(canvas_commands);
+    }
+    else
+    {
+      for (const auto& frame : m_frames)
+      {
+        canvas_commands.append(frame->to_json());
+      }
     }
 
     obj["CommandType"] = "CanvasCommands";
     obj["CanvasId"] = m_canvas_id;
-    obj["Commands"] = canvas_commands;
+    obj["Commands"] = std::move(canvas_commands);
     return obj;
   }
 
+  void Canvas2D::append_shared_frames(JsonValue& canvas_commands) const
+  {
+    typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 2, Eigen::RowMajor>
+      CoordinateBits;
+
+    std::size_t num_coords = 0;
+    std::size_t num_styles = 0;
+    for (const auto& frame : m_frames)
+    {
+      num_coords += frame->m_coords.size();
+      num_styles += frame->m_line_styles.size() + frame->m_circle_styles.size();
+    }
+
+    // coordinates are stored as their bits so that they can be XOR-ed with
+    // the previous frame without any loss
+    std::vector<std::uint32_t> coords(num_coords);
+    std::vector<std::uint8_t> styles;
+    styles.reserve(num_styles);
+    std::vector<bool> deltas(m_frames.size(), false);
+    std::size_t coord_start = 0;
+    for (std::size_t f = 0; f < m_frames.size(); ++f)
+    {
+      const Frame2D& frame = *m_frames[f];
+      std::size_t size = frame.m_coords.size();
+      if (size > 0)
+      {
+        std::memcpy(
+          coords.data() + coord_start,
+          frame.m_coords.data(),
+          size * sizeof(float));
+      }
+
+      if (
+        m_delta_coordinates && f > 0 && size > 0 &&
+        m_frames[f - 1]->m_coords.size() == size)
+      {
+        deltas[f] = true;
+        const float* previous = m_frames[f - 1]->m_coords.data();
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          std::uint32_t bits;
+          std::memcpy(&bits, previous + i, sizeof(bits));
+          coords[coord_start + i] ^= bits;
+        }
+      }
+
+      coord_start += size;
+      styles.insert(
+        styles.end(), frame.m_line_styles.begin(), frame.m_line_styles.end());
+      styles.insert(
+        styles.end(),
+        frame.m_circle_styles.begin(),
+        frame.m_circle_styles.end());
+    }
+
+    JsonValue shared;
+    shared["CommandType"] = "SetSharedBuffers";
+    shared["CoordinateBuffer"] = matrix_to_json(
+      Eigen::Map<const CoordinateBits>(
+        coords.data(), static_cast<Eigen::Index>(num_coords / 2), 2));
+    shared["StyleBuffer"] = matrix_to_json(Eigen::Map<const StyleBuffer>(
+      styles.data(), static_cast<Eigen::Index>(num_styles / 8), 8));
+    canvas_commands.append(std::move(shared));
+
+    std::int64_t coordinate_start = 0;
+    std::int64_t style_start = 0;
+    for (std::size_t f = 0; f < m_frames.size(); ++f)
+    {
+      const Frame2D& frame = *m_frames[f];
+      canvas_commands.append(
+        frame.to_json(coordinate_start, style_start, deltas[f]));
+      coordinate_start += static_cast<std::int64_t>(frame.num_coordinates());
+      style_start += static_cast<std::int64_t>(
+        frame.m_line_width.size() + frame.m_circle_layer_ids.size());
+    }
+  }
+
   const Color& Canvas2D::background_color() const
   {
     return m_background_color;
@@ -122,6 +212,28 @@ namespace scenepic
     return this->to_json().to_string();
   }
 
+  bool Canvas2D::shared_buffers() const
+  {
+    return m_shared_buffers;
+  }
+
+  Canvas2D& Canvas2D::shared_buffers(bool shared_buffers)
+  {
+    m_shared_buffers = shared_buffers;
+    return *this;
+  }
+
+  bool Canvas2D::delta_coordinates() const
+  {
+    return m_delta_coordinates;
+  }
+
+  Canvas2D& Canvas2D::delta_coordinates(bool delta_coordinates)
+  {
+    m_delta_coordinates = delta_coordinates;
+    return *this;
+  }
+
   double Canvas2D::width() const
   {
     return m_width;
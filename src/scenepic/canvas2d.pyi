@@ -65,3 +65,23 @@ class Canvas2D:
         This file will be used to drive playback, i.e. frames will be
         displayed in time with the playback of the media file.
         """
+
+    @property
+    def shared_buffers(self) -> bool:
+        """Whether the frame buffers are written once for the whole canvas.
+
+        When enabled, the coordinates and styles of every frame are written as
+        a single pair of buffers at the canvas level. Each frame then refers to
+        its range of rows, which saves the overhead of compressing many small
+        buffers and lets similar frames compress against each other. Default
+        False.
+        """
+
+    @property
+    def delta_coordinates(self) -> bool:
+        """Whether shared coordinates are stored relative to the previous frame.
+
+        This applies when both frames have the same number of coordinates. It
+        is lossless, and turns unchanged coordinates into zeros. Has no effect
+        unless shared_buffers is set. Default False.
+        """
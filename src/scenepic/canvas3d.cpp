@@ -1,12 +1,33 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 
+#define _USE_MATH_DEFINES
 #include "canvas3d.h"
 
+#include "packing.h"
+#include "transforms.h"
 #include "util.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
 namespace scenepic
 {
+  namespace
+  {
+    // for unit quaternions and directions, and the linear part of affine
+    // transforms relative to the scale of each axis
+    const float ROTATION_STEP = 1.0f / 32768;
+    const float AFFINE_TOLERANCE = 1e-6f;
+    // relative to the largest entry of the projection matrix
+    const float PROJECTION_TOLERANCE = 1e-4f;
+    // in degrees
+    const float FOV_STEP = 1e-3f;
+  } // namespace
+
   Canvas3D::Canvas3D(
     const std::string& canvas_id,
     double width,
@@ -23,7 +44,9 @@ namespace scenepic
     m_focus_point(focus_point),
     m_ui_parameters(ui_parameters),
     m_num_frames(0),
-    m_media_id("")
+    m_media_id(""),
+    m_delta_frames(false),
+    m_static_layer(false)
   {}
 
   const std::string& Canvas3D::canvas_id() const
@@ -45,6 +68,7 @@ namespace scenepic
     m_ui_parameters = UIParameters::None();
     m_layer_settings.clear();
     m_frames.clear();
+    m_tracks.clear();
   }
 
   JsonValue Canvas3D::to_json() const
@@ -78,7 +102,7 @@ namespace scenepic
       JsonValue media;
       media["CommandType"] = "SetMedia";
       media["MediaId"] = m_media_id;
-      canvas_commands.append(media);
+      canvas_commands.append(std::move(media));
     }
 
     if (m_layer_settings.size())
@@ -90,20 +114,237 @@ namespace scenepic
         layer_settings["Value"][layer.first] = layer.second.to_json();
       }
 
-      canvas_commands.append(layer_settings);
+      canvas_commands.append(std::move(layer_settings));
+    }
+
+    if (m_delta_frames)
+    {
+      this->append_delta_frames(canvas_commands);
+    }
+    else
+    {
+      // the client keeps a static layer from an earlier script for every
+      // frame it adds, so it is cleared before these frames
+      if (m_static_layer)
+      {
+        JsonValue static_meshes;
+        static_meshes["CommandType"] = "SetStaticMeshes";
+        static_meshes["MeshIds"].resize(0);
+        canvas_commands.append(std::move(static_meshes));
+      }
+
+      for (const auto& frame : m_frames)
+      {
+        canvas_commands.append(frame->to_json());
+      }
     }
 
-    for (const auto& frame : m_frames)
+    for (const auto& track : m_tracks)
     {
-      canvas_commands.append(frame->to_json());
+      canvas_commands.append(track);
     }
 
     obj["CommandType"] = "CanvasCommands";
     obj["CanvasId"] = m_canvas_id;
-    obj["Commands"] = canvas_commands;
+    obj["Commands"] = std::move(canvas_commands);
     return obj;
   }
 
+  void Canvas3D::append_delta_frames(JsonValue& canvas_commands) const
+  {
+    typedef std::pair<std::uint32_t, std::array<float, 16>> DrawKey;
+    typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 1> IndexBuffer;
+
+    // every draw becomes the index of its (mesh, transform) pair, so that
+    // draws in different frames can be compared cheaply
+    IndexMap<std::string> mesh_ids;
+    IndexMap<DrawKey> draw_keys;
+    std::vector<std::vector<std::uint32_t>> frame_keys(m_frames.size());
+    std::size_t num_first_keys = 0;
+    for (std::size_t f = 0; f < m_frames.size(); ++f)
+    {
+      const Frame3D& frame = *m_frames[f];
+      std::vector<std::uint32_t> frame_mesh_ids;
+      for (const auto& mesh_id : frame.m_mesh_ids.keys())
+      {
+        frame_mesh_ids.push_back(mesh_ids.insert(mesh_id));
+      }
+
+      DrawKey key;
+      frame_keys[f].reserve(frame.m_mesh_indices.size());
+      for (std::size_t i = 0; i < frame.m_mesh_indices.size(); ++i)
+      {
+        key.first = frame_mesh_ids[frame.m_mesh_indices[i]];
+        std::copy_n(frame.m_transforms.data() + 16 * i, 16, key.second.begin());
+        frame_keys[f].push_back(draw_keys.insert(key));
+      }
+
+      if (f == 0)
+      {
+        num_first_keys = draw_keys.size();
+      }
+    }
+
+    // the static layer holds each draw as many times as every frame has it
+    std::vector<std::uint32_t> counts(draw_keys.size(), 0);
+    std::vector<std::uint32_t> static_counts;
+    if (m_frames.size() > 1)
+    {
+      static_counts.assign(num_first_keys, 0);
+      for (auto key : frame_keys[0])
+      {
+        static_counts[key] += 1;
+      }
+
+      for (std::size_t f = 1; f < m_frames.size(); ++f)
+      {
+        for (auto key : frame_keys[f])
+        {
+          counts[key] += 1;
+        }
+
+        for (std::size_t key = 0; key < num_first_keys; ++key)
+        {
+          static_counts[key] = std::min(static_counts[key], counts[key]);
+        }
+
+        for (auto key : frame_keys[f])
+        {
+          counts[key] = 0;
+        }
+      }
+    }
+
+    // splits the draws of a frame into static and dynamic ones
+    auto split_draws = [&](std::size_t f, std::vector<std::uint32_t>& dynamic) {
+      std::vector<std::uint32_t> static_draws;
+      dynamic.clear();
+      const std::vector<std::uint32_t>& keys = frame_keys[f];
+      for (std::uint32_t i = 0; i < keys.size(); ++i)
+      {
+        std::uint32_t key = keys[i];
+        if (key < static_counts.size() && counts[key] < static_counts[key])
+        {
+          counts[key] += 1;
+          static_draws.push_back(i);
+        }
+        else
+        {
+          dynamic.push_back(i);
+        }
+      }
+
+      for (auto key : keys)
+      {
+        counts[key] = 0;
+      }
+
+      return static_draws;
+    };
+
+    // sent even when empty, as it replaces the layer of any earlier script
+    std::vector<std::uint32_t> dynamic;
+    std::vector<std::uint32_t> static_draws;
+    if (!m_frames.empty())
+    {
+      static_draws = split_draws(0, dynamic);
+    }
+
+    JsonValue static_meshes;
+    if (static_draws.empty())
+    {
+      static_meshes["MeshIds"].resize(0);
+    }
+    else
+    {
+      static_meshes = m_frames[0]->mesh_table_to_json(static_draws);
+    }
+
+    static_meshes["CommandType"] = "SetStaticMeshes";
+    canvas_commands.append(std::move(static_meshes));
+
+    // the keys of the dynamic draws of the previous frame, in the order in
+    // which the client holds them
+    std::vector<std::uint32_t> previous;
+    std::vector<std::uint32_t> current;
+    std::vector<std::uint32_t> removed;
+    std::vector<std::uint32_t> added;
+    for (std::size_t f = 0; f < m_frames.size(); ++f)
+    {
+      const Frame3D& frame = *m_frames[f];
+      const std::vector<std::uint32_t>& keys = frame_keys[f];
+      if (f > 0)
+      {
+        split_draws(f, dynamic);
+      }
+
+      // matches the dynamic draws against those of the previous frame
+      for (auto draw : dynamic)
+      {
+        counts[keys[draw]] += 1;
+      }
+
+      current.clear();
+      removed.clear();
+      for (std::uint32_t i = 0; i < previous.size(); ++i)
+      {
+        if (counts[previous[i]] > 0)
+        {
+          counts[previous[i]] -= 1;
+          current.push_back(previous[i]);
+        }
+        else
+        {
+          removed.push_back(i);
+        }
+      }
+
+      added.clear();
+      for (auto draw : dynamic)
+      {
+        if (counts[keys[draw]] > 0)
+        {
+          counts[keys[draw]] -= 1;
+          current.push_back(keys[draw]);
+          added.push_back(draw);
+        }
+      }
+
+      if (f == 0 || removed.size() + added.size() >= dynamic.size())
+      {
+        canvas_commands.append(
+          frame.to_json(frame.mesh_commands_to_json(dynamic)));
+        previous.clear();
+        for (auto draw : dynamic)
+        {
+          previous.push_back(keys[draw]);
+        }
+
+        continue;
+      }
+
+      JsonValue mesh_commands;
+      JsonValue copy;
+      copy["CommandType"] = "CopyMeshes";
+      copy["FrameId"] = m_frames[f - 1]->m_frame_id;
+      if (!removed.empty())
+      {
+        copy["Remove"] = matrix_to_json(Eigen::Map<const IndexBuffer>(
+          removed.data(), static_cast<Eigen::Index>(removed.size())));
+      }
+
+      mesh_commands.append(std::move(copy));
+      JsonValue added_commands = frame.mesh_commands_to_json(added);
+      for (auto& command : added_commands.values())
+      {
+        mesh_commands.append(std::move(command));
+      }
+
+      canvas_commands.append(frame.to_json(std::move(mesh_commands)));
+      previous.swap(current);
+    }
+  }
+
   std::shared_ptr<Frame3D> Canvas3D::create_frame(
     const std::string& frame_id_init,
     const FocusPoint& focus_point,
@@ -129,6 +370,211 @@ namespace scenepic
     return frame;
   }
 
+  void Canvas3D::add_transform_track(
+    const std::string& mesh_id,
+    const ConstVertexBufferRef& poses,
+    std::size_t start_frame,
+    float precision)
+  {
+    if (poses.cols() != 7 && poses.cols() != 16)
+    {
+      throw std::invalid_argument(
+        "Transform tracks must be [F, 7] poses or [F, 16] transforms");
+    }
+
+    JsonValue command = this->track_command(
+      "AddTransformTrack",
+      static_cast<std::size_t>(poses.rows()),
+      start_frame,
+      1);
+    command["MeshId"] = mesh_id;
+    VertexBuffer track;
+    std::vector<float> steps;
+    if (poses.cols() == 7)
+    {
+      // q and -q are the same rotation, so keep consecutive quaternions in
+      // the same hemisphere to keep their deltas small
+      track = poses;
+      Quaternion previous(0, 0, 0, 1);
+      for (Eigen::Index row = 0; row < track.rows(); ++row)
+      {
+        Quaternion rotation = track.block<1, 4>(row, 3).normalized();
+        if (rotation.dot(previous) < 0)
+        {
+          rotation = -rotation;
+        }
+
+        track.block<1, 4>(row, 3) = rotation;
+        previous = rotation;
+      }
+
+      steps = {precision, precision, precision};
+      steps.resize(7, ROTATION_STEP);
+      command["TrackType"] = "Pose";
+    }
+    else
+    {
+      // the bottom row of an affine transform is always [0, 0, 0, 1]
+      track = poses.leftCols(12);
+      Eigen::RowVector4f bottom(0, 0, 0, 1);
+      for (Eigen::Index row = 0; row < poses.rows(); ++row)
+      {
+        float error =
+          (poses.block<1, 4>(row, 12) - bottom).cwiseAbs().maxCoeff();
+        if (!(error <= AFFINE_TOLERANCE))
+        {
+          throw std::invalid_argument(
+            "Transform tracks only support affine transforms");
+        }
+      }
+
+      // the entries of each column of the linear part are bounded by the
+      // scale of that axis, so its step is relative to the largest scale
+      // in the track to keep scaled transforms within range and precision
+      Eigen::RowVector3f scales = Eigen::RowVector3f::Zero();
+      for (Eigen::Index row = 0; row < track.rows(); ++row)
+      {
+        Eigen::Matrix3f linear;
+        linear << track.block<1, 3>(row, 0), track.block<1, 3>(row, 4),
+          track.block<1, 3>(row, 8);
+        scales = scales.cwiseMax(linear.colwise().norm());
+      }
+
+      for (int row = 0; row < 3; ++row)
+      {
+        for (int col = 0; col < 3; ++col)
+        {
+          steps.push_back(
+            scales(col) > 0 ? ROTATION_STEP * scales(col) : ROTATION_STEP);
+        }
+
+        steps.push_back(precision);
+      }
+
+      command["TrackType"] = "Affine";
+    }
+
+    deltas_to_json(delta_encode(track, steps), steps, command);
+    m_tracks.push_back(command);
+  }
+
+  void Canvas3D::add_camera_track(
+    const std::vector<Camera>& cameras,
+    std::size_t start_frame,
+    std::size_t keyframe_interval,
+    float precision)
+  {
+    JsonValue command = this->track_command(
+      "AddCameraTrack", cameras.size(), start_frame, keyframe_interval);
+
+    // the projection is rebuilt by the client from the field of view and
+    // the parameters shared by the whole track
+    const Transform& first = cameras.front().projection();
+    double aspect_ratio = first(1, 1) / first(0, 0);
+    double znear = first(2, 3) / (first(2, 2) - 1);
+    double zfar = first(2, 3) / (first(2, 2) + 1);
+    command["AspectRatio"] = aspect_ratio;
+    command["NearCropDistance"] = znear;
+    command["FarCropDistance"] = zfar;
+
+    VertexBuffer track(cameras.size(), 10);
+    for (Eigen::Index row = 0; row < track.rows(); ++row)
+    {
+      const Camera& camera = cameras[row];
+      const Transform& projection = camera.projection();
+      double fov_y_degrees =
+        2 * std::atan(1.0 / projection(1, 1)) * 180.0 / M_PI;
+      Transform expected =
+        Transforms::gl_projection(fov_y_degrees, aspect_ratio, znear, zfar);
+      float error = (expected - projection).cwiseAbs().maxCoeff();
+      if (!(error <= PROJECTION_TOLERANCE * expected.cwiseAbs().maxCoeff()))
+      {
+        throw std::invalid_argument(
+          "Camera tracks need perspective cameras with the same aspect ratio "
+          "and clipping planes");
+      }
+
+      track.block<1, 3>(row, 0) = camera.center();
+      track.block<1, 3>(row, 3) = camera.look_at();
+      track.block<1, 3>(row, 6) = camera.up_dir();
+      track(row, 9) = static_cast<float>(fov_y_degrees);
+    }
+
+    std::vector<float> steps(6, precision);
+    steps.resize(9, ROTATION_STEP);
+    steps.push_back(FOV_STEP);
+    deltas_to_json(delta_encode(track, steps), steps, command);
+    m_tracks.push_back(command);
+  }
+
+  void Canvas3D::add_focus_point_track(
+    const std::vector<FocusPoint>& focus_points,
+    std::size_t start_frame,
+    std::size_t keyframe_interval,
+    float precision)
+  {
+    JsonValue command = this->track_command(
+      "AddFocusPointTrack",
+      focus_points.size(),
+      start_frame,
+      keyframe_interval);
+
+    bool oriented =
+      focus_points.front().orientation_axis_angle() != VectorNone();
+    VertexBuffer track(focus_points.size(), oriented ? 6 : 3);
+    for (Eigen::Index row = 0; row < track.rows(); ++row)
+    {
+      const FocusPoint& focus_point = focus_points[row];
+      if ((focus_point.orientation_axis_angle() != VectorNone()) != oriented)
+      {
+        throw std::invalid_argument(
+          "Either all or none of the focus points in a track must have an "
+          "orientation");
+      }
+
+      track.block<1, 3>(row, 0) = focus_point.position();
+      if (oriented)
+      {
+        track.block<1, 3>(row, 3) = focus_point.orientation_axis_angle();
+      }
+    }
+
+    std::vector<float> steps(3, precision);
+    steps.resize(track.cols(), ROTATION_STEP);
+    deltas_to_json(delta_encode(track, steps), steps, command);
+    m_tracks.push_back(command);
+  }
+
+  JsonValue Canvas3D::track_command(
+    const std::string& command_type,
+    std::size_t num_keyframes,
+    std::size_t start_frame,
+    std::size_t keyframe_interval) const
+  {
+    if (num_keyframes == 0 || keyframe_interval == 0)
+    {
+      throw std::invalid_argument(
+        "Tracks need at least one value and a positive keyframe interval");
+    }
+
+    if (start_frame + (num_keyframes - 1) * keyframe_interval >= m_num_frames)
+    {
+      throw std::invalid_argument(
+        "Track extends past the last frame of the canvas");
+    }
+
+    JsonValue command;
+    command["CommandType"] = command_type;
+    command["StartFrame"] = static_cast<std::int64_t>(start_frame);
+    if (keyframe_interval > 1)
+    {
+      command["KeyframeInterval"] =
+        static_cast<std::int64_t>(keyframe_interval);
+    }
+
+    return command;
+  }
+
   const Camera& Canvas3D::camera() const
   {
     return m_camera;
@@ -199,6 +645,18 @@ namespace scenepic
     return this->to_json().to_string();
   }
 
+  bool Canvas3D::delta_frames() const
+  {
+    return m_delta_frames;
+  }
+
+  Canvas3D& Canvas3D::delta_frames(bool delta_frames)
+  {
+    m_delta_frames = delta_frames;
+    m_static_layer = m_static_layer || delta_frames;
+    return *this;
+  }
+
   double Canvas3D::width() const
   {
     return m_width;
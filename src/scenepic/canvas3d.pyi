@@ -1,5 +1,7 @@
 from typing import List, Mapping, Union
 
+import numpy as np
+
 from .focus_point import FocusPoint
 from .frame3d import Frame3D
 from .camera import Camera
@@ -30,6 +32,68 @@ class Canvas3D:
             Frame3D: a new Frame3D object
         """
 
+    def add_transform_track(self, mesh_id: str, poses: np.ndarray, start_frame: int = 0,
+                            precision: float = 1e-4):
+        """Adds a mesh to a run of consecutive frames with a different pose in each frame.
+
+        Description:
+            This has the same effect as calling add_mesh_by_id on each frame, e.g. for
+            rigid-body animation, but the whole track is stored as a single quantized,
+            delta-coded buffer, which is orders of magnitude smaller than one transform
+            per frame.
+
+        Args:
+            mesh_id (str): the id of the mesh to animate
+            poses (np.ndarray): float32 matrix with one row per frame, either [F, 7] poses stored as
+                                [tx, ty, tz, qx, qy, qz, qw] (a translation followed by a rotation
+                                quaternion) or [F, 16] affine transforms stored as the 4x4 matrix in
+                                row-major order
+            start_frame (int, optional): the index of the frame which receives the first pose. The
+                                         frames must already have been created. Defaults to 0.
+            precision (float, optional): the largest error allowed in translations. Rotations are
+                                         quantized to 1/32768, relative to the largest scale of
+                                         each axis for affine transforms. Defaults to 1e-4.
+        """
+
+    def add_camera_track(self, cameras: List[Camera], start_frame: int = 0,
+                         keyframe_interval: int = 1, precision: float = 1e-4):
+        """Sets the cameras of a run of frames, e.g. for a fly-through created with Camera.orbit.
+
+        Description:
+            This replaces the cameras passed to create_frame, but instead of two matrices per
+            frame the center, look-at point, up direction and field of view of every camera are
+            stored as a single quantized, delta-coded buffer. With a keyframe interval greater
+            than one, the client interpolates linearly between consecutive cameras for the frames
+            in between.
+
+        Args:
+            cameras (List[Camera]): one camera per keyframe. All of them must have a perspective
+                                    projection with the same aspect ratio and clipping planes.
+            start_frame (int, optional): the index of the frame which receives the first camera.
+                                         The frames must already have been created. Defaults to 0.
+            keyframe_interval (int, optional): the number of frames between cameras. Defaults to 1.
+            precision (float, optional): the largest error allowed in positions. Defaults to 1e-4.
+        """
+
+    def add_focus_point_track(self, focus_points: List[FocusPoint], start_frame: int = 0,
+                              keyframe_interval: int = 1, precision: float = 1e-4):
+        """Sets the focus points of a run of frames.
+
+        Description:
+            This works in the same way as add_camera_track, with the positions (and
+            orientations, if the focus points have them) stored as a single delta-coded buffer.
+
+        Args:
+            focus_points (List[FocusPoint]): one focus point per keyframe. Either all or none of
+                                             them must have an orientation.
+            start_frame (int, optional): the index of the frame which receives the first focus
+                                         point. The frames must already have been created.
+                                         Defaults to 0.
+            keyframe_interval (int, optional): the number of frames between focus points.
+                                               Defaults to 1.
+            precision (float, optional): the largest error allowed in positions. Defaults to 1e-4.
+        """
+
     def set_layer_settings(self, layer_settings: Mapping[str, Union[dict, LayerSettings]]):
         """Specify the visibilities and opacities of certain mesh layers.
 
@@ -87,3 +151,13 @@ class Canvas3D:
         This file will be used to drive playback, i.e. frames will be
         displayed in time with the playback of the media file.
         """
+
+    @property
+    def delta_frames(self) -> bool:
+        """Whether frames are written relative to the previous frame.
+
+        When enabled, the meshes shared by every frame are written once as a
+        static layer, and each later frame only lists the meshes removed from
+        or added to the previous frame (a moved mesh counts as both). Meshes
+        may be drawn in a different order within a frame. Default False.
+        """
@@ -29,6 +29,12 @@ namespace scenepic
     return NONE;
   }
 
+  const ValueBuffer& ValueBufferNone()
+  {
+    static ValueBuffer NONE = ValueBuffer::Zero(0);
+    return NONE;
+  }
+
   const Vector& VectorNone()
   {
     const Vector::Scalar val =
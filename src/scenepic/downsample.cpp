@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "downsample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace scenepic
+{
+  namespace
+  {
+    /** The first index of a bucket when count indices are split into
+     *  num_buckets buckets of (nearly) equal size.
+     */
+    std::size_t
+    bucket_start(std::size_t bucket, std::size_t num_buckets, std::size_t count)
+    {
+      return static_cast<std::size_t>(
+        static_cast<std::uint64_t>(bucket) * count / num_buckets);
+    }
+
+    std::vector<std::uint32_t>
+    downsample_m4(const ConstValueBufferRef& values, std::size_t max_points)
+    {
+      auto count = static_cast<std::size_t>(values.size());
+      std::size_t num_buckets = max_points / 4;
+      std::vector<std::uint32_t> indices;
+      indices.reserve(num_buckets * 4);
+      for (std::size_t bucket = 0; bucket < num_buckets; ++bucket)
+      {
+        std::size_t begin = bucket_start(bucket, num_buckets, count);
+        std::size_t end = bucket_start(bucket + 1, num_buckets, count);
+        std::size_t min_index = begin;
+        std::size_t max_index = begin;
+        for (std::size_t i = begin + 1; i < end; ++i)
+        {
+          if (values(i) < values(min_index))
+          {
+            min_index = i;
+          }
+
+          if (values(i) > values(max_index))
+          {
+            max_index = i;
+          }
+        }
+
+        // the four indices are written in order, skipping repeats
+        std::uint32_t bucket_indices[] = {
+          static_cast<std::uint32_t>(begin),
+          static_cast<std::uint32_t>(std::min(min_index, max_index)),
+          static_cast<std::uint32_t>(std::max(min_index, max_index)),
+          static_cast<std::uint32_t>(end - 1)};
+        for (std::uint32_t index : bucket_indices)
+        {
+          if (indices.empty() || indices.back() != index)
+          {
+            indices.push_back(index);
+          }
+        }
+      }
+
+      return indices;
+    }
+
+    std::vector<std::uint32_t>
+    downsample_lttb(const ConstValueBufferRef& values, std::size_t max_points)
+    {
+      auto count = static_cast<std::size_t>(values.size());
+      std::size_t num_buckets = max_points - 2;
+      std::vector<std::uint32_t> indices;
+      indices.reserve(max_points);
+      indices.push_back(0);
+      std::size_t previous = 0;
+      for (std::size_t bucket = 0; bucket < num_buckets; ++bucket)
+      {
+        // the interior values 1 to count - 2 are split into the buckets
+        std::size_t begin = 1 + bucket_start(bucket, num_buckets, count - 2);
+        std::size_t end = 1 + bucket_start(bucket + 1, num_buckets, count - 2);
+        std::size_t next_end =
+          bucket + 2 > num_buckets
+            ? count
+            : 1 + bucket_start(bucket + 2, num_buckets, count - 2);
+
+        // the next bucket is represented by its average
+        double next_x = 0;
+        double next_y = 0;
+        for (std::size_t i = end; i < next_end; ++i)
+        {
+          next_x += static_cast<double>(i);
+          next_y += values(i);
+        }
+
+        next_x /= static_cast<double>(next_end - end);
+        next_y /= static_cast<double>(next_end - end);
+
+        double previous_x = static_cast<double>(previous);
+        double previous_y = values(previous);
+        double max_area = -1;
+        std::size_t chosen = begin;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+          double area = std::abs(
+            (previous_x - next_x) * (values(i) - previous_y) -
+            (previous_x - static_cast<double>(i)) * (next_y - previous_y));
+          if (area > max_area)
+          {
+            max_area = area;
+            chosen = i;
+          }
+        }
+
+        indices.push_back(static_cast<std::uint32_t>(chosen));
+        previous = chosen;
+      }
+
+      indices.push_back(static_cast<std::uint32_t>(count - 1));
+      return indices;
+    }
+  } // namespace
+
+  std::vector<std::uint32_t> downsample(
+    const ConstValueBufferRef& values,
+    std::size_t max_points,
+    const std::string& method)
+  {
+    bool m4 = method == "m4";
+    if (!m4 && method != "lttb")
+    {
+      throw std::invalid_argument(
+        "Invalid downsampling method: " + method + ". Expected m4 or lttb.");
+    }
+
+    if (max_points < (m4 ? 4u : 3u))
+    {
+      throw std::invalid_argument(
+        "Downsampling with " + method + " needs at least " +
+        (m4 ? "four" : "three") + " points");
+    }
+
+    auto count = static_cast<std::size_t>(values.size());
+    if (count <= max_points)
+    {
+      std::vector<std::uint32_t> indices(count);
+      std::iota(indices.begin(), indices.end(), 0);
+      return indices;
+    }
+
+    return m4 ? downsample_m4(values, max_points)
+              : downsample_lttb(values, max_points);
+  }
+} // namespace scenepic
@@ -73,7 +73,7 @@ namespace scenepic
       command["CommandType"] = "SetDropDownMenuTitle";
       command["DropDownMenuId"] = m_drop_down_menu_id;
       command["Value"] = m_title;
-      commands.append(command);
+      commands.append(std::move(command));
     }
 
     if (m_items.size())
@@ -85,7 +85,7 @@ namespace scenepic
       {
         command["Items"].append(item);
       }
-      commands.append(command);
+      commands.append(std::move(command));
     }
 
     {
@@ -93,7 +93,7 @@ namespace scenepic
       command["CommandType"] = "SetDropDownMenuSelection";
       command["DropDownMenuId"] = m_drop_down_menu_id;
       command["Index"] = static_cast<std::int64_t>(m_selection);
-      commands.append(command);
+      commands.append(std::move(command));
     }
 
     for (auto& index : m_disabled_indices)
@@ -103,7 +103,7 @@ namespace scenepic
       command["DropDownMenuId"] = m_drop_down_menu_id;
       command["Index"] = static_cast<std::int64_t>(index);
       command["Disable"] = true;
-      commands.append(command);
+      commands.append(std::move(command));
     }
 
     return commands;
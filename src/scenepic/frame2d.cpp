@@ -5,8 +5,109 @@
 
 #include "util.h"
 
+#include <limits>
+#include <stdexcept>
+
 namespace scenepic
 {
+  namespace
+  {
+    void append_style(
+      std::vector<std::uint8_t>& styles,
+      const Color& line_color,
+      const Color& fill_color)
+    {
+      Style style;
+      style << line_color.is_none(), line_color.R(), line_color.G(),
+        line_color.B(), fill_color.is_none(), fill_color.R(), fill_color.G(),
+        fill_color.B();
+      styles.insert(styles.end(), style.data(), style.data() + style.size());
+    }
+
+    JsonValue run_length_encode(const std::vector<std::string>& layer_ids)
+    {
+      JsonValue command;
+      command.resize(0);
+      std::string current = layer_ids[0];
+      std::int64_t count = 0;
+      for (const auto& layer_id : layer_ids)
+      {
+        if (layer_id == current)
+        {
+          count += 1;
+        }
+        else
+        {
+          JsonValue id_count;
+          id_count.resize(0);
+          id_count.append(current);
+          id_count.append(count);
+          command.append(std::move(id_count));
+          current = layer_id;
+          count = 1;
+        }
+      }
+
+      if (command.values().size() == 0 && current.empty())
+      {
+        return JsonValue::nullSingleton();
+      }
+
+      JsonValue id_count;
+      id_count.resize(0);
+      id_count.append(current);
+      id_count.append(count);
+      command.append(std::move(id_count));
+      return command;
+    }
+
+    /** Checks that a per-element argument has a single shared row, one row
+     *  per element or (when it has a default) no rows at all.
+     */
+    void check_rows(Eigen::Index rows, Eigen::Index count, const char* name)
+    {
+      if (rows > 1 && rows != count)
+      {
+        throw std::invalid_argument(
+          std::string(name) + " must have a single row or one row per element");
+      }
+    }
+
+    Color color_at(
+      const ConstColorBufferRef& colors, Eigen::Index i, const Color& fallback)
+    {
+      if (colors.rows() == 0)
+      {
+        return fallback;
+      }
+
+      return Color(colors.row(colors.rows() == 1 ? 0 : i).transpose());
+    }
+
+    float value_at(
+      const ConstValueBufferRef& values, Eigen::Index i, float fallback)
+    {
+      if (values.rows() == 0)
+      {
+        return fallback;
+      }
+
+      return values(values.rows() == 1 ? 0 : i);
+    }
+
+    const std::string&
+    layer_at(const std::vector<std::string>& layer_ids, std::size_t i)
+    {
+      static const std::string NO_LAYER;
+      if (layer_ids.empty())
+      {
+        return NO_LAYER;
+      }
+
+      return layer_ids[layer_ids.size() == 1 ? 0 : i];
+    }
+  } // namespace
+
   Frame2D::Frame2D(const std::string& frame_id) : m_frame_id(frame_id) {}
 
   void Frame2D::add_line(
@@ -17,17 +118,51 @@ namespace scenepic
     bool close_path,
     const std::string& layer_id)
   {
-    m_line_layer_ids.push_back(layer_id);
-    std::uint16_t start = this->num_coordinates();
-    append_matrix(m_coord_buffer, coordinates);
-    std::uint16_t end = this->num_coordinates();
-    Style style;
-    style << line_color.is_none(), line_color.R(), line_color.G(),
-      line_color.B(), fill_color.is_none(), fill_color.R(), fill_color.G(),
-      fill_color.B();
-    append_row(m_line_style_buffer, style);
-    m_line_width.push_back(line_width);
-    append_row(m_line_buffer, PolyLine(start, end, close_path));
+    std::vector<std::uint32_t> offsets = {0};
+    this->add_lines(
+      coordinates,
+      offsets,
+      line_color,
+      line_width,
+      fill_color,
+      close_path,
+      layer_id);
+  }
+
+  void Frame2D::add_lines(
+    const CoordinateBuffer& coordinates,
+    const std::vector<std::uint32_t>& offsets,
+    const Color& line_color,
+    float line_width,
+    const Color& fill_color,
+    bool close_path,
+    const std::string& layer_id)
+  {
+    auto num_coords = static_cast<std::uint32_t>(coordinates.rows());
+    for (std::size_t i = 0; i < offsets.size(); ++i)
+    {
+      std::uint32_t end = i + 1 < offsets.size() ? offsets[i + 1] : num_coords;
+      if (offsets[i] > end)
+      {
+        throw std::invalid_argument(
+          "Line offsets must be increasing and within the coordinates");
+      }
+    }
+
+    std::uint32_t start = this->num_coordinates();
+    m_coords.insert(
+      m_coords.end(), coordinates.data(), coordinates.data() + 2 * num_coords);
+    for (std::size_t i = 0; i < offsets.size(); ++i)
+    {
+      std::uint32_t end = i + 1 < offsets.size() ? offsets[i + 1] : num_coords;
+      m_lines.push_back(start + offsets[i]);
+      m_lines.push_back(start + end);
+      m_lines.push_back(close_path);
+      append_style(m_line_styles, line_color, fill_color);
+    }
+
+    m_line_width.insert(m_line_width.end(), offsets.size(), line_width);
+    m_line_layer_ids.insert(m_line_layer_ids.end(), offsets.size(), layer_id);
   }
 
   void Frame2D::add_rectangle(
@@ -56,13 +191,79 @@ namespace scenepic
     const std::string& layer_id)
   {
     m_circle_layer_ids.push_back(layer_id);
-    std::uint32_t index = static_cast<std::uint32_t>(m_circle_buffer.rows());
-    append_row(m_circle_buffer, Circle(x, y, radius, line_width));
-    Style style;
-    style << line_color.is_none(), line_color.R(), line_color.G(),
-      line_color.B(), fill_color.is_none(), fill_color.R(), fill_color.G(),
-      fill_color.B();
-    append_row(m_circle_style_buffer, style);
+    m_circles.insert(m_circles.end(), {x, y, radius, line_width});
+    append_style(m_circle_styles, line_color, fill_color);
+  }
+
+  void Frame2D::add_rectangles(
+    const ConstVertexBufferRef& rectangles,
+    const ConstColorBufferRef& line_colors,
+    const ConstValueBufferRef& line_widths,
+    const ConstColorBufferRef& fill_colors,
+    const std::vector<std::string>& layer_ids)
+  {
+    if (rectangles.cols() != 4)
+    {
+      throw std::invalid_argument("Rectangles must be [N, 4] (x, y, w, h)");
+    }
+
+    Eigen::Index count = rectangles.rows();
+    check_rows(line_colors.rows(), count, "line_colors");
+    check_rows(line_widths.rows(), count, "line_widths");
+    check_rows(fill_colors.rows(), count, "fill_colors");
+    check_rows(static_cast<Eigen::Index>(layer_ids.size()), count, "layer_ids");
+    for (Eigen::Index i = 0; i < count; ++i)
+    {
+      float x = rectangles(i, 0);
+      float y = rectangles(i, 1);
+      float w = rectangles(i, 2);
+      float h = rectangles(i, 3);
+      std::uint32_t start = this->num_coordinates();
+      m_coords.insert(
+        m_coords.end(), {x, y, x + w, y, x + w, y + h, x, y + h});
+      m_lines.insert(m_lines.end(), {start, start + 4, 1u});
+      append_style(
+        m_line_styles,
+        color_at(line_colors, i, Colors::Black),
+        color_at(fill_colors, i, Color::None()));
+      m_line_width.push_back(value_at(line_widths, i, 1.0f));
+      m_line_layer_ids.push_back(layer_at(layer_ids, i));
+    }
+  }
+
+  void Frame2D::add_circles(
+    const ConstCoordinateBufferRef& centers,
+    const ConstValueBufferRef& radii,
+    const ConstColorBufferRef& line_colors,
+    const ConstValueBufferRef& line_widths,
+    const ConstColorBufferRef& fill_colors,
+    const std::vector<std::string>& layer_ids)
+  {
+    Eigen::Index count = centers.rows();
+    if (radii.rows() == 0)
+    {
+      throw std::invalid_argument("Circles need at least one radius");
+    }
+
+    check_rows(radii.rows(), count, "radii");
+    check_rows(line_colors.rows(), count, "line_colors");
+    check_rows(line_widths.rows(), count, "line_widths");
+    check_rows(fill_colors.rows(), count, "fill_colors");
+    check_rows(static_cast<Eigen::Index>(layer_ids.size()), count, "layer_ids");
+    for (Eigen::Index i = 0; i < count; ++i)
+    {
+      m_circles.insert(
+        m_circles.end(),
+        {centers(i, 0),
+         centers(i, 1),
+         value_at(radii, i, 0.0f),
+         value_at(line_widths, i, 1.0f)});
+      append_style(
+        m_circle_styles,
+        color_at(line_colors, i, Colors::Black),
+        color_at(fill_colors, i, Color::None()));
+      m_circle_layer_ids.push_back(layer_at(layer_ids, i));
+    }
   }
 
   void Frame2D::add_image(
@@ -74,8 +275,7 @@ namespace scenepic
     bool smoothed,
     const std::string& layer_id)
   {
-    std::uint16_t index = this->num_coordinates();
-    append_row(m_coord_buffer, Coordinate(x, y));
+    std::uint32_t index = this->add_coordinate(x, y);
     Frame2D::Image image(
       image_id, position_type, index, scale, smoothed, layer_id);
     m_frame_commands.push_back(image.to_json());
@@ -89,8 +289,7 @@ namespace scenepic
     bool smoothed,
     const std::string& layer_id)
   {
-    std::uint16_t index = this->num_coordinates();
-    append_row(m_coord_buffer, Coordinate(x, y));
+    std::uint32_t index = this->add_coordinate(x, y);
     Frame2D::Video video(position_type, index, scale, smoothed, layer_id);
     m_frame_commands.push_back(video.to_json());
   }
@@ -104,59 +303,97 @@ namespace scenepic
     const std::string& font_family,
     const std::string& layer_id)
   {
-    std::uint16_t index = this->num_coordinates();
-    append_row(m_coord_buffer, Coordinate(left, bottom));
+    std::uint32_t index = this->add_coordinate(left, bottom);
     Frame2D::Text element(
       text, index, color, size_in_pixels, font_family, layer_id);
     m_frame_commands.push_back(element.to_json());
   }
 
-  std::uint16_t Frame2D::num_coordinates() const
+  void Frame2D::add_texts(
+    const std::vector<std::string>& texts,
+    const ConstCoordinateBufferRef& positions,
+    const ConstColorBufferRef& colors,
+    const ConstValueBufferRef& sizes_in_pixels,
+    const std::string& font_family,
+    const std::vector<std::string>& layer_ids)
   {
-    return static_cast<std::uint16_t>(m_coord_buffer.rows());
-  }
+    auto count = static_cast<Eigen::Index>(texts.size());
+    if (positions.rows() != count)
+    {
+      throw std::invalid_argument("There must be one position per text");
+    }
 
-  typedef Eigen::Matrix<std::uint8_t, 1, Eigen::Dynamic, Eigen::RowMajor>
-    LineCloseBuffer;
+    check_rows(colors.rows(), count, "colors");
+    check_rows(sizes_in_pixels.rows(), count, "sizes_in_pixels");
+    check_rows(static_cast<Eigen::Index>(layer_ids.size()), count, "layer_ids");
+    if (count == 0)
+    {
+      return;
+    }
+
+    IndexMap<std::string> strings;
+    Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 1> string_indices(count);
+    PackedColorBuffer text_colors(count, 3);
+    ValueBuffer sizes(count);
+    std::vector<std::string> text_layer_ids(count);
+    std::uint32_t start = this->num_coordinates();
+    for (Eigen::Index i = 0; i < count; ++i)
+    {
+      this->add_coordinate(positions(i, 0), positions(i, 1));
+      string_indices(i) = strings.insert(texts[i]);
+      Color color = color_at(colors, i, Colors::White);
+      text_colors.row(i) << color.R(), color.G(), color.B();
+      sizes(i) = value_at(sizes_in_pixels, i, 12.0f);
+      text_layer_ids[i] = layer_at(layer_ids, i);
+    }
 
-  JsonValue run_length_encode(const std::vector<std::string>& layer_ids)
-  {
     JsonValue command;
-    command.resize(0);
-    std::string current = layer_ids[0];
-    std::int64_t count = 0;
-    for (const auto& layer_id : layer_ids)
+    command["CommandType"] = "AddTexts";
+    command["Strings"].resize(0);
+    for (const auto& text : strings.keys())
     {
-      if (layer_id == current)
-      {
-        count += 1;
-      }
-      else
-      {
-        JsonValue id_count;
-        id_count.resize(0);
-        id_count.append(current);
-        id_count.append(count);
-        command.append(id_count);
-        current = layer_id;
-        count = 1;
-      }
+      command["Strings"].append(text);
     }
 
-    if (command.values().size() == 0 && current.empty())
+    command["StringIndices"] = matrix_to_json(string_indices);
+    command["Start"] = static_cast<std::int64_t>(start);
+    command["ColorBuffer"] = matrix_to_json(text_colors);
+    command["SizeBuffer"] = matrix_to_json(sizes);
+    command["Font"] = font_family;
+    JsonValue text_layers = run_length_encode(text_layer_ids);
+    if (text_layers.type() != JsonType::Null)
     {
-      return JsonValue::nullSingleton();
+      command["LayerIds"] = std::move(text_layers);
     }
 
-    JsonValue id_count;
-    id_count.resize(0);
-    id_count.append(current);
-    id_count.append(count);
-    command.append(id_count);
-    return command;
+    m_frame_commands.push_back(std::move(command));
   }
 
+  std::uint32_t Frame2D::num_coordinates() const
+  {
+    return static_cast<std::uint32_t>(m_coords.size() / 2);
+  }
+
+  std::uint32_t Frame2D::add_coordinate(float x, float y)
+  {
+    std::uint32_t index = this->num_coordinates();
+    m_coords.push_back(x);
+    m_coords.push_back(y);
+    return index;
+  }
+
+  typedef Eigen::Matrix<std::uint8_t, 1, Eigen::Dynamic, Eigen::RowMajor>
+    LineCloseBuffer;
+
   JsonValue Frame2D::to_json() const
+  {
+    return this->to_json(-1, -1, false);
+  }
+
+  JsonValue Frame2D::to_json(
+    std::int64_t coordinate_start,
+    std::int64_t style_start,
+    bool delta_coordinates) const
   {
     JsonValue obj;
 
@@ -170,52 +407,104 @@ namespace scenepic
 
     frame_commands["Commands"].resize(0);
 
+    auto num_coords = static_cast<Eigen::Index>(this->num_coordinates());
     JsonValue set_coords;
     set_coords["CommandType"] = "SetCoordinates";
-    set_coords["CoordinateBuffer"] = matrix_to_json(m_coord_buffer);
-    frame_commands["Commands"].append(set_coords);
+    if (coordinate_start < 0)
+    {
+      set_coords["CoordinateBuffer"] = matrix_to_json(
+        Eigen::Map<const CoordinateBuffer>(m_coords.data(), num_coords, 2));
+    }
+    else
+    {
+      set_coords["Start"] = coordinate_start;
+      set_coords["Count"] = static_cast<std::int64_t>(num_coords);
+      if (delta_coordinates)
+      {
+        set_coords["Delta"] = true;
+      }
+    }
+
+    frame_commands["Commands"].append(std::move(set_coords));
 
     for (auto& frame_command : m_frame_commands)
     {
       frame_commands["Commands"].append(frame_command);
     }
 
-    if (m_line_buffer.size())
+    if (!m_lines.empty())
     {
+      typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 3, Eigen::RowMajor>
+        WidePolyLineBuffer;
+      auto num_lines = static_cast<Eigen::Index>(m_line_width.size());
+      Eigen::Map<const WidePolyLineBuffer> lines(m_lines.data(), num_lines, 3);
+
       JsonValue add_lines;
       add_lines["CommandType"] = "AddLines";
-      add_lines["InfoBuffer"] = matrix_to_json(m_line_buffer);
-      add_lines["StyleBuffer"] = matrix_to_json(m_line_style_buffer);
-      Eigen::Index cols = static_cast<Eigen::Index>(m_line_width.size());
+      // 16-bit indices are used whenever they are large enough
+      if (this->num_coordinates() > std::numeric_limits<std::uint16_t>::max())
+      {
+        add_lines["IndexType"] = "UInt32";
+        add_lines["InfoBuffer"] = matrix_to_json(lines);
+      }
+      else
+      {
+        PolyLineBuffer narrow_lines = lines.cast<std::uint16_t>();
+        add_lines["InfoBuffer"] = matrix_to_json(narrow_lines);
+      }
+
+      if (style_start < 0)
+      {
+        add_lines["StyleBuffer"] = matrix_to_json(
+          Eigen::Map<const StyleBuffer>(m_line_styles.data(), num_lines, 8));
+      }
+      else
+      {
+        add_lines["StyleStart"] = style_start;
+      }
+
       Eigen::Map<const Eigen::VectorXf> line_width_buffer(
-        m_line_width.data(), cols);
+        m_line_width.data(), num_lines);
       add_lines["WidthBuffer"] = matrix_to_json(line_width_buffer);
       JsonValue layer_ids = run_length_encode(m_line_layer_ids);
       if (layer_ids.type() != JsonType::Null)
       {
-        add_lines["LayerIds"] = layer_ids;
+        add_lines["LayerIds"] = std::move(layer_ids);
       }
 
-      frame_commands["Commands"].append(add_lines);
+      frame_commands["Commands"].append(std::move(add_lines));
     }
 
-    if (m_circle_buffer.size())
+    if (!m_circles.empty())
     {
+      auto num_circles = static_cast<Eigen::Index>(m_circle_layer_ids.size());
       JsonValue add_circles;
       add_circles["CommandType"] = "AddCircles";
-      add_circles["InfoBuffer"] = matrix_to_json(m_circle_buffer);
-      add_circles["StyleBuffer"] = matrix_to_json(m_circle_style_buffer);
+      add_circles["InfoBuffer"] = matrix_to_json(
+        Eigen::Map<const CircleBuffer>(m_circles.data(), num_circles, 4));
+      if (style_start < 0)
+      {
+        add_circles["StyleBuffer"] = matrix_to_json(
+          Eigen::Map<const StyleBuffer>(
+            m_circle_styles.data(), num_circles, 8));
+      }
+      else
+      {
+        add_circles["StyleStart"] =
+          style_start + static_cast<std::int64_t>(m_line_width.size());
+      }
+
       JsonValue layer_ids = run_length_encode(m_circle_layer_ids);
       if (layer_ids.type() != JsonType::Null)
       {
-        add_circles["LayerIds"] = layer_ids;
+        add_circles["LayerIds"] = std::move(layer_ids);
       }
 
-      frame_commands["Commands"].append(add_circles);
+      frame_commands["Commands"].append(std::move(add_circles));
     }
 
-    obj.append(command);
-    obj.append(frame_commands);
+    obj.append(std::move(command));
+    obj.append(std::move(frame_commands));
 
     return obj;
   }
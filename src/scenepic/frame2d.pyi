@@ -1,4 +1,4 @@
-from typing import Union
+from typing import List, Union
 
 import numpy as np
 from typing import Optional
@@ -23,6 +23,28 @@ class Frame2D:
             layer_id (str, optional): Unique ID of the layer associated with this primitive. Defaults to "".
         """
 
+    def add_lines(self, coordinates: np.ndarray, offsets: List[int],
+                  line_color: np.ndarray, line_width: float,
+                  fill_color: Optional[np.ndarray] = None, close_path: bool = False,
+                  layer_id: str = "") -> None:
+        """Add many lines with the same style to the frame at once.
+
+        Description:
+            This is much faster than calling add_line for each of them.
+
+        Args:
+            coordinates (np.ndarray): float32 matrix of [N, 2] coordinates of all of the lines,
+                                      one after the other
+            offsets (List[int]): the index of the first coordinate of each line. Each line ends
+                                 where the next one starts, and the last one at the end of the
+                                 coordinates.
+            line_color (np.ndarray, optional): the color of the lines. Defaults to Black.
+            line_width (float, optional): the width of the lines. Defaults to 1.0.
+            fill_color (np.ndarray, optional): the fill color to use. Defaults to None.
+            close_path (bool, optional): whether to close the paths. Defaults to False.
+            layer_id (str, optional): Unique ID of the layer associated with these primitives. Defaults to "".
+        """
+
     def add_rectangle(self, x: float, y: float, w: float, h: float,
                       line_color: np.ndarray, line_width: float,
                       fill_color: Optional[np.ndarray] = None, layer_id: str = "") -> None:
@@ -84,6 +106,67 @@ class Frame2D:
             layer_id (str, optional): Unique ID of the layer associated with this primitive. Defaults to "".
         """
 
+    def add_rectangles(self, rectangles: np.ndarray, line_colors: np.ndarray = None,
+                       line_widths: np.ndarray = None, fill_colors: np.ndarray = None,
+                       layer_ids: List[str] = None) -> None:
+        """Add many rectangles to the frame at once.
+
+        Description:
+            Each of the per-rectangle arguments can either have one row per rectangle or a
+            single row which is shared by all of them.
+
+        Args:
+            rectangles (np.ndarray): float32 matrix of [N, 4] (x, y, w, h) rows, where (x, y) is
+                                     the upper left corner
+            line_colors (np.ndarray, optional): float32 matrix of line colors. Defaults to Black.
+            line_widths (np.ndarray, optional): float32 vector of line widths. Defaults to 1.0.
+            fill_colors (np.ndarray, optional): float32 matrix of fill colors. Defaults to None.
+            layer_ids (List[str], optional): Unique IDs of the layers associated with these
+                                             primitives. Defaults to no layer.
+        """
+
+    def add_circles(self, centers: np.ndarray, radii: np.ndarray, line_colors: np.ndarray = None,
+                    line_widths: np.ndarray = None, fill_colors: np.ndarray = None,
+                    layer_ids: List[str] = None) -> None:
+        """Add many circles to the frame at once.
+
+        Description:
+            Each of the per-circle arguments can either have one row per circle or a single row
+            which is shared by all of them.
+
+        Args:
+            centers (np.ndarray): float32 matrix of [N, 2] circle centers
+            radii (np.ndarray): float32 vector of circle radii
+            line_colors (np.ndarray, optional): float32 matrix of line colors. Defaults to Black.
+            line_widths (np.ndarray, optional): float32 vector of line widths. Defaults to 1.0.
+            fill_colors (np.ndarray, optional): float32 matrix of fill colors. Defaults to None.
+            layer_ids (List[str], optional): Unique IDs of the layers associated with these
+                                             primitives. Defaults to no layer.
+        """
+
+    def add_texts(self, texts: List[str], positions: np.ndarray, colors: np.ndarray = None,
+                  sizes_in_pixels: np.ndarray = None, font_family: str = "sans-serif",
+                  layer_ids: List[str] = None) -> None:
+        """Add many pieces of text to the frame at once.
+
+        Description:
+            The texts are sent as a table of distinct strings, so repeated labels are only sent
+            once. Each of the per-text arguments can either have one row per text or a single
+            row which is shared by all of them.
+
+        Args:
+            texts (List[str]): the texts to display
+            positions (np.ndarray): float32 matrix of [N, 2] pixel positions of the left and
+                                    bottom sides of the texts
+            colors (np.ndarray, optional): float32 matrix of text colors. Defaults to White.
+            sizes_in_pixels (np.ndarray, optional): float32 vector of the vertical sizes of the
+                                                    texts in pixels. Defaults to 12.0.
+            font_family (str, optional): the font to use for all of the texts. Defaults to
+                                         "sans-serif".
+            layer_ids (List[str], optional): Unique IDs of the layers associated with these
+                                             primitives. Defaults to no layer.
+        """
+
     def add_text(self, text: str, left: float, bottom: float,
                  color: np.ndarray, size_in_pixels: float, font_family: str,
                  layer_id: str):
@@ -6,13 +6,18 @@
 #include "transforms.h"
 #include "util.h"
 
+#include <numeric>
+
 namespace scenepic
 {
   Frame3D::Frame3D(
     const std::string& frame_id,
     const FocusPoint& focus_point,
     const Camera& camera)
-  : m_frame_id(frame_id), m_focus_point(focus_point), m_camera(camera)
+  : m_frame_id(frame_id),
+    m_focus_point(focus_point),
+    m_camera(camera),
+    m_compact_meshes(false)
   {}
 
   void Frame3D::add_meshes_by_id(
@@ -27,15 +32,9 @@ namespace scenepic
   void Frame3D::add_mesh_by_id(
     const std::string& mesh_id, const Transform& transform)
   {
-    JsonValue instance;
-    instance["CommandType"] = "AddMesh";
-    instance["MeshId"] = mesh_id;
-    if (!transform.isIdentity())
-    {
-      instance["Transform"] = matrix_to_json(transform);
-    }
-
-    m_frame_commands.push_back(instance);
+    m_mesh_indices.push_back(m_mesh_ids.insert(mesh_id));
+    m_transforms.insert(
+      m_transforms.end(), transform.data(), transform.data() + 16);
   }
 
   void Frame3D::add_label(
@@ -51,6 +50,13 @@ namespace scenepic
   }
 
   JsonValue Frame3D::to_json() const
+  {
+    std::vector<std::uint32_t> draws(m_mesh_indices.size());
+    std::iota(draws.begin(), draws.end(), 0);
+    return this->to_json(this->mesh_commands_to_json(draws));
+  }
+
+  JsonValue Frame3D::to_json(JsonValue mesh_commands) const
   {
     JsonValue obj;
 
@@ -61,11 +67,7 @@ namespace scenepic
     JsonValue frame_commands;
     frame_commands["CommandType"] = "FrameCommands";
     frame_commands["FrameId"] = m_frame_id;
-    frame_commands["Commands"].resize(0);
-    for (auto frame_command : m_frame_commands)
-    {
-      frame_commands["Commands"].append(frame_command);
-    }
+    frame_commands["Commands"] = std::move(mesh_commands);
 
     if (!m_focus_point.is_none())
     {
@@ -86,15 +88,86 @@ namespace scenepic
         layer_settings["Value"][layer.first] = layer.second.to_json();
       }
 
-      frame_commands["Commands"].append(layer_settings);
+      frame_commands["Commands"].append(std::move(layer_settings));
     }
 
-    obj.append(command);
-    obj.append(frame_commands);
+    obj.append(std::move(command));
+    obj.append(std::move(frame_commands));
 
     return obj;
   }
 
+  JsonValue Frame3D::mesh_commands_to_json(
+    const std::vector<std::uint32_t>& draws) const
+  {
+    JsonValue commands;
+    commands.resize(0);
+    if (m_compact_meshes && !draws.empty())
+    {
+      commands.append(this->mesh_table_to_json(draws));
+      return commands;
+    }
+
+    const std::vector<std::string>& mesh_ids = m_mesh_ids.keys();
+    for (auto draw : draws)
+    {
+      JsonValue instance;
+      instance["CommandType"] = "AddMesh";
+      instance["MeshId"] = mesh_ids[m_mesh_indices[draw]];
+      Eigen::Map<const Transform> transform(m_transforms.data() + 16 * draw);
+      if (!transform.isIdentity())
+      {
+        instance["Transform"] = matrix_to_json(transform);
+      }
+
+      commands.append(std::move(instance));
+    }
+
+    return commands;
+  }
+
+  JsonValue
+  Frame3D::mesh_table_to_json(const std::vector<std::uint32_t>& draws) const
+  {
+    typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 1> IndexBuffer;
+    typedef Eigen::Matrix<float, Eigen::Dynamic, 16, Eigen::RowMajor>
+      TransformBuffer;
+
+    // only the meshes which are drawn are listed in the table
+    const std::vector<std::string>& mesh_ids = m_mesh_ids.keys();
+    IndexMap<std::uint32_t> table_ids;
+    auto num_draws = static_cast<Eigen::Index>(draws.size());
+    IndexBuffer mesh_indices(num_draws);
+    TransformBuffer transforms(num_draws, 16);
+    bool has_transforms = false;
+    for (Eigen::Index i = 0; i < num_draws; ++i)
+    {
+      std::uint32_t draw = draws[i];
+      mesh_indices(i) = table_ids.insert(m_mesh_indices[draw]);
+      const float* transform = m_transforms.data() + 16 * draw;
+      transforms.row(i) =
+        Eigen::Map<const Eigen::Matrix<float, 1, 16>>(transform);
+      has_transforms =
+        has_transforms || !Eigen::Map<const Transform>(transform).isIdentity();
+    }
+
+    JsonValue command;
+    command["CommandType"] = "AddMeshTable";
+    command["MeshIds"].resize(0);
+    for (auto mesh_index : table_ids.keys())
+    {
+      command["MeshIds"].append(mesh_ids[mesh_index]);
+    }
+
+    command["MeshIndices"] = matrix_to_json(mesh_indices);
+    if (has_transforms)
+    {
+      command["Transforms"] = matrix_to_json(transforms);
+    }
+
+    return command;
+  }
+
   std::string Frame3D::to_string() const
   {
     return this->to_json().to_string();
@@ -122,4 +195,15 @@ namespace scenepic
     return *this;
   }
 
+  bool Frame3D::compact_meshes() const
+  {
+    return m_compact_meshes;
+  }
+
+  Frame3D& Frame3D::compact_meshes(bool value)
+  {
+    m_compact_meshes = value;
+    return *this;
+  }
+
 } // namespace scenepic
\ No newline at end of file
@@ -64,3 +64,13 @@ class Frame3D:
         track at any time. If they reset to the original camera, however, it will make
         subsequent frames use the specified camera parameters.
         """
+
+    @property
+    def compact_meshes(self) -> bool:
+        """Whether the meshes of this frame are sent to the client as a single compact table
+        instead of one command per mesh.
+
+        The table holds the distinct mesh ids of the frame, a compressed buffer of per-mesh
+        indices into them, and (if any mesh is transformed) one compressed buffer of per-mesh
+        transforms. This is much smaller and faster to produce for frames which contain many meshes.
+        """
@@ -1,3 +1,5 @@
-from ._scenepic import ColorFromBytes, js_lib_src, load_obj
+from ._scenepic import ColorFromBytes, js_lib_src, load_obj, load_obj_sequence, \
+    load_ply, save_ply
 
-__all__ = ["ColorFromBytes", "js_lib_src", "load_obj"]
+__all__ = ["ColorFromBytes", "js_lib_src", "load_obj", "load_obj_sequence",
+           "load_ply", "save_ply"]
@@ -1,6 +1,10 @@
+from typing import List
+
 import numpy as np
 
+from .mesh import MeshUpdate
 from .mesh_info import MeshInfo
+from .scene import Scene
 
 
 def js_lib_src() -> str:
@@ -29,3 +33,51 @@ def load_obj(path: str) -> MeshInfo:
     Returns:
         MeshInfo: contains the positions, a triangulation, and UVs (if present)
     """
+
+
+def load_obj_sequence(scene: Scene, base_mesh_id: str, base_path: str,
+                      paths: List[str], num_threads: int = 0) -> List[MeshUpdate]:
+    """Loads a sequence of WaveFront OBJ files (e.g. the frames of a capture) as updates
+    to a base mesh. Files are loaded in parallel on a pool of worker threads, with only
+    a bounded number of frames held in memory at once, and the updates are added to the
+    scene in frame order. Each file must have the same faces (i.e. the same position,
+    texture coordinate and normal indices) as the base OBJ file, and each vertex of the
+    base mesh takes its position (and normal, if the files contain them) from the same
+    indices in every frame. Vertices which coincide in some frames therefore do not
+    change the topology.
+
+    Args:
+        scene (Scene): the scene which contains the base mesh
+        base_mesh_id (str): the id of the base mesh to update
+        base_path (str): the location of the OBJ file the base mesh was created from with
+                         load_obj
+        paths (List[str]): the locations of the OBJ files on disk, in frame order
+        num_threads (int, optional): the number of worker threads to use. A value of 0
+                                     uses one per hardware thread. Defaults to 0.
+
+    Returns:
+        List[MeshUpdate]: the mesh updates, one per file
+    """
+
+
+def load_ply(path: str) -> MeshInfo:
+    """Loads a binary (little endian) PLY file from disk as a MeshInfo object.
+    The file is memory mapped and read in chunks, so files larger than the
+    available memory can be loaded.
+
+    Args:
+        path (str): the path to the PLY file on disk
+
+    Returns:
+        MeshInfo: contains the positions, a triangulation (if present), and
+                  normals, colors or UVs (if present)
+    """
+
+
+def save_ply(path: str, mesh_info: MeshInfo):
+    """Saves a MeshInfo object to disk as a binary (little endian) PLY file.
+
+    Args:
+        path (str): the path to the PLY file on disk
+        mesh_info (MeshInfo): the mesh information to save
+    """
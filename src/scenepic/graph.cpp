@@ -3,10 +3,46 @@
 
 #include "graph.h"
 
+#include "downsample.h"
+#include "packing.h"
 #include "util.h"
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
 namespace scenepic
 {
+  namespace
+  {
+    /** Adds a series of values to a JSON object in the given encoding. */
+    void values_to_json(
+      const ValueBuffer& values,
+      const std::string& value_encoding,
+      JsonValue& obj)
+    {
+      if (value_encoding == "float16")
+      {
+        obj["HalfBuffer"] = matrix_to_json(pack_half(values));
+      }
+      else if (value_encoding == "quantized" && values.size() > 0)
+      {
+        // the step is also kept large enough that the quantized values
+        // cannot overflow, however far the values are from zero
+        float range = values.maxCoeff() - values.minCoeff();
+        float magnitude = values.cwiseAbs().maxCoeff();
+        float step = std::max(range / 65535.0f, magnitude / (1 << 28));
+        std::vector<float> steps = {step > 0 ? step : 1.0f};
+        VertexBuffer column = values;
+        deltas_to_json(delta_encode(column, steps), steps, obj);
+      }
+      else
+      {
+        obj["ValueBuffer"] = matrix_to_json(values);
+      }
+    }
+  } // namespace
+
   Graph::Margin::Margin() : Margin(10) {}
 
   Graph::Margin::Margin(double size) : Margin(size, size, size, size) {}
@@ -45,9 +81,56 @@ namespace scenepic
 
   JsonValue Graph::Sparkline::to_json() const
   {
+    return this->to_json(0, "m4", 1, "float32");
+  }
+
+  JsonValue Graph::Sparkline::to_json(
+    std::size_t max_points,
+    const std::string& downsampling,
+    std::size_t pyramid_levels,
+    const std::string& value_encoding) const
+  {
+    typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 1> IndexBuffer;
+
     JsonValue command;
     command["CommandType"] = "AddSparkline";
-    command["ValueBuffer"] = matrix_to_json(m_values);
+    if (max_points == 0)
+    {
+      values_to_json(m_values, value_encoding, command);
+    }
+    else
+    {
+      auto num_values = static_cast<std::size_t>(m_values.size());
+      command["FrameCount"] = static_cast<std::int64_t>(num_values);
+      command["Levels"].resize(0);
+      std::size_t num_points = max_points;
+      for (std::size_t level = 0; level < pyramid_levels; ++level)
+      {
+        JsonValue level_values;
+        if (num_points >= num_values)
+        {
+          values_to_json(m_values, value_encoding, level_values);
+          command["Levels"].append(std::move(level_values));
+          break;
+        }
+
+        std::vector<std::uint32_t> indices =
+          downsample(m_values, num_points, downsampling);
+        auto num_indices = static_cast<Eigen::Index>(indices.size());
+        ValueBuffer values(num_indices);
+        for (Eigen::Index i = 0; i < num_indices; ++i)
+        {
+          values(i) = m_values(indices[i]);
+        }
+
+        level_values["FrameIndices"] = matrix_to_json(
+          Eigen::Map<const IndexBuffer>(indices.data(), num_indices));
+        values_to_json(values, value_encoding, level_values);
+        command["Levels"].append(std::move(level_values));
+        num_points *= 4;
+      }
+    }
+
     command["Name"] = m_name;
     command["StrokeStyle"] = m_color.to_html_hex();
     command["LineWidth"] = m_line_width;
@@ -64,7 +147,7 @@ namespace scenepic
       vertical_rules.resize(0);
     }
 
-    command["VerticalRules"] = vertical_rules;
+    command["VerticalRules"] = std::move(vertical_rules);
 
     return command;
   }
@@ -111,7 +194,13 @@ namespace scenepic
       name, value_buffer, color, line_width, vertical_rules);
   }
 
-  Graph::Graph(const std::string& canvas_id) : m_canvas_id(canvas_id) {}
+  Graph::Graph(const std::string& canvas_id)
+  : m_canvas_id(canvas_id),
+    m_max_points(0),
+    m_downsampling("m4"),
+    m_pyramid_levels(1),
+    m_value_encoding("float32")
+  {}
 
   std::string Graph::to_string() const
   {
@@ -127,12 +216,12 @@ namespace scenepic
     JsonValue margin;
     margin["CommandType"] = "SetMargin";
     margin["Value"] = m_margin.to_json();
-    canvas_commands.append(margin);
+    canvas_commands.append(std::move(margin));
 
     JsonValue background;
     background["CommandType"] = "SetBackgroundStyle";
     background["Value"] = m_background_color.to_html_hex();
-    canvas_commands.append(background);
+    canvas_commands.append(std::move(background));
 
     JsonValue text;
     text["CommandType"] = "SetTextStyle";
@@ -141,11 +230,12 @@ namespace scenepic
     text["ValueSizeInPixels"] = m_value_size;
     text["NameAlign"] = m_name_align;
     text["ValueAlign"] = m_value_align;
-    canvas_commands.append(text);
+    canvas_commands.append(std::move(text));
 
     for (const auto& sparkline : m_sparklines)
     {
-      canvas_commands.append(sparkline.to_json());
+      canvas_commands.append(sparkline.to_json(
+        m_max_points, m_downsampling, m_pyramid_levels, m_value_encoding));
     }
 
     if (!m_media_id.empty())
@@ -153,12 +243,12 @@ namespace scenepic
       JsonValue media;
       media["CommandType"] = "SetMedia";
       media["MediaId"] = m_media_id;
-      canvas_commands.append(media);
+      canvas_commands.append(std::move(media));
     }
 
     obj["CommandType"] = "CanvasCommands";
     obj["CanvasId"] = m_canvas_id;
-    obj["Commands"] = canvas_commands;
+    obj["Commands"] = std::move(canvas_commands);
     return obj;
   }
 
@@ -239,6 +329,76 @@ namespace scenepic
     return *this;
   }
 
+  std::size_t Graph::max_points() const
+  {
+    return m_max_points;
+  }
+
+  Graph& Graph::max_points(std::size_t max_points)
+  {
+    if (max_points > 0 && max_points < 4)
+    {
+      throw std::invalid_argument("Sparklines need at least four points");
+    }
+
+    m_max_points = max_points;
+    return *this;
+  }
+
+  const std::string& Graph::downsampling() const
+  {
+    return m_downsampling;
+  }
+
+  Graph& Graph::downsampling(const std::string& downsampling)
+  {
+    if (downsampling != "m4" && downsampling != "lttb")
+    {
+      throw std::invalid_argument(
+        "Invalid downsampling method: " + downsampling +
+        ". Expected m4 or lttb.");
+    }
+
+    m_downsampling = downsampling;
+    return *this;
+  }
+
+  std::size_t Graph::pyramid_levels() const
+  {
+    return m_pyramid_levels;
+  }
+
+  Graph& Graph::pyramid_levels(std::size_t pyramid_levels)
+  {
+    if (pyramid_levels == 0)
+    {
+      throw std::invalid_argument("There must be at least one pyramid level");
+    }
+
+    m_pyramid_levels = pyramid_levels;
+    return *this;
+  }
+
+  const std::string& Graph::value_encoding() const
+  {
+    return m_value_encoding;
+  }
+
+  Graph& Graph::value_encoding(const std::string& value_encoding)
+  {
+    if (
+      value_encoding != "float32" && value_encoding != "float16" &&
+      value_encoding != "quantized")
+    {
+      throw std::invalid_argument(
+        "Invalid value encoding: " + value_encoding +
+        ". Expected float32, float16 or quantized.");
+    }
+
+    m_value_encoding = value_encoding;
+    return *this;
+  }
+
   const std::string& Graph::media_id() const
   {
     return m_media_id;
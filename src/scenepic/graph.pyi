@@ -94,6 +94,42 @@ class Graph:
         displayed in time with the playback of the media file.
         """
 
+    @property
+    def max_points(self) -> int:
+        """The largest number of points sent for each sparkline.
+
+        Longer sparklines are downsampled, and the client interpolates between
+        the points which remain. 0 sends every value. Default 0.
+        """
+
+    @property
+    def downsampling(self) -> str:
+        """The method used to downsample sparklines.
+
+        "m4" keeps the first, last, smallest and largest value of each range
+        of frames, so the extremes are always kept. "lttb" (Largest Triangle
+        Three Buckets) follows the shape of the line more closely for the same
+        number of points. Default "m4".
+        """
+
+    @property
+    def pyramid_levels(self) -> int:
+        """The number of resolutions sent for each downsampled sparkline.
+
+        Each level has four times as many points as the one before, up to
+        every value, and the client draws the coarsest level which has a
+        point for each pixel of the line. Default 1.
+        """
+
+    @property
+    def value_encoding(self) -> str:
+        """How sparkline values are stored.
+
+        One of "float32", "float16" or "quantized". Quantized values are delta
+        coded in steps of 1/65535 of the range of the sparkline. Default
+        "float32".
+        """
+
     def add_sparkline(self, name: str, values: np.ndarray,
                       line_color: np.ndarray, line_width: float,
                       vertical_rules: List[VerticalRule] = None) -> None:
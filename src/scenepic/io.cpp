@@ -3,218 +3,825 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <fstream>
-#include <map>
+#include <iterator>
+#include <mutex>
 #include <sstream>
-#include <tuple>
+#include <string>
+#include <thread>
 #include <vector>
 
-#define TINYOBJLOADER_IMPLEMENTATION
 #include "io.h"
 #include "js_lib.h"
+#include "mapped_file.h"
 #include "mesh_info.h"
-#include "tinyobj/tiny_obj_loader.h"
+#include "parallel.h"
+#include "scene.h"
 #include "util.h"
 
 namespace
 {
-  typedef std::tuple<std::int32_t, std::int32_t, std::int32_t> Corner;
-  typedef std::tuple<float, float, float> Vec3;
-  typedef std::tuple<float, float> Vec2;
+  /** Chunks smaller than this are not worth parsing on their own thread. */
+  const std::ptrdiff_t MIN_CHUNK_BYTES = 1 << 20;
 
-  struct MeshData
+  /** Face indices which are relative to the end of the chunk's own vertex
+   *  list are offset by this value until the chunk offsets are known.
+   */
+  const std::int64_t RELATIVE_INDEX = std::int64_t(1) << 40;
+
+  const std::int64_t MISSING_INDEX = -1;
+
+  /** The contents of a contiguous range of lines from an OBJ file. */
+  struct ObjChunk
   {
-    std::vector<Vec3> positions;
-    std::vector<Vec3> normals;
-    std::vector<Vec2> uvs;
-    std::vector<Corner> corners;
+    std::vector<float> positions;
+    std::vector<float> uvs;
+    std::vector<float> normals;
+    std::vector<std::int64_t> corners;
+    std::string error;
   };
 
-  Corner resolve_corner(
-    const Corner& vertex,
-    const std::vector<std::size_t>& position_index,
-    const std::vector<std::size_t>& uv_index,
-    const std::vector<std::size_t>& normal_index)
+  inline bool is_space(char c)
   {
-    std::int32_t pos_idx, uv_idx, norm_idx;
-    std::tie(pos_idx, uv_idx, norm_idx) = vertex;
+    return c == ' ' || c == '\t' || c == '\r';
+  }
 
-    if (pos_idx < 0)
+  inline void skip_space(const char*& ptr, const char* end)
+  {
+    while (ptr < end && is_space(*ptr))
     {
-      pos_idx = static_cast<std::int32_t>(
-        position_index[position_index.size() + pos_idx]);
+      ++ptr;
     }
-    else if (pos_idx > 0)
+  }
+
+  inline bool is_digit(char c)
+  {
+    return c >= '0' && c <= '9';
+  }
+
+  /** Parses a decimal floating point number (with optional exponent). Up to
+   *  19 significant digits are accumulated exactly and then scaled by a power
+   *  of ten, which is well within float precision.
+   */
+  bool parse_float(const char*& ptr, const char* end, float& value)
+  {
+    static const double POWERS[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    skip_space(ptr, end);
+    const char* start = ptr;
+    bool negative = false;
+    if (ptr < end && (*ptr == '-' || *ptr == '+'))
     {
-      pos_idx = static_cast<std::int32_t>(position_index[pos_idx - 1]);
+      negative = *ptr == '-';
+      ++ptr;
     }
 
-    if (uv_idx < 0)
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any_digits = false;
+    for (; ptr < end && is_digit(*ptr); ++ptr)
     {
-      uv_idx = static_cast<std::int32_t>(uv_index[uv_index.size() + uv_idx]);
+      any_digits = true;
+      if (digits < 19)
+      {
+        mantissa = mantissa * 10 + (*ptr - '0');
+        digits += mantissa > 0;
+      }
+      else
+      {
+        exponent += 1;
+      }
     }
-    else if (uv_idx > 0)
+
+    if (ptr < end && *ptr == '.')
     {
-      uv_idx = static_cast<std::int32_t>(uv_index[uv_idx - 1]);
+      for (++ptr; ptr < end && is_digit(*ptr); ++ptr)
+      {
+        any_digits = true;
+        if (digits < 19)
+        {
+          mantissa = mantissa * 10 + (*ptr - '0');
+          digits += mantissa > 0;
+          exponent -= 1;
+        }
+      }
     }
-    else
+
+    if (!any_digits)
+    {
+      // fall back for inf/nan and anything else unusual
+      std::string token(start, std::find_if(start, end, [](char c) {
+                          return is_space(c) || c == '\n';
+                        }));
+      char* token_end = nullptr;
+      value = std::strtof(token.c_str(), &token_end);
+      ptr = start + (token_end - token.c_str());
+      return token_end != token.c_str();
+    }
+
+    if (ptr < end && (*ptr == 'e' || *ptr == 'E'))
+    {
+      const char* exp_start = ptr++;
+      bool exp_negative = false;
+      if (ptr < end && (*ptr == '-' || *ptr == '+'))
+      {
+        exp_negative = *ptr == '-';
+        ++ptr;
+      }
+
+      if (ptr < end && is_digit(*ptr))
+      {
+        int exp_value = 0;
+        for (; ptr < end && is_digit(*ptr); ++ptr)
+        {
+          exp_value = std::min(exp_value * 10 + (*ptr - '0'), 1000);
+        }
+
+        exponent += exp_negative ? -exp_value : exp_value;
+      }
+      else
+      {
+        ptr = exp_start;
+      }
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (mantissa != 0)
+    {
+      while (exponent > 22)
+      {
+        result *= 1e22;
+        exponent -= 22;
+      }
+
+      while (exponent < -22)
+      {
+        result /= 1e22;
+        exponent += 22;
+      }
+
+      result = exponent < 0 ? result / POWERS[-exponent]
+                            : result * POWERS[exponent];
+    }
+
+    value = static_cast<float>(negative ? -result : result);
+    return true;
+  }
+
+  bool parse_int(const char*& ptr, const char* end, std::int64_t& value)
+  {
+    bool negative = false;
+    if (ptr < end && (*ptr == '-' || *ptr == '+'))
     {
-      uv_idx = -1;
+      negative = *ptr == '-';
+      ++ptr;
     }
 
-    if (norm_idx < 0)
+    if (ptr == end || !is_digit(*ptr))
     {
-      norm_idx =
-        static_cast<std::int32_t>(normal_index[normal_index.size() + norm_idx]);
+      return false;
     }
-    else if (norm_idx > 0)
+
+    value = 0;
+    for (; ptr < end && is_digit(*ptr); ++ptr)
     {
-      norm_idx = static_cast<std::int32_t>(normal_index[norm_idx - 1]);
+      value = std::min<std::int64_t>(value * 10 + (*ptr - '0'), INT32_MAX);
+    }
+
+    value = negative ? -value : value;
+    return true;
+  }
+
+  /** Converts a 1-based or negative OBJ index into a 0-based global index,
+   *  or a chunk-relative index offset by RELATIVE_INDEX.
+   */
+  inline std::int64_t resolve_index(std::int64_t index, std::size_t count)
+  {
+    if (index > 0)
+    {
+      return index - 1;
+    }
+
+    if (index < 0)
+    {
+      return RELATIVE_INDEX + static_cast<std::int64_t>(count) + index;
+    }
+
+    return MISSING_INDEX;
+  }
+
+  /** Parses one face corner of the form v, v/t, v//n or v/t/n. */
+  bool parse_corner(
+    const char*& ptr,
+    const char* end,
+    ObjChunk& chunk,
+    std::array<std::int64_t, 3>& corner)
+  {
+    std::int64_t index = 0;
+    if (!parse_int(ptr, end, index))
+    {
+      return false;
+    }
+
+    corner[0] = resolve_index(index, chunk.positions.size() / 3);
+    corner[1] = corner[2] = MISSING_INDEX;
+    if (ptr < end && *ptr == '/')
+    {
+      ++ptr;
+      if (parse_int(ptr, end, index))
+      {
+        corner[1] = resolve_index(index, chunk.uvs.size() / 2);
+      }
+
+      if (ptr < end && *ptr == '/')
+      {
+        ++ptr;
+        if (parse_int(ptr, end, index))
+        {
+          corner[2] = resolve_index(index, chunk.normals.size() / 3);
+        }
+      }
+    }
+
+    return corner[0] != MISSING_INDEX;
+  }
+
+  void parse_face(const char* ptr, const char* end, ObjChunk& chunk)
+  {
+    std::array<std::array<std::int64_t, 3>, 4> corners;
+    std::size_t count = 0;
+    for (skip_space(ptr, end); ptr < end; skip_space(ptr, end))
+    {
+      if (count == corners.size())
+      {
+        chunk.error = "Only triangles and quad meshes are supported.";
+        return;
+      }
+
+      if (!parse_corner(ptr, end, chunk, corners[count++]))
+      {
+        chunk.error = "Invalid face in OBJ file.";
+        return;
+      }
+    }
+
+    static const std::array<std::size_t, 3> TRIANGLE = {0, 1, 2};
+    static const std::array<std::size_t, 6> QUAD = {0, 1, 2, 2, 3, 0};
+    if (count == 3)
+    {
+      for (auto i : TRIANGLE)
+      {
+        chunk.corners.insert(
+          chunk.corners.end(), corners[i].begin(), corners[i].end());
+      }
+    }
+    else if (count == 4)
+    {
+      for (auto i : QUAD)
+      {
+        chunk.corners.insert(
+          chunk.corners.end(), corners[i].begin(), corners[i].end());
+      }
     }
     else
     {
-      norm_idx = -1;
+      chunk.error = "Only triangles and quad meshes are supported.";
     }
+  }
 
-    return std::make_tuple(pos_idx, uv_idx, norm_idx);
+  void parse_floats(
+    const char* ptr,
+    const char* end,
+    std::size_t count,
+    std::vector<float>& values,
+    std::string& error)
+  {
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      float value = 0;
+      if (!parse_float(ptr, end, value))
+      {
+        error = "Invalid vertex data in OBJ file.";
+        return;
+      }
+
+      values.push_back(value);
+    }
   }
 
-} // namespace
+  void parse_position(const char* ptr, const char* end, ObjChunk& chunk)
+  {
+    std::array<float, 3> position;
+    for (auto& value : position)
+    {
+      if (!parse_float(ptr, end, value))
+      {
+        chunk.error = "Invalid vertex data in OBJ file.";
+        return;
+      }
+    }
 
-namespace scenepic
-{
-  std::shared_ptr<MeshInfo> load_obj(const std::string& path)
+    // an optional fourth value is the homogeneous coordinate
+    float w = 1;
+    skip_space(ptr, end);
+    if (ptr < end && parse_float(ptr, end, w) && w != 0)
+    {
+      for (auto& value : position)
+      {
+        value /= w;
+      }
+    }
+
+    chunk.positions.insert(
+      chunk.positions.end(), position.begin(), position.end());
+  }
+
+  void parse_lines(const char* ptr, const char* end, ObjChunk& chunk)
   {
-    std::ifstream stream(path);
-    if (stream.is_open())
-      return load_obj(stream);
+    while (ptr < end && chunk.error.empty())
+    {
+      const char* line_end =
+        static_cast<const char*>(std::memchr(ptr, '\n', end - ptr));
+      if (line_end == nullptr)
+      {
+        line_end = end;
+      }
 
-    throw std::invalid_argument("Unable to open file.");
+      skip_space(ptr, line_end);
+      if (line_end - ptr >= 2 && is_space(ptr[1]))
+      {
+        if (ptr[0] == 'v')
+        {
+          parse_position(ptr + 2, line_end, chunk);
+        }
+        else if (ptr[0] == 'f')
+        {
+          parse_face(ptr + 2, line_end, chunk);
+        }
+      }
+      else if (line_end - ptr >= 3 && ptr[0] == 'v' && is_space(ptr[2]))
+      {
+        if (ptr[1] == 't')
+        {
+          parse_floats(ptr + 3, line_end, 2, chunk.uvs, chunk.error);
+        }
+        else if (ptr[1] == 'n')
+        {
+          parse_floats(ptr + 3, line_end, 3, chunk.normals, chunk.error);
+        }
+      }
+
+      ptr = line_end + 1;
+    }
   }
 
-  std::shared_ptr<MeshInfo> load_obj(std::istream& stream)
+  template<typename T, std::size_t N>
+  using RowIndex = scenepic::IndexMap<std::array<T, N>>;
+
+  /** Deduplicates the rows of a value buffer, returning the unique index of
+   *  every row.
+   */
+  template<std::size_t N>
+  std::vector<std::uint32_t>
+  unique_rows(const std::vector<float>& values, RowIndex<float, N>& index)
+  {
+    std::size_t count = values.size() / N;
+    std::vector<std::uint32_t> reverse_index(count);
+    std::array<float, N> row;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      std::memcpy(row.data(), &values[i * N], sizeof(row));
+      reverse_index[i] = index.insert(row);
+    }
+
+    return reverse_index;
+  }
+
+  template<typename T>
+  void append_chunks(
+    std::vector<ObjChunk>& chunks,
+    std::vector<T> ObjChunk::*member,
+    std::vector<T>& result)
   {
-    MeshData mesh_data;
+    std::size_t total = 0;
+    for (const auto& chunk : chunks)
+    {
+      total += (chunk.*member).size();
+    }
+
+    result.reserve(total);
+    for (auto& chunk : chunks)
+    {
+      std::vector<T>& values = chunk.*member;
+      result.insert(result.end(), values.begin(), values.end());
+      std::vector<T>().swap(values);
+    }
+  }
 
-    std::string warn;
-    std::string err;
+  /** Parses the values and face corners of an OBJ file, with every corner
+   *  stored as global 0-based (position, uv, normal) indices.
+   */
+  ObjChunk read_obj(const char* data, std::size_t size)
+  {
+    // split the file into chunks of whole lines
+    std::ptrdiff_t num_chunks = std::max<std::ptrdiff_t>(
+      scenepic::parallel_chunk_count(size, MIN_CHUNK_BYTES), 1);
+    std::vector<const char*> bounds(num_chunks + 1, data + size);
+    bounds[0] = data;
+    for (std::ptrdiff_t i = 1; i < num_chunks; ++i)
+    {
+      const char* start = std::max(bounds[i - 1], data + size * i / num_chunks);
+      const char* line_end = static_cast<const char*>(
+        std::memchr(start, '\n', data + size - start));
+      bounds[i] = line_end == nullptr ? data + size : line_end + 1;
+    }
 
-    tinyobj::callback_t cb;
-    cb.vertex_cb = [](void* user_data, float x, float y, float z, float w) {
-      auto mesh_data = reinterpret_cast<MeshData*>(user_data);
-      mesh_data->positions.emplace_back(x / w, y / w, z / w);
-    };
-    cb.texcoord_cb = [](void* user_data, float x, float y, float z) {
-      auto mesh_data = reinterpret_cast<MeshData*>(user_data);
-      mesh_data->uvs.emplace_back(x, y);
-    };
-    cb.normal_cb = [](void* user_data, float x, float y, float z) {
-      auto mesh_data = reinterpret_cast<MeshData*>(user_data);
-      mesh_data->normals.emplace_back(x, y, z);
-    };
-    cb.index_cb =
-      [](void* user_data, tinyobj::index_t* indices, int num_indices) {
-        auto mesh_data = reinterpret_cast<MeshData*>(user_data);
-        if (num_indices == 3)
-        {
-          for (auto idx = indices; idx < indices + 3; ++idx)
-          {
-            mesh_data->corners.emplace_back(
-              idx->vertex_index, idx->texcoord_index, idx->normal_index);
-          }
-        }
-        else if (num_indices == 4)
-        {
-          for (auto idx = indices; idx < indices + 3; ++idx)
-          {
-            mesh_data->corners.emplace_back(
-              idx->vertex_index, idx->texcoord_index, idx->normal_index);
-          }
-
-          for (auto idx = indices + 2; idx < indices + 4; ++idx)
-          {
-            mesh_data->corners.emplace_back(
-              idx->vertex_index, idx->texcoord_index, idx->normal_index);
-          }
-
-          mesh_data->corners.emplace_back(
-            indices->vertex_index,
-            indices->texcoord_index,
-            indices->normal_index);
+    std::vector<ObjChunk> chunks(num_chunks);
+    scenepic::parallel_for(
+      0,
+      num_chunks,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+        for (auto i = begin; i < end; ++i)
+        {
+          parse_lines(bounds[i], bounds[i + 1], chunks[i]);
         }
-        else
+      },
+      1);
+
+    // chunk-relative indices can now be made global
+    std::array<std::int64_t, 3> offsets = {0, 0, 0};
+    for (auto& chunk : chunks)
+    {
+      if (!chunk.error.empty())
+      {
+        throw std::invalid_argument(chunk.error);
+      }
+
+      for (std::size_t i = 0; i < chunk.corners.size(); ++i)
+      {
+        std::int64_t& index = chunk.corners[i];
+        if (index >= RELATIVE_INDEX / 2)
         {
-          throw std::invalid_argument(
-            "Only triangles and quad meshes are supported.");
+          index += offsets[i % 3] - RELATIVE_INDEX;
         }
-      };
+      }
 
-    bool ret = tinyobj::LoadObjWithCallback(stream, cb, &mesh_data, NULL, &err);
+      offsets[0] += chunk.positions.size() / 3;
+      offsets[1] += chunk.uvs.size() / 2;
+      offsets[2] += chunk.normals.size() / 3;
+    }
 
-    std::vector<Vec3> unique_positions;
-    std::vector<std::size_t> position_index;
-    unique_index(mesh_data.positions, unique_positions, position_index);
+    ObjChunk obj;
+    append_chunks(chunks, &ObjChunk::positions, obj.positions);
+    append_chunks(chunks, &ObjChunk::uvs, obj.uvs);
+    append_chunks(chunks, &ObjChunk::normals, obj.normals);
+    append_chunks(chunks, &ObjChunk::corners, obj.corners);
+    return obj;
+  }
+
+  /** Builds a mesh info from the contents of an OBJ file, optionally
+   *  returning the first corner which refers to each vertex.
+   */
+  std::shared_ptr<scenepic::MeshInfo> to_mesh_info(
+    const ObjChunk& obj, std::vector<std::size_t>* vertex_corners = nullptr)
+  {
+    using scenepic::MeshInfo;
+
+    const std::vector<float>& positions = obj.positions;
+    const std::vector<float>& uvs = obj.uvs;
+    const std::vector<float>& normals = obj.normals;
+    const std::vector<std::int64_t>& corners = obj.corners;
 
-    std::vector<Vec2> unique_uvs;
-    std::vector<std::size_t> uv_index;
-    unique_index(mesh_data.uvs, unique_uvs, uv_index);
+    // identical values are merged before the corners are deduplicated
+    RowIndex<float, 3> unique_positions(positions.size() / 3);
+    RowIndex<float, 2> unique_uvs(uvs.size() / 2);
+    RowIndex<float, 3> unique_normals(normals.size() / 3);
+    std::vector<std::uint32_t> position_index =
+      unique_rows(positions, unique_positions);
+    std::vector<std::uint32_t> uv_index = unique_rows(uvs, unique_uvs);
+    std::vector<std::uint32_t> normal_index =
+      unique_rows(normals, unique_normals);
 
-    std::vector<Vec3> unique_normals;
-    std::vector<std::size_t> normal_index;
-    unique_index(mesh_data.normals, unique_normals, normal_index);
+    std::array<const std::vector<std::uint32_t>*, 3> indices = {
+      &position_index, &uv_index, &normal_index};
+    std::size_t num_corners = corners.size() / 3;
+    RowIndex<std::int32_t, 3> unique_corners(num_corners / 4);
+    std::vector<std::uint32_t> corner_index(num_corners);
+    for (std::size_t i = 0; i < num_corners; ++i)
+    {
+      std::array<std::int32_t, 3> corner;
+      for (std::size_t j = 0; j < 3; ++j)
+      {
+        std::int64_t index = corners[i * 3 + j];
+        if (index == MISSING_INDEX)
+        {
+          corner[j] = -1;
+          continue;
+        }
 
-    std::transform(
-      mesh_data.corners.begin(),
-      mesh_data.corners.end(),
-      mesh_data.corners.begin(),
-      [&](const Corner& vertex) -> Corner {
-        return resolve_corner(vertex, position_index, uv_index, normal_index);
-      });
+        const auto& lookup = *indices[j];
+        if (index < 0 || index >= static_cast<std::int64_t>(lookup.size()))
+        {
+          throw std::invalid_argument("Face index out of range in OBJ file.");
+        }
 
-    std::vector<Corner> unique_corners;
-    std::vector<std::size_t> corner_index;
-    unique_index(mesh_data.corners, unique_corners, corner_index);
+        corner[j] = static_cast<std::int32_t>(lookup[index]);
+      }
 
-    auto num_vertices = unique_corners.size();
-    auto num_triangles = corner_index.size() / 3;
-    bool has_uvs = mesh_data.uvs.size() != 0;
-    bool has_normals = mesh_data.normals.size() != 0;
+      corner_index[i] = unique_corners.insert(corner);
+      if (vertex_corners && corner_index[i] == vertex_corners->size())
+      {
+        vertex_corners->push_back(i);
+      }
+    }
 
+    std::size_t num_vertices = unique_corners.size();
+    std::size_t num_triangles = num_corners / 3;
+    bool has_uvs = !uvs.empty();
+    bool has_normals = !normals.empty();
     auto mesh_info = std::make_shared<MeshInfo>(
       num_vertices, num_triangles, has_uvs, has_normals, false);
 
-    for (auto i = 0; i < num_vertices; ++i)
+    auto position_buffer = mesh_info->position_buffer();
+    auto uv_buffer = mesh_info->uv_buffer();
+    auto normal_buffer = mesh_info->normal_buffer();
+    const auto& corner_rows = unique_corners.keys();
+    const auto& position_rows = unique_positions.keys();
+    const auto& uv_rows = unique_uvs.keys();
+    const auto& normal_rows = unique_normals.keys();
+    for (std::size_t i = 0; i < num_vertices; ++i)
     {
-      std::int32_t pos_idx, uv_idx, norm_idx;
-      std::tie(pos_idx, uv_idx, norm_idx) = unique_corners[i];
-      float x, y, z;
-      std::tie(x, y, z) = unique_positions[pos_idx];
-      mesh_info->position_buffer().row(i) << x, y, z;
-      if (uv_idx >= 0)
+      const std::int32_t* corner = corner_rows[i].data();
+      const float* position = position_rows[corner[0]].data();
+      position_buffer.row(i) << position[0], position[1], position[2];
+      if (has_uvs)
       {
-        float u, v;
-        std::tie(u, v) = unique_uvs[uv_idx];
-        mesh_info->uv_buffer().row(i) << u, v;
+        if (corner[1] >= 0)
+        {
+          const float* uv = uv_rows[corner[1]].data();
+          uv_buffer.row(i) << uv[0], uv[1];
+        }
+        else
+        {
+          uv_buffer.row(i).setZero();
+        }
       }
 
-      if (norm_idx >= 0)
+      if (has_normals)
       {
-        float x, y, z;
-        std::tie(x, y, z) = unique_normals[norm_idx];
-        mesh_info->normal_buffer().row(i) << x, y, z;
+        if (corner[2] >= 0)
+        {
+          const float* normal = normal_rows[corner[2]].data();
+          normal_buffer.row(i) << normal[0], normal[1], normal[2];
+        }
+        else
+        {
+          normal_buffer.row(i).setZero();
+        }
       }
     }
 
-    for (auto i = 0, j = 0; i < num_triangles; ++i, j += 3)
+    std::copy(
+      corner_index.begin(),
+      corner_index.end(),
+      mesh_info->triangle_buffer().data());
+
+    return mesh_info;
+  }
+
+  std::shared_ptr<scenepic::MeshInfo>
+  parse_obj(const char* data, std::size_t size)
+  {
+    return to_mesh_info(read_obj(data, size));
+  }
+
+  /** Loads a sequence of OBJ files on a pool of worker threads. Workers stay
+   *  at most a fixed number of frames ahead of the consumer, so memory use is
+   *  bounded regardless of the length of the sequence.
+   */
+  class SequenceLoader
+  {
+  public:
+    SequenceLoader(
+      const std::vector<std::string>& paths, std::size_t num_threads)
+    : m_paths(paths),
+      m_frames(paths.size()),
+      m_window(2 * num_threads),
+      m_next(0),
+      m_consumed(0),
+      m_stop(false)
     {
-      std::uint32_t a = static_cast<std::uint32_t>(corner_index[j]);
-      std::uint32_t b = static_cast<std::uint32_t>(corner_index[j + 1]);
-      std::uint32_t c = static_cast<std::uint32_t>(corner_index[j + 2]);
-      mesh_info->triangle_buffer().row(i) << a, b, c;
+      for (std::size_t i = 0; i < num_threads; ++i)
+      {
+        m_workers.emplace_back(&SequenceLoader::work, this);
+      }
     }
 
-    return mesh_info;
+    ~SequenceLoader()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+
+      m_condition.notify_all();
+      for (auto& worker : m_workers)
+      {
+        worker.join();
+      }
+    }
+
+    /** Waits for the next frame in order, rethrowing any load error. */
+    ObjChunk next()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      Frame& frame = m_frames[m_consumed];
+      m_condition.wait(lock, [&]() { return frame.ready; });
+      ObjChunk obj;
+      std::swap(obj, frame.obj);
+      std::exception_ptr error = frame.error;
+      m_consumed += 1;
+      lock.unlock();
+
+      m_condition.notify_all();
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+
+      return obj;
+    }
+
+  private:
+    struct Frame
+    {
+      ObjChunk obj;
+      std::exception_ptr error;
+      bool ready = false;
+    };
+
+    void work()
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (true)
+      {
+        m_condition.wait(lock, [&]() {
+          return m_stop || m_next == m_paths.size() ||
+            m_next < m_consumed + m_window;
+        });
+
+        if (m_stop || m_next == m_paths.size())
+        {
+          return;
+        }
+
+        std::size_t index = m_next++;
+        lock.unlock();
+
+        ObjChunk obj;
+        std::exception_ptr error;
+        try
+        {
+          scenepic::MappedFile file(m_paths[index], true);
+          obj = read_obj(file.data(), file.size());
+        }
+        catch (...)
+        {
+          error = std::current_exception();
+        }
+
+        lock.lock();
+        std::swap(m_frames[index].obj, obj);
+        m_frames[index].error = error;
+        m_frames[index].ready = true;
+        m_condition.notify_all();
+      }
+    }
+
+    const std::vector<std::string>& m_paths;
+    std::vector<Frame> m_frames;
+    std::size_t m_window;
+    std::size_t m_next;
+    std::size_t m_consumed;
+    bool m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<std::thread> m_workers;
+  };
+} // namespace
+
+namespace scenepic
+{
+  std::shared_ptr<MeshInfo> load_obj(const std::string& path)
+  {
+    MappedFile file(path, true);
+    return parse_obj(file.data(), file.size());
+  }
+
+  std::shared_ptr<MeshInfo> load_obj(std::istream& stream)
+  {
+    std::string buffer(
+      (std::istreambuf_iterator<char>(stream)),
+      std::istreambuf_iterator<char>());
+    return parse_obj(buffer.data(), buffer.size());
+  }
+
+  std::vector<std::shared_ptr<MeshUpdate>> load_obj_sequence(
+    Scene& scene,
+    const std::string& base_mesh_id,
+    const std::string& base_path,
+    const std::vector<std::string>& paths,
+    std::size_t num_threads)
+  {
+    std::vector<std::shared_ptr<MeshUpdate>> updates;
+    if (paths.empty())
+    {
+      return updates;
+    }
+
+    if (num_threads == 0)
+    {
+      num_threads = static_cast<std::size_t>(thread_count());
+    }
+
+    // the base is deduplicated exactly as by load_obj, and each of its
+    // vertices is then read from the same file position and normal in
+    // every frame, so that values which coincide in some frames but not
+    // in others do not change the topology
+    ObjChunk base;
+    {
+      MappedFile file(base_path, true);
+      base = read_obj(file.data(), file.size());
+    }
+
+    std::vector<std::size_t> vertex_corners;
+    auto base_info = to_mesh_info(base, &vertex_corners);
+    std::size_t num_vertices = vertex_corners.size();
+    std::vector<std::int64_t> position_index(num_vertices);
+    std::vector<std::int64_t> normal_index(num_vertices);
+    bool has_normals = base_info->has_normals();
+    for (std::size_t i = 0; i < num_vertices; ++i)
+    {
+      position_index[i] = base.corners[vertex_corners[i] * 3];
+      normal_index[i] = base.corners[vertex_corners[i] * 3 + 2];
+      has_normals = has_normals && normal_index[i] != MISSING_INDEX;
+    }
+
+    updates.reserve(paths.size());
+    SequenceLoader loader(paths, std::min(num_threads, paths.size()));
+    VectorBuffer positions(num_vertices, 3);
+    VectorBuffer normals(has_normals ? num_vertices : 0, 3);
+    for (const auto& path : paths)
+    {
+      ObjChunk frame = loader.next();
+      std::int64_t num_positions = frame.positions.size() / 3;
+      std::int64_t num_normals = frame.normals.size() / 3;
+      bool frame_has_normals = has_normals && num_normals > 0;
+      bool valid = frame.corners == base.corners;
+      for (std::size_t i = 0; valid && i < num_vertices; ++i)
+      {
+        valid = position_index[i] < num_positions &&
+          (!frame_has_normals || normal_index[i] < num_normals);
+      }
+
+      if (!valid)
+      {
+        throw std::invalid_argument(
+          "The topology of " + path + " does not match the base mesh.");
+      }
+
+      for (std::size_t i = 0; i < num_vertices; ++i)
+      {
+        const float* position = &frame.positions[position_index[i] * 3];
+        positions.row(i) << position[0], position[1], position[2];
+        if (frame_has_normals)
+        {
+          const float* normal = &frame.normals[normal_index[i] * 3];
+          normals.row(i) << normal[0], normal[1], normal[2];
+        }
+      }
+
+      if (frame_has_normals)
+      {
+        updates.push_back(scene.update_mesh(
+          base_mesh_id, positions, normals, ColorBufferNone()));
+      }
+      else
+      {
+        updates.push_back(
+          scene.update_mesh_positions(base_mesh_id, positions));
+      }
+    }
+
+    return updates;
   }
-} // namespace scenepic
\ No newline at end of file
+} // namespace scenepic
@@ -6,10 +6,19 @@
 #include "internal.h"
 
 #include "json/json.h"
+#include <algorithm>
 #include <exception>
+#include <numeric>
+#include <stdexcept>
 
 namespace scenepic
 {
+  namespace
+  {
+    // objects with this many members are searched through a sorted index
+    const std::size_t INDEX_THRESHOLD = 16;
+  } // namespace
+
   Json::Value scenepic_to_json(const JsonValue& value)
   {
     Json::Value obj;
@@ -133,33 +142,158 @@ namespace scenepic
     throw std::logic_error(errs);
   }
 
+  JsonObject::iterator JsonObject::begin()
+  {
+    return m_members.begin();
+  }
+
+  JsonObject::const_iterator JsonObject::begin() const
+  {
+    return m_members.begin();
+  }
+
+  JsonObject::iterator JsonObject::end()
+  {
+    return m_members.end();
+  }
+
+  JsonObject::const_iterator JsonObject::end() const
+  {
+    return m_members.end();
+  }
+
+  std::size_t JsonObject::size() const
+  {
+    return m_members.size();
+  }
+
+  bool JsonObject::empty() const
+  {
+    return m_members.empty();
+  }
+
+  std::size_t JsonObject::count(const std::string& key) const
+  {
+    return this->find(key) == m_members.end() ? 0 : 1;
+  }
+
+  JsonObject::iterator JsonObject::find(const std::string& key)
+  {
+    auto member = static_cast<const JsonObject*>(this)->find(key);
+    return m_members.begin() + (member - m_members.cbegin());
+  }
+
+  JsonObject::const_iterator JsonObject::find(const std::string& key) const
+  {
+    if (m_index.empty())
+    {
+      return std::find_if(
+        m_members.begin(), m_members.end(), [&key](const value_type& member) {
+          return member.first == key;
+        });
+    }
+
+    auto position = this->index_bound(key);
+    if (position == m_index.end() || m_members[*position].first != key)
+    {
+      return m_members.end();
+    }
+
+    return m_members.begin() + *position;
+  }
+
+  JsonValue& JsonObject::at(const std::string& key)
+  {
+    auto member = this->find(key);
+    if (member == m_members.end())
+    {
+      throw std::out_of_range("No JSON member with key " + key);
+    }
+
+    return member->second;
+  }
+
+  const JsonValue& JsonObject::at(const std::string& key) const
+  {
+    auto member = this->find(key);
+    if (member == m_members.end())
+    {
+      throw std::out_of_range("No JSON member with key " + key);
+    }
+
+    return member->second;
+  }
+
+  JsonValue& JsonObject::operator[](const std::string& key)
+  {
+    auto member = this->find(key);
+    if (member != m_members.end())
+    {
+      return member->second;
+    }
+
+    // most objects have a few members, so room for several is made at once
+    if (m_members.empty())
+    {
+      m_members.reserve(4);
+    }
+
+    m_members.emplace_back(key, JsonValue());
+    if (!m_index.empty())
+    {
+      m_index.insert(this->index_bound(key), m_members.size() - 1);
+    }
+    else if (m_members.size() == INDEX_THRESHOLD)
+    {
+      m_index.resize(m_members.size());
+      std::iota(m_index.begin(), m_index.end(), 0);
+      std::sort(
+        m_index.begin(),
+        m_index.end(),
+        [this](std::size_t lhs, std::size_t rhs) {
+          return m_members[lhs].first < m_members[rhs].first;
+        });
+    }
+
+    return m_members.back().second;
+  }
+
+  std::vector<std::size_t>::const_iterator
+  JsonObject::index_bound(const std::string& key) const
+  {
+    return std::lower_bound(
+      m_index.begin(),
+      m_index.end(),
+      key,
+      [this](std::size_t index, const std::string& value) {
+        return m_members[index].first < value;
+      });
+  }
+
   JsonValue::JsonValue() : JsonValue(JsonType::Object) {}
 
   JsonValue::JsonValue(std::int64_t value)
-  : m_type(JsonType::Integer), m_int(value), m_double(value)
+  : m_type(JsonType::Integer), m_int(value)
   {}
 
-  JsonValue::JsonValue(double value)
-  : m_type(JsonType::Double),
-    m_double(value),
-    m_int(static_cast<std::int64_t>(value))
+  JsonValue::JsonValue(double value) : m_type(JsonType::Double), m_double(value)
   {}
 
   JsonValue::JsonValue(bool value) : m_type(JsonType::Boolean), m_bool(value) {}
 
   JsonValue::JsonValue(const std::string& value)
-  : m_type(JsonType::String), m_string(value)
+  : m_type(JsonType::String), m_int(0), m_string(value)
   {}
 
   JsonValue::JsonValue(const char* value)
-  : m_type(JsonType::String), m_string(value)
+  : m_type(JsonType::String), m_int(0), m_string(value)
   {}
 
   JsonValue::JsonValue(std::string&& value)
-  : m_type(JsonType::String), m_string(std::move(value))
+  : m_type(JsonType::String), m_int(0), m_string(std::move(value))
   {}
 
-  JsonValue::JsonValue(JsonType type) : m_type(type) {}
+  JsonValue::JsonValue(JsonType type) : m_type(type), m_int(0) {}
 
   void JsonValue::resize(std::size_t size)
   {
@@ -181,11 +315,6 @@ namespace scenepic
 
   JsonValue& JsonValue::operator[](const std::string& key)
   {
-    if (m_lookup.count(key) == 0)
-    {
-      m_lookup[key] = JsonValue();
-    }
-
     m_type = JsonType::Object;
     return m_lookup[key];
   }
@@ -220,7 +349,6 @@ namespace scenepic
   {
     m_type = JsonType::Double;
     m_double = value;
-    m_int = static_cast<std::int64_t>(value);
     return *this;
   }
 
@@ -228,7 +356,6 @@ namespace scenepic
   {
     m_type = JsonType::Integer;
     m_int = value;
-    m_double = value;
     return *this;
   }
 
@@ -251,22 +378,45 @@ namespace scenepic
 
   double JsonValue::as_double() const
   {
+    if (m_type == JsonType::Integer)
+    {
+      return static_cast<double>(m_int);
+    }
+
     return m_double;
   }
 
   float JsonValue::as_float() const
   {
-    return static_cast<float>(m_double);
+    return static_cast<float>(this->as_double());
   }
 
   std::int64_t JsonValue::as_int() const
   {
+    if (m_type == JsonType::Double)
+    {
+      return static_cast<std::int64_t>(m_double);
+    }
+
     return m_int;
   }
 
   bool JsonValue::as_boolean() const
   {
-    return m_bool;
+    switch (m_type)
+    {
+      case JsonType::Boolean:
+        return m_bool;
+
+      case JsonType::Integer:
+        return m_int != 0;
+
+      case JsonType::Double:
+        return m_double != 0;
+
+      default:
+        return false;
+    }
   }
 
   const std::vector<JsonValue>& JsonValue::values() const
@@ -274,7 +424,17 @@ namespace scenepic
     return m_values;
   }
 
-  const std::map<std::string, JsonValue>& JsonValue::lookup() const
+  std::vector<JsonValue>& JsonValue::values()
+  {
+    return m_values;
+  }
+
+  const JsonObject& JsonValue::lookup() const
+  {
+    return m_lookup;
+  }
+
+  JsonObject& JsonValue::lookup()
   {
     return m_lookup;
   }
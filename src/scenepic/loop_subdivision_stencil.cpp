@@ -4,210 +4,839 @@
 #define _USE_MATH_DEFINES
 #include "loop_subdivision_stencil.h"
 
+#include "mapped_file.h"
+#include "parallel.h"
+#include "scene.h"
+
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
-#include <map>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
 namespace scenepic
 {
-  typedef std::map<Triangle::Scalar, Triangle::Scalar> VertexMap;
-  typedef std::vector<Triangle::Scalar> VertexList;
-  typedef std::map<Triangle::Scalar, VertexList> VertexListMap;
-  typedef std::vector<VertexMap> VertexMapList;
-  typedef std::pair<Triangle::Scalar, Triangle::Scalar> Edge;
-  typedef std::map<Edge, Triangle::Scalar> EdgeVertexMap;
-  typedef std::vector<Edge> EdgeList;
-
-  const std::size_t MIN_VALENCY = 3;
-  const std::size_t MAX_VALENCY = 10;
-
-  Edge reverse(const Edge& edge)
+  namespace
   {
-    return std::make_pair(edge.second, edge.first);
-  }
+    typedef Triangle::Scalar Index;
+    typedef Eigen::SparseMatrix<float, Eigen::RowMajor> RowMajorMatrix;
 
-  VertexList keys(const VertexMap& vertex_map)
-  {
-    VertexList result;
-    result.reserve(vertex_map.size());
-    std::transform(
-      vertex_map.begin(),
-      vertex_map.end(),
-      std::back_inserter(result),
-      [](const VertexMap::value_type& pair) { return pair.first; });
-    return result;
-  }
+    const Index NO_INDEX = std::numeric_limits<Index>::max();
+    const std::size_t MIN_VALENCY = 3;
+    const std::ptrdiff_t MIN_CHUNK = 4096;
+    const std::ptrdiff_t MIN_ROW_CHUNK = 256;
+    const Eigen::Index COLUMN_TILE = 48;
+    const Eigen::Index FRAMES_PER_PASS = 16;
 
-  struct SubdivisionBuilder
-  {
-    SubdivisionBuilder() : alphas(MAX_VALENCY + 1), omegas(MAX_VALENCY + 1)
+    /** Checks that frames can be multiplied by a subdivision matrix. */
+    void check_frames(
+      const RowMajorMatrix& subdiv, const ConstVertexBufferRef& frames)
     {
-      // Compute alphas and omegas
-      std::vector<double> alphas(MAX_VALENCY + 1);
-      std::vector<double> omegas(MAX_VALENCY + 1);
-      for (auto N = MIN_VALENCY; N < MAX_VALENCY + 1; ++N)
+      if (frames.rows() != subdiv.cols())
+      {
+        throw std::invalid_argument(
+          "The frames do not have the vertex count of the stencil.");
+      }
+
+      if (frames.cols() % 3 != 0)
       {
-        auto val = 3.0 + 2.0 * std::cos(2.0 * M_PI / N);
-        auto val2 = val * val;
-        this->alphas[N] = 5.0 / 8.0 - val2 / 64.0;
-        this->omegas[N] = 24.0 * N / (40.0 - val2);
+        throw std::invalid_argument(
+          "The frames must have three columns per frame.");
       }
     }
 
-    Triangle::Scalar
-    add_new_vertex(const VertexList& idxs, const std::vector<float>& weights)
+    /** Computes output = stencil * frames.middleCols(col, output.cols()),
+     *  splitting the rows across threads. Each row is built a tile of
+     *  columns at a time, so its accumulator stays in cache while the
+     *  input rows are gathered.
+     */
+    void multiply(
+      const RowMajorMatrix& stencil,
+      const ConstVertexBufferRef& frames,
+      Eigen::Index col,
+      VertexBuffer& output)
+    {
+      output.setZero();
+      Eigen::Index cols = output.cols();
+      parallel_for(
+        0,
+        stencil.rows(),
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+          for (Eigen::Index tile = 0; tile < cols; tile += COLUMN_TILE)
+          {
+            Eigen::Index width = std::min(COLUMN_TILE, cols - tile);
+            for (auto row = begin; row < end; ++row)
+            {
+              auto output_tile = output.block(row, tile, 1, width);
+              for (RowMajorMatrix::InnerIterator it(stencil, row); it; ++it)
+              {
+                output_tile.noalias() +=
+                  it.value() * frames.block(it.col(), col + tile, 1, width);
+              }
+            }
+          }
+        },
+        MIN_ROW_CHUNK);
+    }
+
+    const char BINARY_MAGIC[8] = {'S', 'P', 'S', 'T', 'E', 'N', 'C', '\0'};
+    const std::uint32_t BINARY_VERSION = 1;
+
+    /** Sections start on cache line boundaries so that they can be used in
+     *  place from a mapping of the file.
+     */
+    const std::uint64_t BINARY_ALIGNMENT = 64;
+
+    enum BinarySection
+    {
+      Triangles,
+      RowOffsets,
+      Columns,
+      Weights,
+      NumSections
+    };
+
+    struct BinaryHeader
     {
-      auto new_index = this->v_indptr.size();
-      this->v_indptr.push_back(
-        static_cast<Triangle::Scalar>(this->v_weights.size()));
-      this->v_weights.insert(
-        this->v_weights.end(), weights.begin(), weights.end());
-      this->v_generating_idxs.insert(
-        this->v_generating_idxs.end(), idxs.begin(), idxs.end());
-      return static_cast<Triangle::Scalar>(new_index);
+      char magic[8];
+      std::uint32_t version;
+      std::uint32_t flags;
+      std::uint64_t rows;
+      std::uint64_t cols;
+      std::uint64_t num_nonzero;
+      std::uint64_t num_triangles;
+      std::uint64_t offsets[NumSections];
+      std::uint64_t sizes[NumSections];
+    };
+
+    std::uint64_t align_offset(std::uint64_t offset)
+    {
+      return (offset + BINARY_ALIGNMENT - 1) / BINARY_ALIGNMENT *
+        BINARY_ALIGNMENT;
     }
 
-    void generate_vertex_vertex(
-      Triangle::Scalar i_vertex, const VertexListMap& v_neighbors, int steps)
+    /** Returns a section of the file, checking that it has the expected
+     *  number of values and is aligned for use in place.
+     */
+    template<typename T>
+    const T* section(
+      const MappedFile& file,
+      const BinaryHeader& header,
+      BinarySection section,
+      std::uint64_t count)
     {
-      // construct stencils for original vertices
-      auto& ns = v_neighbors.at(i_vertex);
-      auto valency = ns.size();
-      std::vector<float> weights(valency + 1);
-      if (steps == 0)
+      const char* data = file.data() + header.offsets[section];
+      if (
+        count > header.sizes[section] / sizeof(T) ||
+        header.sizes[section] != count * sizeof(T) ||
+        reinterpret_cast<std::uintptr_t>(data) % alignof(T) != 0)
       {
-        auto omega = this->omegas[valency];
-        weights[0] = static_cast<float>(omega / (omega + valency));
-        std::fill(
-          weights.begin() + 1,
-          weights.end(),
-          static_cast<float>(1.0 / (omega + valency)));
+        throw std::invalid_argument("Corrupt stencil section.");
       }
-      else
+
+      return reinterpret_cast<const T*>(data);
+    }
+
+    const std::ptrdiff_t HASH_BLOCK = 1 << 16;
+    const std::size_t CACHE_CAPACITY = 8;
+
+    /** Hashes the triangles a block at a time in parallel and then combines
+     *  the block hashes in order.
+     */
+    std::uint64_t topology_hash(const ConstTriangleBufferRef& triangles)
+    {
+      std::ptrdiff_t num_rows = triangles.rows();
+      std::ptrdiff_t num_blocks = (num_rows + HASH_BLOCK - 1) / HASH_BLOCK;
+      std::vector<std::uint64_t> hashes(num_blocks);
+      parallel_for(
+        0,
+        num_blocks,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+          for (auto block = begin; block < end; ++block)
+          {
+            std::uint64_t result = 0x9E3779B97F4A7C15ull;
+            auto last = std::min(num_rows, (block + 1) * HASH_BLOCK);
+            for (auto row = block * HASH_BLOCK; row < last; ++row)
+            {
+              for (int col = 0; col < 3; ++col)
+              {
+                result = (result ^ triangles(row, col)) * 0xFF51AFD7ED558CCDull;
+                result ^= result >> 32;
+              }
+            }
+
+            hashes[block] = result;
+          }
+        },
+        1);
+
+      std::uint64_t result = static_cast<std::uint64_t>(num_rows);
+      for (auto hash : hashes)
       {
-        auto alpha = this->alphas[valency];
-        weights[0] = static_cast<float>(1 - alpha);
-        std::fill(
-          weights.begin() + 1,
-          weights.end(),
-          static_cast<float>(alpha / valency));
+        result = (result ^ hash) * 0xC4CEB9FE1A85EC53ull;
+        result ^= result >> 29;
       }
 
-      VertexList idxs = {i_vertex};
-      idxs.insert(idxs.end(), ns.begin(), ns.end());
-      this->v_idx[i_vertex] = this->add_new_vertex(idxs, weights);
+      return result;
     }
 
-    void
-    add_triangle(Triangle::Scalar a, Triangle::Scalar b, Triangle::Scalar c)
+    struct CacheEntry
     {
-      this->triangles.emplace_back(
-        this->v_idx[a], this->v_idx[b], this->v_idx[c]);
-    }
+      std::uint64_t hash;
+      int steps;
+      bool project_to_limit;
+      TriangleBuffer triangles;
+      std::shared_ptr<LoopSubdivisionStencil> stencil;
+    };
 
-    void add_triangles(
-      const VertexListMap& v_neighbors,
-      Triangle::Scalar a,
-      Triangle::Scalar b,
-      Triangle::Scalar c)
+    /** The most recently used stencils, most recent first. */
+    std::list<CacheEntry> stencil_cache;
+    std::mutex stencil_cache_mutex;
+
+    /** One stable pass of a radix sort, using a bucket per key value. Each
+     *  chunk of the items counts its keys, and then scatters its items into
+     *  its own slice of every bucket.
+     *
+     *  \param items the items to sort
+     *  \param num_buckets the number of distinct keys
+     *  \param key function returning the key of an item
+     *  \param offsets if provided, receives the start of each bucket
+     *  \return the sorted items
+     */
+    template<typename Key>
+    std::vector<Index> counting_sort(
+      const std::vector<Index>& items,
+      std::size_t num_buckets,
+      Key key,
+      std::vector<Index>* offsets = nullptr)
     {
-      Edge ab = std::make_pair(a, b);
-      Edge bc = std::make_pair(b, c);
-      Edge ca = std::make_pair(c, a);
-      if (v_neighbors.count(a))
-      {
-        this->triangles.emplace_back(
-          this->v_idx[a], this->ev_idx[ab], this->ev_idx[ca]);
-      }
+      auto count = static_cast<std::ptrdiff_t>(items.size());
+      std::ptrdiff_t num_chunks =
+        std::max<std::ptrdiff_t>(1, parallel_chunk_count(count, MIN_CHUNK));
+      std::vector<std::vector<Index>> histograms(
+        num_chunks, std::vector<Index>(num_buckets, 0));
+      parallel_for(
+        0,
+        count,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+          std::vector<Index>& histogram = histograms[chunk];
+          for (auto i = begin; i < end; ++i)
+          {
+            histogram[key(items[i])] += 1;
+          }
+        },
+        MIN_CHUNK);
 
-      if (this->has_vertex(ab) && this->has_vertex(bc) && this->has_vertex(ca))
+      if (offsets != nullptr)
       {
-        this->triangles.emplace_back(
-          this->ev_idx[ab], this->ev_idx[bc], this->ev_idx[ca]);
+        offsets->resize(num_buckets + 1);
       }
 
-      if (v_neighbors.count(c))
+      Index total = 0;
+      for (std::size_t bucket = 0; bucket < num_buckets; ++bucket)
       {
-        this->triangles.emplace_back(
-          this->ev_idx[ca], this->ev_idx[bc], this->v_idx[c]);
+        if (offsets != nullptr)
+        {
+          (*offsets)[bucket] = total;
+        }
+
+        for (auto& histogram : histograms)
+        {
+          Index bucket_count = histogram[bucket];
+          histogram[bucket] = total;
+          total += bucket_count;
+        }
       }
 
-      if (v_neighbors.count(b))
+      if (offsets != nullptr)
       {
-        this->triangles.emplace_back(
-          this->ev_idx[ab], this->v_idx[b], this->ev_idx[bc]);
+        (*offsets)[num_buckets] = total;
       }
+
+      std::vector<Index> sorted(items.size());
+      parallel_for(
+        0,
+        count,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+          std::vector<Index>& histogram = histograms[chunk];
+          for (auto i = begin; i < end; ++i)
+          {
+            sorted[histogram[key(items[i])]++] = items[i];
+          }
+        },
+        MIN_CHUNK);
+
+      return sorted;
     }
 
-    void
-    generate_edge_vertex(const Edge& edge, const VertexMapList& v_1ringlinks)
+    /** Calls func(i, buffer) for each i in [0, count), where func may use
+     *  up to max_size values of the buffer and returns how many of them are
+     *  its output. The outputs are concatenated in order of i. Each chunk
+     *  collects its outputs locally, so func is only called once per item.
+     *
+     *  \param count the number of items
+     *  \param max_size the maximum number of values for an item
+     *  \param func the function which produces the values
+     *  \param offsets if provided, receives the start of the values of each
+     *                 item
+     *  \return the concatenated values
+     */
+    template<typename T, typename Func>
+    std::vector<T> parallel_concat(
+      std::size_t count,
+      std::size_t max_size,
+      Func func,
+      std::vector<Index>* offsets = nullptr)
     {
-      auto n1 = v_1ringlinks[edge.first].at(edge.second);
-      auto n2 = v_1ringlinks[edge.second].at(edge.first);
-      VertexList idxs = {edge.first, edge.second, n1, n2};
-      std::vector<float> weights = {0.375f, 0.375f, 0.125f, 0.125f};
-      this->ev_idx[edge] = this->add_new_vertex(idxs, weights);
-      this->ev_idx[reverse(edge)] = this->ev_idx[edge];
+      auto num_items = static_cast<std::ptrdiff_t>(count);
+      std::ptrdiff_t num_chunks =
+        std::max<std::ptrdiff_t>(1, parallel_chunk_count(num_items, MIN_CHUNK));
+      std::vector<std::vector<T>> chunk_values(num_chunks);
+      std::vector<Index> sizes(count + 1, 0);
+      parallel_for(
+        0,
+        num_items,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+          std::vector<T>& values = chunk_values[chunk];
+          values.reserve((end - begin) * max_size / 2 + max_size);
+          for (auto i = begin; i < end; ++i)
+          {
+            sizes[i] = static_cast<Index>(values.size());
+            values.resize(values.size() + max_size);
+            std::size_t size = func(i, values.data() + sizes[i]);
+            values.resize(sizes[i] + size);
+          }
+        },
+        MIN_CHUNK);
+
+      std::vector<Index> chunk_offsets(num_chunks + 1, 0);
+      for (std::ptrdiff_t chunk = 0; chunk < num_chunks; ++chunk)
+      {
+        chunk_offsets[chunk + 1] =
+          chunk_offsets[chunk] +
+          static_cast<Index>(chunk_values[chunk].size());
+      }
+
+      std::vector<T> values(chunk_offsets.back());
+      sizes[count] = chunk_offsets.back();
+      parallel_for(
+        0,
+        num_items,
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+          for (auto i = begin; i < end; ++i)
+          {
+            sizes[i] += chunk_offsets[chunk];
+          }
+
+          std::copy(
+            chunk_values[chunk].begin(),
+            chunk_values[chunk].end(),
+            values.begin() + chunk_offsets[chunk]);
+          std::vector<T>().swap(chunk_values[chunk]);
+        },
+        MIN_CHUNK);
+
+      if (offsets != nullptr)
+      {
+        offsets->swap(sizes);
+      }
+
+      return values;
     }
 
-    bool has_vertex(Triangle::Scalar i)
+    /** A column and weight in a row of the stencil. */
+    struct StencilEntry
     {
-      return this->v_idx.count(i);
-    }
+      Index col;
+      float weight;
+    };
 
-    bool has_vertex(const Edge& edge)
+    /** The weights of the center and ring of a vertex-vertex. */
+    struct VertexWeights
     {
-      return this->ev_idx.count(edge);
-    }
+      float center;
+      float ring;
+    };
 
-    LoopSubdivisionStencil build(std::size_t vertex_count)
+    /** Builds a single step of subdivision from a half-edge representation
+     *  of the triangles. Half-edge h runs from corner h % 3 of triangle h / 3
+     *  to the next corner of the triangle. The half-edges leaving each vertex
+     *  are stored contiguously (in CSR form), sorted by the vertex they point
+     *  to and then by index, which groups the half-edges of each directed
+     *  edge in the order they appear in the triangles.
+     *
+     *  The new vertices are numbered in the order the triangles first use
+     *  them, with each triangle adding the vertex-vertices of its corners and
+     *  then the edge-vertices of its edges. Every vertex and edge records the
+     *  slot in which it first appears, which lets all of the work run in
+     *  parallel while producing the same numbering as a sequential pass.
+     */
+    class StencilBuilder
     {
-      TriangleBuffer triangles(this->triangles.size(), 3);
-      for (auto row = 0; row < triangles.rows(); ++row)
+    public:
+      StencilBuilder(const ConstTriangleBufferRef& triangles, bool limit)
+      : m_limit(limit),
+        m_num_triangles(static_cast<Index>(triangles.rows())),
+        m_num_vertices(
+          triangles.rows() > 0 ? triangles.maxCoeff() + 1 : Index(0)),
+        m_corners(3 * triangles.rows())
       {
-        triangles.row(row) = this->triangles[row];
+        parallel_for(
+          0,
+          m_num_triangles,
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+            for (auto row = begin; row < end; ++row)
+            {
+              for (int col = 0; col < 3; ++col)
+              {
+                m_corners[3 * row + col] = triangles(row, col);
+              }
+            }
+          },
+          MIN_CHUNK);
+
+        // two radix passes: by end vertex, and then by start vertex
+        std::vector<Index> half_edges(m_corners.size());
+        for (std::size_t h = 0; h < half_edges.size(); ++h)
+        {
+          half_edges[h] = static_cast<Index>(h);
+        }
+
+        half_edges = counting_sort(
+          half_edges, m_num_vertices, [&](Index h) { return to(h); });
+        m_half_edges = counting_sort(
+          half_edges,
+          m_num_vertices,
+          [&](Index h) { return m_corners[h]; },
+          &m_offsets);
       }
 
-      auto rows = this->v_indptr.size();
-      auto cols = vertex_count;
-      typedef Eigen::Triplet<float> T;
-      std::vector<T> triplets;
-      Triangle::Scalar num_nonzero =
-        static_cast<Triangle::Scalar>(this->v_weights.size());
-      triplets.reserve(num_nonzero);
-      this->v_indptr.push_back(num_nonzero);
-      for (auto row = 0; row < rows; ++row)
+      /** Builds the subdivided triangles and the subdivision matrix. */
+      void build(TriangleBuffer& subdiv_triangles, RowMajorMatrix& subdiv)
       {
-        auto start = this->v_indptr[row];
-        auto end = this->v_indptr[row + 1];
-        for (auto j = start; j < end; ++j)
+        find_rings();
+        assign_slots();
+        if (m_non_manifold)
+        {
+          throw std::invalid_argument(
+            "Unable to subdivide a non-manifold edge.");
+        }
+
+        // new vertices are numbered in slot order
+        m_slot_rows = parallel_concat<Index>(
+          m_slots.size(), 1, [&](std::size_t slot, Index* output) {
+            output[0] = static_cast<Index>(slot);
+            return m_slots[slot] != NO_INDEX;
+          });
+
+        m_vertex_index.assign(m_num_vertices, NO_INDEX);
+        m_edge_index.assign(m_corners.size(), NO_INDEX);
+        parallel_for(
+          0,
+          m_slot_rows.size(),
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+            for (auto row = begin; row < end; ++row)
+            {
+              index_row(static_cast<Index>(row));
+            }
+          },
+          MIN_CHUNK);
+
+        std::size_t max_valency = 0;
+        if (m_num_vertices > 0)
         {
-          auto col = this->v_generating_idxs[j];
-          triplets.emplace_back(row, col, this->v_weights[j]);
+          max_valency = *std::max_element(m_valency.begin(), m_valency.end());
         }
+
+        m_vertex_weights.resize(max_valency + 1);
+        for (std::size_t valency = 1; valency <= max_valency; ++valency)
+        {
+          m_vertex_weights[valency] = vertex_weights(valency);
+        }
+
+        std::vector<Index> outer;
+        std::vector<StencilEntry> entries = parallel_concat<StencilEntry>(
+          m_slot_rows.size(),
+          std::max<std::size_t>(4, max_valency + 1),
+          [&](std::size_t row, StencilEntry* output) {
+            return row_entries(static_cast<Index>(row), output);
+          },
+          &outer);
+
+        subdiv.resize(
+          static_cast<Eigen::Index>(m_slot_rows.size()),
+          static_cast<Eigen::Index>(m_num_vertices));
+        subdiv.resizeNonZeros(static_cast<Eigen::Index>(entries.size()));
+        std::copy(outer.begin(), outer.end(), subdiv.outerIndexPtr());
+        auto* columns = subdiv.innerIndexPtr();
+        auto* weights = subdiv.valuePtr();
+        parallel_for(
+          0,
+          entries.size(),
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+            for (auto i = begin; i < end; ++i)
+            {
+              columns[i] = static_cast<int>(entries[i].col);
+              weights[i] = entries[i].weight;
+            }
+          },
+          MIN_CHUNK);
+
+        std::vector<Index> triangles = parallel_concat<Index>(
+          m_num_triangles, 12, [&](std::size_t row, Index* output) {
+            return subdivide_triangle(static_cast<Index>(row), output);
+          });
+        subdiv_triangles =
+          Eigen::Map<TriangleBuffer>(triangles.data(), triangles.size() / 3, 3);
       }
-      SparseMatrix subdiv(rows, cols);
-      subdiv.setFromTriplets(triplets.begin(), triplets.end());
-      return LoopSubdivisionStencil(triangles, subdiv);
-    }
 
-    std::vector<double> alphas;
-    std::vector<double> omegas;
-    VertexMap v_idx;
-    EdgeVertexMap ev_idx;
-    std::vector<Triangle> triangles;
-    std::vector<float> v_weights;
-    VertexList v_generating_idxs;
-    VertexList v_indptr;
-  };
-
-  EdgeList edges(Triangle::Scalar a, Triangle::Scalar b, Triangle::Scalar c)
-  {
-    return {std::make_pair(a, b), std::make_pair(b, c), std::make_pair(c, a)};
-  }
+    private:
+      Index to(Index h) const
+      {
+        return m_corners[h - h % 3 + (h % 3 + 1) % 3];
+      }
+
+      Index opposite(Index h) const
+      {
+        return m_corners[h - h % 3 + (h % 3 + 2) % 3];
+      }
+
+      /** The position of the first half-edge from v to n, or NO_INDEX. */
+      Index find(Index v, Index n) const
+      {
+        auto begin = m_half_edges.begin() + m_offsets[v];
+        auto end = m_half_edges.begin() + m_offsets[v + 1];
+        auto it = std::lower_bound(
+          begin, end, n, [&](Index h, Index value) { return to(h) < value; });
+        if (it == end || to(*it) != n)
+        {
+          return NO_INDEX;
+        }
+
+        return static_cast<Index>(it - m_half_edges.begin());
+      }
+
+      /** The end of the group of half-edges starting at a position. */
+      Index group_end(Index position) const
+      {
+        Index v = m_corners[m_half_edges[position]];
+        Index n = to(m_half_edges[position]);
+        Index end = position + 1;
+        while (end < m_offsets[v + 1] && to(m_half_edges[end]) == n)
+        {
+          ++end;
+        }
+
+        return end;
+      }
+
+      /** The vertex opposite the edge from v to n, taken from the last
+       *  triangle which contains it.
+       */
+      Index link(Index position) const
+      {
+        return opposite(m_half_edges[group_end(position) - 1]);
+      }
+
+      /** Finds the ordered one-ring of each internal vertex by walking its
+       *  links, starting from its lowest numbered neighbour. Vertices whose
+       *  ring does not close are on the boundary and have a valency of 0.
+       */
+      void find_rings()
+      {
+        m_rings.resize(m_half_edges.size());
+        m_valency.assign(m_num_vertices, 0);
+        m_first_use.assign(m_num_vertices, NO_INDEX);
+        parallel_for(
+          0,
+          m_num_vertices,
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+            for (auto v = begin; v < end; ++v)
+            {
+              Index start = m_offsets[v];
+              Index stop = m_offsets[v + 1];
+              if (start == stop)
+              {
+                continue;
+              }
+
+              m_first_use[v] = *std::min_element(
+                m_half_edges.begin() + start, m_half_edges.begin() + stop);
+
+              Index* ring = m_rings.data() + start;
+              Index size = 1;
+              ring[0] = to(m_half_edges[start]);
+              while (true)
+              {
+                Index next = link(find(v, ring[size - 1]));
+                if (next == ring[0])
+                {
+                  m_valency[v] = size;
+                  break;
+                }
+
+                if (find(v, next) == NO_INDEX || size == stop - start)
+                {
+                  break;
+                }
+
+                ring[size++] = next;
+              }
+            }
+          },
+          MIN_CHUNK);
+      }
+
+      /** Records each new vertex in the slot where it is first used. Each
+       *  edge is owned by the group of half-edges with the lower start
+       *  vertex (or the only group, for edges used in one direction).
+       */
+      void assign_slots()
+      {
+        std::atomic<bool> non_manifold(false);
+        m_slots.assign(6 * m_num_triangles, NO_INDEX);
+        m_twins.assign(m_half_edges.size(), NO_INDEX);
+        parallel_for(
+          0,
+          m_num_vertices,
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+            for (auto v = begin; v < end; ++v)
+            {
+              if (m_valency[v] > 0)
+              {
+                Index h = m_first_use[v];
+                m_slots[h / 3 * 6 + h % 3] = static_cast<Index>(v);
+              }
+
+              if (m_limit)
+              {
+                continue;
+              }
+
+              for (Index position = m_offsets[v]; position < m_offsets[v + 1];
+                   position = group_end(position))
+              {
+                Index h = m_half_edges[position];
+                Index n = to(h);
+                Index twin = find(n, static_cast<Index>(v));
+                if (v > n && twin != NO_INDEX)
+                {
+                  continue;
+                }
+
+                if (m_valency[v] == 0 && m_valency[n] == 0)
+                {
+                  continue;
+                }
+
+                if (twin == NO_INDEX)
+                {
+                  non_manifold = true;
+                  continue;
+                }
+
+                h = std::min(h, m_half_edges[twin]);
+                m_slots[h / 3 * 6 + 3 + h % 3] = position;
+                m_twins[position] = twin;
+              }
+            }
+          },
+          MIN_CHUNK);
+
+        m_non_manifold = non_manifold;
+      }
+
+      /** Computes the weights of a vertex-vertex with the given valency. */
+      VertexWeights vertex_weights(std::size_t valency) const
+      {
+        double alpha = 0;
+        double omega = 0;
+        if (valency >= MIN_VALENCY)
+        {
+          double val = 3.0 + 2.0 * std::cos(2.0 * M_PI / valency);
+          double val2 = val * val;
+          alpha = 5.0 / 8.0 - val2 / 64.0;
+          omega = 24.0 * valency / (40.0 - val2);
+        }
+
+        if (m_limit)
+        {
+          return {
+            static_cast<float>(omega / (omega + valency)),
+            static_cast<float>(1.0 / (omega + valency))};
+        }
+
+        return {
+          static_cast<float>(1 - alpha), static_cast<float>(alpha / valency)};
+      }
+
+      /** Gives the vertex or edge of a row its new index. */
+      void index_row(Index row)
+      {
+        Index slot = m_slot_rows[row];
+        if (slot % 6 < 3)
+        {
+          m_vertex_index[m_slots[slot]] = row;
+          return;
+        }
+
+        Index position = m_slots[slot];
+        Index twin = m_twins[position];
+        for (Index group : {position, twin})
+        {
+          for (Index i = group; i < group_end(group); ++i)
+          {
+            m_edge_index[m_half_edges[i]] = row;
+          }
+        }
+      }
+
+      /** Writes the merged columns and weights of a row of the stencil. */
+      std::size_t row_entries(Index row, StencilEntry* output) const
+      {
+        Index slot = m_slot_rows[row];
+        std::size_t size = 0;
+        if (slot % 6 < 3)
+        {
+          Index v = m_slots[slot];
+          Index valency = m_valency[v];
+          const VertexWeights& weights = m_vertex_weights[valency];
+          output[size++] = {v, weights.center};
+          const Index* ring = m_rings.data() + m_offsets[v];
+          for (Index i = 0; i < valency; ++i)
+          {
+            output[size++] = {ring[i], weights.ring};
+          }
+        }
+        else
+        {
+          // the edge runs in the direction of its first use
+          Index position = m_slots[slot];
+          Index twin = m_twins[position];
+          if (m_half_edges[twin] < m_half_edges[position])
+          {
+            std::swap(position, twin);
+          }
+
+          Index first = m_corners[m_half_edges[position]];
+          Index second = m_corners[m_half_edges[twin]];
+          output[size++] = {first, 0.375f};
+          output[size++] = {second, 0.375f};
+          output[size++] = {link(position), 0.125f};
+          output[size++] = {link(twin), 0.125f};
+        }
+
+        // sort the columns, summing any duplicates in order
+        for (std::size_t i = 1; i < size; ++i)
+        {
+          StencilEntry entry = output[i];
+          std::size_t j = i;
+          while (j > 0 && output[j - 1].col > entry.col)
+          {
+            output[j] = output[j - 1];
+            --j;
+          }
+
+          output[j] = entry;
+        }
+
+        std::size_t merged = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          if (merged > 0 && output[merged - 1].col == output[i].col)
+          {
+            output[merged - 1].weight += output[i].weight;
+          }
+          else
+          {
+            output[merged++] = output[i];
+          }
+        }
+
+        return merged;
+      }
+
+      /** Writes the new triangles which replace a triangle. */
+      std::size_t subdivide_triangle(Index row, Index* output) const
+      {
+        const Index* tri = m_corners.data() + 3 * row;
+        Index a = tri[0];
+        Index b = tri[1];
+        Index c = tri[2];
+        bool inner_a = m_valency[a] > 0;
+        bool inner_b = m_valency[b] > 0;
+        bool inner_c = m_valency[c] > 0;
+        std::size_t size = 0;
+        auto add = [&](Index i0, Index i1, Index i2) {
+          output[size++] = i0;
+          output[size++] = i1;
+          output[size++] = i2;
+        };
+
+        if (m_limit)
+        {
+          if (inner_a && inner_b && inner_c)
+          {
+            add(m_vertex_index[a], m_vertex_index[b], m_vertex_index[c]);
+          }
+
+          return size;
+        }
+
+        Index ab = m_edge_index[3 * row];
+        Index bc = m_edge_index[3 * row + 1];
+        Index ca = m_edge_index[3 * row + 2];
+        if (inner_a)
+        {
+          add(m_vertex_index[a], ab, ca);
+        }
+
+        if (ab != NO_INDEX && bc != NO_INDEX && ca != NO_INDEX)
+        {
+          add(ab, bc, ca);
+        }
+
+        if (inner_c)
+        {
+          add(ca, bc, m_vertex_index[c]);
+        }
+
+        if (inner_b)
+        {
+          add(ab, m_vertex_index[b], bc);
+        }
+
+        return size;
+      }
+
+      bool m_limit;
+      bool m_non_manifold;
+      Index m_num_triangles;
+      Index m_num_vertices;
+      std::vector<Index> m_corners;
+      std::vector<Index> m_offsets;
+      std::vector<Index> m_half_edges;
+      std::vector<Index> m_rings;
+      std::vector<Index> m_valency;
+      std::vector<Index> m_first_use;
+      std::vector<Index> m_slots;
+      std::vector<Index> m_twins;
+      std::vector<Index> m_slot_rows;
+      std::vector<Index> m_vertex_index;
+      std::vector<Index> m_edge_index;
+      std::vector<VertexWeights> m_vertex_weights;
+    };
+  } // namespace
 
   const ConstTriangleBufferRef LoopSubdivisionStencil::triangles() const
   {
@@ -230,123 +859,259 @@ namespace scenepic
     return m_subdiv * vertices;
   }
 
-  LoopSubdivisionStencil::LoopSubdivisionStencil(
-    TriangleBuffer triangles, SparseMatrix subdiv)
-  : m_triangles(triangles), m_subdiv(subdiv)
-  {}
-
-  LoopSubdivisionStencil LoopSubdivisionStencil::create(
-    const ConstTriangleBufferRef triangles, int steps, bool project_to_limit)
+  VertexBuffer
+  LoopSubdivisionStencil::apply_batch(const ConstVertexBufferRef frames) const
   {
-    assert(steps > 0 || (steps == 0 && project_to_limit));
+    check_frames(m_subdiv, frames);
+    VertexBuffer result(m_subdiv.rows(), frames.cols());
+    multiply(m_subdiv, frames, 0, result);
+    return result;
+  }
 
-    // Build an index that gives the opposite vertex in a triangle, given a
-    // vertex and an outward pointing half-edge (encoded here using the index of
-    // the vertex at the end of the edge)
-    auto vertex_count = triangles.maxCoeff() + 1;
-    VertexMapList v_1ringlinks(vertex_count);
-    for (auto row = 0; row < triangles.rows(); ++row)
+  std::vector<std::shared_ptr<MeshUpdate>> LoopSubdivisionStencil::apply_batch(
+    const ConstVertexBufferRef frames,
+    Scene& scene,
+    const std::string& base_mesh_id) const
+  {
+    check_frames(m_subdiv, frames);
+    Eigen::Index num_frames = frames.cols() / 3;
+    std::vector<std::shared_ptr<MeshUpdate>> updates;
+    updates.reserve(num_frames);
+    VertexBuffer positions;
+    for (Eigen::Index start = 0; start < num_frames; start += FRAMES_PER_PASS)
     {
-      auto tri_verts = triangles.row(row);
-      for (auto i = 0; i < 3; ++i)
+      Eigen::Index count = std::min(FRAMES_PER_PASS, num_frames - start);
+      positions.resize(m_subdiv.rows(), 3 * count);
+      multiply(m_subdiv, frames, 3 * start, positions);
+      for (Eigen::Index frame = 0; frame < count; ++frame)
       {
-        v_1ringlinks[tri_verts[i]][tri_verts[(i + 1) % 3]] =
-          tri_verts[(i + 2) % 3];
+        updates.push_back(scene.update_mesh_positions(
+          base_mesh_id, positions.middleCols(3 * frame, 3)));
       }
     }
 
-    // Now get vertex neighbours ordered by connectivity around each vertex
-    // The resulting dict contains only internal (non-boundary) vertices.
-    // Each entry in the returned dictionary maps from the index of the
-    // internal vertex to a list of neighbouring vertex indices
-    VertexListMap v_neighbors;
-    for (auto it = v_1ringlinks.begin(); it < v_1ringlinks.end(); ++it)
+    return updates;
+  }
+
+  std::shared_ptr<LoopSubdivisionStencil> LoopSubdivisionStencil::create_cached(
+    const ConstTriangleBufferRef triangles, int steps, bool project_to_limit)
+  {
+    std::uint64_t hash = topology_hash(triangles);
+    auto matches = [&](const CacheEntry& entry) {
+      return entry.hash == hash && entry.steps == steps &&
+        entry.project_to_limit == project_to_limit &&
+        entry.triangles.rows() == triangles.rows() &&
+        entry.triangles == triangles;
+    };
+
     {
-      auto i_vert = static_cast<VertexMap::key_type>(it - v_1ringlinks.begin());
-      auto ringlinks = *it;
-      // Pick the first neighbour arbitrarily
-      VertexList onering = {keys(ringlinks)[0]};
-      // Keep appending neighbors until we complete the 1-ring
-      while (ringlinks[onering.back()] != onering.front())
+      std::lock_guard<std::mutex> lock(stencil_cache_mutex);
+      auto it =
+        std::find_if(stencil_cache.begin(), stencil_cache.end(), matches);
+      if (it != stencil_cache.end())
       {
-        onering.push_back(ringlinks[onering.back()]);
-        if (!ringlinks.count(onering.back()))
-        {
-          // Boundary vertex: incomplete 1-ring
-          onering.clear();
-          break;
-        }
+        stencil_cache.splice(stencil_cache.begin(), stencil_cache, it);
+        return it->stencil;
       }
+    }
 
-      if (onering.size())
-      {
-        v_neighbors[i_vert] = onering;
-      }
+    // the stencil is built without holding the lock, so that other meshes
+    // can be subdivided at the same time
+    auto stencil = std::make_shared<LoopSubdivisionStencil>(
+      LoopSubdivisionStencil::create(triangles, steps, project_to_limit));
+
+    std::lock_guard<std::mutex> lock(stencil_cache_mutex);
+    auto it = std::find_if(stencil_cache.begin(), stencil_cache.end(), matches);
+    if (it != stencil_cache.end())
+    {
+      stencil_cache.splice(stencil_cache.begin(), stencil_cache, it);
+      return it->stencil;
     }
 
-    SubdivisionBuilder builder;
-    // For each triangle we will make up to 3 new v-verts and 3 new e-verts
-    for (auto row = 0; row < triangles.rows(); ++row)
+    stencil_cache.push_front(
+      {hash, steps, project_to_limit, triangles, stencil});
+    if (stencil_cache.size() > CACHE_CAPACITY)
     {
-      auto tri = triangles.row(row);
-      // Loop over each vertex in the triangle to make vertex-vertices
-      for (auto col = 0; col < 3; ++col)
-      {
-        auto i = tri(col);
-        // Check if this vertex already has a new vertex or is on the boundary
-        if (builder.has_vertex(i) || v_neighbors.count(i) == 0)
-        {
-          continue;
-        }
+      stencil_cache.pop_back();
+    }
 
-        builder.generate_vertex_vertex(i, v_neighbors, steps);
-      }
+    return stencil;
+  }
 
-      auto a = tri(0);
-      auto b = tri(1);
-      auto c = tri(2);
-      if (steps == 0)
+  void LoopSubdivisionStencil::clear_cache()
+  {
+    std::lock_guard<std::mutex> lock(stencil_cache_mutex);
+    stencil_cache.clear();
+  }
+
+  void LoopSubdivisionStencil::save(const std::string& path) const
+  {
+    const RowMajorMatrix& rows = m_subdiv;
+    std::array<const char*, NumSections> data = {
+      reinterpret_cast<const char*>(m_triangles.data()),
+      reinterpret_cast<const char*>(rows.outerIndexPtr()),
+      reinterpret_cast<const char*>(rows.innerIndexPtr()),
+      reinterpret_cast<const char*>(rows.valuePtr())};
+    std::array<std::size_t, NumSections> lengths = {
+      m_triangles.size() * sizeof(Index),
+      (rows.rows() + 1) * sizeof(RowMajorMatrix::StorageIndex),
+      rows.nonZeros() * sizeof(RowMajorMatrix::StorageIndex),
+      rows.nonZeros() * sizeof(float)};
+
+    BinaryHeader header = {};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.rows = rows.rows();
+    header.cols = rows.cols();
+    header.num_nonzero = rows.nonZeros();
+    header.num_triangles = m_triangles.rows();
+    std::uint64_t offset = align_offset(sizeof(BinaryHeader));
+    for (int i = 0; i < NumSections; ++i)
+    {
+      header.offsets[i] = offset;
+      header.sizes[i] = lengths[i];
+      offset = align_offset(offset + lengths[i]);
+    }
+
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+    {
+      throw std::invalid_argument("Unable to open file.");
+    }
+
+    const char padding[BINARY_ALIGNMENT] = {};
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t position = sizeof(header);
+    for (int i = 0; i < NumSections; ++i)
+    {
+      stream.write(padding, header.offsets[i] - position);
+      stream.write(data[i], lengths[i]);
+      position = header.offsets[i] + lengths[i];
+    }
+
+    if (!stream)
+    {
+      throw std::invalid_argument("Unable to write file.");
+    }
+  }
+
+  LoopSubdivisionStencil
+  LoopSubdivisionStencil::load(const std::string& path)
+  {
+    MappedFile file(path, true);
+    BinaryHeader header;
+    if (file.size() < sizeof(header))
+    {
+      throw std::invalid_argument("Not a stencil file.");
+    }
+
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+    {
+      throw std::invalid_argument("Not a stencil file.");
+    }
+
+    if (header.version != BINARY_VERSION)
+    {
+      throw std::invalid_argument(
+        "Unsupported stencil version: " + std::to_string(header.version));
+    }
+
+    for (int i = 0; i < NumSections; ++i)
+    {
+      if (
+        header.offsets[i] > file.size() ||
+        header.sizes[i] > file.size() - header.offsets[i])
       {
-        if (
-          v_neighbors.count(a) && v_neighbors.count(b) && v_neighbors.count(c))
-        {
-          builder.add_triangle(a, b, c);
-        }
-        // No edge vertices for project_to_limit
-        continue;
+        throw std::invalid_argument("Stencil file is truncated.");
       }
+    }
 
-      // Loop over each edge in the triangle to make edge-vertices
-      for (auto& edge : edges(a, b, c))
-      {
-        // Check if this edge already has a new edge-vertex
-        if (builder.has_vertex(edge))
-        {
-          continue;
-        }
-        // Or if it's a boundary edge
-        if (
-          v_neighbors.count(edge.first) == 0 &&
-          v_neighbors.count(edge.second) == 0)
-        {
-          continue;
-        }
+    // the value counts below must not wrap around
+    if (header.rows >= UINT64_MAX || header.num_triangles > UINT64_MAX / 3)
+    {
+      throw std::invalid_argument("Corrupt stencil header.");
+    }
 
-        builder.generate_edge_vertex(edge, v_1ringlinks);
-      }
+    typedef RowMajorMatrix::StorageIndex StorageIndex;
+    const Index* triangles =
+      section<Index>(file, header, Triangles, 3 * header.num_triangles);
+    const StorageIndex* outer =
+      section<StorageIndex>(file, header, RowOffsets, header.rows + 1);
+    const StorageIndex* inner =
+      section<StorageIndex>(file, header, Columns, header.num_nonzero);
+    const float* values =
+      section<float>(file, header, Weights, header.num_nonzero);
+    bool valid = outer[0] == 0 &&
+      static_cast<std::uint64_t>(outer[header.rows]) == header.num_nonzero;
+    for (std::uint64_t row = 0; valid && row < header.rows; ++row)
+    {
+      valid = outer[row] <= outer[row + 1];
+    }
+
+    for (std::uint64_t i = 0; valid && i < header.num_nonzero; ++i)
+    {
+      valid = inner[i] >= 0 &&
+        static_cast<std::uint64_t>(inner[i]) < header.cols;
+    }
+
+    for (std::uint64_t i = 0; valid && i < 3 * header.num_triangles; ++i)
+    {
+      valid = triangles[i] < header.rows;
+    }
 
-      builder.add_triangles(v_neighbors, a, b, c);
+    if (!valid)
+    {
+      throw std::invalid_argument("Corrupt stencil section.");
     }
 
-    auto stencil = builder.build(vertex_count);
+    Eigen::Map<const RowMajorMatrix> rows(
+      static_cast<Eigen::Index>(header.rows),
+      static_cast<Eigen::Index>(header.cols),
+      static_cast<Eigen::Index>(header.num_nonzero),
+      outer,
+      inner,
+      values);
+    RowMajorMatrix subdiv = rows;
+    TriangleBuffer subdiv_triangles = Eigen::Map<const TriangleBuffer>(
+      triangles, static_cast<Eigen::Index>(header.num_triangles), 3);
+    return LoopSubdivisionStencil(
+      std::move(subdiv_triangles), std::move(subdiv));
+  }
+
+  LoopSubdivisionStencil::LoopSubdivisionStencil(
+    TriangleBuffer triangles, SparseMatrix subdiv)
+  : m_triangles(std::move(triangles)), m_subdiv(subdiv)
+  {
+    m_subdiv.makeCompressed();
+  }
+
+  LoopSubdivisionStencil::LoopSubdivisionStencil(
+    TriangleBuffer triangles,
+    Eigen::SparseMatrix<float, Eigen::RowMajor> subdiv)
+  : m_triangles(std::move(triangles)), m_subdiv(std::move(subdiv))
+  {
+    m_subdiv.makeCompressed();
+  }
+
+  LoopSubdivisionStencil LoopSubdivisionStencil::create(
+    const ConstTriangleBufferRef triangles, int steps, bool project_to_limit)
+  {
+    assert(steps > 0 || (steps == 0 && project_to_limit));
+
+    TriangleBuffer subdiv_triangles;
+    RowMajorMatrix subdiv;
+    StencilBuilder(triangles, steps == 0).build(subdiv_triangles, subdiv);
     if (steps > 1 || (steps == 1 && project_to_limit))
     {
       auto next_stencil = LoopSubdivisionStencil::create(
-        stencil.m_triangles, steps - 1, project_to_limit);
+        subdiv_triangles, steps - 1, project_to_limit);
+      RowMajorMatrix product = next_stencil.m_subdiv * subdiv;
       return LoopSubdivisionStencil(
-        next_stencil.m_triangles, next_stencil.m_subdiv * stencil.m_subdiv);
+        std::move(next_stencil.m_triangles), std::move(product));
     }
 
-    return stencil;
+    return LoopSubdivisionStencil(
+      std::move(subdiv_triangles), std::move(subdiv));
   }
-} // namespace scenepic
\ No newline at end of file
+} // namespace scenepic
@@ -1,5 +1,10 @@
+from typing import List, overload
+
 import numpy as np
 
+from .mesh import MeshUpdate
+from .scene import Scene
+
 
 class LoopSubdivisionStencil:
     """This class enables efficient Loop subdivision of triangle meshes.
@@ -24,6 +29,38 @@ class LoopSubdivisionStencil:
             np.ndarray: a (S, 3) buffer of subdivided vertices
         """
 
+    @overload
+    def apply_batch(self, frames: np.ndarray) -> np.ndarray:
+        """Applies the stencil to several frames of vertices at once.
+
+        Args:
+            frames (np.ndarray): a (N, 3F) buffer holding F frames of vertices side by side,
+                                 such that frame f occupies columns 3f to 3f + 2.
+
+        Returns:
+            np.ndarray: a (S, 3F) buffer of subdivided frames in the same layout
+        """
+
+    @overload
+    def apply_batch(self, frames: np.ndarray, scene: Scene,
+                    base_mesh_id: str) -> List[MeshUpdate]:
+        """Applies the stencil to several frames of vertices and adds each subdivided frame to the
+        scene as an update of a base mesh.
+
+        Description:
+            The frames are subdivided a few at a time, so the full set of subdivided positions is
+            never held in memory.
+
+        Args:
+            frames (np.ndarray): a (N, 3F) buffer holding F frames of vertices side by side,
+                                 such that frame f occupies columns 3f to 3f + 2.
+            scene (Scene): the scene which will hold the mesh updates
+            base_mesh_id (str): the id of the subdivided base mesh
+
+        Returns:
+            List[MeshUpdate]: the mesh updates, one per frame
+        """
+
     @property
     def triangles(self) -> np.ndarray:
         """The triangles of the subdivided mesh"""
@@ -50,3 +87,49 @@ class LoopSubdivisionStencil:
         Return:
             LoopSubdivisionStencil
         """
+
+    @staticmethod
+    def create_cached(triangles: np.ndarray, steps: int,
+                      project_to_limit: bool) -> "LoopSubdivisionStencil":
+        """Returns a stencil for the provided triangles, reusing a previous stencil if one was
+        created in this process for the same triangles and settings.
+
+        Description:
+            Stencils are found by a hash of the triangles, so meshes which share connectivity
+            share a stencil.
+
+        Args:
+            triangles (np.ndarray): the initial triangle indices
+            steps (int): specifies how many steps of subdivision to apply. Defaults to 1.
+            project_to_limit (bool): specifies whether the vertices should be projected onto the
+                                     limit surface in the final step of subdivision. Defaults to false.
+
+        Return:
+            LoopSubdivisionStencil
+        """
+
+    @staticmethod
+    def clear_cache():
+        """Removes all stencils from the cache used by create_cached."""
+
+    def save(self, path: str):
+        """Save the stencil to a binary file.
+
+        Description:
+            The file holds the subdivided triangles and the subdivision matrix as CSR arrays,
+            each aligned so that it can be used in place from a memory mapping.
+
+        Args:
+            path (str): the location of the file on disk
+        """
+
+    @staticmethod
+    def load(path: str) -> "LoopSubdivisionStencil":
+        """Load a stencil from a file written by save.
+
+        Args:
+            path (str): the location of the file on disk
+
+        Returns:
+            LoopSubdivisionStencil: the stencil stored in the file
+        """
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace scenepic
+{
+  MappedFile::MappedFile(const std::string& path, bool sequential)
+  : m_data(nullptr), m_size(0)
+  {
+#ifdef _WIN32
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+    {
+      throw std::invalid_argument("Unable to open file.");
+    }
+
+    m_buffer.assign(
+      std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+      if (fd >= 0)
+      {
+        close(fd);
+      }
+
+      throw std::invalid_argument("Unable to open file.");
+    }
+
+    m_size = static_cast<std::size_t>(info.st_size);
+    if (m_size > 0)
+    {
+      void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED)
+      {
+        close(fd);
+        throw std::invalid_argument("Unable to map file.");
+      }
+
+      if (sequential)
+      {
+        madvise(data, m_size, MADV_SEQUENTIAL);
+      }
+
+      m_data = static_cast<const char*>(data);
+    }
+
+    close(fd);
+#endif
+  }
+
+  MappedFile::~MappedFile()
+  {
+#ifndef _WIN32
+    if (m_data != nullptr)
+    {
+      munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+  }
+
+  const char* MappedFile::data() const
+  {
+    return m_data;
+  }
+
+  std::size_t MappedFile::size() const
+  {
+    return m_size;
+  }
+
+  void MappedFile::release(std::size_t offset, std::size_t length) const
+  {
+#ifndef _WIN32
+    // only whole pages inside the range can be released
+    std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t start = (offset + page - 1) / page * page;
+    std::size_t end = std::min(offset + length, m_size) / page * page;
+    if (m_data != nullptr && start < end)
+    {
+      madvise(const_cast<char*>(m_data) + start, end - start, MADV_DONTNEED);
+    }
+#else
+    (void)offset;
+    (void)length;
+#endif
+  }
+} // namespace scenepic
@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#ifndef _SCENEPIC_MAPPED_FILE_H_
+#define _SCENEPIC_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace scenepic
+{
+  /** Read-only view of a file on disk. The file is memory mapped where the
+   *  platform supports it, and otherwise read into memory.
+   */
+  class MappedFile
+  {
+  public:
+    /** Constructor.
+     *
+     *  \param path the location of the file on disk
+     *  \param sequential whether the file will be read from start to end
+     */
+    explicit MappedFile(const std::string& path, bool sequential = false);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** The contents of the file. */
+    const char* data() const;
+
+    /** The size of the file in bytes. */
+    std::size_t size() const;
+
+    /** Indicates that a range of the file will not be read again, allowing
+     *  its pages to be evicted so that files larger than memory can be
+     *  streamed through.
+     *
+     *  \param offset the start of the range in bytes
+     *  \param length the length of the range in bytes
+     */
+    void release(std::size_t offset, std::size_t length) const;
+
+  private:
+    const char* m_data;
+    std::size_t m_size;
+#ifdef _WIN32
+    std::string m_buffer;
+#endif
+  };
+} // namespace scenepic
+
+#endif
@@ -4,20 +4,50 @@
 /** File containing all non-primitive creation methods for Mesh (see
  * primitives.cpp) */
 
+#define _USE_MATH_DEFINES
 #include "mesh.h"
 
+#include "packing.h"
+#include "parallel.h"
+#include "spatial_sort.h"
 #include "transforms.h"
 #include "util.h"
 
 #include <Eigen/Geometry>
+#include <algorithm>
 #include <array>
 #include <climits>
+#include <cmath>
+#include <cstdint>
 #include <exception>
 #include <map>
 #include <utility>
+#include <vector>
 
 namespace scenepic
 {
+  namespace
+  {
+    /** Gathers the rows of a buffer in the given order. */
+    template<typename Buffer>
+    Buffer
+    permute_rows(const Buffer& buffer, const std::vector<std::uint32_t>& order)
+    {
+      Buffer permuted(buffer.rows(), buffer.cols());
+      parallel_for(
+        0,
+        buffer.rows(),
+        [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+          for (auto i = begin; i < end; ++i)
+          {
+            permuted.row(i) = buffer.row(order[i]);
+          }
+        });
+
+      return permuted;
+    }
+  } // namespace
+
   Vector compute_triangle_normal(
     const Vector& pos0, const Vector& pos1, const Vector& pos2)
   {
@@ -47,7 +77,9 @@ namespace scenepic
     m_use_texture_alpha(false),
     m_vertices(VertexBuffer::Zero(0, 6)),
     m_triangles(TriangleBuffer::Zero(0, 3)),
-    m_lines(LineBuffer::Zero(0, 2))
+    m_lines(LineBuffer::Zero(0, 2)),
+    m_packed_normals(0),
+    m_packed_colors(false)
   {
     bool vertex_colors = m_shared_color.is_none();
     bool vertex_uvs = !m_texture_id.empty();
@@ -82,6 +114,22 @@ namespace scenepic
     m_vertices.block(0, 3, this->count_vertices(), 3) *= -1;
   }
 
+  void Mesh::spatial_sort(const std::string& curve)
+  {
+    std::vector<std::uint32_t> order =
+      spatial_order(this->vertex_positions(), curve);
+    std::vector<std::uint32_t> new_index(order.size());
+    for (std::uint32_t i = 0; i < order.size(); ++i)
+    {
+      new_index[order[i]] = i;
+    }
+
+    auto remap = [&](std::uint32_t index) { return new_index[index]; };
+    m_vertices = permute_rows(m_vertices, order);
+    m_triangles = m_triangles.unaryExpr(remap);
+    m_lines = m_lines.unaryExpr(remap);
+  }
+
   void Mesh::apply_transform(const Transform& transform)
   {
     WorldVectorMatrix positions(this->count_vertices(), 4);
@@ -298,7 +346,8 @@ namespace scenepic
     const Transform& transform,
     bool reverse_triangle_order,
     bool fill_triangles,
-    bool add_wireframe)
+    bool add_wireframe,
+    float wireframe_feature_angle)
   {
     if (mesh_info->has_normals())
     {
@@ -311,7 +360,8 @@ namespace scenepic
         transform,
         reverse_triangle_order,
         fill_triangles,
-        add_wireframe);
+        add_wireframe,
+        wireframe_feature_angle);
     }
     else
     {
@@ -323,7 +373,8 @@ namespace scenepic
         transform,
         reverse_triangle_order,
         fill_triangles,
-        add_wireframe);
+        add_wireframe,
+        wireframe_feature_angle);
     }
   }
 
@@ -367,6 +418,115 @@ namespace scenepic
     return normals;
   }
 
+  namespace
+  {
+    /** Key for an undirected edge, ordered so that it sorts by start vertex.
+     */
+    std::uint64_t edge_key(std::uint32_t v0, std::uint32_t v1)
+    {
+      if (v1 < v0)
+      {
+        std::swap(v0, v1);
+      }
+
+      return (static_cast<std::uint64_t>(v0) << 32) | v1;
+    }
+
+    /** Collects the (key, triangle) pair for every triangle edge, sorted by
+     *  key so that shared edges are adjacent.
+     */
+    std::vector<std::pair<std::uint64_t, std::uint32_t>>
+    sorted_edges(const ConstTriangleBufferRef& triangles)
+    {
+      std::vector<std::pair<std::uint64_t, std::uint32_t>> edges;
+      edges.reserve(triangles.rows() * 3);
+      for (auto index = 0; index < triangles.rows(); ++index)
+      {
+        const Triangle& triangle = triangles.row(index);
+        auto face = static_cast<std::uint32_t>(index);
+        edges.emplace_back(edge_key(triangle(0), triangle(1)), face);
+        edges.emplace_back(edge_key(triangle(1), triangle(2)), face);
+        edges.emplace_back(edge_key(triangle(2), triangle(0)), face);
+      }
+
+      std::sort(edges.begin(), edges.end());
+      return edges;
+    }
+
+    LineBuffer keys_to_lines(const std::vector<std::uint64_t>& keys)
+    {
+      LineBuffer lines(keys.size(), 2);
+      for (std::size_t i = 0; i < keys.size(); ++i)
+      {
+        lines(i, 0) = static_cast<std::uint32_t>(keys[i] >> 32);
+        lines(i, 1) = static_cast<std::uint32_t>(keys[i]);
+      }
+
+      return lines;
+    }
+  } // namespace
+
+  LineBuffer Mesh::compute_edges(const ConstTriangleBufferRef& triangles)
+  {
+    std::vector<std::uint64_t> keys;
+    keys.reserve(triangles.rows() * 3);
+    for (auto index = 0; index < triangles.rows(); ++index)
+    {
+      const Triangle& triangle = triangles.row(index);
+      keys.push_back(edge_key(triangle(0), triangle(1)));
+      keys.push_back(edge_key(triangle(1), triangle(2)));
+      keys.push_back(edge_key(triangle(2), triangle(0)));
+    }
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys_to_lines(keys);
+  }
+
+  LineBuffer Mesh::compute_feature_edges(
+    const ConstVectorBufferRef& vertices,
+    const ConstTriangleBufferRef& triangles,
+    float angle)
+  {
+    VectorBuffer face_normals(triangles.rows(), 3);
+    for (auto index = 0; index < triangles.rows(); ++index)
+    {
+      const Triangle& triangle = triangles.row(index);
+      face_normals.row(index) = compute_triangle_normal(
+        vertices.row(triangle(0)),
+        vertices.row(triangle(1)),
+        vertices.row(triangle(2)));
+    }
+
+    const float min_cos = std::cos(angle * static_cast<float>(M_PI) / 180);
+    auto edges = sorted_edges(triangles);
+    std::vector<std::uint64_t> keys;
+    for (std::size_t start = 0, end = 0; start < edges.size(); start = end)
+    {
+      end = start + 1;
+      while (end < edges.size() && edges[end].first == edges[start].first)
+      {
+        ++end;
+      }
+
+      // boundary and non-manifold edges are always features
+      bool feature = end - start != 2;
+      if (!feature)
+      {
+        const Vector& n0 = face_normals.row(edges[start].second);
+        const Vector& n1 = face_normals.row(edges[start + 1].second);
+        feature = n0.dot(n1) < min_cos;
+      }
+
+      if (feature)
+      {
+        keys.push_back(edges[start].first);
+      }
+    }
+
+    return keys_to_lines(keys);
+  }
+
   void Mesh::add_mesh_without_normals(
     const ConstVectorBufferRef& vertices,
     const ConstTriangleBufferRef& triangles,
@@ -375,7 +535,8 @@ namespace scenepic
     const Transform& transform,
     bool reverse_triangle_order,
     bool fill_triangles,
-    bool add_wireframe)
+    bool add_wireframe,
+    float wireframe_feature_angle)
   {
     this->check_instances();
 
@@ -390,7 +551,8 @@ namespace scenepic
       transform,
       reverse_triangle_order,
       fill_triangles,
-      add_wireframe);
+      add_wireframe,
+      wireframe_feature_angle);
   }
 
   void Mesh::add_mesh_with_normals(
@@ -402,7 +564,8 @@ namespace scenepic
     const Transform& transform,
     bool reverse_triangle_order,
     bool fill_triangles,
-    bool add_wireframe)
+    bool add_wireframe,
+    float wireframe_feature_angle)
   {
     assert(vertices.rows() == normals.rows());
     this->check_instances();
@@ -465,14 +628,15 @@ namespace scenepic
 
     if (add_wireframe)
     {
-      m.m_lines = LineBuffer(triangles.rows() * 3, 2);
-      m.m_lines.topRows(triangles.rows()) = triangles.leftCols(2);
-      m.m_lines.block(triangles.rows(), 0, triangles.rows(), 2) =
-        triangles.block(0, 1, triangles.rows(), 2);
-      m.m_lines.block(2 * triangles.rows(), 0, triangles.rows(), 1) =
-        triangles.col(0);
-      m.m_lines.block(2 * triangles.rows(), 1, triangles.rows(), 1) =
-        triangles.col(2);
+      if (wireframe_feature_angle > 0)
+      {
+        m.m_lines = Mesh::compute_feature_edges(
+          vertices, triangles, wireframe_feature_angle);
+      }
+      else
+      {
+        m.m_lines = Mesh::compute_edges(triangles);
+      }
     }
 
     if (fill_triangles)
@@ -557,8 +721,16 @@ namespace scenepic
   void Mesh::enable_instancing(
     const ConstVectorBufferRef& positions,
     const ConstQuaternionBufferRef& rotations,
-    const ConstColorBufferRef& colors)
+    const ConstColorBufferRef& colors,
+    const std::string& sort_curve)
   {
+    // computed first so that an invalid curve leaves the mesh untouched
+    std::vector<std::uint32_t> order;
+    if (sort_curve != "none")
+    {
+      order = spatial_order(positions, sort_curve);
+    }
+
     if (m_instance_buffer.rows())
     {
       std::cerr << "WARNING: multiple calls to enable_instancing will replace "
@@ -599,6 +771,11 @@ namespace scenepic
     {
       m_instance_buffer = positions;
     }
+
+    if (!order.empty())
+    {
+      m_instance_buffer = permute_rows(m_instance_buffer, order);
+    }
   }
 
   JsonValue Mesh::definition_to_json() const
@@ -606,7 +783,45 @@ namespace scenepic
     std::string data_type;
     JsonValue obj;
 
-    obj["VertexBuffer"] = matrix_to_json(m_vertices);
+    bool has_packed_normals = m_packed_normals > 0;
+    bool has_packed_colors = m_packed_colors && m_shared_color.is_none();
+    if (has_packed_normals || has_packed_colors)
+    {
+      // the remaining float columns keep their relative order
+      Eigen::Index num_extra_cols = m_vertices.cols() - 6;
+      Eigen::Index num_cols = m_vertices.cols();
+      num_cols -= has_packed_normals ? 3 : 0;
+      num_cols -= has_packed_colors ? 3 : 0;
+      VertexBuffer vertices(m_vertices.rows(), num_cols);
+      vertices.leftCols(3) = this->vertex_positions();
+      if (has_packed_normals)
+      {
+        obj["NormalPacking"] = normal_packing_name(m_packed_normals);
+        obj["PackedNormalBuffer"] =
+          packed_normals_to_json(this->vertex_normals(), m_packed_normals);
+      }
+      else
+      {
+        vertices.middleCols(3, 3) = this->vertex_normals();
+      }
+
+      if (has_packed_colors)
+      {
+        obj["PackedColorBuffer"] =
+          matrix_to_json(pack_colors(this->vertex_colors()));
+      }
+      else if (num_extra_cols > 0)
+      {
+        vertices.rightCols(num_extra_cols) =
+          m_vertices.rightCols(num_extra_cols);
+      }
+
+      obj["VertexBuffer"] = matrix_to_json(vertices);
+    }
+    else
+    {
+      obj["VertexBuffer"] = matrix_to_json(m_vertices);
+    }
 
     if (m_vertices.rows() < 0xFFFF)
     {
@@ -894,11 +1109,39 @@ namespace scenepic
     return *this;
   }
 
+  std::uint32_t Mesh::packed_normals() const
+  {
+    return m_packed_normals;
+  }
+
+  Mesh& Mesh::packed_normals(std::uint32_t packed_normals)
+  {
+    check_normal_packing(packed_normals);
+    m_packed_normals = packed_normals;
+    return *this;
+  }
+
+  bool Mesh::packed_colors() const
+  {
+    return m_packed_colors;
+  }
+
+  Mesh& Mesh::packed_colors(bool packed_colors)
+  {
+    m_packed_colors = packed_colors;
+    return *this;
+  }
+
   const ConstTriangleBufferRef Mesh::triangles() const
   {
     return ConstTriangleBufferRef(m_triangles);
   }
 
+  const ConstLineBufferRef Mesh::lines() const
+  {
+    return ConstLineBufferRef(m_lines);
+  }
+
   VertexBlock Mesh::vertex_positions()
   {
     return m_vertices.leftCols(3);
@@ -89,6 +89,15 @@ class Mesh:
         Useful when interoping with existing codebases that use opposite convention.
         """
 
+    def spatial_sort(self, curve: str = "morton") -> None:
+        """Reorders the vertices of the mesh along a space-filling curve and remaps the triangles
+        and lines to match. Nearby vertices end up close together in the vertex buffer, which
+        makes the buffers compress better and gives the client coherent ranges to cull.
+
+        Args:
+            curve (str, optional): the curve to follow, either "morton" or "hilbert". Defaults to "morton".
+        """
+
     def apply_transform(self, transform: np.ndarray) -> None:
         """Apply a 3D homogeneous matrix transform (i.e. 4x4 matrix) to all vertices
             (and appropriately to the normals) in the Mesh.
@@ -209,6 +218,22 @@ class Mesh:
             add_wireframe (bool, optional): whether to add a wireframe outline. Defaults to False.
         """
 
+    def add_cubes(self, positions: np.ndarray, colors: Optional[np.ndarray] = None,
+                  scales: Optional[np.ndarray] = None, rotations: Optional[np.ndarray] = None,
+                  fill_triangles: bool = True, add_wireframe: bool = False) -> None:
+        """Add N unit diameter cubes to this mesh in a single batch.
+        Each cube is scaled, then rotated, then translated to its position.
+
+        Args:
+            positions (np.ndarray): float32 matrix of [N, 3] cube centers
+            colors (np.ndarray, optional): float32 matrix of [N, 3] per-cube colors. Required unless Mesh was
+                                           constructed with shared_color argument. Defaults to None.
+            scales (np.ndarray, optional): float32 matrix of [N, 3] per-cube scale factors. Defaults to None.
+            rotations (np.ndarray, optional): float32 matrix of [N, 4] per-cube quaternion rotations. Defaults to None.
+            fill_triangles (bool, optional): whether to fill the primitives. Defaults to True.
+            add_wireframe (bool, optional): whether to add wireframe outlines. Defaults to False.
+        """
+
     def add_thickline(self, color: Optional[np.ndarray] = None, start_point: np.ndarray = [-0.5, 0, 0],
                       end_point: np.ndarray = [0.5, 0, 0], start_thickness: float = 0.1,
                       end_thickness: float = 0.1, transform: Optional[np.ndarray] = None,
@@ -242,6 +267,26 @@ class Mesh:
             add_wireframe (bool, optional): whether to add a wireframe outline. Defaults to False.
         """
 
+    def add_cones(self, positions: np.ndarray, colors: Optional[np.ndarray] = None,
+                  scales: Optional[np.ndarray] = None, rotations: Optional[np.ndarray] = None,
+                  truncation_height: float = 1.0, lat_count: int = 10, long_count: int = 10,
+                  fill_triangles: bool = True, add_wireframe: bool = False) -> None:
+        """Add N cones to this Mesh in a single batch (see add_cone).
+        Each cone is scaled, then rotated, then translated to its position.
+
+        Args:
+            positions (np.ndarray): float32 matrix of [N, 3] cone centers
+            colors (np.ndarray, optional): float32 matrix of [N, 3] per-cone colors. Required unless Mesh was
+                                           constructed with shared_color argument. Defaults to None.
+            scales (np.ndarray, optional): float32 matrix of [N, 3] per-cone scale factors. Defaults to None.
+            rotations (np.ndarray, optional): float32 matrix of [N, 4] per-cone quaternion rotations. Defaults to None.
+            truncation_height (float, optional): draws truncated cones of this height. Defaults to 1.
+            lat_count (int, optional): number of discrete samples in latitude. Defaults to 10.
+            long_count (int, optional): number of discrete samples in longitude. Defaults to 10.
+            fill_triangles (bool, optional): whether to fill the primitives. Defaults to True.
+            add_wireframe (bool, optional): whether to add wireframe outlines. Defaults to False.
+        """
+
     def add_coordinate_axes(self, length: float, thickness: float, transform: Optional[np.ndarray] = None) -> None:
         """Add a set of coordinate axes to this Mesh.
         xyz axes map to RGB colors.
@@ -313,6 +358,22 @@ class Mesh:
             add_wireframe (bool, optional): whether to add a wireframe outline. Defaults to False.
         """
 
+    def add_spheres(self, positions: np.ndarray, colors: Optional[np.ndarray] = None,
+                    scales: Optional[np.ndarray] = None, rotations: Optional[np.ndarray] = None,
+                    fill_triangles: bool = True, add_wireframe: bool = False) -> None:
+        """Add N default (ico) unit diameter spheres to this Mesh in a single batch.
+        Each sphere is scaled, then rotated, then translated to its position.
+
+        Args:
+            positions (np.ndarray): float32 matrix of [N, 3] sphere centers
+            colors (np.ndarray, optional): float32 matrix of [N, 3] per-sphere colors. Required unless Mesh was
+                                           constructed with shared_color argument. Defaults to None.
+            scales (np.ndarray, optional): float32 matrix of [N, 3] per-sphere scale factors. Defaults to None.
+            rotations (np.ndarray, optional): float32 matrix of [N, 4] per-sphere quaternion rotations. Defaults to None.
+            fill_triangles (bool, optional): whether to fill the primitives. Defaults to True.
+            add_wireframe (bool, optional): whether to add wireframe outlines. Defaults to False.
+        """
+
     def add_icosphere(self, color: Optional[np.ndarray] = None, transform: Optional[np.ndarray] = None, steps: int = 0,
                       fill_triangles: bool = True, add_wireframe: bool= False) -> None:
         """Add a unit diameter ico-sphere to this Mesh.
@@ -344,7 +405,8 @@ class Mesh:
         """
 
     def add_mesh(self, mesh_info: MeshInfo, transform: Optional[np.ndarray] = None, reverse_triangle_order: bool = False,
-                 fill_triangles: bool = True, add_wireframe: bool = False) -> None:
+                 fill_triangles: bool = True, add_wireframe: bool = False,
+                 wireframe_feature_angle: float = 0) -> None:
         """Add a triangle mesh to this ScenePic Mesh, with normals computed automatically.
 
         Args:
@@ -353,12 +415,16 @@ class Mesh:
             reverse_triangle_order (bool, optional): whether to reverse the triangle winding order. Defaults to False.
             fill_triangles (bool, optional): whether to fill the primitive. Defaults to True.
             add_wireframe (bool, optional): whether to add a wireframe outline. Defaults to False.
+            wireframe_feature_angle (float, optional): if greater than zero, the wireframe only includes
+                                                       boundary edges and edges whose dihedral angle (in
+                                                       degrees) exceeds this value. Defaults to 0.
         """
 
     def add_mesh_without_normals(self, vertices: np.ndarray, triangles: np.ndarray,
                                  colors: Optional[np.ndarray] = None, uvs: Optional[np.ndarray] = None,
                                  transform: Optional[np.ndarray] = None, reverse_triangle_order: bool = False,
-                                 fill_triangles: bool = True, add_wireframe: bool = False) -> None:
+                                 fill_triangles: bool = True, add_wireframe: bool = False,
+                                 wireframe_feature_angle: float = 0) -> None:
         """Add a triangle mesh to this ScenePic Mesh, with normals computed automatically.
 
         Args:
@@ -370,12 +436,16 @@ class Mesh:
             reverse_triangle_order (bool, optional): whether to reverse the triangle winding order. Defaults to False.
             fill_triangles (bool, optional): whether to fill the primitive. Defaults to True.
             add_wireframe (bool, optional): whether to add a wireframe outline. Defaults to False.
+            wireframe_feature_angle (float, optional): if greater than zero, the wireframe only includes
+                                                       boundary edges and edges whose dihedral angle (in
+                                                       degrees) exceeds this value. Defaults to 0.
         """
 
     def add_mesh_with_normals(self, vertices: np.ndarray, normals: np.ndarray,
                               triangles: np.ndarray, colors: Optional[np.ndarray] = None, uvs: Optional[np.ndarray] = None,
                               transform: Optional[np.ndarray] = None, reverse_triangle_order: bool = False,
-                              fill_triangles: bool = True, add_wireframe: bool = False) -> None:
+                              fill_triangles: bool = True, add_wireframe: bool = False,
+                              wireframe_feature_angle: float = 0) -> None:
         """Add a triangle mesh to this ScenePic Mesh.
 
         Args:
@@ -388,6 +458,9 @@ class Mesh:
             reverse_triangle_order (bool, optional): whether to reverse the triangle winding order. Defaults to False.
             fill_triangles (bool, optional): whether to fill the primitive. Defaults to True.
             add_wireframe (bool, optional): whether to add a wireframe outline. Defaults to False.
+            wireframe_feature_angle (float, optional): if greater than zero, the wireframe only includes
+                                                       boundary edges and edges whose dihedral angle (in
+                                                       degrees) exceeds this value. Defaults to 0.
         """
 
     def add_lines(self, start_points: np.ndarray, end_points: np.ndarray,
@@ -403,7 +476,7 @@ class Mesh:
         """
 
     def enable_instancing(self, positions: np.ndarray, rotations: Optional[np.ndarray] = None,
-                          colors: Optional[np.ndarray] = None) -> None:
+                          colors: Optional[np.ndarray] = None, sort_curve: str = "none") -> None:
         """Makes ScenePic render this Mesh with multiple instances, e.g. for point-cloud visualizations.
         Can be used to make point clouds, for example.
         The whole contents of the Mesh will be rendered multiple times.
@@ -413,6 +486,8 @@ class Mesh:
             rotations (np.ndarray, optional): float32 matrix of [N, 4] per-point quaternion rotations. Defaults to None.
             colors (np.ndarray, optional): float32 matrix of [N, 3] colors. If provided, overrides a Mesh's shared_color
                                             or per-vertex color. Defaults to None.
+            sort_curve (str, optional): if "morton" or "hilbert", the instances are reordered along that
+                                        space-filling curve (see spatial_sort). Defaults to "none".
         """
 
     @property
@@ -454,6 +529,14 @@ class Mesh:
     def is_billbord(self) -> bool:
         """Draw this Mesh as a billboard (i.e. always facing the user) rather than rotating with the rest of the world."""
 
+    @property
+    def packed_normals(self) -> int:
+        """Number of bits per component (8 or 16) used to send the vertex normals using octahedral encoding, or 0 to send them as float32."""
+
+    @property
+    def packed_colors(self) -> bool:
+        """Whether to send per-vertex colors as 8-bit RGB instead of float32."""
+
     @property
     def vertex_buffer(self) -> VertexBuffer:
         """The raw vertex buffer."""
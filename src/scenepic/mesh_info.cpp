@@ -4,8 +4,103 @@
 #include "mesh_info.h"
 
 #include "loop_subdivision_stencil.h"
+#include "mapped_file.h"
+#include "zip.h"
 
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <exception>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+  const char BINARY_MAGIC[8] = {'S', 'P', 'M', 'E', 'S', 'H', '\0', '\0'};
+  const std::uint32_t BINARY_VERSION = 1;
+  const std::uint32_t BINARY_COMPRESSED = 1;
+
+  /** Sections start on cache line boundaries so that they can be used in
+   *  place from a mapping of the file.
+   */
+  const std::uint64_t BINARY_ALIGNMENT = 64;
+
+  /** Deflate cannot expand data by more than this factor, which bounds the
+   *  buffer sizes a header may claim before they are allocated.
+   */
+  const std::uint64_t MAX_INFLATE_RATIO = 1032;
+
+  enum BinarySection
+  {
+    Positions,
+    Normals,
+    Triangles,
+    UVs,
+    Colors,
+    NumSections
+  };
+
+  struct BinaryHeader
+  {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint64_t num_vertices;
+    std::uint64_t num_triangles;
+    std::uint64_t offsets[NumSections];
+    std::uint64_t sizes[NumSections];
+  };
+
+  std::uint64_t align_offset(std::uint64_t offset)
+  {
+    return (offset + BINARY_ALIGNMENT - 1) / BINARY_ALIGNMENT *
+      BINARY_ALIGNMENT;
+  }
+
+  /** Copies a section of the file into a buffer, inflating it if needed.
+   *  load_binary checks that every section lies within the file first.
+   */
+  template<typename Buffer>
+  void read_section(
+    const scenepic::MappedFile& file,
+    const BinaryHeader& header,
+    BinarySection section,
+    Buffer& buffer)
+  {
+    std::size_t length = buffer.size() * sizeof(typename Buffer::Scalar);
+    const char* data = file.data() + header.offsets[section];
+    std::size_t size = static_cast<std::size_t>(header.sizes[section]);
+    if (header.flags & BINARY_COMPRESSED)
+    {
+      if (length == 0)
+      {
+        return;
+      }
+
+      std::vector<std::uint8_t> bytes;
+      try
+      {
+        bytes = scenepic::inflate(
+          reinterpret_cast<const std::uint8_t*>(data), size, length);
+      }
+      catch (const std::invalid_argument&)
+      {
+        throw std::invalid_argument("Corrupt mesh info section.");
+      }
+
+      std::memcpy(buffer.data(), bytes.data(), length);
+    }
+    else
+    {
+      if (size != length)
+      {
+        throw std::invalid_argument("Corrupt mesh info section.");
+      }
+
+      std::memcpy(buffer.data(), data, length);
+    }
+  }
+} // namespace
 
 namespace scenepic
 {
@@ -111,35 +206,160 @@ namespace scenepic
   std::shared_ptr<MeshInfo>
   MeshInfo::subdivide(int steps, bool project_to_limit)
   {
-    auto stencil = LoopSubdivisionStencil::create(
+    auto stencil = LoopSubdivisionStencil::create_cached(
       m_triangle_buffer, steps, project_to_limit);
     bool has_uvs = m_uv_buffer.size();
     bool has_color = m_color_buffer.size();
     bool has_normals = m_normal_buffer.size();
     auto subdiv_mesh = std::make_shared<MeshInfo>(
-      stencil.vertex_count(),
-      stencil.triangle_count(),
+      stencil->vertex_count(),
+      stencil->triangle_count(),
       has_uvs,
       has_normals,
       has_color);
-    subdiv_mesh->m_position_buffer = stencil.apply(m_position_buffer);
-    subdiv_mesh->m_triangle_buffer = stencil.triangles();
+    subdiv_mesh->m_position_buffer = stencil->apply(m_position_buffer);
+    subdiv_mesh->m_triangle_buffer = stencil->triangles();
     if (has_color)
     {
-      subdiv_mesh->m_color_buffer = stencil.apply(m_color_buffer);
+      subdiv_mesh->m_color_buffer = stencil->apply(m_color_buffer);
     }
 
     if (has_normals)
     {
-      subdiv_mesh->m_normal_buffer = stencil.apply(m_normal_buffer);
+      subdiv_mesh->m_normal_buffer = stencil->apply(m_normal_buffer);
     }
 
     if (has_uvs)
     {
-      subdiv_mesh->m_uv_buffer = stencil.apply(m_uv_buffer);
+      subdiv_mesh->m_uv_buffer = stencil->apply(m_uv_buffer);
     }
 
     return subdiv_mesh;
   }
 
-} // namespace scenepic
\ No newline at end of file
+
+  void MeshInfo::save_binary(const std::string& path, bool compress) const
+  {
+    std::array<std::vector<std::uint8_t>, NumSections> compressed;
+    std::array<const char*, NumSections> data = {
+      reinterpret_cast<const char*>(m_position_buffer.data()),
+      reinterpret_cast<const char*>(m_normal_buffer.data()),
+      reinterpret_cast<const char*>(m_triangle_buffer.data()),
+      reinterpret_cast<const char*>(m_uv_buffer.data()),
+      reinterpret_cast<const char*>(m_color_buffer.data())};
+    std::array<std::size_t, NumSections> lengths = {
+      m_position_buffer.size() * sizeof(float),
+      m_normal_buffer.size() * sizeof(float),
+      m_triangle_buffer.size() * sizeof(std::uint32_t),
+      m_uv_buffer.size() * sizeof(float),
+      m_color_buffer.size() * sizeof(float)};
+
+    BinaryHeader header = {};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.flags = compress ? BINARY_COMPRESSED : 0;
+    header.num_vertices = m_position_buffer.rows();
+    header.num_triangles = m_triangle_buffer.rows();
+    std::uint64_t offset = align_offset(sizeof(BinaryHeader));
+    for (int i = 0; i < NumSections; ++i)
+    {
+      if (compress && lengths[i] > 0)
+      {
+        compressed[i] = deflate(
+          reinterpret_cast<const std::uint8_t*>(data[i]), lengths[i]);
+        data[i] = reinterpret_cast<const char*>(compressed[i].data());
+        lengths[i] = compressed[i].size();
+      }
+
+      header.offsets[i] = offset;
+      header.sizes[i] = lengths[i];
+      offset = align_offset(offset + lengths[i]);
+    }
+
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+    {
+      throw std::invalid_argument("Unable to open file.");
+    }
+
+    const char padding[BINARY_ALIGNMENT] = {};
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t position = sizeof(header);
+    for (int i = 0; i < NumSections; ++i)
+    {
+      stream.write(padding, header.offsets[i] - position);
+      stream.write(data[i], lengths[i]);
+      position = header.offsets[i] + lengths[i];
+    }
+
+    if (!stream)
+    {
+      throw std::invalid_argument("Unable to write file.");
+    }
+  }
+
+  std::shared_ptr<MeshInfo> MeshInfo::load_binary(const std::string& path)
+  {
+    MappedFile file(path, true);
+    BinaryHeader header;
+    if (file.size() < sizeof(header))
+    {
+      throw std::invalid_argument("Not a mesh info file.");
+    }
+
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+    {
+      throw std::invalid_argument("Not a mesh info file.");
+    }
+
+    if (header.version != BINARY_VERSION)
+    {
+      throw std::invalid_argument(
+        "Unsupported mesh info version: " + std::to_string(header.version));
+    }
+
+    for (int i = 0; i < NumSections; ++i)
+    {
+      if (
+        header.offsets[i] > file.size() ||
+        header.sizes[i] > file.size() - header.offsets[i])
+      {
+        throw std::invalid_argument("Mesh info file is truncated.");
+      }
+    }
+
+    // positions and triangles both take three 4-byte values per row
+    std::uint64_t ratio =
+      header.flags & BINARY_COMPRESSED ? MAX_INFLATE_RATIO : 1;
+    if (
+      header.num_vertices > header.sizes[Positions] / 12 * ratio ||
+      header.num_triangles > header.sizes[Triangles] / 12 * ratio)
+    {
+      throw std::invalid_argument("Corrupt mesh info header.");
+    }
+
+    bool has_normals = header.sizes[Normals] > 0;
+    bool has_uvs = header.sizes[UVs] > 0;
+    bool has_colors = header.sizes[Colors] > 0;
+    auto mesh_info = std::make_shared<MeshInfo>(
+      header.num_vertices,
+      header.num_triangles,
+      has_uvs,
+      has_normals,
+      has_colors);
+    read_section(file, header, Positions, mesh_info->m_position_buffer);
+    read_section(file, header, Normals, mesh_info->m_normal_buffer);
+    read_section(file, header, Triangles, mesh_info->m_triangle_buffer);
+    read_section(file, header, UVs, mesh_info->m_uv_buffer);
+    read_section(file, header, Colors, mesh_info->m_color_buffer);
+    if (
+      mesh_info->m_triangle_buffer.size() > 0 &&
+      mesh_info->m_triangle_buffer.maxCoeff() >= header.num_vertices)
+    {
+      throw std::invalid_argument("Corrupt mesh info section.");
+    }
+
+    return mesh_info;
+  }
+} // namespace scenepic
@@ -43,3 +43,40 @@ class MeshInfo:
         Returns:
             MeshInfo: a subdivided version of this mesh
         """
+
+    def simplify(self, target_triangle_count: int, max_error: float = float("inf")) -> "MeshInfo":
+        """Simplify this mesh using quadric error edge collapses. Vertex normals,
+        colors and UVs are interpolated along each collapsed edge.
+
+        Args:
+            target_triangle_count (int): the number of triangles to reduce the mesh to (if possible).
+            max_error (float): the maximum distance of a collapsed vertex from the planes
+                               of the original faces it replaces, as a fraction of the
+                               diagonal of the mesh bounding box. Defaults to no limit.
+
+        Returns:
+            MeshInfo: a simplified version of this mesh
+        """
+
+    def save_binary(self, path: str, compress: bool = False):
+        """Save this mesh info to disk in a native binary format which can be reloaded
+        far faster than parsing an OBJ or PLY. Each buffer is stored in its own aligned
+        section, optionally deflated.
+
+        Args:
+            path (str): the location on disk to write the file
+            compress (bool): whether to deflate the buffers. This makes the file
+                             smaller but slower to load. Defaults to False.
+        """
+
+    @staticmethod
+    def load_binary(path: str) -> "MeshInfo":
+        """Load a mesh info from a file written by save_binary. The file is memory mapped
+        and each buffer is copied directly from the mapping.
+
+        Args:
+            path (str): the location of the file on disk
+
+        Returns:
+            MeshInfo: the mesh info stored in the file
+        """
@@ -7,6 +7,15 @@
 
 #include <Eigen/Geometry>
 #include <cmath>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 
 namespace
 {
@@ -20,6 +29,401 @@ namespace scenepic
     return alpha * p0 + (1. - alpha) * p1;
   }
 
+  namespace
+  {
+    /** Keep the caches bounded when called with many distinct parameters. */
+    const std::size_t MAX_CACHED_TEMPLATES = 64;
+
+    /** Precomputed unit geometry for a primitive. */
+    struct PrimitiveTemplate
+    {
+      VectorBuffer positions;
+      VectorBuffer normals;
+      TriangleBuffer triangles;
+      LineBuffer lines;
+      UVBuffer uvs;
+    };
+
+    typedef std::shared_ptr<const PrimitiveTemplate> PrimitiveTemplatePtr;
+
+    /** Thread-safe cache of primitive templates keyed on their parameters. */
+    template<typename Key>
+    class TemplateCache
+    {
+    public:
+      template<typename Builder>
+      PrimitiveTemplatePtr get(const Key& key, Builder build)
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_templates.find(key);
+        if (it != m_templates.end())
+        {
+          return it->second;
+        }
+
+        if (m_templates.size() >= MAX_CACHED_TEMPLATES)
+        {
+          m_templates.clear();
+        }
+
+        PrimitiveTemplatePtr primitive =
+          std::make_shared<const PrimitiveTemplate>(build());
+        m_templates[key] = primitive;
+        return primitive;
+      }
+
+    private:
+      std::mutex m_mutex;
+      std::map<Key, PrimitiveTemplatePtr> m_templates;
+    };
+
+    PrimitiveTemplate build_cone(
+      float truncation_height,
+      std::uint32_t lat_count,
+      std::uint32_t long_count)
+    {
+      const float radius = 0.5f;
+      Vector apex(-0.5f, 0., 0.);
+      bool add_apex = std::abs(truncation_height - 1.) < 1e-6;
+      const float base_center_x = 0.5f;
+
+      Eigen::Index num_rings = lat_count > 0 ? lat_count - 1 : 0;
+      Eigen::Index num_vertices =
+        static_cast<Eigen::Index>(lat_count) * long_count + (add_apex ? 1 : 0);
+      Eigen::Index num_apex_faces = add_apex ? long_count : 0;
+
+      PrimitiveTemplate primitive;
+      primitive.positions.resize(num_vertices, 3);
+      primitive.normals.resize(num_vertices, 3);
+      Eigen::Index num_quads = num_rings * long_count;
+      primitive.triangles.resize(2 * num_quads + num_apex_faces, 3);
+      primitive.lines.resize(4 * num_quads + 2 * num_apex_faces, 2);
+
+      Eigen::Index vertex = 0;
+      for (std::uint32_t lat_index = 0; lat_index < lat_count; ++lat_index)
+      {
+        float alpha = static_cast<float>(lat_index) / lat_count;
+        alpha = alpha * truncation_height;
+
+        for (std::uint32_t long_index = 0; long_index < long_count;
+             ++long_index, ++vertex)
+        {
+          float phi = long_index * 2.0f * PI / long_count;
+          float cosPhi = std::cos(phi);
+          float sinPhi = std::sin(phi);
+
+          Vector base_point(base_center_x, cosPhi * radius, sinPhi * radius);
+          Vector xyz = interpolate(apex, base_point, alpha);
+          Vector normal = (base_point - apex).cross(xyz - Vector(xyz(0), 0, 0));
+          normal = normal.cross(base_point - apex);
+          normal.normalize();
+          primitive.positions.row(vertex) = xyz;
+          primitive.normals.row(vertex) = normal.normalized();
+        }
+      }
+
+      if (add_apex)
+      {
+        primitive.positions.row(vertex) = apex;
+        primitive.normals.row(vertex) = Vector(-1, 0, 0);
+      }
+
+      Eigen::Index tri = 0;
+      Eigen::Index line = 0;
+      for (std::uint32_t lat_index = 0; lat_index < num_rings; ++lat_index)
+      {
+        for (std::uint32_t long_index = 0; long_index < long_count;
+             ++long_index)
+        {
+          auto base_index = lat_index * long_count;
+          auto a = base_index + long_index;
+          auto b = base_index + (long_index + 1) % long_count;
+          auto c = base_index + long_index + long_count;
+          auto d = base_index + (long_index + 1) % long_count + long_count;
+          primitive.triangles.row(tri++) = Triangle(b, a, c);
+          primitive.triangles.row(tri++) = Triangle(b, c, d);
+          primitive.lines.row(line++) = Line(a, b);
+          primitive.lines.row(line++) = Line(b, d);
+          primitive.lines.row(line++) = Line(d, c);
+          primitive.lines.row(line++) = Line(c, a);
+        }
+      }
+
+      if (add_apex)
+      {
+        std::uint32_t lat_index = lat_count - 1;
+        auto a = lat_count * long_count;
+        for (std::uint32_t long_index = 0; long_index < long_count;
+             ++long_index)
+        {
+          auto base_index = lat_index * long_count;
+          auto b = base_index + long_index;
+          auto c = base_index + (long_index + 1) % long_count;
+          primitive.triangles.row(tri++) = Triangle(b, a, c);
+          primitive.lines.row(line++) = Line(a, b);
+          primitive.lines.row(line++) = Line(a, c);
+        }
+      }
+
+      return primitive;
+    }
+
+    PrimitiveTemplate build_cylinder_barrel(std::uint32_t segment_count)
+    {
+      // Unit diameter for consistency with other primitives
+      float radius = 0.5f;
+
+      auto N = segment_count;
+      auto thetas = Eigen::ArrayXf::LinSpaced(N, 0, 2.0f * PI);
+      auto ys = radius * thetas.cos();
+      auto zs = radius * thetas.sin();
+
+      PrimitiveTemplate primitive;
+      VectorBuffer& vertices = primitive.positions;
+      vertices.resize(2 * N, 3);
+      vertices.topLeftCorner(N, 1).fill(-0.5f);
+      vertices.bottomLeftCorner(N, 1).fill(+0.5f);
+      vertices.block(0, 1, N, 1) = ys;
+      vertices.block(N, 1, N, 1) = ys;
+      vertices.topRightCorner(N, 1) = zs;
+      vertices.bottomRightCorner(N, 1) = zs;
+
+      primitive.normals = vertices;
+      primitive.normals.col(0).fill(0.0f);
+
+      TriangleBuffer& triangles = primitive.triangles;
+      triangles.resize(2 * N, 3);
+      auto range = arange(0, N);
+      triangles.topLeftCorner(N, 1) = roll(range, 1);
+      triangles.block(0, 1, N, 1) = range;
+      triangles.topRightCorner(N, 1) = range + N;
+      triangles.bottomLeftCorner(N, 1) = roll(range, 1);
+      triangles.block(N, 1, N, 1) = range + N;
+      triangles.bottomRightCorner(N, 1) = roll(range, 1) + N;
+
+      return primitive;
+    }
+
+    PrimitiveTemplate build_icosphere(std::uint32_t steps, bool textured)
+    {
+      // Create a basic icosohedron primitive
+
+      // Leads to unit diameter for consistency with other primitives
+      const float radius = 0.5f;
+      const float t = 0.5f * (1.0f + std::sqrt(5.0f));
+      VectorBuffer vertex_positions(12, 3);
+      vertex_positions << -1.0, +t, 0.0, +1.0, +t, 0.0, -1.0, -t, 0.0, +1.0,
+        -t, 0.0, 0.0, -1.0, +t, 0.0, +1.0, +t, 0.0, -1.0, -t, 0.0, +1.0, -t,
+        +t, 0.0, -1.0, +t, 0.0, +1.0, -t, 0.0, -1.0, -t, 0.0, +1.0;
+      vertex_positions.rowwise().normalize();
+      vertex_positions *= radius;
+
+      TriangleBuffer triangles(20, 3);
+      triangles << 0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5,
+        11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8, 3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8,
+        3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1;
+
+      // Apply subdivision
+      for (std::uint32_t iter = 0; iter < steps; ++iter)
+      {
+        Eigen::Index num_triangles = triangles.rows();
+        Eigen::Index num_vertices = vertex_positions.rows();
+
+        // Each edge gets a single new e-vert, shared with the neighbouring
+        // triangle. Edges are keyed on their sorted vertex indices.
+        std::unordered_map<std::uint64_t, std::uint32_t> new_e_vs;
+        new_e_vs.reserve(static_cast<std::size_t>(num_triangles) * 3 / 2);
+        vertex_positions.conservativeResize(
+          num_vertices + num_triangles * 3, Eigen::NoChange);
+        TriangleBuffer new_triangles(4 * num_triangles, 3);
+
+        auto e_v = [&](std::uint32_t v0, std::uint32_t v1) {
+          std::uint64_t key = v0 < v1
+            ? (static_cast<std::uint64_t>(v0) << 32) | v1
+            : (static_cast<std::uint64_t>(v1) << 32) | v0;
+          auto it = new_e_vs.find(key);
+          if (it != new_e_vs.end())
+          {
+            return it->second;
+          }
+
+          Vector v = vertex_positions.row(v0) + vertex_positions.row(v1);
+          v.normalize();
+          v *= radius;
+          std::uint32_t index = static_cast<std::uint32_t>(num_vertices++);
+          vertex_positions.row(index) = v;
+          new_e_vs.emplace(key, index);
+          return index;
+        };
+
+        for (Eigen::Index triangle = 0; triangle < num_triangles; ++triangle)
+        {
+          auto a = triangles(triangle, 0);
+          auto b = triangles(triangle, 1);
+          auto c = triangles(triangle, 2);
+          auto ab = e_v(a, b);
+          auto ac = e_v(a, c);
+          auto bc = e_v(b, c);
+
+          new_triangles.row(4 * triangle) = Triangle(a, ab, ac);
+          new_triangles.row(4 * triangle + 1) = Triangle(ab, bc, ac);
+          new_triangles.row(4 * triangle + 2) = Triangle(ac, bc, c);
+          new_triangles.row(4 * triangle + 3) = Triangle(ab, b, bc);
+        }
+
+        // Replace existing triangles with new triangles
+        vertex_positions.conservativeResize(num_vertices, Eigen::NoChange);
+        triangles = new_triangles;
+      }
+
+      // Set up per-vertex uvs if required
+      UVBuffer uvs;
+      if (textured)
+      {
+        // Compute azimuth and inclination values into the uv buffer
+        uvs.resize(vertex_positions.rows(), Eigen::NoChange);
+        for (auto v_idx = 0; v_idx < vertex_positions.rows(); ++v_idx)
+        {
+          uvs(v_idx, 0) = static_cast<float>(
+            0.5f -
+            0.5f *
+              std::atan2(
+                vertex_positions(v_idx, 2), vertex_positions(v_idx, 0)) /
+              PI); // Azimuth
+          uvs(v_idx, 1) = static_cast<float>(
+            1.0f -
+            std::acos(vertex_positions(v_idx, 1) * 2.0f) / PI); // Inclination
+        }
+
+        // Duplicate vertices across the longitude seam - not particularly
+        // efficient and bit of a hack but works ok.  Results in non watertight
+        // mesh. Loop over triangles
+        TriangleBuffer new_triangles;
+        for (auto triangle = 0; triangle < triangles.rows(); ++triangle)
+        {
+          auto a = triangles(triangle, 0);
+          auto b = triangles(triangle, 1);
+          auto c = triangles(triangle, 2);
+
+          // Rotate triangle indices to ensure a is east most vertex, preserving
+          // triangle winding order
+          for (std::size_t attempt = 0; attempt < 2; ++attempt)
+          {
+            if (uvs(a, 0) < uvs(b, 0) || uvs(a, 0) < uvs(c, 0))
+            {
+              std::tie(a, b, c) = std::make_tuple(b, c, a);
+            }
+          }
+
+          // Identify hemisphere for a, b, c
+          // Hack - doesn't look great at poles for small number of subdiv steps
+          bool a_isEast = uvs(a, 0) > 0.66f;
+          bool b_isWest = uvs(b, 0) < 0.33f;
+          bool c_isWest = uvs(c, 0) < 0.33f;
+
+          // Duplicate vertices if necessary
+          if (a_isEast && c_isWest) // Duplicate c vertex
+          {
+            Vertex new_vertex = vertex_positions.row(c);
+            append_row(vertex_positions, new_vertex); // Concatenate a copy of c
+            append_row(uvs, Eigen::Vector2f(1.0f + uvs(c, 0), uvs(c, 1)));
+            c = static_cast<uint32_t>(
+              vertex_positions.rows() - 1); // Will overwrite c in triangle
+          }
+          if (a_isEast && b_isWest) // Duplicate b vertex
+          {
+            Vertex new_vertex = vertex_positions.row(b);
+            append_row(vertex_positions, new_vertex); // Concatenate a copy of b
+            append_row(uvs, Eigen::Vector2f(1.0f + uvs(b, 0), uvs(b, 1)));
+            b = static_cast<uint32_t>(
+              vertex_positions.rows() - 1); // Will overwrite b in triangle
+          }
+
+          // Save the new triangle
+          append_row(new_triangles, Triangle(a, b, c));
+        }
+
+        // Replace existing triangles with new triangles
+        triangles = new_triangles;
+      }
+
+      PrimitiveTemplate primitive;
+      primitive.positions = std::move(vertex_positions);
+      primitive.triangles = std::move(triangles);
+      primitive.uvs = std::move(uvs);
+      return primitive;
+    }
+
+    PrimitiveTemplate
+    build_uv_sphere(std::uint32_t lat_count, std::uint32_t long_count)
+    {
+      // Leads to unit diameter for consistency with other primitives
+      const double radius = 0.5;
+      Eigen::Index num_vertices =
+        static_cast<Eigen::Index>(lat_count + 1) * long_count;
+      Eigen::Index num_triangles = 0;
+      if (lat_count > 0)
+      {
+        num_triangles = 2 * lat_count - 1;
+        num_triangles *= long_count;
+      }
+
+      PrimitiveTemplate primitive;
+      primitive.positions.resize(num_vertices, 3);
+      primitive.normals.resize(num_vertices, 3);
+      primitive.triangles.resize(num_triangles, 3);
+      primitive.lines.resize(4 * lat_count * long_count, 2);
+
+      Eigen::Index vertex = 0;
+      for (std::uint32_t lat_index = 0; lat_index < lat_count + 1; ++lat_index)
+      {
+        double theta = lat_index * M_PI / lat_count;
+        double cosTheta = std::cos(theta);
+        double sinTheta = std::sin(theta);
+        for (std::uint32_t long_index = 0; long_index < long_count;
+             ++long_index, ++vertex)
+        {
+          double phi = long_index * 2.0 * M_PI / long_count;
+          double cosPhi = std::cos(phi);
+          double sinPhi = std::sin(phi);
+
+          double dx = radius * cosPhi * sinTheta;
+          double dy = radius * cosTheta;
+          double dz = radius * sinPhi * sinTheta;
+          Vector pos = Eigen::Vector3d(dx, dy, dz).cast<float>();
+          primitive.positions.row(vertex) = pos;
+          primitive.normals.row(vertex) = pos.normalized();
+        }
+      }
+
+      Eigen::Index tri = 0;
+      Eigen::Index line = 0;
+      for (std::uint32_t lat_index = 0; lat_index < lat_count; ++lat_index)
+      {
+        for (std::uint32_t long_index = 0; long_index < long_count;
+             ++long_index)
+        {
+          auto base_index = lat_index * long_count;
+          auto a = base_index + long_index;
+          auto b = base_index + (long_index + 1) % long_count;
+          auto c = base_index + long_index + long_count;
+          auto d = base_index + (long_index + 1) % long_count + long_count;
+          if (lat_index > 0)
+          {
+            primitive.triangles.row(tri++) = Triangle(a, b, c);
+          }
+          primitive.triangles.row(tri++) = Triangle(c, b, d);
+          primitive.lines.row(line++) = Line(a, b);
+          primitive.lines.row(line++) = Line(b, d);
+          primitive.lines.row(line++) = Line(d, c);
+          primitive.lines.row(line++) = Line(c, a);
+        }
+      }
+
+      return primitive;
+    }
+  } // namespace
+
   void Mesh::add_cube(
     const Color& color,
     const Transform& transform,
@@ -143,90 +547,22 @@ namespace scenepic
     this->check_instances();
     this->check_color(color);
 
-    const float radius = 0.5f;
-    Vector apex(-0.5f, 0., 0.);
-    bool add_apex = std::abs(truncation_height - 1.) < 1e-6;
-    const float base_center_x = 0.5f;
-    Mesh m = Mesh("").shared_color(m_shared_color);
-    for (std::uint32_t lat_index = 0; lat_index < lat_count; ++lat_index)
-    {
-      float alpha = static_cast<float>(lat_index) / lat_count;
-      alpha = alpha * truncation_height;
-
-      for (std::uint32_t long_index = 0; long_index < long_count; ++long_index)
-      {
-        float phi = long_index * 2.0f * PI / long_count;
-        float cosPhi = std::cos(phi);
-        float sinPhi = std::sin(phi);
-
-        Vector base_point(base_center_x, cosPhi * radius, sinPhi * radius);
-        Vector xyz = interpolate(apex, base_point, alpha);
-        Vector normal = (base_point - apex).cross(xyz - Vector(xyz(0), 0, 0));
-        normal = normal.cross(base_point - apex);
-        normal.normalize();
-        m.append_vertex(xyz, normal, color);
-      }
-    }
-
-    if (add_apex)
-    {
-      m.append_vertex(apex, Vector(-1, 0, 0), color);
-    }
-
-    for (std::uint32_t lat_index = 0; lat_index < lat_count - 1; ++lat_index)
-    {
-      for (std::uint32_t long_index = 0; long_index < long_count; ++long_index)
-      {
-        auto base_index = lat_index * long_count;
-        auto a = base_index + long_index;
-        auto b = base_index + (long_index + 1) % long_count;
-        auto c = base_index + long_index + long_count;
-        auto d = base_index + (long_index + 1) % long_count + long_count;
-        if (fill_triangles)
-        {
-          m.append_triangle(b, a, c);
-          m.append_triangle(b, c, d);
-        }
-
-        if (add_wireframe)
-        {
-          m.append_line(a, b);
-          m.append_line(b, d);
-          m.append_line(d, c);
-          m.append_line(c, a);
-        }
-      }
-    }
-
-    if (add_apex)
-    {
-      std::uint32_t lat_index = lat_count - 1;
-      auto a = lat_count * long_count;
-      for (std::uint32_t long_index = 0; long_index < long_count; ++long_index)
-      {
-        auto base_index = lat_index * long_count;
-        auto b = base_index + long_index;
-        auto c = base_index + (long_index + 1) % long_count;
-
-        if (fill_triangles)
-        {
-          m.append_triangle(b, a, c);
-        }
-
-        if (add_wireframe)
-        {
-          m.append_line(a, b);
-          m.append_line(a, c);
-        }
-      }
-    }
-
-    if (!transform.isIdentity())
-    {
-      m.apply_transform(transform);
-    }
-
-    this->append_mesh(m);
+    typedef std::tuple<float, std::uint32_t, std::uint32_t> ConeKey;
+    static TemplateCache<ConeKey> cache;
+    auto key = std::make_tuple(truncation_height, lat_count, long_count);
+    auto primitive = cache.get(key, [&]() {
+      return build_cone(truncation_height, lat_count, long_count);
+    });
+
+    this->append_primitive(
+      primitive->positions,
+      primitive->normals,
+      primitive->triangles,
+      primitive->lines,
+      color,
+      transform,
+      fill_triangles,
+      add_wireframe);
   }
 
   void Mesh::add_coordinate_axes(
@@ -470,9 +806,6 @@ namespace scenepic
     this->check_instances();
     this->check_color(color);
 
-    // Unit diameter for consistency with other primitives
-    float radius = 0.5f;
-
     auto N = segment_count;
 
     // Add discs at each end of the cylinder
@@ -491,43 +824,22 @@ namespace scenepic
       this->add_disc(color, disc_transform, N, fill_triangles, add_wireframe);
     }
 
-    auto thetas = Eigen::ArrayXf::LinSpaced(N, 0, 2.0f * PI);
-    auto ys = radius * thetas.cos();
-    auto zs = radius * thetas.sin();
-
-    VectorBuffer vertices(2 * N, 3);
-    vertices.topLeftCorner(N, 1).fill(-0.5f);
-    vertices.bottomLeftCorner(N, 1).fill(+0.5f);
-    vertices.block(0, 1, N, 1) = ys;
-    vertices.block(N, 1, N, 1) = ys;
-    vertices.topRightCorner(N, 1) = zs;
-    vertices.bottomRightCorner(N, 1) = zs;
-
-    VectorBuffer normals = vertices;
-    normals.col(0).fill(0.0f);
-
-    TriangleBuffer triangles(2 * N, 3);
-    auto range = arange(0, N);
-    triangles.topLeftCorner(N, 1) = roll(range, 1);
-    triangles.block(0, 1, N, 1) = range;
-    triangles.topRightCorner(N, 1) = range + N;
-    triangles.bottomLeftCorner(N, 1) = roll(range, 1);
-    triangles.block(N, 1, N, 1) = range + N;
-    triangles.bottomRightCorner(N, 1) = roll(range, 1) + N;
+    static TemplateCache<std::uint32_t> cache;
+    auto barrel = cache.get(N, [&]() { return build_cylinder_barrel(N); });
 
     ColorBuffer colors = ColorBufferNone();
     if (!color.is_none())
     {
-      colors = ColorBuffer(2 * N, 3);
+      colors = ColorBuffer(barrel->positions.rows(), 3);
       colors.col(0).fill(color(0));
       colors.col(1).fill(color(1));
       colors.col(2).fill(color(2));
     }
 
     this->add_mesh_with_normals(
-      vertices,
-      normals,
-      triangles,
+      barrel->positions,
+      barrel->normals,
+      barrel->triangles,
       colors,
       UVBufferNone(),
       transform,
@@ -555,170 +867,29 @@ namespace scenepic
     this->check_instances();
     this->check_color(color);
 
-    // Create a basic icosohedron primitive
-
-    // Leads to unit diameter for consistency with other primitives
-    const float radius = 0.5f;
-    const float t = 0.5f * (1.0f + std::sqrt(5.0f));
-    VectorBuffer vertex_positions(12, 3);
-    vertex_positions << -1.0, +t, 0.0, +1.0, +t, 0.0, -1.0, -t, 0.0, +1.0, -t,
-      0.0, 0.0, -1.0, +t, 0.0, +1.0, +t, 0.0, -1.0, -t, 0.0, +1.0, -t, +t, 0.0,
-      -1.0, +t, 0.0, +1.0, -t, 0.0, -1.0, -t, 0.0, +1.0;
-    vertex_positions.rowwise().normalize();
-    vertex_positions *= radius;
-
-    TriangleBuffer triangles(20, 3);
-    triangles << 0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5,
-      11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8, 3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8,
-      3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1;
-
-    typedef std::pair<std::uint32_t, std::uint32_t> Edge;
-    // Apply subdivision
-    for (std::uint32_t iter = 0; iter < steps; ++iter)
-    {
-      std::map<Edge, std::uint32_t> new_e_vs;
-      TriangleBuffer new_triangles;
-
-      // For each triangle we will make up to 3 new e-verts
-      // (some will have less when shared with neighbouring triangles)
-      for (auto triangle = 0; triangle < triangles.rows(); ++triangle)
-      {
-        auto a = triangles(triangle, 0);
-        auto b = triangles(triangle, 1);
-        auto c = triangles(triangle, 2);
-        std::map<Edge, std::uint32_t> v_idx;
-
-        // Loop over triangle edges
-        std::array<Edge, 3> edges = {Edge(a, b), Edge(a, c), Edge(b, c)};
-        for (const auto& edge : edges)
-        {
-          Edge back_edge(edge.second, edge.first);
-          // Check this edge does not already have a new edge-vertex
-          if (new_e_vs.count(edge))
-          {
-            v_idx[edge] = new_e_vs[edge];
-          }
-          else if (new_e_vs.count(back_edge))
-          {
-            v_idx[edge] = new_e_vs[back_edge];
-          }
-          else
-          {
-            Vector v = vertex_positions.row(edge.first) +
-              vertex_positions.row(edge.second);
-            v.normalize();
-            v *= radius;
-            v_idx[edge] = new_e_vs[edge] =
-              static_cast<std::uint32_t>(vertex_positions.rows());
-            append_row(vertex_positions, v);
-          }
-        }
-
-        // Append new triangles
-        append_row(
-          new_triangles, Triangle(a, v_idx[Edge(a, b)], v_idx[Edge(a, c)]));
-        append_row(
-          new_triangles,
-          Triangle(v_idx[Edge(a, b)], v_idx[Edge(b, c)], v_idx[Edge(a, c)]));
-        append_row(
-          new_triangles, Triangle(v_idx[Edge(a, c)], v_idx[Edge(b, c)], c));
-        append_row(
-          new_triangles, Triangle(v_idx[Edge(a, b)], b, v_idx[Edge(b, c)]));
-      }
-
-      // Replace existing triangles with new triangles
-      triangles = new_triangles;
-    }
+    bool textured = !m_texture_id.empty();
+    static TemplateCache<std::pair<std::uint32_t, bool>> cache;
+    auto primitive = cache.get(std::make_pair(steps, textured), [&]() {
+      return build_icosphere(steps, textured);
+    });
 
     // Set up per-vertex colors if required
     ColorBuffer colors;
     if (!color.is_none())
     {
-      colors = ColorBuffer(vertex_positions.rows(), 3);
+      colors = ColorBuffer(primitive->positions.rows(), 3);
       colors.col(0).fill(color.r());
       colors.col(1).fill(color.g());
       colors.col(2).fill(color.b());
     }
 
-    // Set up per-vertex uvs if required
-    UVBuffer uvs;
-    if (!m_texture_id.empty())
-    {
-      // Compute azimuth and inclination values into the uv buffer
-      uvs.resize(vertex_positions.rows(), Eigen::NoChange);
-      for (auto v_idx = 0; v_idx < vertex_positions.rows(); ++v_idx)
-      {
-        uvs(v_idx, 0) = static_cast<float>(
-          0.5f -
-          0.5f *
-            std::atan2(vertex_positions(v_idx, 2), vertex_positions(v_idx, 0)) /
-            PI); // Azimuth
-        uvs(v_idx, 1) = static_cast<float>(
-          1.0f -
-          std::acos(vertex_positions(v_idx, 1) * 2.0f) / PI); // Inclination
-      }
-
-      // Duplicate vertices across the longitude seam - not particularly
-      // efficient and bit of a hack but works ok.  Results in non watertight
-      // mesh. Loop over triangles
-      TriangleBuffer new_triangles;
-      for (auto triangle = 0; triangle < triangles.rows(); ++triangle)
-      {
-        auto a = triangles(triangle, 0);
-        auto b = triangles(triangle, 1);
-        auto c = triangles(triangle, 2);
-
-        // Rotate triangle indices to ensure a is east most vertex, preserving
-        // triangle winding order
-        for (std::size_t attempt = 0; attempt < 2; ++attempt)
-        {
-          if (uvs(a, 0) < uvs(b, 0) || uvs(a, 0) < uvs(c, 0))
-          {
-            std::tie(a, b, c) = std::make_tuple(b, c, a);
-          }
-        }
-
-        // Identify hemisphere for a, b, c
-        // Hack - doesn't look great at poles for small number of subdiv steps
-        bool a_isEast = uvs(a, 0) > 0.66f;
-        bool b_isWest = uvs(b, 0) < 0.33f;
-        bool c_isWest = uvs(c, 0) < 0.33f;
-
-        // Duplicate vertices if necessary
-        if (a_isEast && c_isWest) // Duplicate c vertex
-        {
-          Vertex new_vertex = vertex_positions.row(c);
-          append_row(vertex_positions, new_vertex); // Concatenate a copy of c
-          append_row(uvs, Eigen::Vector2f(1.0f + uvs(c, 0), uvs(c, 1)));
-          c = static_cast<uint32_t>(
-            vertex_positions.rows() - 1); // Will overwrite c in triangle
-        }
-        if (a_isEast && b_isWest) // Duplicate b vertex
-        {
-          Vertex new_vertex = vertex_positions.row(b);
-          append_row(vertex_positions, new_vertex); // Concatenate a copy of b
-          append_row(uvs, Eigen::Vector2f(1.0f + uvs(b, 0), uvs(b, 1)));
-          b = static_cast<uint32_t>(
-            vertex_positions.rows() - 1); // Will overwrite b in triangle
-        }
-
-        // Save the new triangle
-        append_row(new_triangles, Triangle(a, b, c));
-      }
-
-      // Replace existing triangles with new triangles
-      triangles = new_triangles;
-    }
-
-    // Populate mesh
-
     // vertices double as normals given they lie on unit sphere
     this->add_mesh_with_normals(
-      std::move(vertex_positions),
-      std::move(vertex_positions),
-      std::move(triangles),
-      std::move(colors),
-      std::move(uvs),
+      primitive->positions,
+      primitive->positions,
+      primitive->triangles,
+      colors,
+      primitive->uvs,
       transform,
       false,
       fill_triangles,
@@ -736,56 +907,60 @@ namespace scenepic
     this->check_instances();
     this->check_color(color);
 
-    // Add vertices
+    static TemplateCache<std::pair<std::uint32_t, std::uint32_t>> cache;
+    auto primitive = cache.get(std::make_pair(lat_count, long_count), [&]() {
+      return build_uv_sphere(lat_count, long_count);
+    });
+
+    this->append_primitive(
+      primitive->positions,
+      primitive->normals,
+      primitive->triangles,
+      primitive->lines,
+      color,
+      transform,
+      fill_triangles,
+      add_wireframe);
+  }
+
+  void Mesh::append_primitive(
+    const VectorBuffer& positions,
+    const VectorBuffer& normals,
+    const TriangleBuffer& triangles,
+    const LineBuffer& lines,
+    const Color& color,
+    const Transform& transform,
+    bool fill_triangles,
+    bool add_wireframe)
+  {
+    if (!m_texture_id.empty())
+    {
+      throw std::invalid_argument(
+        "This primitive has no texture coordinates and cannot be added to a "
+        "textured mesh");
+    }
 
-    // Leads to unit diameter for consistency with other primitives
-    const double radius = 0.5;
     Mesh m = Mesh("").shared_color(m_shared_color);
-    for (std::uint32_t lat_index = 0; lat_index < lat_count + 1; ++lat_index)
+    if (color.is_none())
     {
-      double theta = lat_index * M_PI / lat_count;
-      double cosTheta = std::cos(theta);
-      double sinTheta = std::sin(theta);
-      for (std::uint32_t long_index = 0; long_index < long_count; ++long_index)
-      {
-        double phi = long_index * 2.0 * M_PI / long_count;
-        double cosPhi = std::cos(phi);
-        double sinPhi = std::sin(phi);
-
-        double dx = radius * cosPhi * sinTheta;
-        double dy = radius * cosTheta;
-        double dz = radius * sinPhi * sinTheta;
-        Vector pos = Eigen::Vector3d(dx, dy, dz).cast<float>();
-        m.append_vertex(pos, pos, color);
-      }
+      m.m_vertices = VertexBuffer(positions.rows(), 6);
+    }
+    else
+    {
+      m.m_vertices = VertexBuffer(positions.rows(), 9);
+      m.vertex_colors().rowwise() = color.transpose();
     }
 
-    // Add triangles
-    for (std::uint32_t lat_index = 0; lat_index < lat_count; ++lat_index)
+    m.vertex_positions() = positions;
+    m.vertex_normals() = normals;
+    if (fill_triangles)
     {
-      for (std::uint32_t long_index = 0; long_index < long_count; ++long_index)
-      {
-        auto base_index = lat_index * long_count;
-        auto a = base_index + long_index;
-        auto b = base_index + (long_index + 1) % long_count;
-        auto c = base_index + long_index + long_count;
-        auto d = base_index + (long_index + 1) % long_count + long_count;
-        if (fill_triangles)
-        {
-          if (lat_index > 0)
-          {
-            m.append_triangle(a, b, c);
-          }
-          m.append_triangle(c, b, d);
-        }
-        if (add_wireframe)
-        {
-          m.append_line(a, b);
-          m.append_line(b, d);
-          m.append_line(d, c);
-          m.append_line(c, a);
-        }
-      }
+      m.m_triangles = triangles;
+    }
+
+    if (add_wireframe)
+    {
+      m.m_lines = lines;
     }
 
     if (!transform.isIdentity())
@@ -796,4 +971,170 @@ namespace scenepic
     this->append_mesh(m);
   }
 
-} // namespace scenepic
\ No newline at end of file
+  void Mesh::append_primitives(
+    const Mesh& primitive,
+    const ConstVectorBufferRef& positions,
+    const ConstColorBufferRef& colors,
+    const ConstVectorBufferRef& scales,
+    const ConstQuaternionBufferRef& rotations)
+  {
+    const VertexBuffer& vertices = primitive.m_vertices;
+    const TriangleBuffer& triangles = primitive.m_triangles;
+    const LineBuffer& lines = primitive.m_lines;
+    Eigen::Index num_vertices = vertices.rows();
+    Eigen::Index num_triangles = triangles.rows();
+    Eigen::Index num_lines = lines.rows();
+
+    Eigen::Index num_items = positions.rows();
+    bool has_vertex_colors = vertices.cols() == 9;
+    bool has_scales = scales.rows() > 0;
+    bool has_rotations = rotations.rows() > 0;
+
+    if (has_vertex_colors && colors.rows() != num_items)
+    {
+      throw std::invalid_argument(
+        "Per-item colors must be provided unless the mesh has a single color "
+        "or texture map");
+    }
+
+    if (has_scales && scales.rows() != num_items)
+    {
+      throw std::invalid_argument("Expecting per-item scales");
+    }
+
+    if (has_rotations && rotations.rows() != num_items)
+    {
+      throw std::invalid_argument("Expecting per-item rotations");
+    }
+
+    Eigen::Index vert_offset = this->count_vertices();
+    Eigen::Index tri_offset = m_triangles.rows();
+    Eigen::Index line_offset = m_lines.rows();
+    if (vert_offset == 0)
+    {
+      m_vertices.resize(0, vertices.cols());
+    }
+
+    if (m_vertices.cols() != vertices.cols())
+    {
+      throw std::invalid_argument(
+        "Primitive vertices do not match the layout of the mesh");
+    }
+
+    m_vertices.conservativeResize(
+      vert_offset + num_items * num_vertices, Eigen::NoChange);
+    m_triangles.conservativeResize(
+      tri_offset + num_items * num_triangles, Eigen::NoChange);
+    m_lines.conservativeResize(
+      line_offset + num_items * num_lines, Eigen::NoChange);
+
+    // stamp the primitive once per item directly into the mesh buffers
+    for (Eigen::Index i = 0; i < num_items; ++i)
+    {
+      Eigen::Matrix3f linear = Eigen::Matrix3f::Identity();
+      if (has_rotations)
+      {
+        linear = Transforms::quaternion_to_matrix(rotations.row(i))
+                   .topLeftCorner(3, 3);
+      }
+
+      if (has_scales)
+      {
+        linear = linear * scales.row(i).asDiagonal();
+      }
+
+      auto item =
+        m_vertices.middleRows(vert_offset + i * num_vertices, num_vertices);
+      item = vertices;
+      item.leftCols(3) = (vertices.leftCols(3) * linear.transpose()).rowwise() +
+        positions.row(i);
+      if (has_rotations || has_scales)
+      {
+        item.middleCols(3, 3) = vertices.middleCols(3, 3) * linear.inverse();
+        item.middleCols(3, 3).rowwise().normalize();
+      }
+
+      if (has_vertex_colors)
+      {
+        item.rightCols(3).rowwise() = colors.row(i);
+      }
+
+      std::uint32_t index_offset =
+        static_cast<std::uint32_t>(vert_offset + i * num_vertices);
+      m_triangles.middleRows(tri_offset + i * num_triangles, num_triangles) =
+        triangles.array() + index_offset;
+      m_lines.middleRows(line_offset + i * num_lines, num_lines) =
+        lines.array() + index_offset;
+    }
+  }
+
+  Color Mesh::template_color() const
+  {
+    // per-item colors replace the template color, which is only needed when
+    // the vertices have a color column
+    return m_shared_color.is_none() ? Colors::White : Color::None();
+  }
+
+  void Mesh::add_cubes(
+    const ConstVectorBufferRef& positions,
+    const ConstColorBufferRef& colors,
+    const ConstVectorBufferRef& scales,
+    const ConstQuaternionBufferRef& rotations,
+    bool fill_triangles,
+    bool add_wireframe)
+  {
+    this->check_instances();
+    Mesh primitive =
+      Mesh("").shared_color(m_shared_color).texture_id(m_texture_id);
+    primitive.add_cube(
+      this->template_color(),
+      Transform::Identity(),
+      fill_triangles,
+      add_wireframe);
+    this->append_primitives(primitive, positions, colors, scales, rotations);
+  }
+
+  void Mesh::add_spheres(
+    const ConstVectorBufferRef& positions,
+    const ConstColorBufferRef& colors,
+    const ConstVectorBufferRef& scales,
+    const ConstQuaternionBufferRef& rotations,
+    bool fill_triangles,
+    bool add_wireframe)
+  {
+    this->check_instances();
+    Mesh primitive =
+      Mesh("").shared_color(m_shared_color).texture_id(m_texture_id);
+    primitive.add_sphere(
+      this->template_color(),
+      Transform::Identity(),
+      fill_triangles,
+      add_wireframe);
+    this->append_primitives(primitive, positions, colors, scales, rotations);
+  }
+
+  void Mesh::add_cones(
+    const ConstVectorBufferRef& positions,
+    const ConstColorBufferRef& colors,
+    const ConstVectorBufferRef& scales,
+    const ConstQuaternionBufferRef& rotations,
+    float truncation_height,
+    std::uint32_t lat_count,
+    std::uint32_t long_count,
+    bool fill_triangles,
+    bool add_wireframe)
+  {
+    this->check_instances();
+    Mesh primitive =
+      Mesh("").shared_color(m_shared_color).texture_id(m_texture_id);
+    primitive.add_cone(
+      this->template_color(),
+      Transform::Identity(),
+      truncation_height,
+      lat_count,
+      long_count,
+      fill_triangles,
+      add_wireframe);
+    this->append_primitives(primitive, positions, colors, scales, rotations);
+  }
+} // namespace scenepic
@@ -0,0 +1,650 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/** Quadric edge-collapse simplification for MeshInfo (see mesh_info.cpp) */
+
+#include "mesh_info.h"
+#include "parallel.h"
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <vector>
+
+namespace scenepic
+{
+  namespace
+  {
+    /** Boundary edges are held in place by a plane perpendicular to the
+     *  adjacent face, weighted so that they resist collapsing inwards.
+     */
+    const double BOUNDARY_WEIGHT = 10.0;
+
+    /** Collapses which rotate a face normal by more than ~75 degrees are
+     *  rejected as they are likely to fold the surface.
+     */
+    const double MIN_NORMAL_DOT = 0.25;
+
+    /** Symmetric 4x4 quadric error matrix (upper triangle) */
+    struct Quadric
+    {
+      std::array<double, 10> q;
+
+      Quadric()
+      {
+        q.fill(0);
+      }
+
+      Quadric(const Eigen::Vector3d& normal, double offset, double weight)
+      {
+        double a = normal.x();
+        double b = normal.y();
+        double c = normal.z();
+        double d = offset;
+        q = {a * a, a * b, a * c, a * d, b * b,
+             b * c, b * d, c * c, c * d, d * d};
+        for (auto& value : q)
+        {
+          value *= weight;
+        }
+      }
+
+      Quadric& operator+=(const Quadric& other)
+      {
+        for (std::size_t i = 0; i < q.size(); ++i)
+        {
+          q[i] += other.q[i];
+        }
+
+        return *this;
+      }
+
+      double error(const Eigen::Vector3d& p) const
+      {
+        double x = p.x();
+        double y = p.y();
+        double z = p.z();
+        return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z +
+          2 * q[3] * x + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y +
+          q[7] * z * z + 2 * q[8] * z + q[9];
+      }
+
+      bool optimize(Eigen::Vector3d& p) const
+      {
+        Eigen::Matrix3d a;
+        a << q[0], q[1], q[2], q[1], q[4], q[5], q[2], q[5], q[7];
+        double scale = a.trace() / 3;
+        if (scale <= 0 ||
+            std::abs(a.determinant()) <= 1e-9 * scale * scale * scale)
+        {
+          return false;
+        }
+
+        p = a.inverse() * Eigen::Vector3d(-q[3], -q[6], -q[8]);
+        return true;
+      }
+    };
+
+    /** A potential collapse of vertex u into vertex v */
+    struct Collapse
+    {
+      double cost;
+      double error;
+      std::uint32_t v;
+      std::uint32_t u;
+      Eigen::Vector3d position;
+      float t;
+
+      bool operator<(const Collapse& other) const
+      {
+        return cost < other.cost;
+      }
+    };
+
+    /** Working state of the simplification */
+    class Simplifier
+    {
+    public:
+      Simplifier(
+        const ConstVectorBufferRef& positions,
+        const ConstTriangleBufferRef& triangles)
+      : m_positions(positions.cast<double>()), m_triangles(triangles)
+      {
+        m_quadrics.resize(m_positions.rows());
+        m_surface_quadrics.resize(m_positions.rows());
+        this->build_adjacency();
+        this->compute_quadrics();
+      }
+
+      const TriangleBuffer& triangles() const
+      {
+        return m_triangles;
+      }
+
+      const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>&
+      positions() const
+      {
+        return m_positions;
+      }
+
+      /** Runs a single pass of independent collapses.
+       *  \param target the target triangle count
+       *  \param max_error the maximum squared distance of a collapsed vertex
+       *                   from the planes of the faces it replaces
+       *  \param collapses receives the collapses which were applied
+       *  \return whether any collapses were applied
+       */
+      bool pass(
+        Eigen::Index target,
+        double max_error,
+        std::vector<Collapse>& collapses)
+      {
+        std::vector<Collapse> candidates = this->find_candidates(max_error);
+        std::sort(candidates.begin(), candidates.end());
+
+        // greedily select collapses whose neighbourhoods do not overlap, so
+        // that they can be validated and applied independently
+        std::vector<std::uint8_t> locked(m_positions.rows(), 0);
+        Eigen::Index num_triangles = m_triangles.rows();
+        collapses.clear();
+        for (const auto& candidate : candidates)
+        {
+          if (num_triangles <= target)
+          {
+            break;
+          }
+
+          if (locked[candidate.v] || locked[candidate.u])
+          {
+            continue;
+          }
+
+          collapses.push_back(candidate);
+          for (auto vertex : {candidate.v, candidate.u})
+          {
+            for (auto i = m_offsets[vertex]; i < m_offsets[vertex + 1]; ++i)
+            {
+              const auto& triangle = m_triangles.row(m_faces[i]);
+              locked[triangle(0)] = locked[triangle(1)] = locked[triangle(2)] =
+                1;
+            }
+          }
+
+          num_triangles -= this->shared_face_count(candidate.v, candidate.u);
+        }
+
+        if (collapses.empty())
+        {
+          return false;
+        }
+
+        std::vector<std::uint8_t> removed(m_triangles.rows(), 0);
+        parallel_for(
+          0,
+          static_cast<std::ptrdiff_t>(collapses.size()),
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+            for (auto i = begin; i < end; ++i)
+            {
+              this->apply(collapses[i], removed);
+            }
+          },
+          256);
+
+        Eigen::Index count = 0;
+        for (Eigen::Index i = 0; i < m_triangles.rows(); ++i)
+        {
+          if (!removed[i])
+          {
+            m_triangles.row(count++) = m_triangles.row(i);
+          }
+        }
+
+        m_triangles.conservativeResize(count, Eigen::NoChange);
+        this->build_adjacency();
+        return true;
+      }
+
+    private:
+      void build_adjacency()
+      {
+        Eigen::Index num_vertices = m_positions.rows();
+        m_offsets.assign(num_vertices + 1, 0);
+        for (Eigen::Index i = 0; i < m_triangles.size(); ++i)
+        {
+          m_offsets[m_triangles.data()[i] + 1] += 1;
+        }
+
+        for (Eigen::Index i = 0; i < num_vertices; ++i)
+        {
+          m_offsets[i + 1] += m_offsets[i];
+        }
+
+        m_faces.resize(m_offsets.back());
+        std::vector<std::uint32_t> cursor(
+          m_offsets.begin(), m_offsets.end() - 1);
+        for (Eigen::Index f = 0; f < m_triangles.rows(); ++f)
+        {
+          for (int c = 0; c < 3; ++c)
+          {
+            auto vertex = m_triangles(f, c);
+            m_faces[cursor[vertex]++] = static_cast<std::uint32_t>(f);
+          }
+        }
+      }
+
+      Eigen::Vector3d face_normal(
+        std::uint32_t face,
+        std::uint32_t moved = std::numeric_limits<std::uint32_t>::max(),
+        const Eigen::Vector3d& position = Eigen::Vector3d::Zero()) const
+      {
+        std::array<Eigen::Vector3d, 3> p;
+        for (int c = 0; c < 3; ++c)
+        {
+          auto vertex = m_triangles(face, c);
+          p[c] = vertex == moved ? position
+                                 : Eigen::Vector3d(m_positions.row(vertex));
+        }
+
+        return (p[1] - p[0]).cross(p[2] - p[0]);
+      }
+
+      void compute_quadrics()
+      {
+        parallel_for(
+          0,
+          m_positions.rows(),
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+            for (auto v = begin; v < end; ++v)
+            {
+              Quadric quadric;
+              Quadric surface_quadric;
+              for (auto i = m_offsets[v]; i < m_offsets[v + 1]; ++i)
+              {
+                Eigen::Vector3d normal = this->face_normal(m_faces[i]);
+                if (normal.squaredNorm() == 0)
+                {
+                  continue;
+                }
+
+                normal.normalize();
+                double offset = -normal.dot(m_positions.row(v));
+                quadric += Quadric(normal, offset, 1.0);
+                surface_quadric += Quadric(normal, offset, 1.0);
+
+                // edges with a single face are on the boundary
+                for (int c = 0; c < 3; ++c)
+                {
+                  auto u = m_triangles(m_faces[i], c);
+                  if (u == v || this->shared_face_count(v, u) != 1)
+                  {
+                    continue;
+                  }
+
+                  Eigen::Vector3d edge =
+                    m_positions.row(u) - m_positions.row(v);
+                  Eigen::Vector3d plane = edge.cross(normal);
+                  if (plane.squaredNorm() == 0)
+                  {
+                    continue;
+                  }
+
+                  plane.normalize();
+                  offset = -plane.dot(m_positions.row(v));
+                  quadric += Quadric(plane, offset, BOUNDARY_WEIGHT);
+                }
+              }
+
+              m_quadrics[v] = quadric;
+              m_surface_quadrics[v] = surface_quadric;
+            }
+          });
+      }
+
+      int shared_face_count(std::uint32_t v, std::uint32_t u) const
+      {
+        int count = 0;
+        for (auto i = m_offsets[v]; i < m_offsets[v + 1]; ++i)
+        {
+          const auto& triangle = m_triangles.row(m_faces[i]);
+          if (triangle(0) == u || triangle(1) == u || triangle(2) == u)
+          {
+            count += 1;
+          }
+        }
+
+        return count;
+      }
+
+      void neighbors(std::uint32_t v, std::vector<std::uint32_t>& result) const
+      {
+        result.clear();
+        for (auto i = m_offsets[v]; i < m_offsets[v + 1]; ++i)
+        {
+          for (int c = 0; c < 3; ++c)
+          {
+            auto u = m_triangles(m_faces[i], c);
+            if (u != v)
+            {
+              result.push_back(u);
+            }
+          }
+        }
+
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+      }
+
+      /** Whether moving a vertex to a new position would fold any of the
+       *  faces which survive the collapse.
+       */
+      bool flips(
+        std::uint32_t moved,
+        std::uint32_t other,
+        const Eigen::Vector3d& position) const
+      {
+        for (auto i = m_offsets[moved]; i < m_offsets[moved + 1]; ++i)
+        {
+          auto face = m_faces[i];
+          const auto& triangle = m_triangles.row(face);
+          if (triangle(0) == other || triangle(1) == other ||
+              triangle(2) == other)
+          {
+            continue;
+          }
+
+          Eigen::Vector3d before = this->face_normal(face);
+          Eigen::Vector3d after = this->face_normal(face, moved, position);
+          double norms = before.norm() * after.norm();
+          if (norms == 0 || before.dot(after) < MIN_NORMAL_DOT * norms)
+          {
+            return true;
+          }
+        }
+
+        return false;
+      }
+
+      bool evaluate(
+        std::uint32_t v,
+        std::uint32_t u,
+        const std::vector<std::uint32_t>& v_neighbors,
+        std::vector<std::uint32_t>& u_neighbors,
+        Collapse& collapse) const
+      {
+        // link condition: the only vertices shared by both one-rings must be
+        // those opposite the edge, otherwise the collapse is non-manifold
+        this->neighbors(u, u_neighbors);
+        std::ptrdiff_t common = 0;
+        auto it = v_neighbors.begin();
+        auto jt = u_neighbors.cbegin();
+        while (it != v_neighbors.end() && jt != u_neighbors.cend())
+        {
+          if (*it < *jt)
+          {
+            ++it;
+          }
+          else if (*jt < *it)
+          {
+            ++jt;
+          }
+          else
+          {
+            common += 1;
+            ++it;
+            ++jt;
+          }
+        }
+
+        if (common != this->shared_face_count(v, u))
+        {
+          return false;
+        }
+
+        Quadric quadric = m_quadrics[v];
+        quadric += m_quadrics[u];
+
+        Eigen::Vector3d p0 = m_positions.row(v);
+        Eigen::Vector3d p1 = m_positions.row(u);
+        Eigen::Vector3d edge = p1 - p0;
+        double length2 = edge.squaredNorm();
+
+        std::array<Eigen::Vector3d, 4> options = {
+          p0, p1, 0.5 * (p0 + p1), Eigen::Vector3d::Zero()};
+        std::size_t num_options = 3;
+        Eigen::Vector3d optimal;
+        if (quadric.optimize(optimal) &&
+            (optimal - options[2]).squaredNorm() <= 4 * length2)
+        {
+          options[3] = optimal;
+          num_options = 4;
+        }
+
+        collapse.cost = std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i < num_options; ++i)
+        {
+          double cost = quadric.error(options[i]);
+          if (cost < collapse.cost)
+          {
+            collapse.cost = cost;
+            collapse.position = options[i];
+          }
+        }
+
+        collapse.cost = std::max(collapse.cost, 0.0);
+
+        // the boundary planes only steer the choice of position, so the
+        // error is measured against the face planes alone. As a sum of
+        // squared distances it bounds the distance to each of the planes.
+        Quadric surface_quadric = m_surface_quadrics[v];
+        surface_quadric += m_surface_quadrics[u];
+        collapse.error =
+          std::max(surface_quadric.error(collapse.position), 0.0);
+        collapse.v = v;
+        collapse.u = u;
+        collapse.t = 0;
+        if (length2 > 0)
+        {
+          double t = (collapse.position - p0).dot(edge) / length2;
+          collapse.t = static_cast<float>(std::min(std::max(t, 0.0), 1.0));
+        }
+
+        return !this->flips(v, u, collapse.position) &&
+          !this->flips(u, v, collapse.position);
+      }
+
+      std::vector<Collapse> find_candidates(double max_error) const
+      {
+        std::ptrdiff_t num_vertices = m_positions.rows();
+        std::ptrdiff_t min_chunk = 1024;
+        std::vector<std::vector<Collapse>> chunks(
+          std::max<std::ptrdiff_t>(
+            parallel_chunk_count(num_vertices, min_chunk), 1));
+        parallel_for(
+          0,
+          num_vertices,
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+            std::vector<std::uint32_t> v_neighbors;
+            std::vector<std::uint32_t> u_neighbors;
+            Collapse collapse;
+            for (auto v = begin; v < end; ++v)
+            {
+              auto vertex = static_cast<std::uint32_t>(v);
+              this->neighbors(vertex, v_neighbors);
+              for (auto u : v_neighbors)
+              {
+                if (u > vertex &&
+                    this->evaluate(
+                      vertex, u, v_neighbors, u_neighbors, collapse) &&
+                    collapse.error <= max_error)
+                {
+                  chunks[chunk].push_back(collapse);
+                }
+              }
+            }
+          },
+          min_chunk);
+
+        std::vector<Collapse> candidates;
+        for (auto& chunk : chunks)
+        {
+          candidates.insert(candidates.end(), chunk.begin(), chunk.end());
+        }
+
+        return candidates;
+      }
+
+      void apply(const Collapse& collapse, std::vector<std::uint8_t>& removed)
+      {
+        m_positions.row(collapse.v) = collapse.position;
+        m_quadrics[collapse.v] += m_quadrics[collapse.u];
+        m_surface_quadrics[collapse.v] += m_surface_quadrics[collapse.u];
+        for (auto i = m_offsets[collapse.u]; i < m_offsets[collapse.u + 1]; ++i)
+        {
+          auto face = m_faces[i];
+          for (int c = 0; c < 3; ++c)
+          {
+            if (m_triangles(face, c) == collapse.v)
+            {
+              removed[face] = 1;
+            }
+            else if (m_triangles(face, c) == collapse.u)
+            {
+              m_triangles(face, c) = collapse.v;
+            }
+          }
+        }
+      }
+
+      Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> m_positions;
+      TriangleBuffer m_triangles;
+      std::vector<Quadric> m_quadrics;
+      std::vector<Quadric> m_surface_quadrics;
+      std::vector<std::uint32_t> m_offsets;
+      std::vector<std::uint32_t> m_faces;
+    };
+
+    template<typename Buffer>
+    void interpolate_rows(
+      Buffer& buffer, const std::vector<Collapse>& collapses, bool normalize)
+    {
+      for (const auto& collapse : collapses)
+      {
+        buffer.row(collapse.v) = (1 - collapse.t) * buffer.row(collapse.v) +
+          collapse.t * buffer.row(collapse.u);
+        if (normalize)
+        {
+          buffer.row(collapse.v).normalize();
+        }
+      }
+    }
+
+    template<typename Buffer>
+    Buffer
+    gather_rows(const Buffer& buffer, const std::vector<std::uint32_t>& rows)
+    {
+      Buffer result(rows.size(), buffer.cols());
+      for (std::size_t i = 0; i < rows.size(); ++i)
+      {
+        result.row(i) = buffer.row(rows[i]);
+      }
+
+      return result;
+    }
+  } // namespace
+
+  std::shared_ptr<MeshInfo>
+  MeshInfo::simplify(std::size_t target_triangle_count, float max_error) const
+  {
+    if (max_error < 0)
+    {
+      throw std::invalid_argument("max_error must be non-negative");
+    }
+
+    double max_squared_error = std::numeric_limits<double>::infinity();
+    if (std::isfinite(max_error) && m_position_buffer.rows() > 0)
+    {
+      Vector extent = m_position_buffer.colwise().maxCoeff() -
+        m_position_buffer.colwise().minCoeff();
+      double distance = static_cast<double>(max_error) * extent.norm();
+      max_squared_error = distance * distance;
+    }
+
+    bool has_uvs = m_uv_buffer.size();
+    bool has_color = m_color_buffer.size();
+    bool has_normals = m_normal_buffer.size();
+
+    VectorBuffer normals = m_normal_buffer;
+    ColorBuffer colors = m_color_buffer;
+    UVBuffer uvs = m_uv_buffer;
+
+    Eigen::Index target = static_cast<Eigen::Index>(target_triangle_count);
+    Simplifier simplifier(m_position_buffer, m_triangle_buffer);
+    std::vector<Collapse> collapses;
+    while (simplifier.triangles().rows() > target &&
+           simplifier.pass(target, max_squared_error, collapses))
+    {
+      if (has_normals)
+      {
+        interpolate_rows(normals, collapses, true);
+      }
+
+      if (has_color)
+      {
+        interpolate_rows(colors, collapses, false);
+      }
+
+      if (has_uvs)
+      {
+        interpolate_rows(uvs, collapses, false);
+      }
+    }
+
+    // remove the vertices which are no longer referenced
+    const TriangleBuffer& triangles = simplifier.triangles();
+    std::vector<std::uint32_t> index(m_position_buffer.rows(), 0);
+    for (Eigen::Index i = 0; i < triangles.size(); ++i)
+    {
+      index[triangles.data()[i]] = 1;
+    }
+
+    std::vector<std::uint32_t> rows;
+    for (std::size_t i = 0; i < index.size(); ++i)
+    {
+      if (index[i])
+      {
+        index[i] = static_cast<std::uint32_t>(rows.size());
+        rows.push_back(static_cast<std::uint32_t>(i));
+      }
+    }
+
+    auto simplified = std::make_shared<MeshInfo>(
+      rows.size(), triangles.rows(), has_uvs, has_normals, has_color);
+    VectorBuffer positions = simplifier.positions().cast<float>();
+    simplified->m_position_buffer = gather_rows(positions, rows);
+    for (Eigen::Index i = 0; i < triangles.size(); ++i)
+    {
+      simplified->m_triangle_buffer.data()[i] = index[triangles.data()[i]];
+    }
+
+    if (has_normals)
+    {
+      simplified->m_normal_buffer = gather_rows(normals, rows);
+    }
+
+    if (has_color)
+    {
+      simplified->m_color_buffer = gather_rows(colors, rows);
+    }
+
+    if (has_uvs)
+    {
+      simplified->m_uv_buffer = gather_rows(uvs, rows);
+    }
+
+    return simplified;
+  }
+} // namespace scenepic
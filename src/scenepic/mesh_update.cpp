@@ -4,6 +4,7 @@
 #include "mesh_update.h"
 
 #include "base64.h"
+#include "packing.h"
 #include "util.h"
 
 namespace
@@ -25,7 +26,9 @@ namespace scenepic
     m_frame_index(frame_index),
     m_min(0),
     m_max(0),
-    m_keyframe_index(NO_KEYFRAME)
+    m_keyframe_index(NO_KEYFRAME),
+    m_packed_normals(0),
+    m_packed_colors(false)
   {
     m_update_flags = VertexBufferType::None;
     Eigen::Index num_columns = 0;
@@ -78,6 +81,16 @@ namespace scenepic
     return m_mesh_id;
   }
 
+  std::uint32_t MeshUpdate::packed_normals() const
+  {
+    return m_packed_normals;
+  }
+
+  bool MeshUpdate::packed_colors() const
+  {
+    return m_packed_colors;
+  }
+
   VertexBufferRef MeshUpdate::vertex_buffer()
   {
     return VertexBufferRef(m_vertex_buffer);
@@ -141,12 +154,78 @@ namespace scenepic
     }
     else
     {
-      obj["VertexBuffer"] = matrix_to_json(m_vertex_buffer);
+      this->add_vertex_buffers(obj);
     }
 
     return obj;
   }
 
+  void MeshUpdate::add_vertex_buffers(JsonValue& obj) const
+  {
+    auto has_flag = [&](VertexBufferType flag) {
+      return (m_update_flags & flag) != VertexBufferType::None;
+    };
+
+    bool has_packed_normals =
+      m_packed_normals > 0 && has_flag(VertexBufferType::Normals);
+    bool has_packed_colors =
+      m_packed_colors && has_flag(VertexBufferType::Colors);
+    if (!has_packed_normals && !has_packed_colors)
+    {
+      obj["VertexBuffer"] = matrix_to_json(m_vertex_buffer);
+      return;
+    }
+
+    // columns are ordered [positions, normals | rotations, colors]
+    Eigen::Index num_leading_cols = 0;
+    num_leading_cols += has_flag(VertexBufferType::Positions) ? 3 : 0;
+    num_leading_cols += has_flag(VertexBufferType::Rotations) ? 4 : 0;
+
+    Eigen::Index num_cols = m_vertex_buffer.cols();
+    num_cols -= has_packed_normals ? 3 : 0;
+    num_cols -= has_packed_colors ? 3 : 0;
+    VertexBuffer vertices(m_vertex_buffer.rows(), num_cols);
+    vertices.leftCols(num_leading_cols) =
+      m_vertex_buffer.leftCols(num_leading_cols);
+
+    Eigen::Index col = num_leading_cols;
+    Eigen::Index src_col = num_leading_cols;
+    if (has_flag(VertexBufferType::Normals))
+    {
+      if (has_packed_normals)
+      {
+        obj["NormalPacking"] = normal_packing_name(m_packed_normals);
+        obj["PackedNormalBuffer"] = packed_normals_to_json(
+          m_vertex_buffer.middleCols(src_col, 3), m_packed_normals);
+      }
+      else
+      {
+        vertices.middleCols(col, 3) = m_vertex_buffer.middleCols(src_col, 3);
+        col += 3;
+      }
+
+      src_col += 3;
+    }
+
+    if (has_flag(VertexBufferType::Colors))
+    {
+      if (has_packed_colors)
+      {
+        obj["PackedColorBuffer"] =
+          matrix_to_json(pack_colors(m_vertex_buffer.middleCols(src_col, 3)));
+      }
+      else
+      {
+        vertices.middleCols(col, 3) = m_vertex_buffer.middleCols(src_col, 3);
+      }
+    }
+
+    if (num_cols > 0)
+    {
+      obj["VertexBuffer"] = matrix_to_json(vertices);
+    }
+  }
+
   std::uint32_t MeshUpdate::frame_index() const
   {
     return m_frame_index;
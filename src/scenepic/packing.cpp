@@ -0,0 +1,356 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "packing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+  /** Octahedral encoding (Cigolle et al. 2014). All of the work is done
+   *  column-wise on contiguous arrays so that Eigen can vectorize it.
+   */
+  template<typename Packed>
+  Packed pack_normals(const scenepic::ConstVectorBufferRef& normals)
+  {
+    typedef typename Packed::Scalar Scalar;
+    const float scale = static_cast<float>(std::numeric_limits<Scalar>::max());
+
+    Eigen::ArrayXf x = normals.col(0);
+    Eigen::ArrayXf y = normals.col(1);
+    Eigen::ArrayXf z = normals.col(2);
+    Eigen::ArrayXf l1 = x.abs() + y.abs() + z.abs();
+    l1 = (l1 > 0.0f).select(l1, 1.0f);
+    x /= l1;
+    y /= l1;
+
+    // fold the lower hemisphere over the diagonals
+    Eigen::ArrayXf sx = (x >= 0.0f).cast<float>() * 2.0f - 1.0f;
+    Eigen::ArrayXf sy = (y >= 0.0f).cast<float>() * 2.0f - 1.0f;
+    Eigen::ArrayXf u = (z < 0.0f).select((1.0f - y.abs()) * sx, x);
+    Eigen::ArrayXf v = (z < 0.0f).select((1.0f - x.abs()) * sy, y);
+
+    Packed packed(normals.rows(), 2);
+    packed.col(0) = (u.max(-1.0f).min(1.0f) * scale).round().cast<Scalar>();
+    packed.col(1) = (v.max(-1.0f).min(1.0f) * scale).round().cast<Scalar>();
+    return packed;
+  }
+
+  template<typename Packed>
+  scenepic::VectorBuffer unpack_normals(const Packed& packed)
+  {
+    typedef typename Packed::Scalar Scalar;
+    const float scale = static_cast<float>(std::numeric_limits<Scalar>::max());
+
+    Eigen::ArrayXf x = packed.col(0).template cast<float>() / scale;
+    Eigen::ArrayXf y = packed.col(1).template cast<float>() / scale;
+    x = x.max(-1.0f).min(1.0f);
+    y = y.max(-1.0f).min(1.0f);
+    Eigen::ArrayXf z = 1.0f - x.abs() - y.abs();
+
+    // unfold the lower hemisphere
+    Eigen::ArrayXf t = (-z).max(0.0f);
+    Eigen::ArrayXf sx = (x >= 0.0f).cast<float>() * 2.0f - 1.0f;
+    Eigen::ArrayXf sy = (y >= 0.0f).cast<float>() * 2.0f - 1.0f;
+    x -= sx * t;
+    y -= sy * t;
+
+    scenepic::VectorBuffer normals(packed.rows(), 3);
+    normals.col(0) = x.matrix();
+    normals.col(1) = y.matrix();
+    normals.col(2) = z.matrix();
+    normals.rowwise().normalize();
+    return normals;
+  }
+} // namespace
+
+namespace scenepic
+{
+  PackedNormalShortBuffer
+  pack_normals_oct16(const ConstVectorBufferRef& normals)
+  {
+    return pack_normals<PackedNormalShortBuffer>(normals);
+  }
+
+  PackedNormalByteBuffer pack_normals_oct8(const ConstVectorBufferRef& normals)
+  {
+    return pack_normals<PackedNormalByteBuffer>(normals);
+  }
+
+  VectorBuffer unpack_normals(const PackedNormalShortBuffer& packed)
+  {
+    return ::unpack_normals(packed);
+  }
+
+  VectorBuffer unpack_normals(const PackedNormalByteBuffer& packed)
+  {
+    return ::unpack_normals(packed);
+  }
+
+  PackedColorBuffer pack_colors(const ConstColorBufferRef& colors)
+  {
+    PackedColorBuffer packed = (colors.array().max(0.0f).min(1.0f) * 255.0f)
+                                 .round()
+                                 .cast<std::uint8_t>();
+    return packed;
+  }
+
+  ColorBuffer unpack_colors(const PackedColorBuffer& packed)
+  {
+    ColorBuffer colors = packed.cast<float>() / 255.0f;
+    return colors;
+  }
+
+  HalfBuffer pack_half(const ConstValueBufferRef& values)
+  {
+    HalfBuffer packed(values.size());
+    for (Eigen::Index i = 0; i < values.size(); ++i)
+    {
+      std::uint32_t bits;
+      float value = values(i);
+      std::memcpy(&bits, &value, sizeof(bits));
+      auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000);
+      std::uint32_t exponent = (bits >> 23) & 0xff;
+      std::uint32_t mantissa = bits & 0x7fffff;
+      if (exponent == 0xff)
+      {
+        // infinities keep their sign, and NaNs stay NaNs
+        packed(i) = sign | 0x7c00 | (mantissa ? 0x200 : 0);
+        continue;
+      }
+
+      int half_exponent = static_cast<int>(exponent) - 127 + 15;
+      if (half_exponent >= 0x1f)
+      {
+        packed(i) = sign | 0x7c00;
+        continue;
+      }
+
+      int shift = 13;
+      if (half_exponent <= 0)
+      {
+        // subnormal halves hold the implicit leading bit in the mantissa
+        if (half_exponent < -10)
+        {
+          packed(i) = sign;
+          continue;
+        }
+
+        mantissa |= 0x800000;
+        shift = 14 - half_exponent;
+        half_exponent = 0;
+      }
+
+      // round to nearest, ties to even. A carry out of the mantissa
+      // correctly moves on to the next exponent.
+      std::uint32_t half = (static_cast<std::uint32_t>(half_exponent) << 10) +
+                           (mantissa >> shift);
+      std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+      std::uint32_t halfway = 1u << (shift - 1);
+      if (remainder > halfway || (remainder == halfway && (half & 1)))
+      {
+        half += 1;
+      }
+
+      packed(i) = sign | static_cast<std::uint16_t>(half);
+    }
+
+    return packed;
+  }
+
+  ValueBuffer unpack_half(const HalfBuffer& packed)
+  {
+    ValueBuffer values(packed.size());
+    for (Eigen::Index i = 0; i < packed.size(); ++i)
+    {
+      std::uint16_t half = packed(i);
+      float sign = (half & 0x8000) ? -1.0f : 1.0f;
+      int exponent = (half >> 10) & 0x1f;
+      float mantissa = static_cast<float>(half & 0x3ff);
+      if (exponent == 0x1f)
+      {
+        values(i) = mantissa > 0
+                      ? std::numeric_limits<float>::quiet_NaN()
+                      : sign * std::numeric_limits<float>::infinity();
+      }
+      else if (exponent == 0)
+      {
+        values(i) = sign * std::ldexp(mantissa, -24);
+      }
+      else
+      {
+        values(i) = sign * std::ldexp(mantissa + 1024.0f, exponent - 25);
+      }
+    }
+
+    return values;
+  }
+
+  std::string normal_packing_name(std::uint32_t bits)
+  {
+    check_normal_packing(bits);
+    switch (bits)
+    {
+      case 8:
+        return "OctInt8";
+
+      case 16:
+        return "OctInt16";
+
+      default:
+        return "Float32";
+    }
+  }
+
+  std::string packed_normals_to_json(
+    const ConstVectorBufferRef& normals, std::uint32_t bits)
+  {
+    check_normal_packing(bits);
+    if (bits == 8)
+    {
+      return matrix_to_json(pack_normals_oct8(normals));
+    }
+
+    if (bits == 16)
+    {
+      return matrix_to_json(pack_normals_oct16(normals));
+    }
+
+    throw std::invalid_argument("Normals must be packed using 8 or 16 bits");
+  }
+
+  void check_normal_packing(std::uint32_t bits)
+  {
+    if (bits != 0 && bits != 8 && bits != 16)
+    {
+      throw std::invalid_argument(
+        "Normal packing must use 0 (no packing), 8, or 16 bits");
+    }
+  }
+
+  DeltaBuffer delta_encode(
+    const ConstVertexBufferRef& values, const std::vector<float>& steps)
+  {
+    if (static_cast<Eigen::Index>(steps.size()) != values.cols())
+    {
+      throw std::invalid_argument("Expected one quantization step per column");
+    }
+
+    // quantized values beyond this range could overflow the second order
+    // deltas chosen by deltas_to_json
+    const double max_quantized = std::numeric_limits<std::int32_t>::max() / 4;
+    DeltaBuffer deltas(values.cols(), values.rows());
+    for (Eigen::Index col = 0; col < values.cols(); ++col)
+    {
+      if (!(steps[col] > 0))
+      {
+        throw std::invalid_argument("Quantization steps must be positive");
+      }
+
+      std::int32_t previous = 0;
+      for (Eigen::Index row = 0; row < values.rows(); ++row)
+      {
+        double quantized = std::round(values(row, col) / double(steps[col]));
+        if (!(std::abs(quantized) <= max_quantized))
+        {
+          throw std::invalid_argument(
+            "Value is too large (or not finite) for its quantization step");
+        }
+
+        std::int32_t current = static_cast<std::int32_t>(quantized);
+        deltas(col, row) = current - previous;
+        previous = current;
+      }
+    }
+
+    return deltas;
+  }
+
+  VertexBuffer
+  delta_decode(const DeltaBuffer& deltas, const std::vector<float>& steps)
+  {
+    VertexBuffer values(deltas.cols(), deltas.rows());
+    for (Eigen::Index col = 0; col < deltas.rows(); ++col)
+    {
+      std::int32_t current = 0;
+      for (Eigen::Index row = 0; row < deltas.cols(); ++row)
+      {
+        current += deltas(col, row);
+        values(row, col) = static_cast<float>(current * double(steps[col]));
+      }
+    }
+
+    return values;
+  }
+
+  void deltas_to_json(
+    const DeltaBuffer& deltas,
+    const std::vector<float>& steps,
+    JsonValue& obj)
+  {
+    typedef Eigen::Matrix<std::int32_t, Eigen::Dynamic, 1> FlatDeltas;
+
+    obj["Steps"].resize(0);
+    obj["Origin"].resize(0);
+    for (Eigen::Index col = 0; col < deltas.rows(); ++col)
+    {
+      obj["Steps"].append(static_cast<double>(steps[col]));
+      obj["Origin"].append(
+        static_cast<std::int64_t>(deltas.cols() ? deltas(col, 0) : 0));
+    }
+
+    // the first values are usually far larger than the deltas, so they are
+    // sent separately and the remaining deltas are flattened column by column
+    Eigen::Index num_rest = std::max<Eigen::Index>(deltas.cols() - 1, 0);
+    DeltaBuffer rest = deltas.rightCols(num_rest);
+
+    // smooth motion has nearly constant deltas, so differencing them again
+    // leaves mostly zeros. Noisy values get larger, so keep whichever is
+    // smaller overall.
+    DeltaBuffer second = rest;
+    if (num_rest > 1)
+    {
+      second.rightCols(num_rest - 1) -= rest.leftCols(num_rest - 1);
+    }
+
+    auto magnitude = [](const DeltaBuffer& buffer) {
+      return buffer.cast<std::int64_t>().cwiseAbs().sum();
+    };
+
+    std::int64_t order = 1;
+    if (magnitude(second) < magnitude(rest))
+    {
+      rest.swap(second);
+      order = 2;
+    }
+
+    obj["DeltaOrder"] = order;
+    FlatDeltas flat = Eigen::Map<const FlatDeltas>(rest.data(), rest.size());
+    std::int32_t max_magnitude = 0;
+    if (flat.size())
+    {
+      max_magnitude = std::max(flat.maxCoeff(), -flat.minCoeff());
+    }
+
+    if (max_magnitude <= std::numeric_limits<std::int8_t>::max())
+    {
+      obj["DeltaType"] = "Int8";
+      obj["DeltaBuffer"] = matrix_to_json(flat.cast<std::int8_t>().eval());
+    }
+    else if (max_magnitude <= std::numeric_limits<std::int16_t>::max())
+    {
+      obj["DeltaType"] = "Int16";
+      obj["DeltaBuffer"] = matrix_to_json(flat.cast<std::int16_t>().eval());
+    }
+    else
+    {
+      obj["DeltaType"] = "Int32";
+      obj["DeltaBuffer"] = matrix_to_json(flat);
+    }
+  }
+} // namespace scenepic
@@ -0,0 +1,730 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/** Binary PLY reading and writing (see io.h) */
+
+#include "io.h"
+#include "mapped_file.h"
+#include "mesh_info.h"
+#include "parallel.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using scenepic::MeshInfo;
+
+  /** Vertices are read (and their pages released) in chunks of this size. */
+  const std::size_t VERTEX_CHUNK = 1 << 20;
+
+  enum class PlyType
+  {
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Float32,
+    Float64
+  };
+
+  struct PlyProperty
+  {
+    std::string name;
+    PlyType type;
+    bool is_list;
+    PlyType count_type;
+    std::size_t offset;
+  };
+
+  struct PlyElement
+  {
+    std::string name;
+    std::size_t count;
+    std::vector<PlyProperty> properties;
+    bool has_lists;
+    std::size_t stride;
+    const char* data;
+    const char* end;
+  };
+
+  PlyType parse_ply_type(const std::string& name)
+  {
+    if (name == "char" || name == "int8")
+    {
+      return PlyType::Int8;
+    }
+
+    if (name == "uchar" || name == "uint8")
+    {
+      return PlyType::UInt8;
+    }
+
+    if (name == "short" || name == "int16")
+    {
+      return PlyType::Int16;
+    }
+
+    if (name == "ushort" || name == "uint16")
+    {
+      return PlyType::UInt16;
+    }
+
+    if (name == "int" || name == "int32")
+    {
+      return PlyType::Int32;
+    }
+
+    if (name == "uint" || name == "uint32")
+    {
+      return PlyType::UInt32;
+    }
+
+    if (name == "float" || name == "float32")
+    {
+      return PlyType::Float32;
+    }
+
+    if (name == "double" || name == "float64")
+    {
+      return PlyType::Float64;
+    }
+
+    throw std::invalid_argument("Unknown PLY property type: " + name);
+  }
+
+  std::size_t ply_type_size(PlyType type)
+  {
+    switch (type)
+    {
+      case PlyType::Int8:
+      case PlyType::UInt8:
+        return 1;
+
+      case PlyType::Int16:
+      case PlyType::UInt16:
+        return 2;
+
+      case PlyType::Int32:
+      case PlyType::UInt32:
+      case PlyType::Float32:
+        return 4;
+
+      default:
+        return 8;
+    }
+  }
+
+  template<typename T>
+  T read_raw(const char* ptr)
+  {
+    T value;
+    std::memcpy(&value, ptr, sizeof(T));
+    return value;
+  }
+
+  double read_ply_value(const char* ptr, PlyType type)
+  {
+    switch (type)
+    {
+      case PlyType::Int8:
+        return read_raw<std::int8_t>(ptr);
+
+      case PlyType::UInt8:
+        return read_raw<std::uint8_t>(ptr);
+
+      case PlyType::Int16:
+        return read_raw<std::int16_t>(ptr);
+
+      case PlyType::UInt16:
+        return read_raw<std::uint16_t>(ptr);
+
+      case PlyType::Int32:
+        return read_raw<std::int32_t>(ptr);
+
+      case PlyType::UInt32:
+        return read_raw<std::uint32_t>(ptr);
+
+      case PlyType::Float32:
+        return read_raw<float>(ptr);
+
+      default:
+        return read_raw<double>(ptr);
+    }
+  }
+
+  /** Throws unless count values of the given size fit between ptr and end.
+   */
+  void check_remaining(
+    const char* ptr, const char* end, std::size_t count, std::size_t size)
+  {
+    if (size > 0 && count > static_cast<std::size_t>(end - ptr) / size)
+    {
+      throw std::invalid_argument("PLY file is truncated.");
+    }
+  }
+
+  /** Parses the header, returning the elements with their data located. */
+  std::vector<PlyElement> parse_ply_header(const char* data, std::size_t size)
+  {
+    const char* end = data + size;
+    const char* line_start = data;
+    std::vector<PlyElement> elements;
+    bool has_format = false;
+    std::size_t line_number = 0;
+    while (true)
+    {
+      const char* line_end = static_cast<const char*>(
+        std::memchr(line_start, '\n', end - line_start));
+      if (line_end == nullptr)
+      {
+        throw std::invalid_argument("Invalid PLY header.");
+      }
+
+      std::istringstream line(std::string(line_start, line_end));
+      line_start = line_end + 1;
+      std::string keyword;
+      line >> keyword;
+      if (line_number++ == 0)
+      {
+        if (keyword != "ply")
+        {
+          throw std::invalid_argument("Not a PLY file.");
+        }
+      }
+      else if (keyword == "format")
+      {
+        std::string format;
+        line >> format;
+        if (format != "binary_little_endian")
+        {
+          throw std::invalid_argument(
+            "Only binary_little_endian PLY files are supported.");
+        }
+
+        has_format = true;
+      }
+      else if (keyword == "element")
+      {
+        PlyElement element;
+        line >> element.name >> element.count;
+        element.has_lists = false;
+        element.stride = 0;
+        element.data = nullptr;
+        element.end = nullptr;
+        elements.push_back(element);
+      }
+      else if (keyword == "property")
+      {
+        if (elements.empty())
+        {
+          throw std::invalid_argument("PLY property outside of an element.");
+        }
+
+        PlyElement& element = elements.back();
+        PlyProperty property;
+        std::string type;
+        line >> type;
+        property.is_list = type == "list";
+        property.offset = element.stride;
+        if (property.is_list)
+        {
+          std::string count_type;
+          line >> count_type >> type;
+          property.count_type = parse_ply_type(count_type);
+          element.has_lists = true;
+        }
+
+        property.type = parse_ply_type(type);
+        line >> property.name;
+        element.stride += ply_type_size(property.type);
+        element.properties.push_back(property);
+      }
+      else if (keyword == "end_header")
+      {
+        break;
+      }
+    }
+
+    if (!has_format)
+    {
+      throw std::invalid_argument("PLY header is missing its format.");
+    }
+
+    // locate the data of each element, walking any lists
+    const char* ptr = line_start;
+    for (auto& element : elements)
+    {
+      element.data = ptr;
+      if (!element.has_lists)
+      {
+        check_remaining(ptr, end, element.count, element.stride);
+        ptr += element.stride * element.count;
+      }
+      else
+      {
+        for (std::size_t i = 0; i < element.count; ++i)
+        {
+          for (const auto& property : element.properties)
+          {
+            std::size_t count = 1;
+            if (property.is_list)
+            {
+              check_remaining(ptr, end, 1, ply_type_size(property.count_type));
+              count = static_cast<std::size_t>(
+                read_ply_value(ptr, property.count_type));
+              ptr += ply_type_size(property.count_type);
+            }
+
+            std::size_t size = ply_type_size(property.type);
+            check_remaining(ptr, end, count, size);
+            ptr += count * size;
+          }
+        }
+      }
+
+      element.end = ptr;
+    }
+
+    return elements;
+  }
+
+  const PlyProperty*
+  find_property(const PlyElement& element, const std::string& name)
+  {
+    for (const auto& property : element.properties)
+    {
+      if (property.name == name && !property.is_list)
+      {
+        return &property;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /** Finds the first complete set of named properties. */
+  template<std::size_t N>
+  std::vector<const PlyProperty*> find_properties(
+    const PlyElement& element,
+    const std::vector<std::array<const char*, N>>& alternatives)
+  {
+    for (const auto& names : alternatives)
+    {
+      std::vector<const PlyProperty*> properties;
+      for (const auto& name : names)
+      {
+        const PlyProperty* property = find_property(element, name);
+        if (property == nullptr)
+        {
+          break;
+        }
+
+        properties.push_back(property);
+      }
+
+      if (properties.size() == N)
+      {
+        return properties;
+      }
+    }
+
+    return {};
+  }
+
+  /** Copies vertex properties into the rows of a buffer, using a strided
+   *  Eigen::Map over the file when the layout allows it.
+   */
+  template<typename Buffer>
+  void read_columns(
+    const char* data,
+    std::size_t stride,
+    std::size_t count,
+    const std::vector<const PlyProperty*>& properties,
+    Buffer buffer,
+    double scale)
+  {
+    typedef Eigen::OuterStride<> Stride;
+    typedef Eigen::
+      Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        FloatMatrix;
+    typedef Eigen::
+      Matrix<std::uint8_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        ByteMatrix;
+
+    auto cols = static_cast<Eigen::Index>(properties.size());
+    auto rows = static_cast<Eigen::Index>(count);
+    bool contiguous = true;
+    for (std::size_t i = 1; i < properties.size(); ++i)
+    {
+      contiguous = contiguous && properties[i]->type == properties[0]->type &&
+        properties[i]->offset ==
+          properties[0]->offset + i * ply_type_size(properties[0]->type);
+    }
+
+    const char* start = data + properties[0]->offset;
+    bool aligned = reinterpret_cast<std::uintptr_t>(start) % 4 == 0;
+    if (
+      contiguous && aligned && stride % 4 == 0 &&
+      properties[0]->type == PlyType::Float32)
+    {
+      Eigen::Map<const FloatMatrix, Eigen::Unaligned, Stride> values(
+        reinterpret_cast<const float*>(start), rows, cols, Stride(stride / 4));
+      buffer = values * static_cast<float>(scale);
+    }
+    else if (contiguous && properties[0]->type == PlyType::UInt8)
+    {
+      Eigen::Map<const ByteMatrix, Eigen::Unaligned, Stride> values(
+        reinterpret_cast<const std::uint8_t*>(start),
+        rows,
+        cols,
+        Stride(stride));
+      buffer = values.cast<float>() * static_cast<float>(scale);
+    }
+    else
+    {
+      for (Eigen::Index row = 0; row < rows; ++row)
+      {
+        const char* vertex = data + row * stride;
+        for (Eigen::Index col = 0; col < cols; ++col)
+        {
+          const PlyProperty* property = properties[col];
+          buffer(row, col) = static_cast<float>(
+            read_ply_value(vertex + property->offset, property->type) * scale);
+        }
+      }
+    }
+  }
+
+  double color_scale(const PlyProperty* property)
+  {
+    switch (property->type)
+    {
+      case PlyType::UInt8:
+        return 1.0 / 255;
+
+      case PlyType::UInt16:
+        return 1.0 / 65535;
+
+      default:
+        return 1.0;
+    }
+  }
+
+  /** Reads the faces, triangulating polygons as fans. */
+  std::vector<std::uint32_t>
+  read_faces(const PlyElement& element, std::size_t num_vertices)
+  {
+    std::vector<std::uint32_t> triangles;
+    const PlyProperty* indices = nullptr;
+    for (const auto& property : element.properties)
+    {
+      if (
+        property.is_list &&
+        (property.name == "vertex_indices" || property.name == "vertex_index"))
+      {
+        indices = &property;
+      }
+    }
+
+    if (indices == nullptr)
+    {
+      throw std::invalid_argument("PLY faces have no vertex_indices.");
+    }
+
+    triangles.reserve(element.count * 3);
+    std::vector<std::uint32_t> polygon;
+    const char* ptr = element.data;
+    for (std::size_t face = 0; face < element.count; ++face)
+    {
+      for (const auto& property : element.properties)
+      {
+        std::size_t count = 1;
+        if (property.is_list)
+        {
+          check_remaining(
+            ptr, element.end, 1, ply_type_size(property.count_type));
+          count = static_cast<std::size_t>(
+            read_ply_value(ptr, property.count_type));
+          ptr += ply_type_size(property.count_type);
+        }
+
+        std::size_t size = ply_type_size(property.type);
+        check_remaining(ptr, element.end, count, size);
+        if (&property == indices)
+        {
+          polygon.resize(count);
+          for (std::size_t i = 0; i < count; ++i)
+          {
+            double index = read_ply_value(ptr + i * size, property.type);
+            if (index < 0 || index >= num_vertices)
+            {
+              throw std::invalid_argument("PLY face index out of range.");
+            }
+
+            polygon[i] = static_cast<std::uint32_t>(index);
+          }
+
+          for (std::size_t i = 1; i + 1 < count; ++i)
+          {
+            triangles.push_back(polygon[0]);
+            triangles.push_back(polygon[i]);
+            triangles.push_back(polygon[i + 1]);
+          }
+        }
+
+        ptr += count * size;
+      }
+    }
+
+    return triangles;
+  }
+
+  void
+  write_bytes(std::vector<char>& buffer, const void* value, std::size_t size)
+  {
+    const char* bytes = static_cast<const char*>(value);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  }
+} // namespace
+
+namespace scenepic
+{
+  std::shared_ptr<MeshInfo> load_ply(const std::string& path)
+  {
+    MappedFile file(path, true);
+    std::vector<PlyElement> elements =
+      parse_ply_header(file.data(), file.size());
+
+    auto vertex_it = std::find_if(
+      elements.begin(), elements.end(), [](const PlyElement& element) {
+        return element.name == "vertex";
+      });
+    if (vertex_it == elements.end() || vertex_it->has_lists)
+    {
+      throw std::invalid_argument("PLY file has no valid vertex element.");
+    }
+
+    const PlyElement& vertices = *vertex_it;
+    auto positions = find_properties<3>(vertices, {{"x", "y", "z"}});
+    auto normals = find_properties<3>(vertices, {{"nx", "ny", "nz"}});
+    auto colors = find_properties<3>(
+      vertices, {{"red", "green", "blue"}, {"r", "g", "b"}});
+    auto uvs = find_properties<2>(
+      vertices, {{"u", "v"}, {"s", "t"}, {"texture_u", "texture_v"}});
+    if (positions.empty())
+    {
+      throw std::invalid_argument("PLY vertices have no positions.");
+    }
+
+    // a MeshInfo cannot have both, and textured meshes rarely have colors
+    if (!uvs.empty())
+    {
+      colors.clear();
+    }
+
+    std::vector<std::uint32_t> triangles;
+    for (const auto& element : elements)
+    {
+      if (element.name == "face")
+      {
+        triangles = read_faces(element, vertices.count);
+      }
+    }
+
+    auto mesh_info = std::make_shared<MeshInfo>(
+      vertices.count,
+      triangles.size() / 3,
+      !uvs.empty(),
+      !normals.empty(),
+      !colors.empty());
+    std::copy(
+      triangles.begin(),
+      triangles.end(),
+      mesh_info->triangle_buffer().data());
+    std::vector<std::uint32_t>().swap(triangles);
+
+    // each chunk releases its pages once read, so that the file itself never
+    // needs to be resident in full
+    auto num_chunks = static_cast<std::ptrdiff_t>(
+      (vertices.count + VERTEX_CHUNK - 1) / VERTEX_CHUNK);
+    parallel_for(
+      0,
+      num_chunks,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+        for (auto chunk = begin; chunk < end; ++chunk)
+        {
+          std::size_t start = chunk * VERTEX_CHUNK;
+          std::size_t count = std::min(VERTEX_CHUNK, vertices.count - start);
+          auto rows = static_cast<Eigen::Index>(start);
+          auto num_rows = static_cast<Eigen::Index>(count);
+          const char* data = vertices.data + start * vertices.stride;
+          read_columns(
+            data,
+            vertices.stride,
+            count,
+            positions,
+            mesh_info->position_buffer().middleRows(rows, num_rows),
+            1.0);
+          if (!normals.empty())
+          {
+            read_columns(
+              data,
+              vertices.stride,
+              count,
+              normals,
+              mesh_info->normal_buffer().middleRows(rows, num_rows),
+              1.0);
+          }
+
+          if (!colors.empty())
+          {
+            read_columns(
+              data,
+              vertices.stride,
+              count,
+              colors,
+              mesh_info->color_buffer().middleRows(rows, num_rows),
+              color_scale(colors[0]));
+          }
+
+          if (!uvs.empty())
+          {
+            read_columns(
+              data,
+              vertices.stride,
+              count,
+              uvs,
+              mesh_info->uv_buffer().middleRows(rows, num_rows),
+              1.0);
+          }
+
+          file.release(
+            static_cast<std::size_t>(data - file.data()),
+            count * vertices.stride);
+        }
+      },
+      1);
+
+    return mesh_info;
+  }
+
+  void save_ply(
+    const std::string& path, const std::shared_ptr<MeshInfo>& mesh_info)
+  {
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream.is_open())
+    {
+      throw std::invalid_argument("Unable to open file.");
+    }
+
+    auto positions = mesh_info->position_buffer();
+    auto normals = mesh_info->normal_buffer();
+    auto colors = mesh_info->color_buffer();
+    auto uvs = mesh_info->uv_buffer();
+    auto triangles = mesh_info->triangle_buffer();
+    bool has_normals = normals.rows() > 0;
+    bool has_colors = colors.rows() > 0;
+    bool has_uvs = uvs.rows() > 0;
+
+    stream << "ply\n"
+           << "format binary_little_endian 1.0\n"
+           << "comment Created by ScenePic\n"
+           << "element vertex " << positions.rows() << "\n"
+           << "property float x\n"
+           << "property float y\n"
+           << "property float z\n";
+    if (has_normals)
+    {
+      stream << "property float nx\n"
+             << "property float ny\n"
+             << "property float nz\n";
+    }
+
+    if (has_colors)
+    {
+      stream << "property uchar red\n"
+             << "property uchar green\n"
+             << "property uchar blue\n";
+    }
+
+    if (has_uvs)
+    {
+      stream << "property float u\n"
+             << "property float v\n";
+    }
+
+    if (triangles.rows() > 0)
+    {
+      stream << "element face " << triangles.rows() << "\n"
+             << "property list uchar int vertex_indices\n";
+    }
+
+    stream << "end_header\n";
+
+    std::vector<char> buffer;
+    for (Eigen::Index start = 0; start < positions.rows();
+         start += VERTEX_CHUNK)
+    {
+      Eigen::Index end = std::min<Eigen::Index>(
+        start + VERTEX_CHUNK, positions.rows());
+      buffer.clear();
+      for (Eigen::Index i = start; i < end; ++i)
+      {
+        write_bytes(buffer, positions.row(i).data(), 3 * sizeof(float));
+        if (has_normals)
+        {
+          write_bytes(buffer, normals.row(i).data(), 3 * sizeof(float));
+        }
+
+        if (has_colors)
+        {
+          for (int c = 0; c < 3; ++c)
+          {
+            float value = std::min(std::max(colors(i, c), 0.0f), 1.0f);
+            auto byte = static_cast<std::uint8_t>(value * 255 + 0.5f);
+            write_bytes(buffer, &byte, 1);
+          }
+        }
+
+        if (has_uvs)
+        {
+          write_bytes(buffer, uvs.row(i).data(), 2 * sizeof(float));
+        }
+      }
+
+      stream.write(buffer.data(), buffer.size());
+    }
+
+    for (Eigen::Index start = 0; start < triangles.rows();
+         start += VERTEX_CHUNK)
+    {
+      Eigen::Index end = std::min<Eigen::Index>(
+        start + VERTEX_CHUNK, triangles.rows());
+      buffer.clear();
+      for (Eigen::Index i = start; i < end; ++i)
+      {
+        std::uint8_t count = 3;
+        write_bytes(buffer, &count, 1);
+        write_bytes(buffer, triangles.row(i).data(), 3 * sizeof(std::int32_t));
+      }
+
+      stream.write(buffer.data(), buffer.size());
+    }
+
+    if (!stream)
+    {
+      throw std::invalid_argument("Unable to write file.");
+    }
+  }
+} // namespace scenepic
@@ -528,6 +528,47 @@ PYBIND11_MODULE(_scenepic, m)
                 np.ndarray: a (S, 3) buffer of subdivided vertices
         )scenepicdoc",
       "vertices"_a)
+    .def(
+      "apply_batch",
+      py::overload_cast<const ConstVertexBufferRef>(
+        &LoopSubdivisionStencil::apply_batch, py::const_),
+      R"scenepicdoc(
+            Applies the stencil to several frames of vertices at once.
+
+            Args:
+                frames (np.ndarray): a (N, 3F) buffer holding F frames of vertices side by side,
+                                     such that frame f occupies columns 3f to 3f + 2.
+
+            Returns:
+                np.ndarray: a (S, 3F) buffer of subdivided frames in the same layout
+        )scenepicdoc",
+      "frames"_a)
+    .def(
+      "apply_batch",
+      py::overload_cast<
+        const ConstVertexBufferRef,
+        Scene&,
+        const std::string&>(&LoopSubdivisionStencil::apply_batch, py::const_),
+      R"scenepicdoc(
+            Applies the stencil to several frames of vertices and adds each subdivided frame to the
+            scene as an update of a base mesh.
+
+            Description:
+                The frames are subdivided a few at a time, so the full set of subdivided positions is
+                never held in memory.
+
+            Args:
+                frames (np.ndarray): a (N, 3F) buffer holding F frames of vertices side by side,
+                                     such that frame f occupies columns 3f to 3f + 2.
+                scene (Scene): the scene which will hold the mesh updates
+                base_mesh_id (str): the id of the subdivided base mesh
+
+            Returns:
+                List[MeshUpdate]: the mesh updates, one per frame
+        )scenepicdoc",
+      "frames"_a,
+      "scene"_a,
+      "base_mesh_id"_a)
     .def_property_readonly(
       "triangles",
       &LoopSubdivisionStencil::triangles,
@@ -557,7 +598,61 @@ PYBIND11_MODULE(_scenepic, m)
             )scenepicdoc",
       "triangles"_a,
       "steps"_a = 1,
-      "project_to_limit"_a = false);
+      "project_to_limit"_a = false)
+    .def_static(
+      "create_cached",
+      &LoopSubdivisionStencil::create_cached,
+      R"scenepicdoc(
+            Returns a stencil for the provided triangles, reusing a previous stencil if one was
+            created in this process for the same triangles and settings.
+
+            Description:
+                Stencils are found by a hash of the triangles, so meshes which share connectivity
+                share a stencil.
+
+            Args:
+                triangles (np.ndarray): the initial triangle indices
+                steps (int, optional): specifies how many steps of subdivision to apply. Defaults to 1.
+                project_to_limit (bool, optional): specifies whether the vertices should be projected onto the
+                                                   limit surface in the final step of subdivision. Defaults to false.
+
+            Return:
+                LoopSubdivisionStencil
+            )scenepicdoc",
+      "triangles"_a,
+      "steps"_a = 1,
+      "project_to_limit"_a = false)
+    .def_static(
+      "clear_cache",
+      &LoopSubdivisionStencil::clear_cache,
+      "Removes all stencils from the cache used by create_cached.")
+    .def(
+      "save",
+      &LoopSubdivisionStencil::save,
+      R"scenepicdoc(
+            Save the stencil to a binary file.
+
+            Description:
+                The file holds the subdivided triangles and the subdivision matrix as CSR arrays,
+                each aligned so that it can be used in place from a memory mapping.
+
+            Args:
+                path (str): the location of the file on disk
+        )scenepicdoc",
+      "path"_a)
+    .def_static(
+      "load",
+      &LoopSubdivisionStencil::load,
+      R"scenepicdoc(
+            Load a stencil from a file written by save.
+
+            Args:
+                path (str): the location of the file on disk
+
+            Returns:
+                LoopSubdivisionStencil: the stencil stored in the file
+        )scenepicdoc",
+      "path"_a);
 
   py::class_<MeshInfo, std::shared_ptr<MeshInfo>>(m, "MeshInfo", R"scenepicdoc(
         Class which holds information needed to construct a mesh object, like
@@ -603,7 +698,54 @@ PYBIND11_MODULE(_scenepic, m)
                 MeshInfo: a subdivided version of this mesh
         )scenepicdoc",
       "steps"_a = 1,
-      "project_to_limit"_a = false);
+      "project_to_limit"_a = false)
+    .def(
+      "simplify",
+      &MeshInfo::simplify,
+      R"scenepicdoc(
+            Simplify this mesh using quadric error edge collapses. Vertex normals, colors and
+            UVs are interpolated along each collapsed edge.
+
+            Args:
+                target_triangle_count (int): the number of triangles to reduce the mesh to (if possible).
+                max_error (float, optional): the maximum distance of a collapsed vertex from the planes
+                                             of the original faces it replaces, as a fraction of the
+                                             diagonal of the mesh bounding box. Defaults to no limit.
+
+            Returns:
+                MeshInfo: a simplified version of this mesh
+        )scenepicdoc",
+      "target_triangle_count"_a,
+      "max_error"_a = std::numeric_limits<float>::infinity())
+    .def(
+      "save_binary",
+      &MeshInfo::save_binary,
+      R"scenepicdoc(
+            Save this mesh info to disk in a native binary format which can be reloaded
+            far faster than parsing an OBJ or PLY. Each buffer is stored in its own aligned
+            section, optionally deflated.
+
+            Args:
+                path (str): the location on disk to write the file
+                compress (bool, optional): whether to deflate the buffers. This makes the file
+                                           smaller but slower to load. Defaults to False.
+        )scenepicdoc",
+      "path"_a,
+      "compress"_a = false)
+    .def_static(
+      "load_binary",
+      &MeshInfo::load_binary,
+      R"scenepicdoc(
+            Load a mesh info from a file written by save_binary. The file is memory mapped
+            and each buffer is copied directly from the mapping.
+
+            Args:
+                path (str): the location of the file on disk
+
+            Returns:
+                MeshInfo: the mesh info stored in the file
+        )scenepicdoc",
+      "path"_a);
 
   m.def(
     "load_obj",
@@ -619,6 +761,36 @@ PYBIND11_MODULE(_scenepic, m)
             MeshInfo: contains the positions, a triangulation, and UVs (if present)
     )scenepicdoc");
 
+  m.def(
+    "load_ply",
+    &load_ply,
+    "path"_a,
+    R"scenepicdoc(
+        Loads a binary (little endian) PLY file from disk as a MeshInfo object.
+        The file is memory mapped and read in chunks, so files larger than the
+        available memory can be loaded.
+
+        Args:
+            path (str): the path to the PLY file on disk
+
+        Returns:
+            MeshInfo: contains the positions, a triangulation (if present), and
+                      normals, colors or UVs (if present)
+    )scenepicdoc");
+
+  m.def(
+    "save_ply",
+    &save_ply,
+    "path"_a,
+    "mesh_info"_a,
+    R"scenepicdoc(
+        Saves a MeshInfo object to disk as a binary (little endian) PLY file.
+
+        Args:
+            path (str): the path to the PLY file on disk
+            mesh_info (MeshInfo): the mesh information to save
+    )scenepicdoc");
+
   py::class_<Mesh, std::shared_ptr<Mesh>>(m, "Mesh", R"scenepicdoc(
         The basic ScenePic mesh class, containing vertex, triangle, and line buffers.
         To allow for compatibility with Numpy, we use row major order, so each
@@ -658,6 +830,18 @@ PYBIND11_MODULE(_scenepic, m)
             Reverses the winding order of all triangles in this mesh.
             Useful when interoping with existing codebases that use opposite convention
         )scenepicdoc")
+    .def(
+      "spatial_sort",
+      &Mesh::spatial_sort,
+      R"scenepicdoc(
+            Reorders the vertices of the mesh along a space-filling curve and remaps the triangles
+            and lines to match. Nearby vertices end up close together in the vertex buffer, which
+            makes the buffers compress better and gives the client coherent ranges to cull.
+
+            Args:
+                curve (str, optional): the curve to follow, either "morton" or "hilbert". Defaults to "morton".
+        )scenepicdoc",
+      "curve"_a = "morton")
     .def(
       "apply_transform",
       &Mesh::apply_transform,
@@ -827,6 +1011,28 @@ PYBIND11_MODULE(_scenepic, m)
       "transform"_a = Transform::Identity(),
       "fill_triangles"_a = true,
       "add_wireframe"_a = false)
+    .def(
+      "add_cubes",
+      &Mesh::add_cubes,
+      R"scenepicdoc(
+            Add N unit diameter cubes to this mesh in a single batch. Each cube is scaled, then rotated,
+            then translated to its position.
+
+            Args:
+                positions (np.ndarray): float32 matrix of [N, 3] cube centers
+                colors (np.ndarray, optional): float32 matrix of [N, 3] per-cube colors. Required unless Mesh was
+                                               constructed with shared_color argument. Defaults to None.
+                scales (np.ndarray, optional): float32 matrix of [N, 3] per-cube scale factors. Defaults to None.
+                rotations (np.ndarray, optional): float32 matrix of [N, 4] per-cube quaternion rotations. Defaults to None.
+                fill_triangles (bool, optional): whether to fill the primitives. Defaults to True.
+                add_wireframe (bool, optional): whether to add wireframe outlines. Defaults to False.
+        )scenepicdoc",
+      "positions"_a,
+      "colors"_a = ColorBufferNone(),
+      "scales"_a = VectorBufferNone(),
+      "rotations"_a = QuaternionBufferNone(),
+      "fill_triangles"_a = true,
+      "add_wireframe"_a = false)
     .def(
       "add_thickline",
       &Mesh::add_thickline,
@@ -874,6 +1080,34 @@ PYBIND11_MODULE(_scenepic, m)
       "long_count"_a = 10,
       "fill_triangles"_a = true,
       "add_wireframe"_a = false)
+    .def(
+      "add_cones",
+      &Mesh::add_cones,
+      R"scenepicdoc(
+            Add N cones to this Mesh in a single batch (see add_cone). Each cone is scaled, then rotated,
+            then translated to its position.
+
+            Args:
+                positions (np.ndarray): float32 matrix of [N, 3] cone centers
+                colors (np.ndarray, optional): float32 matrix of [N, 3] per-cone colors. Required unless Mesh was
+                                               constructed with shared_color argument. Defaults to None.
+                scales (np.ndarray, optional): float32 matrix of [N, 3] per-cone scale factors. Defaults to None.
+                rotations (np.ndarray, optional): float32 matrix of [N, 4] per-cone quaternion rotations. Defaults to None.
+                truncation_height (float, optional): draws truncated cones of this height. Defaults to 1.
+                lat_count (int, optional): number of discrete samples in latitude. Defaults to 10.
+                long_count (int, optional): number of discrete samples in longitude. Defaults to 10.
+                fill_triangles (bool, optional): whether to fill the primitives. Defaults to True.
+                add_wireframe (bool, optional): whether to add wireframe outlines. Defaults to False.
+        )scenepicdoc",
+      "positions"_a,
+      "colors"_a = ColorBufferNone(),
+      "scales"_a = VectorBufferNone(),
+      "rotations"_a = QuaternionBufferNone(),
+      "truncation_height"_a = 1,
+      "lat_count"_a = 10,
+      "long_count"_a = 10,
+      "fill_triangles"_a = true,
+      "add_wireframe"_a = false)
     .def(
       "add_coordinate_axes",
       &Mesh::add_coordinate_axes,
@@ -995,6 +1229,28 @@ PYBIND11_MODULE(_scenepic, m)
       "transform"_a = Transform::Identity(),
       "fill_triangles"_a = true,
       "add_wireframe"_a = false)
+    .def(
+      "add_spheres",
+      &Mesh::add_spheres,
+      R"scenepicdoc(
+            Add N default (ico) unit diameter spheres to this Mesh in a single batch. Each sphere is
+            scaled, then rotated, then translated to its position.
+
+            Args:
+                positions (np.ndarray): float32 matrix of [N, 3] sphere centers
+                colors (np.ndarray, optional): float32 matrix of [N, 3] per-sphere colors. Required unless Mesh was
+                                               constructed with shared_color argument. Defaults to None.
+                scales (np.ndarray, optional): float32 matrix of [N, 3] per-sphere scale factors. Defaults to None.
+                rotations (np.ndarray, optional): float32 matrix of [N, 4] per-sphere quaternion rotations. Defaults to None.
+                fill_triangles (bool, optional): whether to fill the primitives. Defaults to True.
+                add_wireframe (bool, optional): whether to add wireframe outlines. Defaults to False.
+        )scenepicdoc",
+      "positions"_a,
+      "colors"_a = ColorBufferNone(),
+      "scales"_a = VectorBufferNone(),
+      "rotations"_a = QuaternionBufferNone(),
+      "fill_triangles"_a = true,
+      "add_wireframe"_a = false)
     .def(
       "add_icosphere",
       &Mesh::add_icosphere,
@@ -1049,12 +1305,16 @@ PYBIND11_MODULE(_scenepic, m)
                 reverse_triangle_order (bool, optional): whether to reverse the triangle winding order. Defaults to False.
                 fill_triangles (bool, optional): whether to fill the primitive. Defaults to True.
                 add_wireframe (bool, optional): whether to add a wireframe outline. Defaults to False.
+                wireframe_feature_angle (float, optional): if greater than zero, the wireframe only includes
+                                                           boundary edges and edges whose dihedral angle (in
+                                                           degrees) exceeds this value. Defaults to 0.
         )scenepicdoc",
       "mesh_info"_a,
       "transform"_a = Transform::Identity(),
       "reverse_triangle_order"_a = false,
       "fill_triangles"_a = true,
-      "add_wireframe"_a = false)
+      "add_wireframe"_a = false,
+      "wireframe_feature_angle"_a = 0.0f)
     .def(
       "add_mesh_without_normals",
       &Mesh::add_mesh_without_normals,
@@ -1070,6 +1330,9 @@ PYBIND11_MODULE(_scenepic, m)
                 reverse_triangle_order (bool, optional): whether to reverse the triangle winding order. Defaults to False.
                 fill_triangles (bool, optional): whether to fill the primitive. Defaults to True.
                 add_wireframe (bool, optional): whether to add a wireframe outline. Defaults to False.
+                wireframe_feature_angle (float, optional): if greater than zero, the wireframe only includes
+                                                           boundary edges and edges whose dihedral angle (in
+                                                           degrees) exceeds this value. Defaults to 0.
         )scenepicdoc",
       "vertices"_a,
       "triangles"_a,
@@ -1078,7 +1341,8 @@ PYBIND11_MODULE(_scenepic, m)
       "transform"_a = Transform::Identity(),
       "reverse_triangle_order"_a = false,
       "fill_triangles"_a = true,
-      "add_wireframe"_a = false)
+      "add_wireframe"_a = false,
+      "wireframe_feature_angle"_a = 0.0f)
     .def(
       "add_mesh_with_normals",
       &Mesh::add_mesh_with_normals,
@@ -1095,6 +1359,9 @@ PYBIND11_MODULE(_scenepic, m)
                 reverse_triangle_order (bool, optional): whether to reverse the triangle winding order. Defaults to False.
                 fill_triangles (bool, optional): whether to fill the primitive. Defaults to True.
                 add_wireframe (bool, optional): whether to add a wireframe outline. Defaults to False.
+                wireframe_feature_angle (float, optional): if greater than zero, the wireframe only includes
+                                                           boundary edges and edges whose dihedral angle (in
+                                                           degrees) exceeds this value. Defaults to 0.
         )scenepicdoc",
       "vertices"_a,
       "normals"_a,
@@ -1104,7 +1371,8 @@ PYBIND11_MODULE(_scenepic, m)
       "transform"_a = Transform::Identity(),
       "reverse_triangle_order"_a = false,
       "fill_triangles"_a = true,
-      "add_wireframe"_a = false)
+      "add_wireframe"_a = false,
+      "wireframe_feature_angle"_a = 0.0f)
     .def(
       "add_lines",
       &Mesh::add_lines,
@@ -1135,10 +1403,13 @@ PYBIND11_MODULE(_scenepic, m)
                 rotations (np.ndarray, optional): float32 matrix of [N, 4] per-point quaternion rotations. Defaults to None.
                 colors (np.ndarray, optional): float32 matrix of [N, 3] colors. If provided, overrides a Mesh's shared_color
                                                or per-vertex color. Defaults to None.
+                sort_curve (str, optional): if "morton" or "hilbert", the instances are reordered along that
+                                            space-filling curve (see spatial_sort). Defaults to "none".
         )scenepicdoc",
       "positions"_a,
       "rotations"_a = QuaternionBufferNone(),
-      "colors"_a = ColorBufferNone())
+      "colors"_a = ColorBufferNone(),
+      "sort_curve"_a = "none")
     .def_property(
       "shared_color",
       py::overload_cast<>(&Mesh::shared_color, py::const_),
@@ -1198,6 +1469,23 @@ PYBIND11_MODULE(_scenepic, m)
                           bool: Draw this Mesh as a billboard (i.e. always facing the user) rather than
                           rotating with the rest of the world.
                       )scenepicdoc")
+    .def_property(
+      "packed_normals",
+      py::overload_cast<>(&Mesh::packed_normals, py::const_),
+      py::overload_cast<std::uint32_t>(&Mesh::packed_normals),
+      R"scenepicdoc(
+                          int: Number of bits per component (8 or 16) used to send the vertex normals
+                          using octahedral encoding, or 0 (default) to send them as float32. Inherited
+                          by (non-quantized) updates of this Mesh.
+                      )scenepicdoc")
+    .def_property(
+      "packed_colors",
+      py::overload_cast<>(&Mesh::packed_colors, py::const_),
+      py::overload_cast<bool>(&Mesh::packed_colors),
+      R"scenepicdoc(
+                          bool: Whether to send per-vertex colors as 8-bit RGB instead of float32. Inherited
+                          by (non-quantized) updates of this Mesh.
+                      )scenepicdoc")
     .def("get_vertex_buffer", &Mesh::vertex_buffer, R"scenepicdoc(
                           Returns a reference to the contents vertex buffer. 
                           Vertices are stored in a NxD matrix in the following way per row:
@@ -1399,6 +1687,32 @@ PYBIND11_MODULE(_scenepic, m)
       "fill_color"_a = Color::None(),
       "close_path"_a = false,
       "layer_id"_a = "")
+    .def(
+      "add_lines",
+      &Frame2D::add_lines,
+      R"scenepicdoc(
+            Add many lines with the same style to the frame at once. This is much faster than
+            calling add_line for each of them.
+
+            Args:
+                coordinates (np.ndarray): float32 matrix of [N, 2] coordinates of all of the lines,
+                                          one after the other
+                offsets (List[int]): the index of the first coordinate of each line. Each line ends
+                                     where the next one starts, and the last one at the end of the
+                                     coordinates.
+                line_color (np.ndarray, optional): the color of the lines. Defaults to Black.
+                line_width (float, optional): the width of the lines. Defaults to 1.0.
+                fill_color (np.ndarray, optional): the fill color to use. Defaults to None.
+                close_path (bool, optional): whether to close the paths. Defaults to False.
+                layer_id (str, optional): Unique ID of the layer associated with these primitives. Defaults to "".
+        )scenepicdoc",
+      "coordinates"_a,
+      "offsets"_a,
+      "line_color"_a = Colors::Black,
+      "line_width"_a = 1.0f,
+      "fill_color"_a = Color::None(),
+      "close_path"_a = false,
+      "layer_id"_a = "")
     .def(
       "add_rectangle",
       &Frame2D::add_rectangle,
@@ -1423,6 +1737,49 @@ PYBIND11_MODULE(_scenepic, m)
       "line_width"_a = 1.0f,
       "fill_color"_a = Color::None(),
       "layer_id"_a = "")
+    .def(
+      "add_rectangles",
+      &Frame2D::add_rectangles,
+      R"scenepicdoc(
+            Add many rectangles to the frame at once. Each of the per-rectangle arguments can
+            either have one row per rectangle or a single row which is shared by all of them.
+
+            Args:
+                rectangles (np.ndarray): float32 matrix of [N, 4] (x, y, w, h) rows, where (x, y) is
+                                         the upper left corner
+                line_colors (np.ndarray, optional): float32 matrix of line colors. Defaults to Black.
+                line_widths (np.ndarray, optional): float32 vector of line widths. Defaults to 1.0.
+                fill_colors (np.ndarray, optional): float32 matrix of fill colors. Defaults to None.
+                layer_ids (List[str], optional): Unique IDs of the layers associated with these
+                                                 primitives. Defaults to no layer.
+        )scenepicdoc",
+      "rectangles"_a,
+      "line_colors"_a = ColorBufferNone(),
+      "line_widths"_a = ValueBufferNone(),
+      "fill_colors"_a = ColorBufferNone(),
+      "layer_ids"_a = std::vector<std::string>())
+    .def(
+      "add_circles",
+      &Frame2D::add_circles,
+      R"scenepicdoc(
+            Add many circles to the frame at once. Each of the per-circle arguments can either
+            have one row per circle or a single row which is shared by all of them.
+
+            Args:
+                centers (np.ndarray): float32 matrix of [N, 2] circle centers
+                radii (np.ndarray): float32 vector of circle radii
+                line_colors (np.ndarray, optional): float32 matrix of line colors. Defaults to Black.
+                line_widths (np.ndarray, optional): float32 vector of line widths. Defaults to 1.0.
+                fill_colors (np.ndarray, optional): float32 matrix of fill colors. Defaults to None.
+                layer_ids (List[str], optional): Unique IDs of the layers associated with these
+                                                 primitives. Defaults to no layer.
+        )scenepicdoc",
+      "centers"_a,
+      "radii"_a,
+      "line_colors"_a = ColorBufferNone(),
+      "line_widths"_a = ValueBufferNone(),
+      "fill_colors"_a = ColorBufferNone(),
+      "layer_ids"_a = std::vector<std::string>())
     .def(
       "add_circle_",
       &Frame2D::add_circle,
@@ -1474,7 +1831,34 @@ PYBIND11_MODULE(_scenepic, m)
       "color"_a = Colors::White,
       "size_in_pixels"_a = 12.0f,
       "font_family"_a = "sans-serif",
-      "layer_id"_a = "");
+      "layer_id"_a = "")
+    .def(
+      "add_texts",
+      &Frame2D::add_texts,
+      R"scenepicdoc(
+            Add many pieces of text to the frame at once. The texts are sent as a table of
+            distinct strings, so repeated labels are only sent once. Each of the per-text
+            arguments can either have one row per text or a single row which is shared by all
+            of them.
+
+            Args:
+                texts (List[str]): the texts to display
+                positions (np.ndarray): float32 matrix of [N, 2] pixel positions of the left and
+                                        bottom sides of the texts
+                colors (np.ndarray, optional): float32 matrix of text colors. Defaults to White.
+                sizes_in_pixels (np.ndarray, optional): float32 vector of the vertical sizes of the
+                                                        texts in pixels. Defaults to 12.0.
+                font_family (str, optional): the font to use for all of the texts. Defaults to
+                                             "sans-serif".
+                layer_ids (List[str], optional): Unique IDs of the layers associated with these
+                                                 primitives. Defaults to no layer.
+        )scenepicdoc",
+      "texts"_a,
+      "positions"_a,
+      "colors"_a = ColorBufferNone(),
+      "sizes_in_pixels"_a = ValueBufferNone(),
+      "font_family"_a = "sans-serif",
+      "layer_ids"_a = std::vector<std::string>());
 
   py::class_<Frame3D, std::shared_ptr<Frame3D>>(m, "Frame3D", R"scenepicdoc(
         Represents a frame of an animation which contains a number of
@@ -1540,7 +1924,17 @@ PYBIND11_MODULE(_scenepic, m)
             Camera: The camera for the frame. This property can be used to create cinematic
             camera movement within a ScenePic, but the user can choose to override the camera
             track at any time. If they reset to the original camera, however, it will make
-            subsequent frames use the specified camera parameters.)scenepicdoc");
+            subsequent frames use the specified camera parameters.)scenepicdoc")
+    .def_property(
+      "compact_meshes",
+      py::overload_cast<>(&Frame3D::compact_meshes, py::const_),
+      py::overload_cast<bool>(&Frame3D::compact_meshes),
+      R"scenepicdoc(
+            bool: Whether the meshes of this frame are sent to the client as a single compact table
+            instead of one command per mesh. The table holds the distinct mesh ids of the frame, a
+            compressed buffer of per-mesh indices into them, and (if any mesh is transformed) one
+            compressed buffer of per-mesh transforms. This is much smaller and faster to produce for
+            frames which contain many meshes.)scenepicdoc");
 
   py::class_<Shading>(m, "Shading", R"scenepicdoc(
         Parameters of the shaders
@@ -1679,7 +2073,25 @@ PYBIND11_MODULE(_scenepic, m)
                           
                           This file will be used to drive playback, i.e. frames will be
                           displayed in time with the playback of the media file.
-                      )scenepicdoc");
+                      )scenepicdoc")
+    .def_property(
+      "shared_buffers",
+      py::overload_cast<>(&Canvas2D::shared_buffers, py::const_),
+      py::overload_cast<bool>(&Canvas2D::shared_buffers),
+      R"scenepicdoc(
+            bool: Whether the coordinates and styles of every frame are written as a single pair
+            of buffers at the canvas level. Each frame then refers to its range of rows, which
+            saves the overhead of compressing many small buffers and lets similar frames compress
+            against each other. Default False.)scenepicdoc")
+    .def_property(
+      "delta_coordinates",
+      py::overload_cast<>(&Canvas2D::delta_coordinates, py::const_),
+      py::overload_cast<bool>(&Canvas2D::delta_coordinates),
+      R"scenepicdoc(
+            bool: Whether the shared coordinates of a frame are stored relative to those of the
+            previous frame, when both have the same number of coordinates. This is lossless, and
+            turns unchanged coordinates into zeros. Has no effect unless shared_buffers is set.
+            Default False.)scenepicdoc");
 
   py::class_<LayerSettings>(m, "LayerSettings", R"scenepicdoc(
         Settings used for customizing canvas drawing by layer.
@@ -1756,6 +2168,76 @@ PYBIND11_MODULE(_scenepic, m)
       "canvas_id",
       &Canvas3D::canvas_id,
       "str: A unique identifier for the canvas")
+    .def(
+      "add_transform_track",
+      &Canvas3D::add_transform_track,
+      R"scenepicdoc(
+            Adds a mesh to a run of consecutive frames with a different pose in each frame, e.g.
+            for rigid-body animation. This has the same effect as calling add_mesh_by_id on each
+            frame, but the whole track is stored as a single quantized, delta-coded buffer, which
+            is orders of magnitude smaller than one transform per frame.
+
+            Args:
+                mesh_id (str): the id of the mesh to animate
+                poses (np.ndarray): float32 matrix with one row per frame, either [F, 7] poses stored as
+                                    [tx, ty, tz, qx, qy, qz, qw] (a translation followed by a rotation
+                                    quaternion) or [F, 16] affine transforms stored as the 4x4 matrix in
+                                    row-major order
+                start_frame (int, optional): the index of the frame which receives the first pose. The
+                                             frames must already have been created. Defaults to 0.
+                precision (float, optional): the largest error allowed in translations. Rotations are
+                                             quantized to 1/32768, relative to the largest scale of
+                                             each axis for affine transforms. Defaults to 1e-4.
+        )scenepicdoc",
+      "mesh_id"_a,
+      "poses"_a,
+      "start_frame"_a = 0,
+      "precision"_a = 1e-4f)
+    .def(
+      "add_camera_track",
+      &Canvas3D::add_camera_track,
+      R"scenepicdoc(
+            Sets the cameras of a run of frames, e.g. for a fly-through created with
+            Camera.orbit. This replaces the cameras passed to create_frame, but instead of two
+            matrices per frame the center, look-at point, up direction and field of view of every
+            camera are stored as a single quantized, delta-coded buffer. With a keyframe interval
+            greater than one, the client interpolates linearly between consecutive cameras for the
+            frames in between.
+
+            Args:
+                cameras (List[Camera]): one camera per keyframe. All of them must have a perspective
+                                        projection with the same aspect ratio and clipping planes.
+                start_frame (int, optional): the index of the frame which receives the first camera.
+                                             The frames must already have been created. Defaults to 0.
+                keyframe_interval (int, optional): the number of frames between cameras. Defaults to 1.
+                precision (float, optional): the largest error allowed in positions. Defaults to 1e-4.
+        )scenepicdoc",
+      "cameras"_a,
+      "start_frame"_a = 0,
+      "keyframe_interval"_a = 1,
+      "precision"_a = 1e-4f)
+    .def(
+      "add_focus_point_track",
+      &Canvas3D::add_focus_point_track,
+      R"scenepicdoc(
+            Sets the focus points of a run of frames. This works in the same way as
+            add_camera_track, with the positions (and orientations, if the focus points have them)
+            stored as a single delta-coded buffer.
+
+            Args:
+                focus_points (List[FocusPoint]): one focus point per keyframe. Either all or none of
+                                                 them must have an orientation.
+                start_frame (int, optional): the index of the frame which receives the first focus
+                                             point. The frames must already have been created.
+                                             Defaults to 0.
+                keyframe_interval (int, optional): the number of frames between focus points.
+                                                   Defaults to 1.
+                precision (float, optional): the largest error allowed in positions. Defaults to 1e-4.
+        )scenepicdoc",
+      "focus_points"_a,
+      "start_frame"_a = 0,
+      "keyframe_interval"_a = 1,
+      "precision"_a = 1e-4f)
     .def(
       "set_layer_settings_",
       &Canvas3D::set_layer_settings,
@@ -1804,7 +2286,16 @@ PYBIND11_MODULE(_scenepic, m)
                           
                           This file will be used to drive playback, i.e. frames will be
                           displayed in time with the playback of the media file.
-                      )scenepicdoc");
+                      )scenepicdoc")
+    .def_property(
+      "delta_frames",
+      py::overload_cast<>(&Canvas3D::delta_frames, py::const_),
+      py::overload_cast<bool>(&Canvas3D::delta_frames),
+      R"scenepicdoc(
+            bool: Whether frames are written relative to the previous frame. When enabled, the
+            meshes shared by every frame are written once as a static layer, and each later frame
+            only lists the meshes removed from or added to the previous frame (a moved mesh counts
+            as both). Meshes may be drawn in a different order within a frame. Default False.)scenepicdoc");
 
   py::class_<Graph::Margin>(m, "Margin", R"scenepicdoc(
         Represents the margin along the edges of a graph.
@@ -1914,6 +2405,43 @@ PYBIND11_MODULE(_scenepic, m)
                           This file will be used to drive playback, i.e. frames will be
                           displayed in time with the playback of the media file.
                       )scenepicdoc")
+    .def_property(
+      "max_points",
+      py::overload_cast<>(&Graph::max_points, py::const_),
+      py::overload_cast<std::size_t>(&Graph::max_points),
+      R"scenepicdoc(
+        int: The largest number of points sent for each sparkline, or 0 to send every value.
+        Longer sparklines are downsampled, and the client interpolates between the points
+        which remain. Default 0.
+      )scenepicdoc")
+    .def_property(
+      "downsampling",
+      py::overload_cast<>(&Graph::downsampling, py::const_),
+      py::overload_cast<const std::string&>(&Graph::downsampling),
+      R"scenepicdoc(
+        str: The method used to downsample sparklines. "m4" keeps the first, last, smallest and
+        largest value of each range of frames, so the extremes are always kept. "lttb" (Largest
+        Triangle Three Buckets) follows the shape of the line more closely for the same number
+        of points. Default "m4".
+      )scenepicdoc")
+    .def_property(
+      "pyramid_levels",
+      py::overload_cast<>(&Graph::pyramid_levels, py::const_),
+      py::overload_cast<std::size_t>(&Graph::pyramid_levels),
+      R"scenepicdoc(
+        int: The number of resolutions sent for each downsampled sparkline. Each level has four
+        times as many points as the one before, up to every value, and the client draws the
+        coarsest level which has a point for each pixel of the line. Default 1.
+      )scenepicdoc")
+    .def_property(
+      "value_encoding",
+      py::overload_cast<>(&Graph::value_encoding, py::const_),
+      py::overload_cast<const std::string&>(&Graph::value_encoding),
+      R"scenepicdoc(
+        str: How sparkline values are stored. One of "float32", "float16" or "quantized".
+        Quantized values are delta coded in steps of 1/65535 of the range of the sparkline.
+        Default "float32".
+      )scenepicdoc")
     .def(
       "add_sparkline",
       &Graph::add_sparkline,
@@ -2427,6 +2955,14 @@ PYBIND11_MODULE(_scenepic, m)
       R"scenepicdoc(
                           str: CSS visibility for the status bar
                       )scenepicdoc")
+    .def_property(
+      "intern_ids",
+      py::overload_cast<>(&Scene::intern_ids, py::const_),
+      py::overload_cast<bool>(&Scene::intern_ids),
+      R"scenepicdoc(
+            bool: Whether mesh, layer and canvas ids are interned when the scene is converted to
+            JSON. Each distinct id is then written once, in a table at the start of the script,
+            and commands refer to it by its index in the table. Default False.)scenepicdoc")
     .def(
       "configure_user_interface",
       &Scene::configure_user_interface,
@@ -2499,6 +3035,20 @@ PYBIND11_MODULE(_scenepic, m)
         )scenepicdoc",
       "path"_a,
       "standalone"_a = false)
+    .def(
+      "save_as_glb",
+      &Scene::save_as_glb,
+      R"scenepicdoc(
+            Save the meshes of the scene as a binary glTF 2.0 (GLB) file.
+            Each mesh becomes a node, and instanced meshes are written using the
+            EXT_mesh_gpu_instancing extension. Mesh updates are animated at the
+            scene framerate, as morph targets for regular meshes and as per-frame
+            nodes for instanced meshes. Labels, canvases and frames are not exported.
+
+            Args:
+                path (str): the path to the file on disk
+        )scenepicdoc",
+      "path"_a)
     .def(
       "save_as_html",
       &Scene::save_as_html,
@@ -2528,4 +3078,35 @@ PYBIND11_MODULE(_scenepic, m)
       "script_cleared",
       &Scene::script_cleared,
       "bool: Whether the script has been cleared");
+
+  m.def(
+    "load_obj_sequence",
+    &load_obj_sequence,
+    "scene"_a,
+    "base_mesh_id"_a,
+    "base_path"_a,
+    "paths"_a,
+    "num_threads"_a = 0,
+    R"scenepicdoc(
+        Loads a sequence of WaveFront OBJ files (e.g. the frames of a capture) as updates
+        to a base mesh. Files are loaded in parallel on a pool of worker threads, with only
+        a bounded number of frames held in memory at once, and the updates are added to the
+        scene in frame order. Each file must have the same faces (i.e. the same position,
+        texture coordinate and normal indices) as the base OBJ file, and each vertex of the
+        base mesh takes its position (and normal, if the files contain them) from the same
+        indices in every frame. Vertices which coincide in some frames therefore do not
+        change the topology.
+
+        Args:
+            scene (Scene): the scene which contains the base mesh
+            base_mesh_id (str): the id of the base mesh to update
+            base_path (str): the location of the OBJ file the base mesh was created from with
+                             load_obj
+            paths (List[str]): the locations of the OBJ files on disk, in frame order
+            num_threads (int, optional): the number of worker threads to use. A value of 0
+                                         uses one per hardware thread. Defaults to 0.
+
+        Returns:
+            List[MeshUpdate]: the mesh updates, one per file
+    )scenepicdoc");
 }
\ No newline at end of file
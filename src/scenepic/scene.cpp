@@ -13,12 +13,71 @@
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <set>
 #include <sstream>
 
 namespace scenepic
 {
+  namespace
+  {
+    const std::set<std::string> ID_KEYS = {
+      "BaseMeshId", "CanvasId", "LayerId", "MeshId"};
+    const std::set<std::string> ID_LIST_KEYS = {
+      "CanvasIds", "LayerIds", "MeshIds"};
+
+    /** Replaces a string id with its index in the table of ids. Missing
+     *  (null) ids are left as they are.
+     */
+    void intern_id(JsonValue& id, IndexMap<std::string>& ids)
+    {
+      if (id.type() == JsonType::String)
+      {
+        id = static_cast<std::int64_t>(ids.insert(id.as_string()));
+      }
+    }
+
+    /** Replaces the ids in a command, and in any commands it contains, with
+     *  their indices in the table of ids.
+     */
+    void intern_command_ids(JsonValue& value, IndexMap<std::string>& ids)
+    {
+      if (value.type() == JsonType::Array)
+      {
+        for (auto& child : value.values())
+        {
+          intern_command_ids(child, ids);
+        }
+      }
+      else if (value.type() == JsonType::Object)
+      {
+        for (auto& entry : value.lookup())
+        {
+          if (ID_KEYS.count(entry.first))
+          {
+            intern_id(entry.second, ids);
+          }
+          else if (ID_LIST_KEYS.count(entry.first))
+          {
+            // layer ids are run-length encoded as [id, count] pairs
+            for (auto& id : entry.second.values())
+            {
+              intern_id(
+                id.type() == JsonType::Array ? id.values()[0] : id, ids);
+            }
+          }
+          else
+          {
+            intern_command_ids(entry.second, ids);
+          }
+        }
+      }
+    }
+  } // namespace
+
   Scene::Scene(const std::string& scene_id)
   : m_scene_id(scene_id),
+    m_fps(30.0f),
+    m_status_bar_visibility("visible"),
     m_num_canvases(0),
     m_num_meshes(0),
     m_num_images(0),
@@ -28,8 +87,7 @@ namespace scenepic
     m_num_text_panels(0),
     m_num_drop_down_menus(0),
     m_script_cleared(false),
-    m_fps(30.0f),
-    m_status_bar_visibility("visible")
+    m_intern_ids(false)
   {}
 
   std::shared_ptr<Canvas3D> Scene::create_canvas_3d(
@@ -320,6 +378,8 @@ namespace scenepic
 
     auto mesh_update = std::make_shared<MeshUpdate>(
       MeshUpdate(base_mesh_id, mesh_id, buffers, buffer_types, frame_index));
+    mesh_update->m_packed_normals = base_mesh->packed_normals();
+    mesh_update->m_packed_colors = base_mesh->packed_colors();
     m_mesh_updates.push_back(mesh_update);
     m_num_meshes += 1;
     return mesh_update;
@@ -365,6 +425,8 @@ namespace scenepic
 
     auto mesh_update = std::make_shared<MeshUpdate>(
       MeshUpdate(base_mesh_id, mesh_id, buffers, buffer_types, frame_index));
+    mesh_update->m_packed_normals = base_mesh->packed_normals();
+    mesh_update->m_packed_colors = base_mesh->packed_colors();
     m_mesh_updates.push_back(mesh_update);
     m_num_meshes += 1;
     return mesh_update;
@@ -610,14 +672,14 @@ namespace scenepic
       JsonValue command;
       command["CommandType"] = "SetSceneId";
       command["SceneId"] = m_scene_id;
-      commands.append(command);
+      commands.append(std::move(command));
     }
 
     JsonValue properties;
     properties["CommandType"] = "SetSceneProperties";
     properties["FrameRate"] = m_fps;
     properties["StatusBarVisibility"] = m_status_bar_visibility;
-    commands.append(properties);
+    commands.append(std::move(properties));
 
     Scene::add_commands(commands, m_meshes);
 
@@ -660,6 +722,33 @@ namespace scenepic
       commands.append(misc);
     }
 
+    if (m_intern_ids)
+    {
+      IndexMap<std::string> ids;
+      for (auto& command : commands.values())
+      {
+        intern_command_ids(command, ids);
+      }
+
+      JsonValue table;
+      table["CommandType"] = "SetIdTable";
+      table["Ids"].resize(0);
+      for (const auto& id : ids.keys())
+      {
+        table["Ids"].append(id);
+      }
+
+      JsonValue interned;
+      interned.resize(0);
+      interned.append(std::move(table));
+      for (auto& command : commands.values())
+      {
+        interned.append(std::move(command));
+      }
+
+      return interned;
+    }
+
     return commands;
   }
 
@@ -706,6 +795,16 @@ namespace scenepic
     m_fps = fps;
   }
 
+  bool Scene::intern_ids() const
+  {
+    return m_intern_ids;
+  }
+
+  void Scene::intern_ids(bool intern_ids)
+  {
+    m_intern_ids = intern_ids;
+  }
+
   const std::string& Scene::status_bar_visibility() const
   {
     return m_status_bar_visibility;
@@ -397,6 +397,15 @@ class Scene:
     def status_bar_visibility(self) -> str:
         """CSS visibility for the status bar."""
 
+    @property
+    def intern_ids(self) -> bool:
+        """Whether ids are interned when the scene is converted to JSON.
+
+        When enabled, each distinct mesh, layer and canvas id is written once,
+        in a table at the start of the script, and commands refer to it by its
+        index in the table. Default False.
+        """
+
     def configure_user_interface(self, ui_parameters: UIParameters) -> None:
         """Set user interface parameters across all Canvases with given UIParameters instance.
 
@@ -468,6 +477,18 @@ class Scene:
             standalone (bool): whether to make the script standalone by including the library
         """
 
+    def save_as_glb(self, path: str) -> None:
+        """Save the meshes of the scene as a binary glTF 2.0 (GLB) file.
+
+        Each mesh becomes a node, and instanced meshes are written using the
+        EXT_mesh_gpu_instancing extension. Mesh updates are animated at the
+        scene framerate, as morph targets for regular meshes and as per-frame
+        nodes for instanced meshes. Labels, canvases and frames are not exported.
+
+        Args:
+            path (str): the path to the file on disk
+        """
+
     def save_as_html(self, path: Optional[str] = None, title: Optional[str] = None,
                      head_html: Optional[str] = None, body_html: Optional[str] = None) -> None:
         """Save the scene as a self-contained html file with no dependencies.
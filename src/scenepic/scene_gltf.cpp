@@ -0,0 +1,679 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+/** Export of scene meshes as glTF 2.0 binary (GLB) files. */
+
+#include "scene.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+  using scenepic::JsonType;
+  using scenepic::JsonValue;
+
+  const std::uint32_t GLB_MAGIC = 0x46546C67;
+  const std::uint32_t GLB_VERSION = 2;
+  const std::uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+  const std::uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+  const std::int64_t FLOAT = 5126;
+  const std::int64_t UNSIGNED_INT = 5125;
+  const std::int64_t ARRAY_BUFFER = 34962;
+  const std::int64_t ELEMENT_ARRAY_BUFFER = 34963;
+  const std::int64_t MODE_LINES = 1;
+  const std::int64_t MODE_TRIANGLES = 4;
+  const std::int64_t NEAREST = 9728;
+  const std::int64_t LINEAR = 9729;
+  const char* INSTANCING = "EXT_mesh_gpu_instancing";
+
+  std::size_t align4(std::size_t offset)
+  {
+    return (offset + 3) & ~static_cast<std::size_t>(3);
+  }
+
+  std::int64_t to_int(std::size_t value)
+  {
+    return static_cast<std::int64_t>(value);
+  }
+
+  /** Appends a value to a JSON array, returning its index. */
+  std::int64_t append_index(JsonValue& array, JsonValue&& value)
+  {
+    array.append(std::move(value));
+    return to_int(array.values().size() - 1);
+  }
+
+  template<typename Derived>
+  JsonValue to_json_array(const Eigen::MatrixBase<Derived>& values)
+  {
+    JsonValue array(JsonType::Array);
+    for (Eigen::Index i = 0; i < values.size(); ++i)
+    {
+      array.append(JsonValue(static_cast<double>(values(i))));
+    }
+
+    return array;
+  }
+
+  /** Lays out the JSON and binary chunks of a GLB file. All data is stored in
+   *  a single buffer, and buffer views refer either directly to memory owned
+   *  by the scene or to data computed during export, so that the binary
+   *  chunk is only assembled as it is streamed to disk.
+   */
+  class GlbWriter
+  {
+  public:
+    GlbWriter()
+    : m_buffer_views(JsonType::Array),
+      m_accessors(JsonType::Array),
+      m_length(0)
+    {
+      m_gltf["asset"]["version"] = "2.0";
+      m_gltf["asset"]["generator"] = "ScenePic";
+    }
+
+    JsonValue& gltf()
+    {
+      return m_gltf;
+    }
+
+    /** Adds a buffer view over memory which must outlive the writer. */
+    std::int64_t add_buffer_view(
+      const void* data,
+      std::size_t size,
+      std::size_t stride = 0,
+      std::int64_t target = 0)
+    {
+      m_length = align4(m_length);
+      JsonValue view;
+      view["buffer"] = std::int64_t(0);
+      view["byteOffset"] = to_int(m_length);
+      view["byteLength"] = to_int(size);
+      if (stride > 0)
+      {
+        view["byteStride"] = to_int(stride);
+      }
+
+      if (target > 0)
+      {
+        view["target"] = target;
+      }
+
+      m_views.push_back({static_cast<const char*>(data), size, m_length});
+      m_length += size;
+      return append_index(m_buffer_views, std::move(view));
+    }
+
+    /** Adds a buffer view over data computed during export. */
+    std::int64_t add_buffer_view(
+      std::vector<float>&& data,
+      std::size_t stride = 0,
+      std::int64_t target = 0)
+    {
+      m_owned.push_back(std::move(data));
+      const std::vector<float>& owned = m_owned.back();
+      return add_buffer_view(
+        owned.data(), owned.size() * sizeof(float), stride, target);
+    }
+
+    std::int64_t add_accessor(
+      std::int64_t view,
+      std::size_t offset,
+      std::int64_t component_type,
+      std::size_t count,
+      const std::string& type)
+    {
+      return append_index(
+        m_accessors,
+        accessor_json(view, offset, component_type, count, type));
+    }
+
+    /** Adds an accessor which records the bounds of its values, as glTF
+     *  requires for positions and animation inputs.
+     */
+    template<typename Derived>
+    std::int64_t add_bounded_accessor(
+      std::int64_t view,
+      std::size_t offset,
+      const Eigen::MatrixBase<Derived>& values,
+      const std::string& type)
+    {
+      JsonValue accessor =
+        accessor_json(view, offset, FLOAT, values.rows(), type);
+      accessor["min"] = to_json_array(values.colwise().minCoeff());
+      accessor["max"] = to_json_array(values.colwise().maxCoeff());
+      return append_index(m_accessors, std::move(accessor));
+    }
+
+    void write(const std::string& path)
+    {
+      std::ofstream stream(path, std::ios::binary);
+      if (!stream.is_open())
+      {
+        throw std::invalid_argument("Unable to open file.");
+      }
+
+      // buffers must not be empty, so a scene without any data is written
+      // without a buffer or binary chunk
+      m_length = align4(m_length);
+      std::size_t bin_chunk_length = 0;
+      if (m_length > 0)
+      {
+        JsonValue buffer;
+        buffer["byteLength"] = to_int(m_length);
+        m_gltf["buffers"].append(std::move(buffer));
+        m_gltf["bufferViews"] = m_buffer_views;
+        m_gltf["accessors"] = m_accessors;
+        bin_chunk_length = 8 + m_length;
+      }
+
+      std::string json = m_gltf.to_string();
+      json.resize(align4(json.size()), ' ');
+
+      std::uint32_t header[5] = {
+        GLB_MAGIC,
+        GLB_VERSION,
+        static_cast<std::uint32_t>(12 + 8 + json.size() + bin_chunk_length),
+        static_cast<std::uint32_t>(json.size()),
+        GLB_CHUNK_JSON};
+      stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+      stream.write(json.data(), json.size());
+      if (m_length > 0)
+      {
+        std::uint32_t bin_header[2] = {
+          static_cast<std::uint32_t>(m_length), GLB_CHUNK_BIN};
+        stream.write(
+          reinterpret_cast<const char*>(bin_header), sizeof(bin_header));
+        const char padding[4] = {0, 0, 0, 0};
+        std::size_t position = 0;
+        for (const auto& view : m_views)
+        {
+          stream.write(padding, view.offset - position);
+          stream.write(view.data, view.size);
+          position = view.offset + view.size;
+        }
+
+        stream.write(padding, m_length - position);
+      }
+
+      if (!stream)
+      {
+        throw std::invalid_argument("Unable to write file.");
+      }
+    }
+
+  private:
+    struct View
+    {
+      const char* data;
+      std::size_t size;
+      std::size_t offset;
+    };
+
+    JsonValue accessor_json(
+      std::int64_t view,
+      std::size_t offset,
+      std::int64_t component_type,
+      std::size_t count,
+      const std::string& type)
+    {
+      JsonValue accessor;
+      accessor["bufferView"] = view;
+      accessor["byteOffset"] = to_int(offset);
+      accessor["componentType"] = component_type;
+      accessor["count"] = to_int(count);
+      accessor["type"] = type;
+      return accessor;
+    }
+
+    JsonValue m_gltf;
+    JsonValue m_buffer_views;
+    JsonValue m_accessors;
+    std::vector<View> m_views;
+    std::deque<std::vector<float>> m_owned;
+    std::size_t m_length;
+  };
+
+  /** Copies a block of columns into a tightly packed buffer. */
+  template<typename Derived>
+  std::vector<float> pack_columns(const Eigen::MatrixBase<Derived>& values)
+  {
+    std::vector<float> packed(values.size());
+    Eigen::Map<scenepic::VertexBuffer>(
+      packed.data(), values.rows(), values.cols()) = values;
+    return packed;
+  }
+
+  /** Adds the key times of an animation sampler. */
+  std::int64_t add_times(GlbWriter& writer, const std::vector<float>& times)
+  {
+    Eigen::Map<const Eigen::VectorXf> values(times.data(), times.size());
+    std::int64_t view = writer.add_buffer_view(std::vector<float>(times));
+    return writer.add_bounded_accessor(view, 0, values, "SCALAR");
+  }
+
+  /** Adds a vertex attribute computed during export. */
+  std::int64_t add_vertex_attribute(
+    GlbWriter& writer, const scenepic::VectorBuffer& values)
+  {
+    std::int64_t view =
+      writer.add_buffer_view(pack_columns(values), 0, ARRAY_BUFFER);
+    return writer.add_bounded_accessor(view, 0, values, "VEC3");
+  }
+
+  std::string mime_type(const std::string& ext_init)
+  {
+    std::string ext = ext_init;
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) {
+      return static_cast<char>(std::tolower(c));
+    });
+    if (ext == "png")
+    {
+      return "image/png";
+    }
+
+    if (ext == "jpg" || ext == "jpeg")
+    {
+      return "image/jpeg";
+    }
+
+    return "";
+  }
+} // namespace
+
+namespace scenepic
+{
+  void Scene::save_as_glb(const std::string& path) const
+  {
+    GlbWriter writer;
+    JsonValue& gltf = writer.gltf();
+    JsonValue nodes(JsonType::Array);
+    JsonValue scene_nodes(JsonType::Array);
+    JsonValue channels(JsonType::Array);
+    JsonValue samplers(JsonType::Array);
+    std::map<std::string, std::int64_t> images;
+    std::map<std::pair<std::string, bool>, std::int64_t> textures;
+    bool uses_instancing = false;
+    float frame_time = m_fps > 0 ? 1.0f / m_fps : 1.0f;
+
+    // animations show one frame per mesh update, with the base mesh first
+    auto add_channel = [&](
+                         const std::vector<float>& times,
+                         std::vector<float>&& values,
+                         const std::string& type,
+                         std::int64_t node,
+                         const std::string& property) {
+      JsonValue sampler;
+      sampler["input"] = add_times(writer, times);
+      std::size_t count = values.size() / (type == "VEC3" ? 3 : 1);
+      sampler["output"] = writer.add_accessor(
+        writer.add_buffer_view(std::move(values)), 0, FLOAT, count, type);
+      sampler["interpolation"] = "STEP";
+      JsonValue channel;
+      channel["sampler"] = append_index(samplers, std::move(sampler));
+      channel["target"]["node"] = node;
+      channel["target"]["path"] = property;
+      channels.append(std::move(channel));
+    };
+
+    for (const auto& mesh : m_meshes)
+    {
+      const VertexBuffer& vertices = mesh->m_vertices;
+      if (
+        mesh->m_is_label || vertices.rows() == 0 ||
+        (mesh->m_triangles.rows() == 0 && mesh->m_lines.rows() == 0))
+      {
+        continue;
+      }
+
+      std::vector<std::shared_ptr<MeshUpdate>> updates;
+      for (const auto& update : m_mesh_updates)
+      {
+        if (update->m_base_mesh_id == mesh->m_mesh_id)
+        {
+          updates.push_back(update);
+        }
+      }
+
+      std::vector<float> times(updates.size() + 1);
+      for (std::size_t i = 0; i < times.size(); ++i)
+      {
+        times[i] = i * frame_time;
+      }
+
+      // the vertex buffer is row major, so its columns are interleaved
+      // attributes which can be written without repacking
+      std::size_t num_vertices = vertices.rows();
+      bool has_uvs = vertices.cols() == 8;
+      bool has_colors = vertices.cols() == 9;
+      std::int64_t vertex_view = writer.add_buffer_view(
+        vertices.data(),
+        vertices.size() * sizeof(float),
+        vertices.cols() * sizeof(float),
+        ARRAY_BUFFER);
+      JsonValue attributes;
+      attributes["POSITION"] = writer.add_bounded_accessor(
+        vertex_view, 0, vertices.leftCols(3), "VEC3");
+      attributes["NORMAL"] = writer.add_accessor(
+        vertex_view, 3 * sizeof(float), FLOAT, num_vertices, "VEC3");
+      if (has_colors)
+      {
+        attributes["COLOR_0"] = writer.add_accessor(
+          vertex_view, 6 * sizeof(float), FLOAT, num_vertices, "VEC3");
+      }
+
+      if (has_uvs)
+      {
+        // glTF places the texture origin at the top left
+        UVBuffer uvs = vertices.rightCols(2);
+        uvs.col(1) = 1.0f - uvs.col(1).array();
+        std::int64_t uv_view =
+          writer.add_buffer_view(pack_columns(uvs), 0, ARRAY_BUFFER);
+        attributes["TEXCOORD_0"] =
+          writer.add_accessor(uv_view, 0, FLOAT, num_vertices, "VEC2");
+      }
+
+      JsonValue material;
+      JsonValue pbr;
+      pbr["metallicFactor"] = 0.0;
+      pbr["roughnessFactor"] = 1.0;
+      material["doubleSided"] = mesh->m_double_sided;
+      if (!mesh->m_shared_color.is_none())
+      {
+        Eigen::Vector4f color;
+        color << mesh->m_shared_color, 1.0f;
+        pbr["baseColorFactor"] = to_json_array(color);
+      }
+
+      auto image_it = std::find_if(
+        m_images.begin(),
+        m_images.end(),
+        [&](const std::shared_ptr<Image>& image) {
+          return image->image_id() == mesh->m_texture_id;
+        });
+      if (
+        has_uvs && image_it != m_images.end() &&
+        !mime_type((*image_it)->ext()).empty())
+      {
+        const Image& image = **image_it;
+        if (images.count(image.image_id()) == 0)
+        {
+          JsonValue gltf_image;
+          gltf_image["bufferView"] =
+            writer.add_buffer_view(image.data().data(), image.data().size());
+          gltf_image["mimeType"] = mime_type(image.ext());
+          images[image.image_id()] =
+            append_index(gltf["images"], std::move(gltf_image));
+        }
+
+        auto key = std::make_pair(image.image_id(), mesh->m_nn_texture);
+        if (textures.count(key) == 0)
+        {
+          std::int64_t filter = mesh->m_nn_texture ? NEAREST : LINEAR;
+          JsonValue sampler;
+          sampler["magFilter"] = filter;
+          sampler["minFilter"] = filter;
+          JsonValue texture;
+          texture["source"] = images[image.image_id()];
+          texture["sampler"] =
+            append_index(gltf["samplers"], std::move(sampler));
+          textures[key] = append_index(gltf["textures"], std::move(texture));
+        }
+
+        pbr["baseColorTexture"]["index"] = textures[key];
+        if (mesh->m_use_texture_alpha)
+        {
+          material["alphaMode"] = "BLEND";
+        }
+      }
+
+      material["pbrMetallicRoughness"] = std::move(pbr);
+      JsonValue primitive;
+      primitive["attributes"] = std::move(attributes);
+      primitive["material"] =
+        append_index(gltf["materials"], std::move(material));
+
+      JsonValue gltf_mesh;
+      gltf_mesh["name"] = mesh->m_mesh_id;
+      if (!mesh->is_instanced() && !updates.empty())
+      {
+        // vertex updates become morph targets holding the difference from
+        // the base mesh, and each frame weights a single target. Updates
+        // pack only the streams they contain, whereas the base vertex buffer
+        // always starts with positions, normals and then any colors.
+        struct Stream
+        {
+          VertexBufferType type;
+          const char* attribute;
+          Eigen::Index base_col;
+        };
+
+        const Stream streams[] = {
+          {VertexBufferType::Positions, "POSITION", 0},
+          {VertexBufferType::Normals, "NORMAL", 3},
+          {VertexBufferType::Colors, "COLOR_0", 6}};
+        JsonValue& targets = primitive["targets"];
+        for (const auto& update : updates)
+        {
+          JsonValue target;
+          Eigen::Index col = 0;
+          for (const auto& stream : streams)
+          {
+            if (
+              (update->m_update_flags & stream.type) == VertexBufferType::None)
+            {
+              continue;
+            }
+
+            // targets may only displace attributes the base mesh has
+            if (stream.type != VertexBufferType::Colors || has_colors)
+            {
+              VectorBuffer delta = update->m_vertex_buffer.middleCols(col, 3) -
+                vertices.middleCols(stream.base_col, 3);
+              target[stream.attribute] = add_vertex_attribute(writer, delta);
+            }
+
+            col += 3;
+          }
+
+          targets.append(std::move(target));
+        }
+
+        std::size_t num_targets = updates.size();
+        gltf_mesh["weights"] =
+          to_json_array(Eigen::VectorXf::Zero(num_targets));
+        std::vector<float> weights(times.size() * num_targets, 0.0f);
+        for (std::size_t i = 0; i < num_targets; ++i)
+        {
+          weights[(i + 1) * num_targets + i] = 1.0f;
+        }
+
+        add_channel(
+          times,
+          std::move(weights),
+          "SCALAR",
+          to_int(nodes.values().size()),
+          "weights");
+      }
+
+      JsonValue& primitives = gltf_mesh["primitives"];
+      if (mesh->m_triangles.rows() > 0)
+      {
+        std::int64_t view = writer.add_buffer_view(
+          mesh->m_triangles.data(),
+          mesh->m_triangles.size() * sizeof(std::uint32_t),
+          0,
+          ELEMENT_ARRAY_BUFFER);
+        JsonValue triangles = primitive;
+        triangles["indices"] = writer.add_accessor(
+          view, 0, UNSIGNED_INT, mesh->m_triangles.size(), "SCALAR");
+        triangles["mode"] = MODE_TRIANGLES;
+        primitives.append(std::move(triangles));
+      }
+
+      if (mesh->m_lines.rows() > 0)
+      {
+        std::int64_t view = writer.add_buffer_view(
+          mesh->m_lines.data(),
+          mesh->m_lines.size() * sizeof(std::uint32_t),
+          0,
+          ELEMENT_ARRAY_BUFFER);
+        JsonValue lines = primitive;
+        lines["indices"] = writer.add_accessor(
+          view, 0, UNSIGNED_INT, mesh->m_lines.size(), "SCALAR");
+        lines["mode"] = MODE_LINES;
+        primitives.append(std::move(lines));
+      }
+
+      JsonValue node;
+      node["name"] = mesh->m_mesh_id;
+      node["mesh"] = append_index(gltf["meshes"], std::move(gltf_mesh));
+      if (!mesh->is_instanced())
+      {
+        scene_nodes.append(JsonValue(append_index(nodes, std::move(node))));
+        continue;
+      }
+
+      // instances are drawn through EXT_mesh_gpu_instancing. Each update
+      // becomes a node of its own which shares the mesh and any unchanged
+      // instance attributes, and which is only visible during its frame.
+      uses_instancing = true;
+      const InstanceBuffer& instances = mesh->m_instance_buffer;
+      std::size_t num_instances = instances.rows();
+      std::int64_t instance_view = writer.add_buffer_view(
+        instances.data(),
+        instances.size() * sizeof(float),
+        instances.cols() * sizeof(float));
+      JsonValue base_attributes;
+      base_attributes["TRANSLATION"] =
+        writer.add_accessor(instance_view, 0, FLOAT, num_instances, "VEC3");
+      std::size_t offset = 3 * sizeof(float);
+      if (mesh->m_instance_buffer_has_rotations)
+      {
+        base_attributes["ROTATION"] = writer.add_accessor(
+          instance_view, offset, FLOAT, num_instances, "VEC4");
+        offset += 4 * sizeof(float);
+      }
+
+      if (mesh->m_instance_buffer_has_colors)
+      {
+        base_attributes["_COLOR_0"] = writer.add_accessor(
+          instance_view, offset, FLOAT, num_instances, "VEC3");
+      }
+
+      std::vector<JsonValue> frame_nodes;
+      node["extensions"][INSTANCING]["attributes"] = base_attributes;
+      frame_nodes.push_back(node);
+      for (const auto& update : updates)
+      {
+        const VertexBuffer& buffer = update->m_vertex_buffer;
+        std::size_t count = buffer.rows();
+        std::int64_t view = writer.add_buffer_view(
+          buffer.data(),
+          buffer.size() * sizeof(float),
+          buffer.cols() * sizeof(float));
+        // updates pack only the streams they contain, and the base values
+        // are kept for the others
+        JsonValue frame_attributes = base_attributes;
+        offset = 0;
+        if (
+          (update->m_update_flags & VertexBufferType::Positions) !=
+          VertexBufferType::None)
+        {
+          frame_attributes["TRANSLATION"] =
+            writer.add_accessor(view, offset, FLOAT, count, "VEC3");
+          offset += 3 * sizeof(float);
+        }
+
+        if (
+          (update->m_update_flags & VertexBufferType::Rotations) !=
+          VertexBufferType::None)
+        {
+          frame_attributes["ROTATION"] =
+            writer.add_accessor(view, offset, FLOAT, count, "VEC4");
+          offset += 4 * sizeof(float);
+        }
+
+        if (
+          (update->m_update_flags & VertexBufferType::Colors) !=
+          VertexBufferType::None)
+        {
+          frame_attributes["_COLOR_0"] =
+            writer.add_accessor(view, offset, FLOAT, count, "VEC3");
+        }
+
+        JsonValue frame_node;
+        frame_node["name"] = update->m_mesh_id;
+        frame_node["mesh"] = node["mesh"];
+        frame_node["scale"] = to_json_array(Eigen::Vector3f::Zero());
+        frame_node["extensions"][INSTANCING]["attributes"] =
+          std::move(frame_attributes);
+        frame_nodes.push_back(std::move(frame_node));
+      }
+
+      for (std::size_t i = 0; i < frame_nodes.size(); ++i)
+      {
+        std::int64_t node_index =
+          append_index(nodes, std::move(frame_nodes[i]));
+        scene_nodes.append(JsonValue(node_index));
+        if (updates.empty())
+        {
+          continue;
+        }
+
+        // with step interpolation only the changes in visibility are keyed
+        std::vector<float> keys = {0.0f};
+        std::vector<float> scales = {0, 0, 0};
+        if (i == 0)
+        {
+          std::fill(scales.begin(), scales.end(), 1.0f);
+        }
+        else
+        {
+          keys.push_back(times[i]);
+          scales.insert(scales.end(), {1, 1, 1});
+        }
+
+        if (i + 1 < times.size())
+        {
+          keys.push_back(times[i + 1]);
+          scales.insert(scales.end(), {0, 0, 0});
+        }
+
+        add_channel(keys, std::move(scales), "VEC3", node_index, "scale");
+      }
+    }
+
+    if (!channels.values().empty())
+    {
+      JsonValue animation;
+      animation["channels"] = std::move(channels);
+      animation["samplers"] = std::move(samplers);
+      gltf["animations"].append(std::move(animation));
+    }
+
+    if (uses_instancing)
+    {
+      gltf["extensionsUsed"].append(JsonValue(INSTANCING));
+    }
+
+    JsonValue scene;
+    if (!scene_nodes.values().empty())
+    {
+      gltf["nodes"] = std::move(nodes);
+      scene["nodes"] = std::move(scene_nodes);
+    }
+
+    gltf["scene"] = std::int64_t(0);
+    gltf["scenes"].append(std::move(scene));
+    writer.write(path);
+  }
+} // namespace scenepic
@@ -0,0 +1,226 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "spatial_sort.h"
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace scenepic
+{
+  namespace
+  {
+    const int BITS_PER_AXIS = 21;
+    const int KEY_BITS = 3 * BITS_PER_AXIS;
+    const int RADIX_BITS = 11;
+    const std::size_t NUM_BUCKETS = std::size_t(1) << RADIX_BITS;
+    const std::ptrdiff_t MIN_CHUNK = 16384;
+
+    struct SortEntry
+    {
+      std::uint64_t key;
+      std::uint32_t index;
+    };
+
+    /** Spreads the low 21 bits of value so that there are two zero bits
+     *  between each of them.
+     */
+    std::uint64_t spread_bits(std::uint64_t value)
+    {
+      value &= 0x1fffff;
+      value = (value | value << 32) & 0x1f00000000ffffULL;
+      value = (value | value << 16) & 0x1f0000ff0000ffULL;
+      value = (value | value << 8) & 0x100f00f00f00f00fULL;
+      value = (value | value << 4) & 0x10c30c30c30c30c3ULL;
+      value = (value | value << 2) & 0x1249249249249249ULL;
+      return value;
+    }
+
+    /** Interleaves three quantized coordinates, with the first coordinate
+     *  in the most significant position of each triple.
+     */
+    std::uint64_t interleave(const std::array<std::uint32_t, 3>& axes)
+    {
+      return spread_bits(axes[0]) << 2 | spread_bits(axes[1]) << 1 |
+             spread_bits(axes[2]);
+    }
+
+    /** Converts quantized coordinates to the transposed form of their
+     *  Hilbert index (Skilling, "Programming the Hilbert curve", 2004).
+     *  Interleaving the result gives the index along the curve.
+     */
+    std::uint64_t hilbert_key(std::array<std::uint32_t, 3> axes)
+    {
+      const std::uint32_t top = 1u << (BITS_PER_AXIS - 1);
+      for (std::uint32_t bit = top; bit > 1; bit >>= 1)
+      {
+        std::uint32_t mask = bit - 1;
+        for (auto& axis : axes)
+        {
+          if (axis & bit)
+          {
+            axes[0] ^= mask;
+          }
+          else
+          {
+            std::uint32_t swap = (axes[0] ^ axis) & mask;
+            axes[0] ^= swap;
+            axis ^= swap;
+          }
+        }
+      }
+
+      axes[1] ^= axes[0];
+      axes[2] ^= axes[1];
+      std::uint32_t flip = 0;
+      for (std::uint32_t bit = top; bit > 1; bit >>= 1)
+      {
+        if (axes[2] & bit)
+        {
+          flip ^= bit - 1;
+        }
+      }
+
+      for (auto& axis : axes)
+      {
+        axis ^= flip;
+      }
+
+      return interleave(axes);
+    }
+
+    /** Sorts the entries by key with a stable LSD radix sort. Each pass
+     *  builds per-chunk histograms in parallel and scatters every chunk into
+     *  its own slice of the output, so the result does not depend on the
+     *  number of threads.
+     */
+    void radix_sort(std::vector<SortEntry>& entries)
+    {
+      auto count = static_cast<std::ptrdiff_t>(entries.size());
+      std::ptrdiff_t num_chunks =
+        std::max<std::ptrdiff_t>(1, parallel_chunk_count(count, MIN_CHUNK));
+      std::vector<std::vector<std::size_t>> histograms(num_chunks);
+      std::vector<SortEntry> sorted(entries.size());
+      for (int shift = 0; shift < KEY_BITS; shift += RADIX_BITS)
+      {
+        auto digit = [shift](const SortEntry& entry) {
+          return static_cast<std::size_t>(entry.key >> shift) &
+                 (NUM_BUCKETS - 1);
+        };
+
+        parallel_for(
+          0,
+          count,
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+            std::vector<std::size_t>& histogram = histograms[chunk];
+            histogram.assign(NUM_BUCKETS, 0);
+            for (auto i = begin; i < end; ++i)
+            {
+              histogram[digit(entries[i])] += 1;
+            }
+          },
+          MIN_CHUNK);
+
+        // a digit shared by every entry leaves the order unchanged
+        std::size_t total = 0;
+        bool single_bucket = false;
+        for (std::size_t bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+        {
+          std::size_t bucket_total = 0;
+          for (auto& histogram : histograms)
+          {
+            std::size_t bucket_count = histogram[bucket];
+            histogram[bucket] = total;
+            total += bucket_count;
+            bucket_total += bucket_count;
+          }
+
+          single_bucket = single_bucket || bucket_total == entries.size();
+        }
+
+        if (single_bucket)
+        {
+          continue;
+        }
+
+        parallel_for(
+          0,
+          count,
+          [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t chunk) {
+            std::vector<std::size_t>& histogram = histograms[chunk];
+            for (auto i = begin; i < end; ++i)
+            {
+              sorted[histogram[digit(entries[i])]++] = entries[i];
+            }
+          },
+          MIN_CHUNK);
+
+        entries.swap(sorted);
+      }
+    }
+  } // namespace
+
+  std::vector<std::uint32_t> spatial_order(
+    const ConstVectorBufferRef& positions, const std::string& curve)
+  {
+    bool hilbert = curve == "hilbert";
+    if (!hilbert && curve != "morton" && curve != "none")
+    {
+      throw std::invalid_argument(
+        "Invalid curve: " + curve + ". Expected morton, hilbert or none.");
+    }
+
+    auto count = static_cast<std::ptrdiff_t>(positions.rows());
+    std::vector<std::uint32_t> order(count);
+    if (curve == "none" || count < 2)
+    {
+      std::iota(order.begin(), order.end(), 0);
+      return order;
+    }
+
+    Eigen::RowVector3f min_corner = positions.colwise().minCoeff();
+    Eigen::RowVector3f extent = positions.colwise().maxCoeff() - min_corner;
+    const float max_value = static_cast<float>((1u << BITS_PER_AXIS) - 1);
+    Eigen::RowVector3f scale;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      scale(axis) = extent(axis) > 0 ? max_value / extent(axis) : 0.0f;
+    }
+
+    std::vector<SortEntry> entries(count);
+    parallel_for(
+      0,
+      count,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t) {
+        std::array<std::uint32_t, 3> axes;
+        for (auto i = begin; i < end; ++i)
+        {
+          for (int axis = 0; axis < 3; ++axis)
+          {
+            float value = (positions(i, axis) - min_corner(axis)) * scale(axis);
+            // also catches NaN, which cannot be converted to an integer
+            value = value > 0 ? std::min(value, max_value) : 0.0f;
+            axes[axis] = static_cast<std::uint32_t>(value);
+          }
+
+          entries[i].key = hilbert ? hilbert_key(axes) : interleave(axes);
+          entries[i].index = static_cast<std::uint32_t>(i);
+        }
+      },
+      MIN_CHUNK);
+
+    radix_sort(entries);
+    for (std::ptrdiff_t i = 0; i < count; ++i)
+    {
+      order[i] = entries[i].index;
+    }
+
+    return order;
+  }
+} // namespace scenepic
@@ -53,7 +53,7 @@ namespace scenepic
       command["CommandType"] = "SetTextPanelValue";
       command["TextPanelId"] = m_text_panel_id;
       command["Value"] = m_text;
-      commands.append(command);
+      commands.append(std::move(command));
     }
 
     if (!m_title.empty())
@@ -62,7 +62,7 @@ namespace scenepic
       command["CommandType"] = "SetTextPanelTitle";
       command["TextPanelId"] = m_text_panel_id;
       command["Value"] = m_title;
-      commands.append(command);
+      commands.append(std::move(command));
     }
 
     if (!m_input_text.empty())
@@ -71,7 +71,7 @@ namespace scenepic
       command["CommandType"] = "SetTextPanelInputText";
       command["TextPanelId"] = m_text_panel_id;
       command["Value"] = m_input_text;
-      commands.append(command);
+      commands.append(std::move(command));
     }
 
     return commands;
@@ -5,6 +5,8 @@
 
 #include "miniz/miniz.h"
 
+#include <stdexcept>
+
 namespace scenepic
 {
   std::vector<std::uint8_t>
@@ -26,7 +28,13 @@ namespace scenepic
     mz_ulong dest_len = static_cast<mz_ulong>(dest_length);
     std::vector<std::uint8_t> inflate_bytes(dest_len);
     mz_ulong source_len = static_cast<mz_ulong>(source_length);
-    mz_uncompress(inflate_bytes.data(), &dest_len, data, source_len);
+    int status =
+      mz_uncompress(inflate_bytes.data(), &dest_len, data, source_len);
+    if (status != MZ_OK || dest_len != dest_length)
+    {
+      throw std::invalid_argument("Unable to inflate the data.");
+    }
+
     return inflate_bytes;
   }
 }
\ No newline at end of file
@@ -3,9 +3,15 @@
 
 #include "canvas2d.h"
 
+#include "base64.h"
+#include "compression.h"
 #include "scene.h"
 #include "scenepic_tests.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 int test_canvas2d()
 {
   int result = EXIT_SUCCESS;
@@ -34,5 +40,84 @@ int test_canvas2d()
 
   test::assert_equal(canvas2d->to_json(), "canvas2d_cleared", result);
 
+  // shared buffers hold the same coordinates and styles as the frames
+  auto shared = scene.create_canvas_2d("shared");
+  std::vector<std::shared_ptr<scenepic::Frame2D>> frames;
+  for (int i = 0; i < 3; ++i)
+  {
+    frame2d = shared->create_frame();
+    frame2d->add_line(positions.array() + (i == 2 ? 1.0f : 0.0f));
+    frame2d->add_circle(i, 0, 1, scenepic::Colors::Red);
+    frames.push_back(frame2d);
+  }
+
+  shared->shared_buffers(true).delta_coordinates(true);
+  scenepic::JsonValue commands = shared->to_json()["Commands"];
+  const scenepic::JsonValue& buffers = commands.values()[1];
+  test::assert_equal(
+    buffers["CommandType"].as_string(),
+    std::string("SetSharedBuffers"),
+    result,
+    "shared_command");
+
+  typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 2, Eigen::RowMajor>
+    CoordinateBits;
+  std::string text =
+    scenepic::base64_decode(buffers["CoordinateBuffer"].as_string());
+  std::vector<std::uint8_t> bytes(text.begin(), text.end());
+  CoordinateBits bits = scenepic::decompress_matrix<CoordinateBits>(bytes);
+  text = scenepic::base64_decode(buffers["StyleBuffer"].as_string());
+  bytes.assign(text.begin(), text.end());
+  scenepic::StyleBuffer styles =
+    scenepic::decompress_matrix<scenepic::StyleBuffer>(bytes);
+  test::assert_equal(
+    static_cast<int>(styles.rows()), 6, result, "shared_styles");
+
+  scenepic::CoordinateBuffer previous;
+  for (int i = 0; i < 3; ++i)
+  {
+    const scenepic::JsonValue& frame_commands =
+      commands.values()[2 + i].values()[1]["Commands"];
+    const scenepic::JsonValue& set_coords = frame_commands.values()[0];
+    Eigen::Index start = set_coords["Start"].as_int();
+    Eigen::Index count = set_coords["Count"].as_int();
+    CoordinateBits frame_bits = bits.middleRows(start, count);
+    bool delta = set_coords.lookup().count("Delta") > 0;
+    test::assert_equal(delta, i > 0, result, "shared_delta");
+    if (delta)
+    {
+      const auto* previous_bits =
+        reinterpret_cast<const std::uint32_t*>(previous.data());
+      for (Eigen::Index j = 0; j < frame_bits.size(); ++j)
+      {
+        frame_bits.data()[j] ^= previous_bits[j];
+      }
+    }
+
+    scenepic::CoordinateBuffer coordinates = Eigen::Map<
+      const scenepic::CoordinateBuffer>(
+      reinterpret_cast<const float*>(frame_bits.data()), count, 2);
+    scenepic::JsonValue expected = frames[i]->to_json();
+    text = scenepic::base64_decode(
+      expected.values()[1]["Commands"].values()[0]["CoordinateBuffer"]
+        .as_string());
+    bytes.assign(text.begin(), text.end());
+    test::assert_allclose(
+      coordinates,
+      scenepic::decompress_matrix<scenepic::CoordinateBuffer>(bytes),
+      result,
+      "shared_coordinates",
+      0.0f);
+    previous = coordinates;
+
+    const scenepic::JsonValue& add_circles = frame_commands.values()[2];
+    Eigen::Index style_start = add_circles["StyleStart"].as_int();
+    test::assert_equal(
+      static_cast<int>(styles(style_start, 1)),
+      255,
+      result,
+      "shared_circle_style");
+  }
+
   return result;
 }
\ No newline at end of file
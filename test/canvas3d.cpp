@@ -3,10 +3,89 @@
 
 #include "canvas3d.h"
 
+#include "base64.h"
+#include "compression.h"
+#include "packing.h"
 #include "scene.h"
 #include "scenepic_tests.h"
 #include "transforms.h"
 
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+  /** Decompresses a buffer of integer deltas stored as the given type. */
+  template<typename Integer>
+  Eigen::Matrix<std::int64_t, Eigen::Dynamic, 1>
+  decompress_deltas(const std::vector<std::uint8_t>& bytes)
+  {
+    typedef Eigen::Matrix<Integer, Eigen::Dynamic, 1> Deltas;
+    Deltas deltas = scenepic::decompress_matrix<Deltas>(bytes);
+    return deltas.template cast<std::int64_t>();
+  }
+
+  /** Decodes a track the way the client does. */
+  scenepic::VertexBuffer decode_track(const scenepic::JsonValue& track)
+  {
+    std::string buffer =
+      scenepic::base64_decode(track["DeltaBuffer"].as_string());
+    std::vector<std::uint8_t> bytes(buffer.begin(), buffer.end());
+    const std::string& delta_type = track["DeltaType"].as_string();
+    Eigen::Matrix<std::int64_t, Eigen::Dynamic, 1> deltas;
+    if (delta_type == "Int8")
+    {
+      deltas = decompress_deltas<std::int8_t>(bytes);
+    }
+    else if (delta_type == "Int16")
+    {
+      deltas = decompress_deltas<std::int16_t>(bytes);
+    }
+    else
+    {
+      deltas = decompress_deltas<std::int32_t>(bytes);
+    }
+
+    const auto& steps = track["Steps"].values();
+    const auto& origin = track["Origin"].values();
+    auto num_cols = static_cast<Eigen::Index>(steps.size());
+    Eigen::Index num_rows = deltas.size() / num_cols + 1;
+    scenepic::VertexBuffer values(num_rows, num_cols);
+    bool second_order = track["DeltaOrder"].as_int() == 2;
+    for (Eigen::Index col = 0; col < num_cols; ++col)
+    {
+      std::int64_t current = origin[col].as_int();
+      std::int64_t delta = 0;
+      for (Eigen::Index row = 0; row < num_rows; ++row)
+      {
+        if (row > 0)
+        {
+          std::int64_t value = deltas(col * (num_rows - 1) + row - 1);
+          delta = second_order ? delta + value : value;
+          current += delta;
+        }
+
+        values(row, col) = static_cast<float>(current * steps[col].as_double());
+      }
+    }
+
+    return values;
+  }
+
+  /** Decodes a buffer of unsigned indices. */
+  std::vector<std::uint32_t> decode_indices(const scenepic::JsonValue& buffer)
+  {
+    typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 1> IndexBuffer;
+    std::string text = scenepic::base64_decode(buffer.as_string());
+    std::vector<std::uint8_t> bytes(text.begin(), text.end());
+    IndexBuffer indices = scenepic::decompress_matrix<IndexBuffer>(bytes);
+    return std::vector<std::uint32_t>(
+      indices.data(), indices.data() + indices.size());
+  }
+} // namespace
+
 int test_canvas3d()
 {
   int result = EXIT_SUCCESS;
@@ -48,5 +127,274 @@ int test_canvas3d()
 
   test::assert_equal(canvas3d->to_json(), "canvas3d_cleared", result);
 
+  auto tracks = scene.create_canvas_3d("tracks");
+  const int num_frames = 100;
+  for (int i = 0; i < num_frames; ++i)
+  {
+    tracks->create_frame();
+  }
+
+  scenepic::VertexBuffer poses(num_frames - 10, 7);
+  for (Eigen::Index i = 0; i < poses.rows(); ++i)
+  {
+    // the quaternion flips hemisphere halfway through the track
+    float angle = 0.05f * i;
+    float sign = i < poses.rows() / 2 ? 1.0f : -1.0f;
+    poses.row(i) << std::cos(angle), 0.01f * i, 2, 0, 0,
+      sign * std::sin(angle / 2), sign * std::cos(angle / 2);
+  }
+
+  tracks->add_transform_track("cube", poses, 10);
+  scenepic::JsonValue track = tracks->to_json()["Commands"].values().back();
+  test::assert_equal(
+    track["CommandType"].as_string(),
+    std::string("AddTransformTrack"),
+    result,
+    "track_type");
+  test::assert_equal(
+    track["StartFrame"].as_int(), std::int64_t(10), result, "track_start");
+  test::assert_equal(
+    track["DeltaType"].as_string(),
+    std::string("Int16"),
+    result,
+    "track_delta_type");
+
+  scenepic::VertexBuffer decoded = decode_track(track);
+  poses.rightCols(4).bottomRows(poses.rows() / 2) *= -1;
+  test::assert_allclose(decoded, poses, result, "track_poses", 1e-4f);
+
+  scenepic::VertexBuffer transforms(2, 16);
+  transforms.row(0) << 2, 0, 0, 1, 0, 2, 0, 2, 0, 0, 2, 3, 0, 0, 0, 1;
+  transforms.row(1) << 0, -1, 0, 1, 1, 0, 0, 2, 0, 0, 1, 3, 0, 0, 0, 1;
+  tracks->add_transform_track("cube", transforms);
+  track = tracks->to_json()["Commands"].values().back();
+  test::assert_equal(
+    track["TrackType"].as_string(),
+    std::string("Affine"),
+    result,
+    "affine_type");
+
+  // the linear part is quantized relative to the scale of each axis
+  scenepic::VertexBuffer scaled = transforms;
+  float large_error = 0;
+  float small_error = 0;
+  for (int row = 0; row < 3; ++row)
+  {
+    scaled.col(4 * row) *= 1e5f;
+    scaled.col(4 * row + 1) *= 1e-3f;
+  }
+
+  tracks->add_transform_track("cube", scaled);
+  track = tracks->to_json()["Commands"].values().back();
+  decoded = decode_track(track);
+  for (int row = 0; row < 3; ++row)
+  {
+    large_error = std::max(
+      large_error,
+      (decoded.col(4 * row) - scaled.col(4 * row)).cwiseAbs().maxCoeff());
+    small_error = std::max(
+      small_error,
+      (decoded.col(4 * row + 1) - scaled.col(4 * row + 1))
+        .cwiseAbs()
+        .maxCoeff());
+  }
+
+  test::assert_lessthan(
+    large_error, 2e5f / 32768, result, "affine_large_scale");
+  test::assert_lessthan(
+    small_error, 2e-3f / 32768, result, "affine_small_scale");
+
+  try
+  {
+    tracks->add_transform_track("cube", scenepic::VertexBuffer(0, 7));
+    std::cerr << "track_empty did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  try
+  {
+    tracks->add_transform_track("cube", poses, 20);
+    std::cerr << "track_past_end did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  try
+  {
+    transforms(1, 12) = 1;
+    tracks->add_transform_track("cube", transforms);
+    std::cerr << "track_projective did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  // every ninth frame of the fly-through is a keyframe
+  std::vector<scenepic::Camera> cameras = scenepic::Camera::orbit(11, 3, 1);
+  tracks->add_camera_track(cameras, 0, 9);
+  track = tracks->to_json()["Commands"].values().back();
+  test::assert_equal(
+    track["CommandType"].as_string(),
+    std::string("AddCameraTrack"),
+    result,
+    "camera_track_type");
+  test::assert_equal(
+    track["KeyframeInterval"].as_int(),
+    std::int64_t(9),
+    result,
+    "camera_track_interval");
+  test::assert_near(
+    track["FarCropDistance"].as_float(),
+    20.0f,
+    result,
+    "camera_track_far",
+    1e-3f);
+  scenepic::VertexBuffer expected_cameras(cameras.size(), 10);
+  for (std::size_t i = 0; i < cameras.size(); ++i)
+  {
+    expected_cameras.row(i) << cameras[i].center(), cameras[i].look_at(),
+      cameras[i].up_dir(), 45;
+  }
+
+  decoded = decode_track(track);
+  test::assert_allclose(
+    decoded, expected_cameras, result, "camera_track_values", 1e-3f);
+
+  std::vector<scenepic::FocusPoint> focus_points = {
+    scenepic::FocusPoint(scenepic::Vector(1, 2, 3), scenepic::Vector(0, 1, 0)),
+    scenepic::FocusPoint(scenepic::Vector(2, 2, 3), scenepic::Vector(0, 1, 0))};
+  tracks->add_focus_point_track(focus_points, 5);
+  track = tracks->to_json()["Commands"].values().back();
+  decoded = decode_track(track);
+  scenepic::VertexBuffer expected_focus(2, 6);
+  expected_focus << 1, 2, 3, 0, 1, 0, 2, 2, 3, 0, 1, 0;
+  test::assert_allclose(
+    decoded, expected_focus, result, "focus_track_values", 1e-3f);
+
+  try
+  {
+    cameras.back() = scenepic::Camera(
+      scenepic::Vector(0, 0, 4),
+      scenepic::Vector(0, 0, 0),
+      scenepic::Vector(0, 1, 0),
+      45,
+      0.01,
+      100);
+    tracks->add_camera_track(cameras);
+    std::cerr << "camera_track_clipping did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  try
+  {
+    focus_points.push_back(scenepic::FocusPoint(scenepic::Vector(3, 2, 3)));
+    tracks->add_focus_point_track(focus_points);
+    std::cerr << "focus_track_orientation did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  // the untransformed cube is in every frame and so joins the static layer
+  auto deltas = scene.create_canvas_3d("deltas");
+  deltas->delta_frames(true);
+  const std::vector<std::vector<float>> frame_offsets = {
+    {0, 1, 2, 3}, {0, 1, 2, 4}, {0, 5}};
+  for (const auto& offsets : frame_offsets)
+  {
+    auto frame = deltas->create_frame();
+    for (auto offset : offsets)
+    {
+      scenepic::Vector position(offset, 0, 0);
+      frame->add_mesh_by_id("cube", scenepic::Transforms::translate(position));
+    }
+  }
+
+  std::vector<scenepic::JsonValue> frame_commands;
+  scenepic::JsonValue static_meshes;
+  scenepic::JsonValue delta_json = deltas->to_json();
+  for (const auto& command : delta_json["Commands"].values())
+  {
+    if (command.type() == scenepic::JsonType::Array)
+    {
+      frame_commands.push_back(command.values()[1]["Commands"]);
+    }
+    else if (command["CommandType"].as_string() == "SetStaticMeshes")
+    {
+      static_meshes = command;
+    }
+  }
+
+  test::assert_equal(
+    frame_commands.size(), std::size_t(3), result, "delta_frame_count");
+  test::assert_equal(
+    static_meshes["MeshIds"].values().size(),
+    std::size_t(1),
+    result,
+    "static_mesh_ids");
+  test::assert_equal(
+    decode_indices(static_meshes["MeshIndices"]),
+    std::vector<std::uint32_t>({0}),
+    result,
+    "static_mesh_indices");
+  test::assert_equal(
+    frame_commands[0].values().size(), std::size_t(3), result, "delta_first");
+
+  const scenepic::JsonValue& copy = frame_commands[1].values()[0];
+  test::assert_equal(
+    copy["CommandType"].as_string(),
+    std::string("CopyMeshes"),
+    result,
+    "delta_copy");
+  test::assert_equal(
+    decode_indices(copy["Remove"]),
+    std::vector<std::uint32_t>({2}),
+    result,
+    "delta_remove");
+  test::assert_equal(
+    frame_commands[1].values().size(), std::size_t(2), result, "delta_added");
+
+  // replacing every dynamic mesh is cheaper to send in full
+  test::assert_equal(
+    frame_commands[2].values().size(), std::size_t(1), result, "delta_full");
+  test::assert_equal(
+    frame_commands[2].values()[0]["CommandType"].as_string(),
+    std::string("AddMesh"),
+    result,
+    "delta_full_type");
+
+  // frames written in full after a delta script must not keep its layer
+  deltas->clear_script();
+  deltas->delta_frames(false);
+  deltas->create_frame()->add_mesh_by_id("cube");
+  std::size_t num_static_meshes = 0;
+  std::size_t num_static_commands = 0;
+  delta_json = deltas->to_json();
+  for (const auto& command : delta_json["Commands"].values())
+  {
+    if (
+      command.type() != scenepic::JsonType::Array &&
+      command["CommandType"].as_string() == "SetStaticMeshes")
+    {
+      num_static_meshes += command["MeshIds"].values().size();
+      num_static_commands += 1;
+    }
+  }
+
+  test::assert_equal(
+    num_static_commands, std::size_t(1), result, "static_cleared");
+  test::assert_equal(
+    num_static_meshes, std::size_t(0), result, "static_cleared_ids");
+
   return result;
 }
\ No newline at end of file
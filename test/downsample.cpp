@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "scenepic.h"
+#include "scenepic_tests.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace sp = scenepic;
+
+int test_downsample()
+{
+  int result = EXIT_SUCCESS;
+
+  // a noisy curve with a single spike in the middle
+  const int count = 100000;
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noise(0.0f, 0.1f);
+  sp::ValueBuffer values(count);
+  for (int i = 0; i < count; ++i)
+  {
+    values(i) = std::exp(-i / 20000.0f) + noise(rng);
+  }
+
+  const int spike = 54321;
+  values(spike) = 10.0f;
+
+  for (const std::string method : {"m4", "lttb"})
+  {
+    std::vector<std::uint32_t> indices = sp::downsample(values, 400, method);
+    test::assert_equal(
+      indices.size() <= 400 && indices.size() > 200,
+      true,
+      result,
+      method + "_count");
+    test::assert_equal(
+      std::adjacent_find(
+        indices.begin(), indices.end(), std::greater_equal<std::uint32_t>()) ==
+        indices.end(),
+      true,
+      result,
+      method + "_increasing");
+    test::assert_equal(indices.front(), 0u, result, method + "_first");
+    test::assert_equal(
+      indices.back(),
+      static_cast<std::uint32_t>(count - 1),
+      result,
+      method + "_last");
+    test::assert_equal(
+      std::find(indices.begin(), indices.end(), spike) != indices.end(),
+      true,
+      result,
+      method + "_spike");
+  }
+
+  // m4 keeps the extremes of every bucket, including the global minimum
+  std::vector<std::uint32_t> m4 = sp::downsample(values, 400, "m4");
+  Eigen::Index min_index;
+  values.minCoeff(&min_index);
+  test::assert_equal(
+    std::find(m4.begin(), m4.end(), min_index) != m4.end(),
+    true,
+    result,
+    "m4_minimum");
+
+  // short series are returned as they are
+  std::vector<std::uint32_t> identity(10);
+  std::iota(identity.begin(), identity.end(), 0);
+  test::assert_equal(
+    sp::downsample(values.head(10), 16, "lttb"),
+    identity,
+    result,
+    "short_series");
+
+  try
+  {
+    sp::downsample(values, 400, "average");
+    std::cerr << "invalid_method did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  try
+  {
+    sp::downsample(values, 3, "m4");
+    std::cerr << "too_few_points did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  return result;
+}
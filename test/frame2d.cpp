@@ -1,9 +1,15 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 
+#include "base64.h"
+#include "compression.h"
 #include "scene.h"
 #include "scenepic_tests.h"
 
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 int test_frame2d()
 {
   int result = EXIT_SUCCESS;
@@ -15,5 +21,121 @@ int test_frame2d()
 
   test::assert_equal(frame2d->to_json(), "frame2d", result);
 
+  // adding lines in bulk is the same as adding them one at a time
+  scenepic::CoordinateBuffer coordinates(7, 2);
+  coordinates << 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6;
+  auto single = canvas2d->create_frame();
+  single->add_line(coordinates.topRows(3), scenepic::Colors::Red);
+  single->add_line(coordinates.bottomRows(4), scenepic::Colors::Red);
+  auto bulk = canvas2d->create_frame();
+  bulk->add_lines(coordinates, {0, 3}, scenepic::Colors::Red);
+  test::assert_equal(
+    bulk->to_json().values()[1]["Commands"].to_string(),
+    single->to_json().values()[1]["Commands"].to_string(),
+    result,
+    "bulk_lines");
+
+  // frames with more coordinates than 16-bit indices can address
+  const Eigen::Index num_coords = 70000;
+  scenepic::CoordinateBuffer dense =
+    scenepic::CoordinateBuffer::Random(num_coords, 2);
+  auto large = canvas2d->create_frame();
+  large->add_lines(dense, {0, 60000, 65000});
+  test::assert_equal(
+    large->num_coordinates(),
+    static_cast<std::uint32_t>(num_coords),
+    result,
+    "num_coordinates");
+  scenepic::JsonValue frame_json = large->to_json();
+  const scenepic::JsonValue& add_lines =
+    frame_json.values()[1]["Commands"].values()[1];
+  test::assert_equal(
+    add_lines["IndexType"].as_string(),
+    std::string("UInt32"),
+    result,
+    "index_type");
+  typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 3, Eigen::RowMajor>
+    WideLines;
+  std::string text =
+    scenepic::base64_decode(add_lines["InfoBuffer"].as_string());
+  std::vector<std::uint8_t> bytes(text.begin(), text.end());
+  WideLines lines = scenepic::decompress_matrix<WideLines>(bytes);
+  test::assert_equal(
+    static_cast<std::uint32_t>(lines(2, 1)),
+    static_cast<std::uint32_t>(num_coords),
+    result,
+    "wide_line_end");
+
+  try
+  {
+    large->add_lines(coordinates, {3, 1});
+    std::cerr << "decreasing_offsets did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  // bulk rectangles and circles match their single counterparts
+  scenepic::VertexBuffer rectangles(2, 4);
+  rectangles << 0, 0, 10, 5, 20, 20, 4, 4;
+  scenepic::ValueBuffer radii(1);
+  radii << 3;
+  single = canvas2d->create_frame();
+  single->add_rectangle(0, 0, 10, 5, scenepic::Colors::Red, 2.0f);
+  single->add_rectangle(20, 20, 4, 4, scenepic::Colors::Red, 2.0f);
+  single->add_circle(1, 2, 3, scenepic::Colors::Black);
+  single->add_circle(4, 5, 3, scenepic::Colors::Black);
+  bulk = canvas2d->create_frame();
+  scenepic::ValueBuffer widths(1);
+  widths << 2;
+  bulk->add_rectangles(
+    rectangles, scenepic::Colors::Red.transpose(), widths);
+  scenepic::CoordinateBuffer centers(2, 2);
+  centers << 1, 2, 4, 5;
+  bulk->add_circles(centers, radii);
+  test::assert_equal(
+    bulk->to_json().values()[1]["Commands"].to_string(),
+    single->to_json().values()[1]["Commands"].to_string(),
+    result,
+    "bulk_shapes");
+
+  // repeated labels are sent once in the string table
+  auto labels = canvas2d->create_frame();
+  scenepic::CoordinateBuffer positions(4, 2);
+  positions << 0, 0, 1, 1, 2, 2, 3, 3;
+  labels->add_texts({"a", "b", "a", "a"}, positions);
+  frame_json = labels->to_json();
+  const scenepic::JsonValue& add_texts =
+    frame_json.values()[1]["Commands"].values()[1];
+  std::vector<std::string> strings;
+  for (const auto& string : add_texts["Strings"].values())
+  {
+    strings.push_back(string.as_string());
+  }
+
+  test::assert_equal(
+    strings, std::vector<std::string>({"a", "b"}), result, "string_table");
+  typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 1> Indices;
+  text = scenepic::base64_decode(add_texts["StringIndices"].as_string());
+  bytes.assign(text.begin(), text.end());
+  Indices indices = scenepic::decompress_matrix<Indices>(bytes);
+  Indices expected_indices(4);
+  expected_indices << 0, 1, 0, 0;
+  test::assert_equal(
+    indices == expected_indices, true, result, "string_indices");
+
+  try
+  {
+    scenepic::ValueBuffer too_few(2);
+    too_few << 1, 2;
+    bulk->add_circles(positions, too_few);
+    std::cerr << "mismatched_rows did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
   return result;
-}
\ No newline at end of file
+}
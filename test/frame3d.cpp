@@ -1,8 +1,14 @@
 // Copyright (c) Microsoft Corporation.
 // Licensed under the MIT License.
 
+#include "base64.h"
+#include "compression.h"
 #include "scene.h"
 #include "scenepic_tests.h"
+#include "transforms.h"
+
+#include <string>
+#include <vector>
 
 int test_frame3d()
 {
@@ -18,5 +24,51 @@ int test_frame3d()
 
   test::assert_equal(frame3d->to_json(), "frame3d", result);
 
+  auto sphere_mesh = scene.create_mesh("sphere");
+  sphere_mesh->add_sphere(test::COLOR);
+  auto compact = canvas3d->create_frame();
+  compact->compact_meshes(true);
+  compact->add_mesh(cube_mesh);
+  compact->add_mesh(sphere_mesh, scenepic::Transforms::scale(2));
+  compact->add_mesh(cube_mesh);
+
+  scenepic::JsonValue compact_json = compact->to_json();
+  const std::vector<scenepic::JsonValue>& commands =
+    compact_json.values()[1]["Commands"].values();
+  test::assert_equal(commands.size(), std::size_t(1), result, "table_commands");
+  const scenepic::JsonValue& table = commands[0];
+  test::assert_equal(
+    table["CommandType"].as_string(),
+    std::string("AddMeshTable"),
+    result,
+    "table_type");
+  test::assert_equal(
+    table["MeshIds"].values()[1].as_string(),
+    std::string("sphere"),
+    result,
+    "table_mesh_ids");
+
+  typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, 1> IndexBuffer;
+  std::string index_bytes =
+    scenepic::base64_decode(table["MeshIndices"].as_string());
+  IndexBuffer indices = scenepic::decompress_matrix<IndexBuffer>(
+    std::vector<std::uint8_t>(index_bytes.begin(), index_bytes.end()));
+  test::assert_equal(
+    std::vector<std::uint32_t>(indices.data(), indices.data() + 3),
+    std::vector<std::uint32_t>({0, 1, 0}),
+    result,
+    "table_indices");
+
+  typedef Eigen::Matrix<float, Eigen::Dynamic, 16, Eigen::RowMajor>
+    TransformBuffer;
+  std::string transform_bytes =
+    scenepic::base64_decode(table["Transforms"].as_string());
+  TransformBuffer transforms = scenepic::decompress_matrix<TransformBuffer>(
+    std::vector<std::uint8_t>(transform_bytes.begin(), transform_bytes.end()));
+  scenepic::Transform scale =
+    Eigen::Map<const scenepic::Transform>(transforms.row(1).data());
+  test::assert_allclose(
+    scale, scenepic::Transforms::scale(2), result, "table_transforms");
+
   return result;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <stdexcept>
 #include <vector>
 
 int test_graph()
@@ -37,5 +38,50 @@ int test_graph()
   graph->add_sparkline("sin", sin_t, scenepic::Colors::Black, 2.0f);
 
   test::assert_equal(graph->to_json(), "graph", result);
+
+  // long sparklines are sent as a pyramid of downsampled levels
+  std::vector<float> steps(10000);
+  std::iota(steps.begin(), steps.end(), 0.0f);
+  auto pyramid = scene.create_graph();
+  pyramid->add_sparkline("steps", steps);
+  pyramid->max_points(100).pyramid_levels(5).value_encoding("float16");
+  scenepic::JsonValue sparkline = pyramid->to_json()["Commands"].values()[3];
+  test::assert_equal(
+    sparkline["FrameCount"].as_int(),
+    std::int64_t(10000),
+    result,
+    "frame_count");
+  const auto& levels = sparkline["Levels"].values();
+  test::assert_equal(levels.size(), std::size_t(5), result, "num_levels");
+  for (std::size_t i = 0; i < levels.size(); ++i)
+  {
+    bool downsampled = levels[i].lookup().count("FrameIndices") > 0;
+    test::assert_equal(downsampled, i < 4, result, "level_indices");
+    test::assert_equal(
+      levels[i].lookup().count("HalfBuffer"),
+      std::size_t(1),
+      result,
+      "level_values");
+  }
+
+  // a single level with the full values needs no frame indices
+  pyramid->max_points(20000).value_encoding("quantized");
+  sparkline = pyramid->to_json()["Commands"].values()[3];
+  test::assert_equal(
+    sparkline["Levels"].values()[0].lookup().count("DeltaBuffer"),
+    std::size_t(1),
+    result,
+    "quantized_values");
+
+  try
+  {
+    pyramid->value_encoding("float8");
+    std::cerr << "invalid_encoding did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
   return result;
 }
\ No newline at end of file
@@ -4,6 +4,15 @@
 #include "scenepic.h"
 #include "scenepic_tests.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
 using scenepic::Scene;
 
 int test_io()
@@ -21,5 +30,334 @@ int test_io()
 
   test::assert_equal(mesh->to_json(), "io", result);
 
+  // quads, relative indices, homogeneous and exponent coordinates
+  std::stringstream obj;
+  obj << "# comment\n"
+      << "o quad\n"
+      << "v 0 0 0\n"
+      << "v 2.0 0.0 0.0 2.0\n"
+      << "v 1e0 1E+0 -0.0\n"
+      << "v 0.0 100e-2 0\r\n"
+      << "vn 0 0 1\n"
+      << "f -4//1 -3//1 -2//1 -1//1\n"
+      << "v 0 0 0\n"
+      << "f 1//1 2//1 -1//-1\n";
+  auto quad_info = scenepic::load_obj(obj);
+  scenepic::VectorBuffer positions(4, 3);
+  positions << 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0;
+  scenepic::TriangleBuffer triangles(3, 3);
+  triangles << 0, 1, 2, 2, 3, 0, 0, 1, 0;
+  test::assert_allclose(
+    scenepic::VectorBuffer(quad_info->position_buffer()),
+    positions,
+    result,
+    "obj_positions");
+  test::assert_equal(
+    (quad_info->triangle_buffer().array() != triangles.array()).count(),
+    Eigen::Index(0),
+    result,
+    "obj_triangles");
+
+  // sequences are loaded in parallel but must come back in frame order,
+  // and vertices which coincide in one frame keep the base topology
+  const int coincident_frame = 5;
+  std::vector<std::string> paths;
+  for (int frame = 0; frame < 8; ++frame)
+  {
+    paths.push_back(
+      test::temp_path("sequence_" + std::to_string(frame) + ".obj"));
+    std::ofstream frame_obj(paths.back());
+    frame_obj << "v 0 0 " << frame << "\n"
+              << "v 1 0 " << frame << "\n"
+              << "v 1 " << (frame == coincident_frame ? 0 : 1) << " " << frame
+              << "\n"
+              << "v 0 1 " << frame << "\n"
+              << "f 1 2 3 4\n";
+  }
+
+  auto base_info = scenepic::load_obj(paths.front());
+  auto base_mesh = scene.create_mesh("base");
+  base_mesh->shared_color(scenepic::Colors::White);
+  base_mesh->add_mesh(base_info);
+  auto updates =
+    scenepic::load_obj_sequence(scene, "base", paths.front(), paths, 3);
+  test::assert_equal(updates.size(), paths.size(), result, "sequence_size");
+  for (std::size_t frame = 0; frame < updates.size(); ++frame)
+  {
+    test::assert_equal(
+      updates[frame]->frame_index(),
+      static_cast<std::uint32_t>(frame),
+      result,
+      "sequence_frame_index");
+    test::assert_near(
+      updates[frame]->vertex_buffer()(0, 2),
+      static_cast<float>(frame),
+      result,
+      "sequence_position");
+  }
+
+  test::assert_allclose(
+    scenepic::VectorBuffer(
+      updates[coincident_frame]->vertex_buffer().block(2, 0, 1, 3)),
+    scenepic::VectorBuffer(scenepic::Vector(1, 0, coincident_frame)),
+    result,
+    "sequence_coincident");
+
+  // a base with coincident vertices keeps them merged when they separate
+  auto collapsed_info = scenepic::load_obj(paths[coincident_frame]);
+  auto collapsed_mesh = scene.create_mesh("collapsed");
+  collapsed_mesh->shared_color(scenepic::Colors::White);
+  collapsed_mesh->add_mesh(collapsed_info);
+  auto separated = scenepic::load_obj_sequence(
+    scene, "collapsed", paths[coincident_frame], {paths[0], paths[1]});
+  test::assert_equal(
+    separated.back()->vertex_buffer().rows(),
+    collapsed_info->position_buffer().rows(),
+    result,
+    "sequence_separated");
+
+  std::string mismatch_path = test::temp_path("sequence_mismatch.obj");
+  std::ofstream mismatch_obj(mismatch_path);
+  mismatch_obj << "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3\n";
+  mismatch_obj.close();
+  try
+  {
+    scenepic::load_obj_sequence(
+      scene, "base", paths.front(), {paths[0], mismatch_path});
+    std::cerr << "sequence_mismatch did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  paths.push_back(mismatch_path);
+  for (const auto& path : paths)
+  {
+    std::remove(path.c_str());
+  }
+
+  // binary PLY round trips
+  auto hand_info = scenepic::load_obj(test::asset_path("hand.obj"));
+  auto colored_info = std::make_shared<scenepic::MeshInfo>(
+    hand_info->position_buffer().rows(),
+    hand_info->triangle_buffer().rows(),
+    false,
+    true,
+    true);
+  colored_info->position_buffer() = hand_info->position_buffer();
+  colored_info->triangle_buffer() = hand_info->triangle_buffer();
+  colored_info->normal_buffer() =
+    hand_info->position_buffer().rowwise().normalized();
+  colored_info->color_buffer() =
+    (hand_info->position_buffer().array() * 0.5f + 0.5f)
+      .min(1.0f)
+      .max(0.0f)
+      .matrix();
+  std::string colored_path = test::temp_path("colored.ply");
+  scenepic::save_ply(colored_path, colored_info);
+  auto colored_ply = scenepic::load_ply(colored_path);
+  test::assert_allclose(
+    scenepic::VectorBuffer(colored_ply->position_buffer()),
+    scenepic::VectorBuffer(colored_info->position_buffer()),
+    result,
+    "ply_positions");
+  test::assert_allclose(
+    scenepic::VectorBuffer(colored_ply->normal_buffer()),
+    scenepic::VectorBuffer(colored_info->normal_buffer()),
+    result,
+    "ply_normals");
+  test::assert_lessthan(
+    (colored_ply->color_buffer() - colored_info->color_buffer())
+      .cwiseAbs()
+      .maxCoeff(),
+    1.0f / 255,
+    result,
+    "ply_colors");
+  test::assert_equal(
+    (colored_ply->triangle_buffer().array() !=
+     colored_info->triangle_buffer().array())
+      .count(),
+    Eigen::Index(0),
+    result,
+    "ply_triangles");
+
+  std::string textured_path = test::temp_path("textured.ply");
+  scenepic::save_ply(textured_path, mesh_info);
+  auto textured_ply = scenepic::load_ply(textured_path);
+  test::assert_allclose(
+    scenepic::UVBuffer(textured_ply->uv_buffer()),
+    scenepic::UVBuffer(mesh_info->uv_buffer()),
+    result,
+    "ply_uvs");
+
+  auto points_info = std::make_shared<scenepic::MeshInfo>(
+    hand_info->position_buffer().rows(), 0, false, false, false);
+  points_info->position_buffer() = hand_info->position_buffer();
+  std::string points_path = test::temp_path("points.ply");
+  scenepic::save_ply(points_path, points_info);
+  auto points_ply = scenepic::load_ply(points_path);
+  test::assert_equal(
+    points_ply->triangle_buffer().rows(),
+    Eigen::Index(0),
+    result,
+    "ply_points_triangles");
+  test::assert_allclose(
+    scenepic::VectorBuffer(points_ply->position_buffer()),
+    scenepic::VectorBuffer(points_info->position_buffer()),
+    result,
+    "ply_points");
+
+  // truncated files and hostile counts are rejected before they are read
+  std::ifstream colored_file(colored_path, std::ios::binary);
+  std::string colored_bytes(
+    (std::istreambuf_iterator<char>(colored_file)),
+    std::istreambuf_iterator<char>());
+  colored_file.close();
+  std::string truncated_path = test::temp_path("truncated.ply");
+  std::ofstream truncated_file(truncated_path, std::ios::binary);
+  truncated_file << colored_bytes.substr(0, colored_bytes.size() - 7);
+  truncated_file.close();
+  std::string hostile_path = test::temp_path("hostile.ply");
+  std::ofstream hostile_file(hostile_path, std::ios::binary);
+  hostile_file << "ply\nformat binary_little_endian 1.0\n"
+               << "element vertex 4611686018427387904\n"
+               << "property float x\nproperty float y\nproperty float z\n"
+               << "end_header\n"
+               << std::string(24, '\0');
+  hostile_file.close();
+  for (const auto& path : {truncated_path, hostile_path})
+  {
+    try
+    {
+      scenepic::load_ply(path);
+      std::cerr << path << " did not throw" << std::endl;
+      result = EXIT_FAILURE;
+    }
+    catch (const std::invalid_argument&)
+    {
+    }
+  }
+
+  // native binary round trips, with and without compression
+  for (bool compress : {false, true})
+  {
+    std::string tag = compress ? "binary_compressed" : "binary";
+    std::string colored_bin_path = test::temp_path(tag + ".bin");
+    std::string textured_bin_path = test::temp_path(tag + "_uv.bin");
+    colored_info->save_binary(colored_bin_path, compress);
+    auto colored_bin = scenepic::MeshInfo::load_binary(colored_bin_path);
+    test::assert_allclose(
+      scenepic::VectorBuffer(colored_bin->position_buffer()),
+      scenepic::VectorBuffer(colored_info->position_buffer()),
+      result,
+      tag + "_positions",
+      0.0f);
+    test::assert_allclose(
+      scenepic::VectorBuffer(colored_bin->normal_buffer()),
+      scenepic::VectorBuffer(colored_info->normal_buffer()),
+      result,
+      tag + "_normals",
+      0.0f);
+    test::assert_allclose(
+      scenepic::ColorBuffer(colored_bin->color_buffer()),
+      scenepic::ColorBuffer(colored_info->color_buffer()),
+      result,
+      tag + "_colors",
+      0.0f);
+    test::assert_equal(
+      (colored_bin->triangle_buffer().array() !=
+       colored_info->triangle_buffer().array())
+        .count(),
+      Eigen::Index(0),
+      result,
+      tag + "_triangles");
+
+    mesh_info->save_binary(textured_bin_path, compress);
+    auto textured_bin = scenepic::MeshInfo::load_binary(textured_bin_path);
+    test::assert_allclose(
+      scenepic::UVBuffer(textured_bin->uv_buffer()),
+      scenepic::UVBuffer(mesh_info->uv_buffer()),
+      result,
+      tag + "_uvs",
+      0.0f);
+    test::assert_equal(
+      textured_bin->color_buffer().rows(),
+      Eigen::Index(0),
+      result,
+      tag + "_no_colors");
+
+    // a header claiming more vertices than the sections can hold, a
+    // compressed positions section overwritten with garbage and a triangle
+    // index past the last vertex
+    for (std::string corruption : {"header", "data", "triangles"})
+    {
+      if ((corruption == "data") != compress && corruption != "header")
+      {
+        continue;
+      }
+
+      std::string corrupt_path = test::temp_path(tag + "_corrupt.bin");
+      std::ifstream bin_file(colored_bin_path, std::ios::binary);
+      std::string bytes(
+        (std::istreambuf_iterator<char>(bin_file)),
+        std::istreambuf_iterator<char>());
+      bin_file.close();
+
+      std::uint64_t positions_offset;
+      std::memcpy(&positions_offset, bytes.data() + 32, sizeof(std::uint64_t));
+      std::uint64_t triangles_offset;
+      std::memcpy(&triangles_offset, bytes.data() + 48, sizeof(std::uint64_t));
+      if (corruption == "data")
+      {
+        bytes.replace(positions_offset, 16, 16, '\xff');
+      }
+      else if (corruption == "triangles")
+      {
+        bytes.replace(triangles_offset, 4, 4, '\xff');
+      }
+      else
+      {
+        std::uint64_t num_vertices = std::uint64_t(1) << 62;
+        std::memcpy(&bytes[16], &num_vertices, sizeof(std::uint64_t));
+      }
+
+      std::ofstream corrupt_file(corrupt_path, std::ios::binary);
+      corrupt_file << bytes;
+      corrupt_file.close();
+      try
+      {
+        scenepic::MeshInfo::load_binary(corrupt_path);
+        std::cerr << tag << "_corrupt_" << corruption << " did not throw"
+                  << std::endl;
+        result = EXIT_FAILURE;
+      }
+      catch (const std::invalid_argument&)
+      {
+      }
+
+      std::remove(corrupt_path.c_str());
+    }
+
+    std::remove(colored_bin_path.c_str());
+    std::remove(textured_bin_path.c_str());
+  }
+
+  try
+  {
+    scenepic::MeshInfo::load_binary(colored_path);
+    std::cerr << "binary_magic did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  for (const auto& path :
+       {colored_path, textured_path, points_path, truncated_path, hostile_path})
+  {
+    std::remove(path.c_str());
+  }
+
   return result;
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "json_value.h"
+
+#include "scenepic_tests.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sp = scenepic;
+
+int test_json_value()
+{
+  int result = EXIT_SUCCESS;
+
+  // members are kept in the order they were added
+  sp::JsonValue obj;
+  obj["b"] = std::int64_t(1);
+  obj["a"] = "text";
+  obj["c"]["d"] = true;
+  obj["b"] = 2.5;
+  std::vector<std::string> keys;
+  for (const auto& member : obj.lookup())
+  {
+    keys.push_back(member.first);
+  }
+
+  test::assert_equal(
+    keys, std::vector<std::string>({"b", "a", "c"}), result, "member_order");
+  test::assert_equal(obj.lookup().size(), std::size_t(3), result, "size");
+  test::assert_equal(obj["b"].as_double(), 2.5, result, "replaced_value");
+  test::assert_equal(
+    obj["b"].as_int(), std::int64_t(2), result, "double_as_int");
+  test::assert_equal(
+    obj.lookup().count("d"), std::size_t(0), result, "missing_count");
+
+  // the text is the same whatever order the members were added in
+  std::stringstream text(obj.to_string());
+  sp::JsonValue parsed = sp::JsonValue::parse(text);
+  test::assert_equal(
+    parsed.to_string(), obj.to_string(), result, "round_trip");
+
+  const sp::JsonValue& const_obj = obj;
+  try
+  {
+    const_obj["d"];
+    std::cerr << "missing_key did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::out_of_range&)
+  {
+  }
+
+  // large objects are searched through an index and keep their order
+  sp::JsonValue large;
+  const int num_members = 1000;
+  for (int i = num_members - 1; i >= 0; --i)
+  {
+    large["key" + std::to_string(i)] = std::int64_t(i);
+  }
+
+  large["key500"] = std::int64_t(-1);
+  bool found = true;
+  for (int i = 0; i < num_members; ++i)
+  {
+    found = found &&
+      large.lookup().at("key" + std::to_string(i)).as_int() ==
+        (i == 500 ? -1 : i);
+  }
+
+  test::assert_equal(found, true, result, "large_find");
+  test::assert_equal(
+    large.lookup().size(),
+    std::size_t(num_members),
+    result,
+    "large_size");
+  test::assert_equal(
+    large.lookup().count("key1000"), std::size_t(0), result, "large_missing");
+  test::assert_equal(
+    large.lookup().begin()->first,
+    std::string("key999"),
+    result,
+    "large_order");
+
+  // moving a value into its parent takes its members without copying them
+  sp::JsonValue child;
+  child["Buffer"] = std::string(1024, 'x');
+  const char* buffer = child["Buffer"].as_string().data();
+  sp::JsonValue parent;
+  parent.append(std::move(child));
+  test::assert_equal(
+    parent.values()[0]["Buffer"].as_string().data() == buffer,
+    true,
+    result,
+    "moved_member");
+
+  return result;
+}
@@ -0,0 +1,179 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "scenepic.h"
+#include "scenepic_tests.h"
+
+#include "base64.h"
+#include "compression.h"
+#include "packing.h"
+
+#include <cmath>
+#include <limits>
+
+namespace sp = scenepic;
+
+namespace
+{
+  template<typename Matrix>
+  Matrix from_json(const sp::JsonValue& value)
+  {
+    std::string buffer = sp::base64_decode(value.as_string());
+    std::vector<std::uint8_t> bytes(buffer.begin(), buffer.end());
+    return sp::decompress_matrix<Matrix>(bytes);
+  }
+} // namespace
+
+int test_packing()
+{
+  int result = EXIT_SUCCESS;
+
+  sp::VectorBuffer normals = sp::random<sp::VectorBuffer>(1000, 3, -1, 1);
+  normals.rowwise().normalize();
+  normals.row(0) << 0, 0, 1;
+  normals.row(1) << 0, 0, -1;
+  normals.row(2) << 1, 0, 0;
+  normals.row(3) << 0, -1, 0;
+
+  sp::VectorBuffer unpacked =
+    sp::unpack_normals(sp::pack_normals_oct16(normals));
+  test::assert_allclose(unpacked, normals, result, "oct16", 1e-4f);
+
+  unpacked = sp::unpack_normals(sp::pack_normals_oct8(normals));
+  test::assert_allclose(unpacked, normals, result, "oct8", 2e-2f);
+
+  sp::ColorBuffer colors = sp::random<sp::ColorBuffer>(1000, 3, 0, 1);
+  sp::ColorBuffer unpacked_colors = sp::unpack_colors(sp::pack_colors(colors));
+  test::assert_allclose(
+    unpacked_colors, colors, result, "colors", 0.5f / 255.0f + test::EPSILON);
+
+  sp::Scene scene;
+  auto mesh = scene.create_mesh("packed");
+  mesh->add_sphere(test::COLOR);
+  mesh->packed_normals(16).packed_colors(true);
+
+  auto definition = mesh->to_json()["Definition"];
+  test::assert_equal(
+    definition["NormalPacking"].as_string(),
+    std::string("OctInt16"),
+    result,
+    "definition_packing");
+  sp::VertexBuffer vertices =
+    from_json<sp::VertexBuffer>(definition["VertexBuffer"]);
+  test::assert_equal(
+    vertices.cols(), Eigen::Index(3), result, "definition_cols");
+  test::assert_allclose(
+    vertices, sp::VertexBuffer(mesh->vertex_positions()), result, "positions");
+  sp::VectorBuffer mesh_normals = sp::unpack_normals(
+    from_json<sp::PackedNormalShortBuffer>(definition["PackedNormalBuffer"]));
+  test::assert_allclose(
+    mesh_normals,
+    sp::VectorBuffer(mesh->vertex_normals().rowwise().normalized()),
+    result,
+    "definition_normals",
+    1e-4f);
+  sp::ColorBuffer mesh_colors = sp::unpack_colors(
+    from_json<sp::PackedColorBuffer>(definition["PackedColorBuffer"]));
+  test::assert_allclose(
+    mesh_colors,
+    sp::ColorBuffer(mesh->vertex_colors()),
+    result,
+    "definition_colors",
+    0.5f / 255.0f + test::EPSILON);
+
+  mesh->packed_normals(8);
+  sp::VectorBuffer positions = mesh->vertex_positions() * 2;
+  sp::VectorBuffer update_normals =
+    mesh->vertex_normals().rowwise().normalized();
+  sp::ColorBuffer update_colors = mesh->vertex_colors();
+  auto update =
+    scene.update_mesh("packed", positions, update_normals, update_colors);
+  auto update_json = update->to_json();
+  test::assert_equal(
+    update_json["NormalPacking"].as_string(),
+    std::string("OctInt8"),
+    result,
+    "update_packing");
+  test::assert_allclose(
+    from_json<sp::VertexBuffer>(update_json["VertexBuffer"]),
+    sp::VertexBuffer(positions),
+    result,
+    "update_positions");
+  test::assert_allclose(
+    sp::unpack_normals(
+      from_json<sp::PackedNormalByteBuffer>(update_json["PackedNormalBuffer"])),
+    update_normals,
+    result,
+    "update_normals",
+    2e-2f);
+
+  sp::VertexBuffer track(500, 2);
+  for (Eigen::Index row = 0; row < track.rows(); ++row)
+  {
+    track(row, 0) = std::sin(row * 0.01f);
+    track(row, 1) = row * 0.5f - 100.0f;
+  }
+
+  std::vector<float> steps = {1e-3f, 0.25f};
+  sp::DeltaBuffer deltas = sp::delta_encode(track, steps);
+  test::assert_equal(deltas.rows(), Eigen::Index(2), result, "delta_rows");
+  test::assert_allclose(
+    sp::delta_decode(deltas, steps), track, result, "delta_decode", 5e-4f);
+
+  sp::JsonValue delta_json;
+  sp::deltas_to_json(deltas, steps, delta_json);
+  test::assert_equal(
+    delta_json["DeltaType"].as_string(),
+    std::string("Int8"),
+    result,
+    "delta_type");
+  test::assert_equal(
+    delta_json["Origin"].values()[1].as_int(),
+    std::int64_t(-400),
+    result,
+    "delta_origin");
+  test::assert_equal(
+    delta_json["DeltaOrder"].as_int(),
+    std::int64_t(2),
+    result,
+    "delta_order");
+  typedef Eigen::Matrix<std::int8_t, Eigen::Dynamic, 1> ByteDeltas;
+  sp::DeltaBuffer rest = deltas.rightCols(track.rows() - 1);
+  rest.rightCols(rest.cols() - 1) -= deltas.middleCols(1, rest.cols() - 1);
+  Eigen::VectorXi expected_deltas =
+    Eigen::Map<const Eigen::VectorXi>(rest.data(), rest.size());
+  Eigen::VectorXi json_deltas =
+    from_json<ByteDeltas>(delta_json["DeltaBuffer"]).cast<int>();
+  test::assert_equal(
+    json_deltas == expected_deltas, true, result, "delta_json");
+
+  // half precision keeps representable values exactly and rounds the rest
+  sp::ValueBuffer halves(8);
+  halves << 1.0f, -2.5f, 65504.0f, std::ldexp(1.0f, -24), 0.0f, 1e6f,
+    -std::numeric_limits<float>::infinity(), 1.0f + std::ldexp(1.0f, -11);
+  sp::ValueBuffer expected_halves = halves;
+  expected_halves(5) = std::numeric_limits<float>::infinity();
+  // a tie between 1 and the next half rounds to the even mantissa
+  expected_halves(7) = 1.0f;
+  sp::ValueBuffer unpacked_halves = sp::unpack_half(sp::pack_half(halves));
+  test::assert_equal(
+    unpacked_halves == expected_halves, true, result, "half_exact");
+
+  sp::ValueBuffer noisy = sp::ValueBuffer::Random(1000) * 100.0f;
+  sp::ValueBuffer noisy_halves = sp::unpack_half(sp::pack_half(noisy));
+  float max_error =
+    ((noisy_halves - noisy).array() / noisy.array().abs()).abs().maxCoeff();
+  test::assert_equal(
+    max_error <= std::ldexp(1.0f, -11), true, result, "half_error");
+
+  try
+  {
+    mesh->packed_normals(12);
+    result = EXIT_FAILURE;
+    std::cerr << "Invalid normal packing did not throw" << std::endl;
+  }
+  catch (std::invalid_argument&)
+  {}
+
+  return result;
+}
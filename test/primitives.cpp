@@ -4,6 +4,12 @@
 #include "scenepic.h"
 #include "scenepic_tests.h"
 
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
 namespace sp = scenepic;
 
 int test_primitives()
@@ -103,5 +109,190 @@ int test_primitives()
   mesh->add_lines(positions, end_points, test::COLOR);
   test::assert_equal(mesh->to_json(), "line_cloud", result);
 
+  sp::VectorBuffer centers = sp::random<sp::VectorBuffer>(8, 3, -1, 1);
+  sp::ColorBuffer colors = sp::random<sp::ColorBuffer>(8, 3, 0, 1);
+  sp::VectorBuffer scales = sp::random<sp::VectorBuffer>(8, 3, 0.1f, 1);
+  sp::QuaternionBuffer rotations =
+    sp::random<sp::QuaternionBuffer>(8, 4, -1, 1);
+  rotations.rowwise().normalize();
+
+  auto batched = scene.create_mesh("batched");
+  auto looped = scene.create_mesh("looped");
+  batched->add_cubes(centers, colors, scales, rotations, true, true);
+  batched->add_spheres(centers, colors, scales, rotations);
+  batched->add_cones(centers, colors, scales, rotations, 0.7f);
+  for (auto i = 0; i < centers.rows(); ++i)
+  {
+    sp::Transform transform = sp::Transforms::translate(centers.row(i)) *
+      sp::Transforms::quaternion_to_matrix(rotations.row(i)) *
+      sp::Transforms::scale(sp::Vector(scales.row(i)));
+    looped->add_cube(colors.row(i), transform, true, true);
+  }
+
+  for (auto i = 0; i < centers.rows(); ++i)
+  {
+    sp::Transform transform = sp::Transforms::translate(centers.row(i)) *
+      sp::Transforms::quaternion_to_matrix(rotations.row(i)) *
+      sp::Transforms::scale(sp::Vector(scales.row(i)));
+    looped->add_sphere(colors.row(i), transform);
+  }
+
+  for (auto i = 0; i < centers.rows(); ++i)
+  {
+    sp::Transform transform = sp::Transforms::translate(centers.row(i)) *
+      sp::Transforms::quaternion_to_matrix(rotations.row(i)) *
+      sp::Transforms::scale(sp::Vector(scales.row(i)));
+    looped->add_cone(colors.row(i), transform, 0.7f);
+  }
+
+  test::assert_allclose(
+    sp::VertexBuffer(batched->vertex_buffer()),
+    sp::VertexBuffer(looped->vertex_buffer()),
+    result,
+    "batched_vertices",
+    1e-5f);
+  test::assert_equal(
+    batched->triangles().rows(),
+    looped->triangles().rows(),
+    result,
+    "batched_triangles");
+  if (result == EXIT_SUCCESS)
+  {
+    test::assert_equal(
+      (batched->triangles().array() != looped->triangles().array()).count(),
+      Eigen::Index(0),
+      result,
+      "batched_triangles");
+  }
+
+  // the batched builders follow the layout of shared color and textured
+  // meshes, apart from cones which have no texture coordinates
+  for (bool textured : {false, true})
+  {
+    std::string tag = textured ? "textured" : "shared_color";
+    sp::Color shared_color = textured ? sp::Color::None() : test::COLOR;
+    std::string texture_id = textured ? texture->image_id() : "";
+    batched = scene.create_mesh(
+      "batched_" + tag, "", false, false, shared_color, texture_id);
+    looped = scene.create_mesh(
+      "looped_" + tag, "", false, false, shared_color, texture_id);
+    batched->add_cubes(centers, sp::ColorBufferNone(), scales, rotations);
+    batched->add_spheres(centers, sp::ColorBufferNone(), scales, rotations);
+    for (auto i = 0; i < centers.rows(); ++i)
+    {
+      sp::Transform transform = sp::Transforms::translate(centers.row(i)) *
+        sp::Transforms::quaternion_to_matrix(rotations.row(i)) *
+        sp::Transforms::scale(sp::Vector(scales.row(i)));
+      looped->add_cube(sp::Color::None(), transform);
+    }
+
+    for (auto i = 0; i < centers.rows(); ++i)
+    {
+      sp::Transform transform = sp::Transforms::translate(centers.row(i)) *
+        sp::Transforms::quaternion_to_matrix(rotations.row(i)) *
+        sp::Transforms::scale(sp::Vector(scales.row(i)));
+      looped->add_sphere(sp::Color::None(), transform);
+    }
+
+    if (textured)
+    {
+      try
+      {
+        batched->add_cones(centers);
+        std::cerr << "textured_cones did not throw" << std::endl;
+        result = EXIT_FAILURE;
+      }
+      catch (const std::invalid_argument&)
+      {
+      }
+    }
+    else
+    {
+      batched->add_cones(centers, sp::ColorBufferNone(), scales, rotations);
+      for (auto i = 0; i < centers.rows(); ++i)
+      {
+        sp::Transform transform = sp::Transforms::translate(centers.row(i)) *
+          sp::Transforms::quaternion_to_matrix(rotations.row(i)) *
+          sp::Transforms::scale(sp::Vector(scales.row(i)));
+        looped->add_cone(sp::Color::None(), transform);
+      }
+    }
+
+    test::assert_allclose(
+      sp::VertexBuffer(batched->vertex_buffer()),
+      sp::VertexBuffer(looped->vertex_buffer()),
+      result,
+      "batched_vertices_" + tag,
+      1e-5f);
+    test::assert_equal(
+      batched->triangles().rows() == looped->triangles().rows() &&
+        batched->triangles() == looped->triangles(),
+      true,
+      result,
+      "batched_triangles_" + tag);
+  }
+
+  // primitive templates are cached, so concurrent calls must all agree
+  sp::Mesh serial(sp::Colors::White);
+  serial.add_icosphere(sp::Color::None(), sp::Transform::Identity(), 3);
+  serial.add_uv_sphere();
+  serial.add_cone(sp::Color::None(), sp::Transform::Identity(), 0.5f, 7, 9);
+  serial.add_cylinder(sp::Color::None(), sp::Transform::Identity(), 12);
+
+  std::vector<sp::Mesh> concurrent(4, sp::Mesh(sp::Colors::White));
+  std::vector<std::thread> threads;
+  for (auto& mesh : concurrent)
+  {
+    threads.emplace_back([&mesh]() {
+      mesh.add_icosphere(sp::Color::None(), sp::Transform::Identity(), 3);
+      mesh.add_uv_sphere();
+      mesh.add_cone(sp::Color::None(), sp::Transform::Identity(), 0.5f, 7, 9);
+      mesh.add_cylinder(sp::Color::None(), sp::Transform::Identity(), 12);
+    });
+  }
+
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (auto& mesh : concurrent)
+  {
+    test::assert_allclose(
+      sp::VertexBuffer(mesh.vertex_buffer()),
+      sp::VertexBuffer(serial.vertex_buffer()),
+      result,
+      "concurrent_vertices");
+  }
+
+  // shared edges should only be drawn once, and feature edges should skip
+  // the diagonals of the flat cube faces
+  sp::VectorBuffer cube_vertices(8, 3);
+  cube_vertices << 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 0, 0, 1, 1, 0, 1, 1, 1,
+    1, 0, 1, 1;
+  sp::TriangleBuffer cube_triangles(12, 3);
+  cube_triangles << 0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4, 1, 2,
+    6, 1, 6, 5, 2, 3, 7, 2, 7, 6, 3, 0, 4, 3, 4, 7;
+  sp::LineBuffer edges = sp::Mesh::compute_edges(cube_triangles);
+  test::assert_equal(edges.rows(), Eigen::Index(18), result, "cube_edges");
+  sp::LineBuffer features =
+    sp::Mesh::compute_feature_edges(cube_vertices, cube_triangles, 30);
+  test::assert_equal(
+    features.rows(), Eigen::Index(12), result, "cube_feature_edges");
+
+  sp::Mesh wireframe(sp::Colors::White);
+  wireframe.add_mesh_without_normals(
+    cube_vertices,
+    cube_triangles,
+    sp::ColorBufferNone(),
+    sp::UVBufferNone(),
+    sp::Transform::Identity(),
+    false,
+    false,
+    true,
+    30);
+  test::assert_equal(
+    wireframe.lines().rows(), Eigen::Index(12), result, "feature_wireframe");
+
   return result;
 }
@@ -7,8 +7,16 @@
 #include "scenepic_tests.h"
 #include "transforms.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
 #include <utility>
+#include <vector>
 
 namespace sp = scenepic;
 
@@ -26,9 +34,84 @@ namespace
     return {vertices, triangles};
   }
 
+  /** Reads the JSON and binary chunks of a GLB file. */
+  sp::JsonValue read_glb(const std::string& path, std::string& bin)
+  {
+    std::ifstream glb(path, std::ios::binary);
+    std::uint32_t header[5];
+    glb.read(reinterpret_cast<char*>(header), sizeof(header));
+    std::string json_chunk(header[3], ' ');
+    glb.read(&json_chunk[0], json_chunk.size());
+    std::uint32_t bin_header[2] = {0, 0};
+    glb.read(reinterpret_cast<char*>(bin_header), sizeof(bin_header));
+    bin.assign(bin_header[0], '\0');
+    glb.read(&bin[0], bin.size());
+    std::stringstream json_stream(json_chunk);
+    return sp::JsonValue::parse(json_stream);
+  }
+
+  /** Reads the values of a tightly packed VEC3 accessor. */
+  sp::VectorBuffer read_vec3(
+    const sp::JsonValue& gltf, const std::string& bin, std::int64_t index)
+  {
+    const auto& accessor = gltf["accessors"].values()[index];
+    const auto& view =
+      gltf["bufferViews"].values()[accessor["bufferView"].as_int()];
+    std::int64_t offset =
+      view["byteOffset"].as_int() + accessor["byteOffset"].as_int();
+    sp::VectorBuffer values(accessor["count"].as_int(), 3);
+    std::memcpy(
+      values.data(), bin.data() + offset, values.size() * sizeof(float));
+    return values;
+  }
+
   const std::size_t SIZE = 500;
 
   const float PI = static_cast<float>(M_PI);
+
+  /** Replaces interned ids with the ids themselves, as the client does. */
+  void resolve_ids(sp::JsonValue& value, const std::vector<std::string>& ids)
+  {
+    static const std::set<std::string> id_keys = {
+      "BaseMeshId", "CanvasId", "LayerId", "MeshId"};
+    static const std::set<std::string> id_list_keys = {
+      "CanvasIds", "LayerIds", "MeshIds"};
+    auto resolve = [&ids](sp::JsonValue& id) {
+      if (id.type() == sp::JsonType::Integer)
+      {
+        id = ids[id.as_int()];
+      }
+    };
+
+    if (value.type() == sp::JsonType::Array)
+    {
+      for (auto& child : value.values())
+      {
+        resolve_ids(child, ids);
+      }
+    }
+    else if (value.type() == sp::JsonType::Object)
+    {
+      for (auto& entry : value.lookup())
+      {
+        if (id_keys.count(entry.first))
+        {
+          resolve(entry.second);
+        }
+        else if (id_list_keys.count(entry.first))
+        {
+          for (auto& id : entry.second.values())
+          {
+            resolve(id.type() == sp::JsonType::Array ? id.values()[0] : id);
+          }
+        }
+        else
+        {
+          resolve_ids(entry.second, ids);
+        }
+      }
+    }
+  }
 }
 
 int test_scene()
@@ -119,5 +202,173 @@ int test_scene()
 
   test::assert_equal(scene.to_json(), "scene_cleared", result);
 
+  // interned ids resolve back to the same script
+  std::string plain = scene.to_json().to_string();
+  scene.intern_ids(true);
+  sp::JsonValue interned = scene.to_json();
+  const sp::JsonValue& id_table = interned.values()[0];
+  test::assert_equal(
+    id_table["CommandType"].as_string(),
+    std::string("SetIdTable"),
+    result,
+    "id_table");
+  std::vector<std::string> ids;
+  for (const auto& id : id_table["Ids"].values())
+  {
+    ids.push_back(id.as_string());
+  }
+
+  test::assert_equal(
+    std::set<std::string>(ids.begin(), ids.end()).size(),
+    ids.size(),
+    result,
+    "unique_ids");
+  test::assert_equal(
+    std::find(ids.begin(), ids.end(), canvas_tet->canvas_id()) != ids.end(),
+    true,
+    result,
+    "interned_canvas_id");
+  sp::JsonValue resolved;
+  resolved.resize(0);
+  for (std::size_t i = 1; i < interned.values().size(); ++i)
+  {
+    resolve_ids(interned.values()[i], ids);
+    resolved.append(interned.values()[i]);
+  }
+
+  test::assert_equal(resolved.to_string(), plain, result, "resolved_ids");
+  scene.intern_ids(false);
+
+  // GLB export, with updates as morph targets and instanced frame nodes
+  sp::Scene glb_scene;
+  auto glb_mesh = glb_scene.create_mesh("tet");
+  glb_mesh->shared_color(sp::Color(1, 0, 0));
+  glb_mesh->add_mesh_without_normals(tet.first, tet.second);
+  for (int i = 0; i < 3; ++i)
+  {
+    sp::VectorBuffer positions = tet.first * (1.0f + i);
+    glb_scene.update_mesh_positions("tet", positions);
+  }
+
+  auto glb_cloud = glb_scene.create_mesh("cloud");
+  glb_cloud->add_cube(sp::Color(0, 0, 1));
+  sp::VectorBuffer instances = sp::VectorBuffer::Random(16, 3);
+  glb_cloud->enable_instancing(instances);
+  glb_scene.update_instanced_mesh(
+    "cloud", instances * 2, sp::QuaternionBufferNone(), sp::ColorBufferNone());
+  std::string glb_path = test::temp_path("scene.glb");
+  glb_scene.save_as_glb(glb_path);
+
+  std::ifstream glb(glb_path, std::ios::binary);
+  std::uint32_t header[5];
+  glb.read(reinterpret_cast<char*>(header), sizeof(header));
+  glb.seekg(0, std::ios::end);
+  test::assert_equal(header[0], 0x46546C67u, result, "glb_magic");
+  test::assert_equal(
+    static_cast<std::uint32_t>(glb.tellg()), header[2], result, "glb_length");
+  glb.seekg(20);
+  std::string json_chunk(header[3], ' ');
+  glb.read(&json_chunk[0], json_chunk.size());
+  std::stringstream json_stream(json_chunk);
+  auto gltf = sp::JsonValue::parse(json_stream);
+  test::assert_equal(
+    gltf["meshes"].values().size(), std::size_t(2), result, "glb_meshes");
+  test::assert_equal(
+    gltf["meshes"].values()[0]["primitives"].values()[0]["targets"]
+      .values()
+      .size(),
+    std::size_t(3),
+    result,
+    "glb_targets");
+  test::assert_equal(
+    gltf["nodes"].values().size(), std::size_t(3), result, "glb_nodes");
+  test::assert_equal(
+    gltf["extensionsUsed"].values()[0].as_string(),
+    std::string("EXT_mesh_gpu_instancing"),
+    result,
+    "glb_extensions");
+  test::assert_equal(
+    gltf["animations"].values()[0]["channels"].values().size(),
+    std::size_t(3),
+    result,
+    "glb_channels");
+  glb.close();
+
+  // morph targets for updates which do not contain every stream
+  sp::Scene morph_scene;
+  sp::ColorBuffer colors = sp::ColorBuffer::Random(4, 3);
+  auto morph_mesh = morph_scene.create_mesh("tet");
+  morph_mesh->add_mesh_without_normals(tet.first, tet.second, colors);
+  sp::ColorBuffer colors_only = sp::ColorBuffer::Random(4, 3);
+  morph_scene.update_mesh(
+    "tet", sp::VectorBufferNone(), sp::VectorBufferNone(), colors_only);
+  sp::VectorBuffer positions = tet.first * 2;
+  sp::ColorBuffer with_positions = sp::ColorBuffer::Random(4, 3);
+  morph_scene.update_mesh(
+    "tet", positions, sp::VectorBufferNone(), with_positions);
+  morph_scene.save_as_glb(glb_path);
+
+  std::string bin;
+  gltf = read_glb(glb_path, bin);
+  const auto& targets =
+    gltf["meshes"].values()[0]["primitives"].values()[0]["targets"].values();
+  test::assert_equal(
+    targets.size(), std::size_t(2), result, "glb_morph_targets");
+  test::assert_allclose(
+    read_vec3(gltf, bin, targets[0]["COLOR_0"].as_int()),
+    sp::VectorBuffer(colors_only - colors),
+    result,
+    "glb_colors_only_target");
+  test::assert_allclose(
+    read_vec3(gltf, bin, targets[1]["POSITION"].as_int()),
+    sp::VectorBuffer(positions - tet.first),
+    result,
+    "glb_positions_target");
+  test::assert_allclose(
+    read_vec3(gltf, bin, targets[1]["COLOR_0"].as_int()),
+    sp::VectorBuffer(with_positions - colors),
+    result,
+    "glb_positions_colors_target");
+
+  // an instanced update with only colors keeps the base translations
+  sp::Scene instance_scene;
+  auto instance_mesh = instance_scene.create_mesh("cloud");
+  instance_mesh->add_cube(sp::Color(0, 0, 1));
+  sp::ColorBuffer instance_colors = sp::ColorBuffer::Random(16, 3);
+  instance_mesh->enable_instancing(
+    instances, sp::QuaternionBufferNone(), instance_colors);
+  sp::ColorBuffer new_colors = sp::ColorBuffer::Random(16, 3);
+  instance_scene.update_instanced_mesh(
+    "cloud", sp::VectorBufferNone(), sp::QuaternionBufferNone(), new_colors);
+  instance_scene.save_as_glb(glb_path);
+  gltf = read_glb(glb_path, bin);
+  const auto& base_instances =
+    gltf["nodes"].values()[0]["extensions"]["EXT_mesh_gpu_instancing"]
+        ["attributes"];
+  const auto& frame_instances =
+    gltf["nodes"].values()[1]["extensions"]["EXT_mesh_gpu_instancing"]
+        ["attributes"];
+  test::assert_equal(
+    frame_instances["TRANSLATION"].as_int(),
+    base_instances["TRANSLATION"].as_int(),
+    result,
+    "glb_instance_translation");
+  test::assert_allclose(
+    read_vec3(gltf, bin, frame_instances["_COLOR_0"].as_int()),
+    sp::VectorBuffer(new_colors),
+    result,
+    "glb_instance_colors");
+
+  // a scene without any meshes has no buffer
+  sp::Scene empty_scene;
+  empty_scene.save_as_glb(glb_path);
+  gltf = read_glb(glb_path, bin);
+  test::assert_equal(
+    gltf.to_string().find("\"buffers\"") == std::string::npos,
+    true,
+    result,
+    "glb_empty_buffers");
+  std::remove(glb_path.c_str());
+
   return result;
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "compression.h"
 #include "internal.h"
 
+#include <cstdlib>
 #include <functional>
 
 namespace sp = scenepic;
@@ -29,6 +30,24 @@ namespace test
     return ASSET_DIR + sep() + asset_name;
   }
 
+  std::string temp_path(const std::string& file_name)
+  {
+    for (const char* name : {"TMPDIR", "TEMP", "TMP"})
+    {
+      const char* dir = std::getenv(name);
+      if (dir != nullptr && dir[0] != '\0')
+      {
+        return std::string(dir) + sep() + "scenepic_" + file_name;
+      }
+    }
+
+#if defined(_WIN32) || defined(WIN32)
+    return "scenepic_" + file_name;
+#else
+    return "/tmp/scenepic_" + file_name;
+#endif
+  }
+
   void assert_near(
     float actual,
     float expected,
@@ -280,24 +299,30 @@ int main(int argc, char** argv)
   tests["camera"] = test_camera;
   tests["canvas2d"] = test_canvas2d;
   tests["canvas3d"] = test_canvas3d;
+  tests["downsample"] = test_downsample;
   tests["drop_down_menu"] = test_drop_down_menu;
   tests["frame2d"] = test_frame2d;
   tests["frame3d"] = test_frame3d;
   tests["graph"] = test_graph;
   tests["image"] = test_image;
   tests["io"] = test_io;
+  tests["json_value"] = test_json_value;
   tests["label"] = test_label;
   tests["layer_settings"] = test_layer_settings;
   tests["matrix"] = test_matrix;
   tests["mesh_update"] = test_mesh_update;
+  tests["packing"] = test_packing;
   tests["primitives"] = test_primitives;
   tests["quantization"] = test_quantization;
   tests["scene"] = test_scene;
   tests["shading"] = test_shading;
+  tests["simplify"] = test_simplify;
+  tests["spatial_sort"] = test_spatial_sort;
   tests["stencil"] = test_stencil;
   tests["text_panel"] = test_text_panel;
   tests["transforms"] = test_transforms;
   tests["ui_parameters"] = test_ui_parameters;
+  tests["util"] = test_util;
   tests["video"] = test_video;
 
   if (argc == 2)
@@ -17,24 +17,30 @@ int test_base64();
 int test_camera();
 int test_canvas2d();
 int test_canvas3d();
+int test_downsample();
 int test_drop_down_menu();
 int test_frame2d();
 int test_frame3d();
 int test_graph();
 int test_image();
 int test_io();
+int test_json_value();
 int test_label();
 int test_layer_settings();
 int test_matrix();
 int test_mesh_update();
+int test_packing();
 int test_primitives();
 int test_quantization();
 int test_scene();
 int test_shading();
+int test_simplify();
+int test_spatial_sort();
 int test_stencil();
 int test_text_panel();
 int test_transforms();
 int test_ui_parameters();
+int test_util();
 int test_video();
 
 namespace test
@@ -42,6 +48,11 @@ namespace test
   const float EPSILON = 1e-5f;
   const scenepic::Color COLOR(0.83863144f, 0.39671423f, 0.77389568f);
   std::string asset_path(const std::string& asset_name);
+
+  /** Return a path in the temporary directory for a file written by a test.
+   *  Tests remove these files once they are done with them.
+   */
+  std::string temp_path(const std::string& file_name);
   void assert_equal(
     const scenepic::JsonValue& actual,
     const std::string& expected_name,
@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "scenepic.h"
+#include "scenepic_tests.h"
+
+namespace sp = scenepic;
+
+namespace
+{
+  std::shared_ptr<sp::MeshInfo> create_grid(int size)
+  {
+    int num_vertices = (size + 1) * (size + 1);
+    int num_triangles = 2 * size * size;
+    auto grid = std::make_shared<sp::MeshInfo>(
+      num_vertices, num_triangles, false, true, false);
+    auto positions = grid->position_buffer();
+    auto normals = grid->normal_buffer();
+    auto triangles = grid->triangle_buffer();
+    for (int row = 0, i = 0; row <= size; ++row)
+    {
+      for (int col = 0; col <= size; ++col, ++i)
+      {
+        positions.row(i) << static_cast<float>(col) / size,
+          static_cast<float>(row) / size, 0;
+        normals.row(i) << 0, 0, 1;
+      }
+    }
+
+    for (int row = 0, t = 0; row < size; ++row)
+    {
+      for (int col = 0; col < size; ++col, t += 2)
+      {
+        std::uint32_t v0 = row * (size + 1) + col;
+        std::uint32_t v1 = v0 + 1;
+        std::uint32_t v2 = v0 + size + 1;
+        std::uint32_t v3 = v2 + 1;
+        triangles.row(t) << v0, v1, v3;
+        triangles.row(t + 1) << v0, v3, v2;
+      }
+    }
+
+    return grid;
+  }
+
+  std::shared_ptr<sp::MeshInfo> create_sphere()
+  {
+    sp::Mesh mesh(sp::Colors::White);
+    mesh.add_icosphere(sp::Color::None(), sp::Transform::Identity(), 4);
+    auto positions = mesh.vertex_positions();
+    auto triangles = mesh.triangles();
+    auto sphere = std::make_shared<sp::MeshInfo>(
+      positions.rows(), triangles.rows(), false, false, false);
+    sphere->position_buffer() = positions;
+    sphere->triangle_buffer() = triangles;
+    return sphere;
+  }
+} // namespace
+
+int test_simplify()
+{
+  int result = EXIT_SUCCESS;
+
+  auto grid = create_grid(32);
+  auto simple_grid = grid->simplify(64);
+  test::assert_lessthan<Eigen::Index>(
+    simple_grid->triangle_buffer().rows(), 64, result, "grid triangles");
+  test::assert_equal<Eigen::Index>(
+    simple_grid->normal_buffer().rows(),
+    simple_grid->position_buffer().rows(),
+    result,
+    "grid normals");
+  test::assert_near(
+    simple_grid->position_buffer().col(2).cwiseAbs().maxCoeff(),
+    0,
+    result,
+    "grid z");
+  test::assert_allclose(
+    sp::Vector(simple_grid->position_buffer().colwise().minCoeff()),
+    sp::Vector(0, 0, 0),
+    result,
+    "grid min");
+  test::assert_allclose(
+    sp::Vector(simple_grid->position_buffer().colwise().maxCoeff()),
+    sp::Vector(1, 1, 0),
+    result,
+    "grid max");
+
+  auto sphere = create_sphere();
+  auto simple_sphere = sphere->simplify(500);
+  test::assert_lessthan<Eigen::Index>(
+    simple_sphere->triangle_buffer().rows(), 500, result, "sphere triangles");
+  test::assert_lessthan<Eigen::Index>(
+    400, simple_sphere->triangle_buffer().rows(), result, "sphere minimum");
+  auto radii = simple_sphere->position_buffer().rowwise().norm();
+  test::assert_near(radii.minCoeff(), 0.5f, result, "sphere min radius", 0.05f);
+  test::assert_near(radii.maxCoeff(), 0.5f, result, "sphere max radius", 0.05f);
+
+  auto bounded_sphere = sphere->simplify(500, 1e-5f);
+  test::assert_lessthan<Eigen::Index>(
+    1000,
+    bounded_sphere->triangle_buffer().rows(),
+    result,
+    "bounded sphere triangles");
+
+  // the error is a distance, so flat regions (and their boundaries) can
+  // still collapse while curved ones stay close to the surface
+  auto bounded_grid = grid->simplify(64, 1e-4f);
+  test::assert_lessthan<Eigen::Index>(
+    bounded_grid->triangle_buffer().rows(),
+    64,
+    result,
+    "bounded grid triangles");
+  auto coarse_sphere = sphere->simplify(100, 5e-3f);
+  test::assert_lessthan<Eigen::Index>(
+    100,
+    coarse_sphere->triangle_buffer().rows(),
+    result,
+    "bounded sphere stops early");
+  auto coarse_radii = coarse_sphere->position_buffer().rowwise().norm();
+  float max_distance = 5e-3f * std::sqrt(3.0f);
+  test::assert_lessthan<float>(
+    (coarse_radii.array() - 0.5f).abs().maxCoeff(),
+    max_distance,
+    result,
+    "bounded sphere distance");
+
+  return result;
+}
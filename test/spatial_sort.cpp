@@ -0,0 +1,132 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "scenepic.h"
+#include "scenepic_tests.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace sp = scenepic;
+
+int test_spatial_sort()
+{
+  int result = EXIT_SUCCESS;
+
+  // the corners of a cube, listed in reverse Morton order
+  sp::VectorBuffer corners(8, 3);
+  for (int i = 0; i < 8; ++i)
+  {
+    int code = 7 - i;
+    corners.row(i) << ((code >> 2) & 1), ((code >> 1) & 1), (code & 1);
+  }
+
+  test::assert_equal(
+    sp::spatial_order(corners, "morton"),
+    std::vector<std::uint32_t>({7, 6, 5, 4, 3, 2, 1, 0}),
+    result,
+    "morton_corners");
+
+  // consecutive points on the Hilbert curve through a grid are neighbours
+  const int size = 8;
+  sp::VectorBuffer grid(size * size * size, 3);
+  std::vector<int> shuffle(grid.rows());
+  std::iota(shuffle.begin(), shuffle.end(), 0);
+  std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(42));
+  for (int i = 0; i < grid.rows(); ++i)
+  {
+    int cell = shuffle[i];
+    grid.row(i) << cell % size, (cell / size) % size, cell / (size * size);
+  }
+
+  std::vector<std::uint32_t> order = sp::spatial_order(grid, "hilbert");
+  std::vector<std::uint32_t> sorted_order(order);
+  std::sort(sorted_order.begin(), sorted_order.end());
+  std::vector<std::uint32_t> identity(order.size());
+  std::iota(identity.begin(), identity.end(), 0);
+  test::assert_equal(sorted_order, identity, result, "hilbert_permutation");
+  float max_step = 0;
+  for (std::size_t i = 1; i < order.size(); ++i)
+  {
+    float step = (grid.row(order[i]) - grid.row(order[i - 1])).cwiseAbs().sum();
+    max_step = std::max(max_step, step);
+  }
+
+  test::assert_equal(max_step, 1.0f, result, "hilbert_step");
+  test::assert_equal(
+    sp::spatial_order(grid, "none"), identity, result, "none_order");
+
+  // sorting the vertices must not change the geometry
+  sp::Mesh mesh;
+  mesh.add_sphere(sp::Colors::White);
+  mesh.add_lines(
+    sp::VertexBuffer::Random(16, 3),
+    sp::VertexBuffer::Random(16, 3),
+    sp::Colors::White);
+  sp::Mesh sorted = mesh;
+  sorted.spatial_sort("hilbert");
+  test::assert_equal(
+    sorted.count_vertices(), mesh.count_vertices(), result, "sort_count");
+  sp::VertexBuffer expected_triangles(mesh.triangles().size(), 9);
+  sp::VertexBuffer actual_triangles(mesh.triangles().size(), 9);
+  for (Eigen::Index i = 0; i < mesh.triangles().size(); ++i)
+  {
+    expected_triangles.row(i) =
+      mesh.vertex_buffer().row(mesh.triangles()(i / 3, i % 3));
+    actual_triangles.row(i) =
+      sorted.vertex_buffer().row(sorted.triangles()(i / 3, i % 3));
+  }
+
+  test::assert_allclose(
+    actual_triangles, expected_triangles, result, "sort_triangles", 0.0f);
+  sp::VertexBuffer expected_lines(mesh.lines().size(), 9);
+  sp::VertexBuffer actual_lines(mesh.lines().size(), 9);
+  for (Eigen::Index i = 0; i < mesh.lines().size(); ++i)
+  {
+    expected_lines.row(i) =
+      mesh.vertex_buffer().row(mesh.lines()(i / 2, i % 2));
+    actual_lines.row(i) =
+      sorted.vertex_buffer().row(sorted.lines()(i / 2, i % 2));
+  }
+
+  test::assert_allclose(
+    actual_lines, expected_lines, result, "sort_lines", 0.0f);
+
+  // instance attributes follow their positions
+  sp::VectorBuffer positions = sp::VectorBuffer::Random(50000, 3);
+  sp::ColorBuffer colors = positions.array() * 0.5f + 0.5f;
+  sp::Mesh cloud(sp::Colors::White);
+  cloud.add_cube();
+  cloud.enable_instancing(
+    positions, sp::QuaternionBufferNone(), colors, "morton");
+  sp::InstanceBuffer instances = cloud.instance_buffer();
+  sp::ColorBuffer expected_colors = instances.leftCols(3).array() * 0.5f + 0.5f;
+  sp::ColorBuffer actual_colors = instances.rightCols(3);
+  test::assert_allclose(
+    actual_colors, expected_colors, result, "instance_colors", 0.0f);
+  std::vector<std::uint32_t> instance_order =
+    sp::spatial_order(positions, "morton");
+  sp::VectorBuffer expected_positions(positions.rows(), 3);
+  for (Eigen::Index i = 0; i < positions.rows(); ++i)
+  {
+    expected_positions.row(i) = positions.row(instance_order[i]);
+  }
+
+  sp::VectorBuffer actual_positions = instances.leftCols(3);
+  test::assert_allclose(
+    actual_positions, expected_positions, result, "instance_positions", 0.0f);
+
+  try
+  {
+    cloud.enable_instancing(positions, sp::QuaternionBufferNone(), colors, "z");
+    std::cerr << "invalid_curve did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  return result;
+}
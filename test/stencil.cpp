@@ -4,6 +4,15 @@
 #include "scenepic.h"
 #include "scenepic_tests.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
 namespace sp = scenepic;
 
 int test_stencil()
@@ -22,5 +31,135 @@ int test_stencil()
   hand_mesh2->add_mesh(hand_hi2);
 
   test::assert_equal(scene.to_json(), "loop_subdivision_stencil", result);
+
+  auto stencil =
+    sp::LoopSubdivisionStencil::create(hand_lo->triangle_buffer(), 2);
+  auto positions = hand_lo->position_buffer();
+  sp::VertexBuffer frames(positions.rows(), 9);
+  frames.middleCols(0, 3) = positions;
+  frames.middleCols(3, 3) = 2 * positions;
+  frames.middleCols(6, 3) = positions.array() + 0.5f;
+
+  sp::VertexBuffer batch = stencil.apply_batch(frames);
+  test::assert_equal(
+    batch.rows(),
+    static_cast<Eigen::Index>(stencil.vertex_count()),
+    result,
+    "batch_rows");
+  for (int frame = 0; frame < 3; ++frame)
+  {
+    sp::VertexBuffer actual = batch.middleCols(3 * frame, 3);
+    sp::VertexBuffer expected = stencil.apply(frames.middleCols(3 * frame, 3));
+    test::assert_allclose(actual, expected, result, "batch_frame");
+  }
+
+  sp::Scene batch_scene;
+  auto base_mesh = batch_scene.create_mesh("base");
+  base_mesh->shared_color(sp::Colors::Blue);
+  base_mesh->add_mesh(hand_hi2);
+  auto updates = stencil.apply_batch(frames, batch_scene, "base");
+  test::assert_equal(updates.size(), std::size_t(3), result, "batch_updates");
+  for (int frame = 0; frame < 3; ++frame)
+  {
+    sp::VertexBuffer actual = updates[frame]->vertex_buffer().leftCols(3);
+    sp::VertexBuffer expected = batch.middleCols(3 * frame, 3);
+    test::assert_allclose(actual, expected, result, "batch_update_frame");
+  }
+
+  std::string stencil_path = test::temp_path("stencil.bin");
+  stencil.save(stencil_path);
+  auto loaded = sp::LoopSubdivisionStencil::load(stencil_path);
+  test::assert_equal(
+    loaded.triangles() == stencil.triangles(), true, result, "load_triangles");
+  sp::VertexBuffer loaded_batch = loaded.apply_batch(frames);
+  test::assert_allclose(loaded_batch, batch, result, "load_apply", 0.0f);
+
+  try
+  {
+    sp::LoopSubdivisionStencil::load(test::asset_path("hand.obj"));
+    std::cerr << "stencil_magic did not throw" << std::endl;
+    result = EXIT_FAILURE;
+  }
+  catch (const std::invalid_argument&)
+  {
+  }
+
+  // a triangle index past the last subdivided vertex, a section moved off
+  // its alignment, and counts which wrap around to match a small section
+  std::ifstream stencil_file(stencil_path, std::ios::binary);
+  std::string stencil_bytes(
+    (std::istreambuf_iterator<char>(stencil_file)),
+    std::istreambuf_iterator<char>());
+  stencil_file.close();
+  std::string corrupt_path = test::temp_path("stencil_corrupt.bin");
+  for (const std::string tag :
+       {"stencil_index",
+        "stencil_alignment",
+        "stencil_rows",
+        "stencil_triangles"})
+  {
+    std::string bytes = stencil_bytes;
+    std::uint64_t offsets[2];
+    std::memcpy(offsets, bytes.data() + 48, sizeof(offsets));
+    std::uint64_t sizes[2];
+    std::memcpy(sizes, bytes.data() + 80, sizeof(sizes));
+    if (tag == "stencil_index")
+    {
+      std::uint32_t index = 0xFFFFFFFF;
+      std::memcpy(&bytes[offsets[0]], &index, sizeof(index));
+    }
+    else if (tag == "stencil_alignment")
+    {
+      offsets[1] += 1;
+      std::memcpy(&bytes[48], offsets, sizeof(offsets));
+    }
+    else if (tag == "stencil_rows")
+    {
+      // rows + 1 wraps to an empty row offsets section
+      std::uint64_t rows = UINT64_MAX;
+      std::memcpy(&bytes[16], &rows, sizeof(rows));
+      sizes[1] = 0;
+      std::memcpy(&bytes[80], sizes, sizeof(sizes));
+    }
+    else
+    {
+      // 3 * num_triangles wraps to a single index
+      std::uint64_t num_triangles = 0xAAAAAAAAAAAAAAABull;
+      std::memcpy(&bytes[40], &num_triangles, sizeof(num_triangles));
+      sizes[0] = sizeof(std::uint32_t);
+      std::memcpy(&bytes[80], sizes, sizeof(sizes));
+    }
+
+    std::ofstream corrupt_file(corrupt_path, std::ios::binary);
+    corrupt_file << bytes;
+    corrupt_file.close();
+    try
+    {
+      sp::LoopSubdivisionStencil::load(corrupt_path);
+      std::cerr << tag << " did not throw" << std::endl;
+      result = EXIT_FAILURE;
+    }
+    catch (const std::invalid_argument&)
+    {
+    }
+  }
+
+  std::remove(corrupt_path.c_str());
+  std::remove(stencil_path.c_str());
+
+  sp::LoopSubdivisionStencil::clear_cache();
+  auto cached = sp::LoopSubdivisionStencil::create_cached(
+    hand_lo->triangle_buffer(), 2);
+  auto shared = sp::LoopSubdivisionStencil::create_cached(
+    hand_lo->triangle_buffer(), 2);
+  auto other = sp::LoopSubdivisionStencil::create_cached(
+    hand_lo->triangle_buffer(), 1);
+  test::assert_equal(cached == shared, true, result, "cache_hit");
+  test::assert_equal(cached == other, false, result, "cache_steps");
+  sp::LoopSubdivisionStencil::clear_cache();
+  auto rebuilt = sp::LoopSubdivisionStencil::create_cached(
+    hand_lo->triangle_buffer(), 2);
+  test::assert_equal(cached == rebuilt, false, result, "cache_clear");
+
   return result;
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "util.h"
+
+#include "scenepic_tests.h"
+
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace sp = scenepic;
+
+int test_util()
+{
+  int result = EXIT_SUCCESS;
+
+  std::vector<std::string> words = {"b", "a", "b", "c", "a", "d"};
+  std::vector<std::string> unique_words;
+  std::vector<std::size_t> word_index;
+  sp::unique_index(words, unique_words, word_index);
+  test::assert_equal(
+    unique_words,
+    std::vector<std::string>({"b", "a", "c", "d"}),
+    result,
+    "unique_words");
+  test::assert_equal(
+    word_index,
+    std::vector<std::size_t>({0, 1, 0, 2, 1, 3}),
+    result,
+    "word_index");
+
+  std::vector<float> zeros = {0.0f, -0.0f, 1.0f, 0.0f};
+  std::vector<float> unique_zeros;
+  std::vector<std::size_t> zero_index;
+  sp::unique_index(zeros, unique_zeros, zero_index);
+  test::assert_equal(
+    zero_index, std::vector<std::size_t>({0, 0, 1, 0}), result, "zero_index");
+
+  typedef std::tuple<int, float, std::string> Key;
+  std::vector<Key> keys = {
+    Key(1, 0.5f, "x"), Key(1, 0.5f, "y"), Key(1, 0.5f, "x"), Key(2, 0.5f, "x")};
+  std::vector<Key> unique_keys;
+  std::vector<std::size_t> key_index;
+  sp::unique_index(keys, unique_keys, key_index);
+  test::assert_equal(unique_keys.size(), std::size_t(3), result, "tuple_keys");
+  test::assert_equal(
+    key_index, std::vector<std::size_t>({0, 1, 0, 2}), result, "tuple_index");
+
+  sp::IndexMap<Eigen::RowVector3f> rows(2);
+  std::uint32_t first = rows.insert(Eigen::RowVector3f(1, 2, 3));
+  std::uint32_t second = rows.insert(Eigen::RowVector3f(3, 2, 1));
+  std::uint32_t repeat = rows.insert(Eigen::RowVector3f(1, 2, 3));
+  test::assert_equal(first, std::uint32_t(0), result, "row_first");
+  test::assert_equal(second, std::uint32_t(1), result, "row_second");
+  test::assert_equal(repeat, std::uint32_t(0), result, "row_repeat");
+  test::assert_equal(rows.size(), std::size_t(2), result, "row_size");
+
+  std::mt19937 rng(12345);
+  std::uniform_int_distribution<int> dist(0, 50000);
+  std::vector<std::pair<int, int>> pairs(200000);
+  for (auto& pair : pairs)
+  {
+    pair = std::make_pair(dist(rng), dist(rng) % 4);
+  }
+
+  std::vector<std::pair<int, int>> expected_pairs;
+  std::vector<std::size_t> expected_index;
+  sp::unique_index(pairs, expected_pairs, expected_index);
+  std::vector<std::pair<int, int>> actual_pairs;
+  std::vector<std::size_t> actual_index;
+  sp::parallel_unique_index(pairs, actual_pairs, actual_index);
+  test::assert_equal(
+    actual_pairs == expected_pairs, true, result, "parallel_unique_items");
+  test::assert_equal(actual_index, expected_index, result, "parallel_index");
+
+  return result;
+}
@@ -240,6 +240,10 @@ export default class Canvas2D extends CanvasBase {
 
     frameCoordinates: Float32Array[] = []; // The coordinates for each frame [frameIndex]
 
+    sharedCoordinates: Uint32Array = null; // The bits of the coordinates shared by all frames
+    sharedStyles: Uint8Array = null; // The styles shared by all frames
+    previousCoordinates: Float32Array = null; // The shared coordinates of the last frame read
+
     center: vec2;
     scale: number;
     angle: number;
@@ -425,6 +429,12 @@ export default class Canvas2D extends CanvasBase {
                 this.layerIds = command["LayerIds"];
                 break;
 
+            case "SetSharedBuffers":
+                this.sharedCoordinates = Misc.Base64ToUInt32Array(command["CoordinateBuffer"]);
+                this.sharedStyles = Misc.Base64ToUInt8Array(command["StyleBuffer"]);
+                this.previousCoordinates = null;
+                break;
+
             default:
                 super.ExecuteCanvasCommand(command);
                 break;
@@ -472,13 +482,37 @@ export default class Canvas2D extends CanvasBase {
         this.frameCoordinates[frameIndex] = coordinates;
     }
 
+    SetSharedCoordinates(frameIndex: number, start: number, count: number, delta: boolean) {
+        let bits = this.sharedCoordinates.slice(start * 2, (start + count) * 2);
+        if (delta) {
+            // coordinates are stored as their bits XOR-ed with the previous frame
+            let previous = new Uint32Array(this.previousCoordinates.buffer, this.previousCoordinates.byteOffset, bits.length);
+            for (let i = 0; i < bits.length; ++i) {
+                bits[i] ^= previous[i];
+            }
+        }
+
+        let coordinates = new Float32Array(bits.buffer);
+        this.previousCoordinates = coordinates;
+        this.SetCoordinates(frameIndex, coordinates);
+    }
+
+    GetStyle(command: any, count: number) {
+        if ("StyleStart" in command) {
+            let start = <number>command["StyleStart"] * 8;
+            return this.sharedStyles.slice(start, start + count * 8);
+        }
+
+        return Misc.Base64ToUInt8Array(command["StyleBuffer"]);
+    }
+
     GetCoordinate(frameIndex: number, index: number) {
         let start = index * 2;
         let end = start + 2;
         return this.frameCoordinates[frameIndex].slice(start, end);
     }
 
-    AddLines(frameIndex: number, lines: Uint16Array, style: Uint8Array, width: Float32Array, layerIds: [string, number][]) {
+    AddLines(frameIndex: number, lines: Uint16Array | Uint32Array, style: Uint8Array, width: Float32Array, layerIds: [string, number][]) {
         let numLines = width.length;
         let layerId = null;
         let nextLayer = numLines;
@@ -532,12 +566,47 @@ export default class Canvas2D extends CanvasBase {
         }
     }
 
+    AddTexts(frameIndex: number, command: any) {
+        let strings = <string[]>command["Strings"];
+        let stringIndices = Misc.Base64ToUInt32Array(command["StringIndices"]);
+        let colors = Misc.Base64ToUInt8Array(command["ColorBuffer"]);
+        let sizes = Misc.Base64ToFloat32Array(command["SizeBuffer"]);
+        let fontFamily = command["Font"];
+        let start = <number>command["Start"];
+        let layerIds = <[string, number][]>Misc.GetDefault(command, "LayerIds", null);
+        let numTexts = stringIndices.length;
+        let layerId = null;
+        let nextLayer = numTexts;
+        let currentLayer = 0;
+        if (layerIds != null) {
+            layerId = layerIds[0][0];
+            nextLayer = currentLayer + layerIds[0][1];
+        }
+
+        for (let i = 0; i < numTexts; ++i) {
+            let text = strings[stringIndices[i]];
+            let fillStyle = "#" + Misc.Byte2Hex(colors[i * 3]) + Misc.Byte2Hex(colors[i * 3 + 1]) + Misc.Byte2Hex(colors[i * 3 + 2]);
+            let position = this.GetCoordinate(frameIndex, start + i);
+            if (i == nextLayer) {
+                currentLayer += 1;
+                layerId = layerIds[currentLayer][0];
+                nextLayer = i + layerIds[currentLayer][1]
+            }
+
+            this.AddPrimitive(frameIndex, new TextPrimitive(text, fillStyle, sizes[i], fontFamily, position, layerId));
+        }
+    }
+
     // Execute a single frame command
     ExecuteFrameCommand(command: any, frameIndex: number) {
         switch (command["CommandType"]) {
             case "SetCoordinates":
-                var coordinates = Misc.Base64ToFloat32Array(command["CoordinateBuffer"])
-                this.SetCoordinates(frameIndex, coordinates);
+                if ("Start" in command) {
+                    this.SetSharedCoordinates(frameIndex, command["Start"], command["Count"], Misc.GetDefault(command, "Delta", false));
+                } else {
+                    var coordinates = Misc.Base64ToFloat32Array(command["CoordinateBuffer"])
+                    this.SetCoordinates(frameIndex, coordinates);
+                }
                 break;
 
             case "AddImage":
@@ -562,16 +631,18 @@ export default class Canvas2D extends CanvasBase {
                 break;
 
             case "AddLines":
-                var lines = Misc.Base64ToUInt16Array(command["InfoBuffer"]);
-                var style = Misc.Base64ToUInt8Array(command["StyleBuffer"]);
+                var lines = Misc.GetDefault(command, "IndexType", "UInt16") == "UInt32" ?
+                    Misc.Base64ToUInt32Array(command["InfoBuffer"]) :
+                    Misc.Base64ToUInt16Array(command["InfoBuffer"]);
                 var width = Misc.Base64ToFloat32Array(command["WidthBuffer"]);
+                var style = this.GetStyle(command, width.length);
                 var layerIds = Misc.GetDefault(command, "LayerIds", null);
                 this.AddLines(frameIndex, lines, style, width, layerIds);
                 break;
 
             case "AddCircles":
                 var circles = Misc.Base64ToFloat32Array(command["InfoBuffer"]);
-                var style = Misc.Base64ToUInt8Array(command["StyleBuffer"]);
+                var style = this.GetStyle(command, circles.length / 4);
                 var layerIds = Misc.GetDefault(command, "LayerIds", null);
                 this.AddCircles(frameIndex, circles, style, layerIds);
                 break;
@@ -586,6 +657,11 @@ export default class Canvas2D extends CanvasBase {
                 var layerId = Misc.GetDefault(command, "LayerId", null);
                 this.AddPrimitive(frameIndex, new TextPrimitive(text, fillStyle, sizeInPixels, fontFamily, position, layerId));
                 break;
+
+            case "AddTexts":
+                this.AddTexts(frameIndex, command);
+                break;
+
             default:
                 super.ExecuteFrameCommand(command, frameIndex);
                 break;
@@ -127,6 +127,8 @@ export default class Canvas3D extends CanvasBase {
 
     // Frame instances
     frameInstances: MeshInstance[][] = []; // [frameIndex][mesh instance within frame]
+    frameStaticCounts: number[] = []; // [frameIndex] number of leading instances taken from the static layer
+    staticInstances: MeshInstance[] = []; // Mesh instances shared by every frame added from now on
 
     // Mesh buffers *for the current frame*
     meshBuffers: any = {}; // The webgl mesh buffers for the currently selected frame: dictionary from meshId to webGLMeshBuffer
@@ -537,6 +539,22 @@ export default class Canvas3D extends CanvasBase {
                     this.SetLayerSettings(layerSettings);
                 break;
 
+            case "AddTransformTrack":
+                this.AddTransformTrack(command);
+                break;
+
+            case "AddCameraTrack":
+                this.AddCameraTrack(command);
+                break;
+
+            case "AddFocusPointTrack":
+                this.AddFocusPointTrack(command);
+                break;
+
+            case "SetStaticMeshes":
+                this.SetStaticMeshes(command);
+                break;
+
             default:
                 super.ExecuteCanvasCommand(command);
                 break;
@@ -562,6 +580,19 @@ export default class Canvas3D extends CanvasBase {
                 this.AddMesh(frameIndex, meshId, transform);
                 break;
 
+            case "AddMeshTable":
+                var meshIds = <string[]>command["MeshIds"];
+                var meshIndices = Misc.Base64ToUInt32Array(command["MeshIndices"]);
+                var transforms = Misc.Base64ToFloat32Array(Misc.GetDefault(command, "Transforms", null));
+                this.AddMeshTable(frameIndex, meshIds, meshIndices, transforms);
+                break;
+
+            case "CopyMeshes":
+                var sourceIndex = <number>this.frameIdToIndexMap[command["FrameId"]];
+                var removed = Misc.Base64ToUInt32Array(Misc.GetDefault(command, "Remove", null));
+                this.CopyMeshes(frameIndex, sourceIndex, removed);
+                break;
+
             case "RemoveMesh":
                 var meshId = command["MeshId"];
                 this.RemoveMesh(frameIndex, meshId);
@@ -655,7 +686,8 @@ export default class Canvas3D extends CanvasBase {
     }
 
     AllocateFrame() {
-        this.frameInstances.push([]);
+        this.frameInstances.push(this.staticInstances.slice());
+        this.frameStaticCounts.push(this.staticInstances.length);
         this.initialFocusPoints.push(this.globalFocusPoint);
         this.currentFocusPoints.push(this.globalFocusPoint);
         this.frameCameraParams.push(this.globalCameraParams);
@@ -663,6 +695,7 @@ export default class Canvas3D extends CanvasBase {
 
     DeallocateFrame(frameIndex: number) {
         this.frameInstances[frameIndex] = [];
+        this.frameStaticCounts[frameIndex] = 0;
     }
 
     AddMesh(frameIndex: number, meshId: string, meshTransform: mat4) {
@@ -687,6 +720,161 @@ export default class Canvas3D extends CanvasBase {
         }
     }
 
+    // Adds every mesh of a compact mesh table, rebuilding the buffers once
+    AddMeshTable(frameIndex: number, meshIds: string[], meshIndices: Uint32Array, transforms: Float32Array) {
+        var instances = this.frameInstances[frameIndex];
+        for (var instance of this.ParseMeshTable(meshIds, meshIndices, transforms))
+            instances.push(instance);
+
+        this.AddMeshLayers(meshIds, this.currentFrameIndex == frameIndex);
+        if (this.currentFrameIndex == frameIndex)
+            this.PrepareBuffers();
+    }
+
+    // Creates the mesh instances described by a compact mesh table
+    ParseMeshTable(meshIds: string[], meshIndices: Uint32Array, transforms: Float32Array) {
+        var instances: MeshInstance[] = [];
+        for (var i = 0; i < meshIndices.length; i++) {
+            var meshId = meshIds[meshIndices[i]];
+            var transform = transforms == null ? mat4.create() : <mat4>transforms.subarray(16 * i, 16 * (i + 1));
+            instances.push(new MeshInstance(meshId, transform));
+        }
+
+        return instances;
+    }
+
+    // Adds settings for any new layers used by the meshes
+    AddMeshLayers(meshIds: string[], warnMissing: boolean) {
+        var addedLayer = false;
+        for (var meshId of meshIds) {
+            let mesh = <Mesh>this.allMeshes[meshId];
+            if (mesh == null) {
+                if (warnMissing)
+                    this.SetWarning("Mesh " + meshId + " does not exist!");
+                continue;
+            }
+
+            if (mesh.layerId != null && !(mesh.layerId in this.layerSettings)) {
+                this.layerSettings[mesh.layerId] = {};
+                addedLayer = true;
+            }
+        }
+
+        if (addedLayer)
+            this.SetLayerSettings(this.layerSettings);
+    }
+
+    // Sets the static layer, i.e. the meshes which start off every frame added from now on
+    SetStaticMeshes(command: any) {
+        var meshIds = <string[]>command["MeshIds"];
+        if (meshIds.length == 0) {
+            this.staticInstances = [];
+            return;
+        }
+
+        var meshIndices = Misc.Base64ToUInt32Array(command["MeshIndices"]);
+        var transforms = Misc.Base64ToFloat32Array(Misc.GetDefault(command, "Transforms", null));
+        this.staticInstances = this.ParseMeshTable(meshIds, meshIndices, transforms);
+        this.AddMeshLayers(meshIds, false);
+    }
+
+    // Adds the meshes of another frame which are not in its static layer, skipping the removed ones
+    CopyMeshes(frameIndex: number, sourceIndex: number, removed: Uint32Array) {
+        if (sourceIndex == null || sourceIndex >= frameIndex) {
+            this.SetWarning("Cannot copy meshes from frame " + sourceIndex + " into frame " + frameIndex);
+            return;
+        }
+
+        var source = this.frameInstances[sourceIndex];
+        var instances = this.frameInstances[frameIndex];
+        var offset = this.frameStaticCounts[sourceIndex];
+        var skip = new Uint8Array(source.length - offset);
+        if (removed != null) {
+            for (var index of removed)
+                skip[index] = 1;
+        }
+
+        for (var i = offset; i < source.length; i++) {
+            if (!skip[i - offset])
+                instances.push(source[i]);
+        }
+
+        if (this.currentFrameIndex == frameIndex)
+            this.PrepareBuffers();
+    }
+
+    // Calls setFrame for each frame covered by a delta-coded track with the values for that frame,
+    // interpolating linearly between keyframes
+    ForEachTrackFrame(command: any, setFrame: (frameIndex: number, values: Float32Array) => void) {
+        var startFrame = <number>command["StartFrame"];
+        var interval = <number>Misc.GetDefault(command, "KeyframeInterval", 1);
+        var columns = Misc.DecodeDeltas(command);
+        var values = new Float32Array(columns.length);
+        var numFrames = (columns[0].length - 1) * interval + 1;
+        for (var i = 0; i < numFrames; i++) {
+            var frameIndex = startFrame + i;
+            if (frameIndex >= this.frameInstances.length) {
+                this.SetWarning(command["CommandType"] + " extends past the last frame");
+                break;
+            }
+
+            var key = Math.floor(i / interval);
+            var t = (i - key * interval) / interval;
+            for (var col = 0; col < columns.length; col++)
+                values[col] = t == 0 ? columns[col][key] : (1 - t) * columns[col][key] + t * columns[col][key + 1];
+
+            setFrame(frameIndex, values);
+        }
+    }
+
+    // Adds a mesh to consecutive frames using a delta-coded track of per-frame transforms
+    AddTransformTrack(command: any) {
+        var meshId = command["MeshId"];
+        var isPose = command["TrackType"] == "Pose";
+        this.ForEachTrackFrame(command, (frameIndex, values) => {
+            var transform = mat4.create();
+            if (isPose) {
+                var rotation = quat.fromValues(values[3], values[4], values[5], values[6]);
+                quat.normalize(rotation, rotation);
+                var translation = vec3.fromValues(values[0], values[1], values[2]);
+                mat4.fromRotationTranslation(transform, rotation, translation);
+            }
+            else {
+                // the track holds the top three rows of each transform
+                for (var row = 0; row < 3; row++)
+                    for (var col = 0; col < 4; col++)
+                        transform[col * 4 + row] = values[row * 4 + col];
+            }
+
+            this.AddMesh(frameIndex, meshId, transform);
+        });
+    }
+
+    // Sets the cameras of consecutive frames from a delta-coded track of center, look-at, up and field of view
+    AddCameraTrack(command: any) {
+        var aspectRatio = <number>command["AspectRatio"];
+        var near = <number>command["NearCropDistance"];
+        var far = <number>command["FarCropDistance"];
+        this.ForEachTrackFrame(command, (frameIndex, values) => {
+            var center = vec3.fromValues(values[0], values[1], values[2]);
+            var lookAt = vec3.fromValues(values[3], values[4], values[5]);
+            var upDir = vec3.fromValues(values[6], values[7], values[8]);
+            vec3.normalize(upDir, upDir);
+            var worldToCamera = mat4.create();
+            mat4.lookAt(worldToCamera, center, lookAt, upDir);
+            var projection = mat4.create();
+            mat4.perspective(projection, values[9] * DegreesToRadians, aspectRatio, near, far);
+            this.SetPerFrameCamera(frameIndex, { "WorldToCamera": worldToCamera, "Projection": projection });
+        });
+    }
+
+    // Sets the focus points of consecutive frames from a delta-coded track
+    AddFocusPointTrack(command: any) {
+        this.ForEachTrackFrame(command, (frameIndex, values) => {
+            this.SetPerFrameFocusPoint(frameIndex, new Float32Array(values));
+        });
+    }
+
     RemoveMesh(frameIndex: number, meshId: string) {
         // Add the mesh id
         var instances = this.frameInstances[frameIndex];
@@ -696,6 +884,8 @@ export default class Canvas3D extends CanvasBase {
             if (instances[meshIndex].meshId == meshId) {
                 // Remove
                 instances.splice(meshIndex, 1);
+                if (meshIndex < this.frameStaticCounts[frameIndex])
+                    this.frameStaticCounts[frameIndex]--;
                 edited = true;
             }
             else {
@@ -195,10 +195,40 @@ class VerticalRule {
     }
 }
 
+// One resolution of a sparkline. The frame indices are null when there is a value for every frame.
+class SparklineLevel {
+    frameIndices: Uint32Array;
+    values: Float32Array;
+
+    constructor(frameIndices: Uint32Array, values: Float32Array) {
+        this.frameIndices = frameIndices;
+        this.values = values;
+    }
+
+    FrameIndex(i: number): number {
+        return this.frameIndices == null ? i : this.frameIndices[i];
+    }
+
+    // Decode the values of a sparkline (or one of its levels) from whichever encoding was used
+    static Parse(obj: any): SparklineLevel {
+        let frameIndices = Misc.Base64ToUInt32Array(Misc.GetDefault(obj, "FrameIndices", null));
+        let values: Float32Array;
+        if ("HalfBuffer" in obj)
+            values = Misc.Base64HalfToFloat32Array(obj["HalfBuffer"]);
+        else if ("DeltaBuffer" in obj)
+            values = Misc.DecodeDeltas(obj)[0];
+        else
+            values = Misc.Base64ToFloat32Array(obj["ValueBuffer"]);
+
+        return new SparklineLevel(frameIndices, values);
+    }
+}
+
 class Sparkline {
     static readonly MARKER_RADIUS = 4;
 
-    values: Float32Array;
+    levels: SparklineLevel[]; // From the coarsest to the finest
+    frameCount: number;
     name: string;
     strokeStyle: string;
     lineWidth: number;
@@ -206,18 +236,35 @@ class Sparkline {
     maxValue: number;
     verticalRules: VerticalRule[];
 
-    constructor(name: string, values: Float32Array, strokeStyle: string, lineWidth: number, verticalRules: VerticalRule[]) {
+    constructor(name: string, levels: SparklineLevel[], frameCount: number, strokeStyle: string, lineWidth: number, verticalRules: VerticalRule[]) {
         this.name = name;
-        this.values = values;
+        this.levels = levels;
+        this.frameCount = frameCount;
         this.strokeStyle = strokeStyle;
         this.lineWidth = lineWidth;
-        this.minValue = Math.min(...values);
-        this.maxValue = Math.max(...values);
         this.verticalRules = verticalRules;
+
+        // a loop, as spreading millions of values into Math.min overflows the stack
+        this.minValue = Infinity;
+        this.maxValue = -Infinity;
+        for (let value of this.levels[this.levels.length - 1].values) {
+            this.minValue = Math.min(this.minValue, value);
+            this.maxValue = Math.max(this.maxValue, value);
+        }
+    }
+
+    // The coarsest level which still has a point for each pixel of the line
+    SelectLevel(width: number): SparklineLevel {
+        for (let level of this.levels) {
+            if (level.values.length >= width)
+                return level;
+        }
+
+        return this.levels[this.levels.length - 1];
     }
 
     Draw(context: CanvasRenderingContext2D, box: Rect, frameIndex: number) {
-        let xScale = box.width / this.values.length;
+        let xScale = box.width / this.frameCount;
         let yScale = 0;
         let yOffset = box.y + 0.5 * box.height;
         if (this.minValue != this.maxValue) {
@@ -240,13 +287,14 @@ class Sparkline {
             context.restore();
         }
 
-        let x = box.x;
-        let y = yOffset - (this.values[0] - this.minValue) * yScale;
+        let level = this.SelectLevel(box.width);
+        let x = box.x + level.FrameIndex(0) * xScale;
+        let y = yOffset - (level.values[0] - this.minValue) * yScale;
         context.beginPath();
         context.moveTo(x, y);
-        for (let value of this.values.slice(1)) {
-            x += xScale;
-            y = yOffset - (value - this.minValue) * yScale;
+        for (let i = 1; i < level.values.length; ++i) {
+            x = box.x + level.FrameIndex(i) * xScale;
+            y = yOffset - (level.values[i] - this.minValue) * yScale;
             context.lineTo(x, y);
         }
 
@@ -259,7 +307,7 @@ class Sparkline {
         context.restore();
 
         x = box.x + xScale * frameIndex;
-        y = yOffset - (this.values[frameIndex] - this.minValue) * yScale;
+        y = yOffset - (this.ValueAt(frameIndex) - this.minValue) * yScale;
         context.beginPath();
         context.arc(x, y, Sparkline.MARKER_RADIUS * window.devicePixelRatio, 0.0, 2.0 * Math.PI, false);
         context.save();
@@ -270,8 +318,31 @@ class Sparkline {
         context.restore();
     }
 
+    // Frames which were downsampled away are interpolated from the finest level
     ValueAt(frameIndex: number): number {
-        return this.values[frameIndex];
+        let level = this.levels[this.levels.length - 1];
+        if (level.frameIndices == null)
+            return level.values[frameIndex];
+
+        let indices = level.frameIndices;
+        let lower = 0;
+        let upper = indices.length - 1;
+        while (upper - lower > 1) {
+            let middle = (lower + upper) >> 1;
+            if (indices[middle] <= frameIndex)
+                lower = middle;
+            else
+                upper = middle;
+        }
+
+        if (indices[upper] <= frameIndex)
+            return level.values[upper];
+
+        if (indices[lower] >= frameIndex)
+            return level.values[lower];
+
+        let t = (frameIndex - indices[lower]) / (indices[upper] - indices[lower]);
+        return level.values[lower] + t * (level.values[upper] - level.values[lower]);
     }
 }
 
@@ -334,7 +405,16 @@ export default class Graph extends CanvasBase {
 
             case "AddSparkline":
                 let name = String(command["Name"]);
-                let values = Misc.Base64ToFloat32Array(command["ValueBuffer"]);
+                let levels: SparklineLevel[] = [];
+                if ("Levels" in command) {
+                    for (let level of command["Levels"]) {
+                        levels.push(SparklineLevel.Parse(level));
+                    }
+                } else {
+                    levels.push(SparklineLevel.Parse(command));
+                }
+
+                let frameCount = Number(Misc.GetDefault(command, "FrameCount", levels[0].values.length));
                 let strokeStyle = String(command["StrokeStyle"]);
                 let lineWidth = Number(command["LineWidth"]);
                 let verticalRules: VerticalRule[] = []
@@ -343,12 +423,12 @@ export default class Graph extends CanvasBase {
                 }
 
                 if (this.sparklines.length == 0) {
-                    for (let i = 0; i < values.length; ++i) {
+                    for (let i = 0; i < frameCount; ++i) {
                         this.AddFrame(i.toString());
                     }
                 }
 
-                this.sparklines.push(new Sparkline(name, values, strokeStyle, lineWidth, verticalRules));
+                this.sparklines.push(new Sparkline(name, levels, frameCount, strokeStyle, lineWidth, verticalRules));
                 break;
 
             default:
@@ -1,7 +1,7 @@
 // NB ONLY TO BE USED INTERNALLY, NOT IN API
 import Misc from "./Misc"
 import { vec3, vec4, mat4 } from "gl-matrix";
-import { VertexBuffer, VertexBufferType } from "./VertexBuffers";
+import { VertexBuffer, VertexBufferType, VertexSegment } from "./VertexBuffers";
 
 export default class Mesh {
     static readonly ElementsPerTriangle: number = 3;
@@ -174,6 +174,14 @@ export default class Mesh {
                 useTextureAlpha = Misc.GetDefault(definition, "UseTextureAlpha", false);
             case "MultiColorMesh":
                 let vertexBuffer = Misc.Base64ToFloat32Array(definition["VertexBuffer"]);
+                let packedNormals = VertexBuffer.ReadPackedNormals(definition);
+                let packedColors = VertexBuffer.ReadPackedColors(definition);
+                if (packedNormals != null || packedColors != null) {
+                    let segments = [new VertexSegment(3, null), new VertexSegment(3, packedNormals)];
+                    if (color == null) segments.push(new VertexSegment(3, packedColors));
+                    if (textureId != null) segments.push(new VertexSegment(2, null));
+                    vertexBuffer = VertexBuffer.Interleave(vertexBuffer, segments);
+                }
                 var indexBufferType = definition["IndexBufferType"];
                 var bytesPerIndex: number, triangleBuffer: ArrayBuffer, lineBuffer: ArrayBuffer;
                 if (indexBufferType == "UInt16") {
@@ -131,6 +131,24 @@ export default class Misc {
             return new Uint16Array(obj);
     }
 
+    // Convert either from Base64 string or from regular array to Int8Array
+    static Base64ToInt8Array(obj: any) {
+        if (obj == null) return null;
+        if (typeof obj == "string")
+            return new Int8Array(Misc.Base64ToArrayBuffer(obj));
+        else
+            return new Int8Array(obj);
+    }
+
+    // Convert either from Base64 string or from regular array to Int16Array
+    static Base64ToInt16Array(obj: any) {
+        if (obj == null) return null;
+        if (typeof obj == "string")
+            return new Int16Array(Misc.Base64ToArrayBuffer(obj));
+        else
+            return new Int16Array(obj);
+    }
+
     // Convert either from Base64 string or from regular array to Int32Array
     static Base64ToUInt32Array(obj: any) {
         if (obj == null) return null;
@@ -140,6 +158,78 @@ export default class Misc {
             return new Uint32Array(obj);
     }
 
+    // Convert either from Base64 string or from regular array to Int32Array
+    static Base64ToInt32Array(obj: any) {
+        if (obj == null) return null;
+        if (typeof obj == "string")
+            return new Int32Array(Misc.Base64ToArrayBuffer(obj));
+        else
+            return new Int32Array(obj);
+    }
+
+    // Convert from a Base64 string of IEEE 754 half precision values to Float32Array
+    static Base64HalfToFloat32Array(obj: any) {
+        var halves = Misc.Base64ToUInt16Array(obj);
+        if (halves == null) return null;
+        var values = new Float32Array(halves.length);
+        for (var i = 0; i < halves.length; i++) {
+            var half = halves[i];
+            var sign = (half & 0x8000) ? -1 : 1;
+            var exponent = (half >> 10) & 0x1f;
+            var mantissa = half & 0x3ff;
+            if (exponent == 0x1f)
+                values[i] = mantissa ? NaN : sign * Infinity;
+            else if (exponent == 0)
+                values[i] = sign * mantissa * Math.pow(2, -24);
+            else
+                values[i] = sign * (mantissa + 1024) * Math.pow(2, exponent - 25);
+        }
+
+        return values;
+    }
+
+    // Decode quantized, delta-coded values ("Steps", "Origin", "DeltaOrder", "DeltaType" and "DeltaBuffer") into one array per column
+    static DecodeDeltas(obj: any): Float32Array[] {
+        var steps = <number[]>obj["Steps"];
+        var origin = <number[]>obj["Origin"];
+        var deltas: Int8Array | Int16Array | Int32Array;
+        switch (obj["DeltaType"]) {
+            case "Int8":
+                deltas = Misc.Base64ToInt8Array(obj["DeltaBuffer"]);
+                break;
+            case "Int16":
+                deltas = Misc.Base64ToInt16Array(obj["DeltaBuffer"]);
+                break;
+            default:
+                deltas = Misc.Base64ToInt32Array(obj["DeltaBuffer"]);
+                break;
+        }
+
+        // the deltas after the first value of each column are stored contiguously
+        var numDeltas = deltas.length / steps.length;
+        var secondOrder = Misc.GetDefault(obj, "DeltaOrder", 1) == 2;
+        var columns: Float32Array[] = [];
+        for (var col = 0; col < steps.length; col++) {
+            var column = new Float32Array(numDeltas + 1);
+            var current = origin[col];
+            var delta = 0;
+            column[0] = current * steps[col];
+            for (var i = 0; i < numDeltas; i++) {
+                if (secondOrder)
+                    delta += deltas[col * numDeltas + i];
+                else
+                    delta = deltas[col * numDeltas + i];
+
+                current += delta;
+                column[i + 1] = current * steps[col];
+            }
+
+            columns.push(column);
+        }
+
+        return columns;
+    }
+
     static GetSearchValue(name: string) {
         var searchStr = location.search.substring(1);
         var vars = searchStr.split('&');
@@ -7,7 +7,7 @@ import DropDownMenu from "./DropDownMenu";
 import InitializeCSSStyles from "./CSSStyles";
 import Misc from "./Misc"
 import Mesh from "./Mesh";
-import { VertexBufferType } from "./VertexBuffers";
+import { VertexBuffer, VertexBufferType } from "./VertexBuffers";
 import { vec2, vec3 } from "gl-matrix";
 import { saveAs } from "file-saver";
 import JSZip from "jszip";
@@ -33,6 +33,13 @@ export default class SPScene {
     // Set of global images and text labels that can be used as textures
     objectCache: ObjectCache;
 
+    // Keys whose values are interned ids, or lists of interned ids
+    static idKeys = new Set<string>(["BaseMeshId", "CanvasId", "LayerId", "MeshId"]);
+    static idListKeys = new Set<string>(["CanvasIds", "LayerIds", "MeshIds"]);
+
+    // Table of interned ids, set when the script was written with interned ids
+    idTable: string[] = null;
+
     // Text panels by id
     textPanels: Map<string, TextPanel> = new Map<string, TextPanel>();
 
@@ -640,6 +647,41 @@ export default class SPScene {
         }
     }
 
+    // Replaces interned ids (indices into the id table) with the ids themselves
+    ResolveIds(command: any) {
+        if (Array.isArray(command)) {
+            for (var child of command)
+                this.ResolveIds(child);
+            return;
+        }
+
+        if (command == null || typeof command !== "object")
+            return;
+
+        for (var key in command) {
+            var value = command[key];
+            if (SPScene.idKeys.has(key)) {
+                if (typeof value === "number")
+                    command[key] = this.idTable[value];
+            }
+            else if (SPScene.idListKeys.has(key)) {
+                // layer ids are run-length encoded as [id, count] pairs
+                for (var i = 0; i < value.length; i++) {
+                    if (Array.isArray(value[i])) {
+                        if (typeof value[i][0] === "number")
+                            value[i][0] = this.idTable[value[i][0]];
+                    }
+                    else if (typeof value[i] === "number") {
+                        value[i] = this.idTable[value[i]];
+                    }
+                }
+            }
+            else {
+                this.ResolveIds(value);
+            }
+        }
+    }
+
     // Execute commands
     ExecuteSceneCommands(command: any) {
         // Support recursive parsing of sub-lists of commands
@@ -653,6 +695,9 @@ export default class SPScene {
         if (!("CommandType" in command))
             this.AddWarning("Expecting \"CommandType\" in Scene Command object: " + JSON.stringify(command));
 
+        if (this.idTable != null)
+            this.ResolveIds(command);
+
         switch (command["CommandType"]) {
             case "ConfigureUserInterface": // Provided for convenience - really a per canvas option
                 for (var canvasId in this.canvases) {
@@ -662,6 +707,10 @@ export default class SPScene {
                 }
                 break;
 
+            case "SetIdTable":
+                this.idTable = command["Ids"];
+                break;
+
             case "SetSceneId":
                 this.SetSceneId(command["SceneId"]);
                 break;
@@ -695,7 +744,7 @@ export default class SPScene {
                 if ("QuantizedBuffer" in command)
                     buffer = Misc.Base64ToUInt16Array(command["QuantizedBuffer"])
                 else
-                    buffer = Misc.Base64ToFloat32Array(command["VertexBuffer"])
+                    buffer = VertexBuffer.UnpackUpdate(command, updateFlags)
 
                 this.UpdateMesh(baseMeshId, meshId, buffer, frameIndex, keyframeIndex, min, max, updateFlags);
                 break;
@@ -1,3 +1,5 @@
+import Misc from "./Misc"
+
 export const enum VertexBufferType {
     None = 0,
     Positions = 1,
@@ -114,4 +116,111 @@ export class VertexBuffer {
 
         return buffer;
     }
-}
\ No newline at end of file
+
+    // Decodes octahedral normals (see packing.h) into unit float normals
+    static DecodeOctahedralNormals(packed: Int8Array | Int16Array, maxValue: number): Float32Array {
+        let normals = new Float32Array((packed.length / 2) * 3);
+        for (let p_i = 0, n_i = 0; p_i < packed.length; p_i += 2, n_i += 3) {
+            let x = Math.max(-1, Math.min(1, packed[p_i] / maxValue));
+            let y = Math.max(-1, Math.min(1, packed[p_i + 1] / maxValue));
+            let z = 1 - Math.abs(x) - Math.abs(y);
+            let t = Math.max(-z, 0);
+            x += x >= 0 ? -t : t;
+            y += y >= 0 ? -t : t;
+            let length = Math.sqrt(x * x + y * y + z * z);
+            normals[n_i] = x / length;
+            normals[n_i + 1] = y / length;
+            normals[n_i + 2] = z / length;
+        }
+
+        return normals;
+    }
+
+    // Reads the packed normals from a mesh definition or update (or null if absent)
+    static ReadPackedNormals(obj: any): Float32Array {
+        switch (Misc.GetDefault(obj, "NormalPacking", null)) {
+            case "OctInt8":
+                return this.DecodeOctahedralNormals(Misc.Base64ToInt8Array(obj["PackedNormalBuffer"]), 127);
+
+            case "OctInt16":
+                return this.DecodeOctahedralNormals(Misc.Base64ToInt16Array(obj["PackedNormalBuffer"]), 32767);
+        }
+
+        return null;
+    }
+
+    // Reads the packed 8-bit colors from a mesh definition or update (or null if absent)
+    static ReadPackedColors(obj: any): Float32Array {
+        let packed = Misc.Base64ToUInt8Array(Misc.GetDefault(obj, "PackedColorBuffer", null));
+        if (packed == null) {
+            return null;
+        }
+
+        let colors = new Float32Array(packed.length);
+        for (let i = 0; i < packed.length; ++i) {
+            colors[i] = packed[i] / 255;
+        }
+
+        return colors;
+    }
+
+    // Interleaves the float buffer with the unpacked streams to restore the standard
+    // vertex layout. Each segment is either a number of columns taken from the float
+    // buffer (values == null) or an unpacked stream with the given number of columns.
+    static Interleave(floats: Float32Array, segments: VertexSegment[]): Float32Array {
+        let elementsPerRow = 0;
+        let floatsPerRow = 0;
+        let numRows = -1;
+        segments.forEach(segment => {
+            elementsPerRow += segment.size;
+            if (segment.values == null) {
+                floatsPerRow += segment.size;
+            } else {
+                numRows = segment.values.length / segment.size;
+            }
+        });
+
+        if (numRows < 0) {
+            return floats;
+        }
+
+        let buffer = new Float32Array(numRows * elementsPerRow);
+        for (let r = 0, b_i = 0, f_i = 0; r < numRows; ++r) {
+            for (let segment of segments) {
+                if (segment.values == null) {
+                    for (let c = 0; c < segment.size; ++c, ++b_i, ++f_i) {
+                        buffer[b_i] = floats[f_i];
+                    }
+                } else {
+                    let s_i = r * segment.size;
+                    for (let c = 0; c < segment.size; ++c, ++b_i) {
+                        buffer[b_i] = segment.values[s_i + c];
+                    }
+                }
+            }
+        }
+
+        return buffer;
+    }
+
+    // Restores the packed streams (if any) of an unquantized mesh update
+    static UnpackUpdate(command: any, updateFlags: VertexBufferType): Float32Array {
+        let floats = Misc.Base64ToFloat32Array(Misc.GetDefault(command, "VertexBuffer", null));
+        let normals = this.ReadPackedNormals(command);
+        let colors = this.ReadPackedColors(command);
+        if (normals == null && colors == null) {
+            return floats;
+        }
+
+        let segments: VertexSegment[] = [];
+        if (updateFlags & VertexBufferType.Positions) segments.push(new VertexSegment(3, null));
+        if (updateFlags & VertexBufferType.Rotations) segments.push(new VertexSegment(4, null));
+        if (updateFlags & VertexBufferType.Normals) segments.push(new VertexSegment(3, normals));
+        if (updateFlags & VertexBufferType.Colors) segments.push(new VertexSegment(3, colors));
+        return this.Interleave(floats, segments);
+    }
+}
+
+export class VertexSegment {
+    constructor(public size: number, public values: Float32Array) { }
+}